@@ -0,0 +1,107 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DDS_ROS_BRIDGE_ASYNC_SENDER_H_
+#define DDS_ROS_BRIDGE_ASYNC_SENDER_H_
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+
+namespace ff {
+
+/**
+ * @brief sends messages to rapid from a thread of its own
+ * @details Large samples take long to copy into DDS and to write, and a
+ *          reliable writer may block until its readers catch up. Push only
+ *          queues the message, which is a shared pointer to the ROS message
+ *          so its payload is not copied, and the send function runs on the
+ *          sender thread. With a depth, the oldest queued messages are
+ *          dropped to make room, so a depth of 1 always sends the latest.
+ *          A depth of 0 queues every message. Messages still queued when
+ *          the sender is destroyed are sent before the destructor returns.
+ */
+template <typename MsgPtr>
+class AsyncSender {
+ public:
+  typedef std::function<void(MsgPtr const&)> SendFunction;
+
+  AsyncSender(SendFunction send, size_t depth)
+    : m_send_(send), m_depth_(depth), m_dropped_(0), m_stop_(false),
+      m_thread_(&AsyncSender::Run, this) {
+  }
+
+  ~AsyncSender() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex_);
+      m_stop_ = true;
+    }
+    m_cond_.notify_one();
+    m_thread_.join();
+  }
+
+  void Push(MsgPtr const& msg) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex_);
+      if (m_depth_ > 0 && m_queue_.size() >= m_depth_) {
+        m_queue_.pop_front();
+        m_dropped_++;
+      }
+      m_queue_.push_back(msg);
+    }
+    m_cond_.notify_one();
+  }
+
+  /**
+   * Number of messages dropped before they could be sent
+   */
+  size_t Dropped() {
+    std::lock_guard<std::mutex> lock(m_mutex_);
+    return m_dropped_;
+  }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(m_mutex_);
+    while (true) {
+      m_cond_.wait(lock, [this]() { return m_stop_ || !m_queue_.empty(); });
+      // Drain the queue before stopping, so no message is lost on shutdown
+      if (m_queue_.empty())
+        return;
+      MsgPtr msg = m_queue_.front();
+      m_queue_.pop_front();
+      lock.unlock();
+      m_send_(msg);
+      lock.lock();
+    }
+  }
+
+  SendFunction m_send_;
+  size_t m_depth_, m_dropped_;
+  bool m_stop_;
+  std::deque<MsgPtr> m_queue_;
+  std::mutex m_mutex_;
+  std::condition_variable m_cond_;
+  std::thread m_thread_;
+};
+
+}  // end namespace ff
+
+#endif  // DDS_ROS_BRIDGE_ASYNC_SENDER_H_
@@ -0,0 +1,132 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DDS_ROS_BRIDGE_CHUNKED_TRANSFER_H_
+#define DDS_ROS_BRIDGE_CHUNKED_TRANSFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace ff {
+
+// Size of the samples a large payload is split into, header included. It is
+// the bound of the RAPID image sample.
+static const size_t kChunkSize = 1048576;
+
+/**
+ * @brief header in front of each chunk of a payload too large for one sample
+ * @details A payload over the bound of its RAPID sample is sent as a series
+ *          of samples, each holding this header followed by a slice of the
+ *          payload. The offset and total size let the receiver place every
+ *          chunk on its own, whatever order they arrive in. The transfer id
+ *          is derived from the payload, so sending the same payload again
+ *          resumes a transfer the receiver did not complete.
+ */
+struct ChunkHeader {
+  static const uint32_t kMagic = 0x4b4e4843;  // "CHNK", little endian
+  static const size_t kSize = 36;
+
+  uint32_t transfer;  // Id of the payload
+  uint32_t sequence;  // Index of this chunk
+  uint32_t count;     // Number of chunks of the payload
+  uint32_t length;    // Bytes of payload in this chunk
+  uint64_t offset;    // Position of the chunk in the payload
+  uint64_t total;     // Size of the whole payload
+
+  // Write the header, little endian, to kSize bytes
+  void Write(uint8_t* out) const;
+
+  // Read the header from the front of a sample. Returns false if the sample
+  // is not a chunk, or if the header does not describe a valid chunk of it.
+  bool Read(uint8_t const* in, size_t size);
+};
+
+/**
+ * Id of a transfer, a 32 bit FNV-1a hash of its payload
+ */
+uint32_t TransferId(uint8_t const* data, size_t size);
+
+/**
+ * @brief splits a payload into chunks
+ * @details Chunks are written straight from the payload into the buffer of the
+ *          outgoing sample, so there is no copy other than the one into the
+ *          sample itself.
+ */
+class ChunkWriter {
+ public:
+  // The chunk size includes the header
+  ChunkWriter(uint8_t const* data, size_t size, size_t chunk_size);
+
+  uint32_t Count() const;
+
+  // Size of a chunk, header included
+  size_t Size(uint32_t sequence) const;
+
+  // Write a chunk to a buffer of at least Size(sequence) bytes
+  void Write(uint32_t sequence, uint8_t* out) const;
+
+ private:
+  uint8_t const* data_;
+  size_t size_, slice_;
+  uint32_t transfer_, count_;
+};
+
+/**
+ * @brief puts payloads back together from their chunks
+ * @details Incomplete transfers are kept, so a sender that starts a payload
+ *          over only fills in the chunks that were missed. Only the most
+ *          recent transfers are kept, and payloads over a maximum size are
+ *          refused.
+ */
+class ChunkReassembler {
+ public:
+  enum Result {
+    NOT_CHUNKED,  // The sample is a whole payload
+    INCOMPLETE,   // The chunk was stored, chunks are still missing
+    COMPLETE,     // The chunk completed the payload
+    INVALID       // The chunk does not match its transfer, or is too large
+  };
+
+  ChunkReassembler(size_t max_transfers, uint64_t max_size);
+
+  // Add a sample. On COMPLETE, the payload is moved to the output.
+  Result Add(uint8_t const* data, size_t size, std::vector<uint8_t>* payload);
+
+  // Chunks still missing from an incomplete transfer
+  std::vector<uint32_t> Missing(uint32_t transfer) const;
+
+ private:
+  struct Transfer {
+    std::vector<uint8_t> payload;
+    std::vector<bool> received;
+    uint32_t remaining;
+  };
+
+  size_t max_transfers_;
+  uint64_t max_size_;
+  std::map<uint32_t, Transfer> transfers_;
+  std::deque<uint32_t> order_;
+};
+
+}  // end namespace ff
+
+#endif  // DDS_ROS_BRIDGE_CHUNKED_TRANSFER_H_
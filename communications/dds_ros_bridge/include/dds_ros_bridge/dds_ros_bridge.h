@@ -24,6 +24,7 @@
 #include <config_reader/config_reader.h>
 #include <dds_ros_bridge/rapid_pub.h>
 #include <dds_ros_bridge/rapid_sub_ros_pub.h>
+#include <dds_ros_bridge/rapid_telemetry_frame.h>
 #include <dds_ros_bridge/ros_sub_rapid_pub.h>
 #include <ff_util/ff_names.h>
 #include <ff_util/ff_nodelet.h>
@@ -146,18 +147,28 @@ class DdsRosBridge : public ff_util::FreeFlyerNodelet {
  protected:
   virtual void Initialize(ros::NodeHandle *nh);
   bool ReadParams();
+  bool ReadTelemetryTolerances(ff::TelemetryTolerances *tol);
+  bool BuildTelemetryFrame();
+  void DiagnosticsCallback(const ros::TimerEvent& event);
 
  private:
   config_reader::ConfigReader config_params_;
 
   int components_;
 
+  // Send images and files over 1 MB in chunks, which only a receiver with a
+  // ChunkReassembler can put back together
+  bool chunk_large_samples_;
+
   ros::NodeHandle nh_;
+  ros::Timer diagnostics_timer_;
 
   std::map<std::string, ff::RosSubRapidPubPtr> m_rosSubRapidPubs_;
   std::shared_ptr<kn::DdsEntitiesFactorySvc> m_ddsEntitiesFactory_;
   std::string agent_name_, participant_name_;
   std::vector<ff::RapidPubPtr> m_rapidPubs_;
+  std::shared_ptr<ff::RapidTelemetryFrame> telemetry_frame_;
+  std::shared_ptr<ff::RapidSubReactor> m_rapidSubReactor_;
   std::vector<ff::RapidSubRosPubPtr> m_rapidSubRosPubs_;
 };
 
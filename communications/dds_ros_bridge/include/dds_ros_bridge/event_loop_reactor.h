@@ -0,0 +1,105 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DDS_ROS_BRIDGE_EVENT_LOOP_REACTOR_H_
+#define DDS_ROS_BRIDGE_EVENT_LOOP_REACTOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ff {
+
+/**
+ * @brief runs event loops shared by many subscriptions on a pool of threads
+ * @details Subscriptions are spread round robin over a fixed number of event
+ *          loops, each processed by its own worker thread, instead of every
+ *          subscription owning a loop and a thread. A loop waits on all of
+ *          its subscriptions at once and dispatches samples as they arrive,
+ *          so the timeout only bounds how long Stop() takes.
+ *          Loop must be constructible from a name and have
+ *          processEvents(Duration). Subscriptions are connected to the loop
+ *          returned by Assign() before Start() is called.
+ */
+template <typename Loop, typename Duration>
+class EventLoopReactor {
+ public:
+  EventLoopReactor(const std::string& name, unsigned int workers,
+                   const Duration& timeout)
+    : m_running_(false), m_timeout_(timeout), m_next_(0) {
+    if (workers == 0)
+      workers = 1;
+    for (unsigned int i = 0; i < workers; i++)
+      m_loops_.emplace_back(new Loop(name + std::to_string(i)));
+  }
+
+  ~EventLoopReactor() {
+    Stop();
+  }
+
+  /**
+   * Returns the loop a new subscription should connect to
+   */
+  Loop& Assign() {
+    Loop& loop = *m_loops_[m_next_];
+    m_next_ = (m_next_ + 1) % m_loops_.size();
+    return loop;
+  }
+
+  /**
+   * Starts a worker thread per loop
+   */
+  void Start() {
+    if (m_running_.exchange(true))
+      return;
+    for (size_t i = 0; i < m_loops_.size(); i++)
+      m_threads_.emplace_back(&EventLoopReactor::Run, this, m_loops_[i].get());
+  }
+
+  /**
+   * Stops and joins the workers, after which no callback is running
+   */
+  void Stop() {
+    m_running_ = false;
+    for (size_t i = 0; i < m_threads_.size(); i++)
+      m_threads_[i].join();
+    m_threads_.clear();
+  }
+
+  size_t Workers() const {
+    return m_loops_.size();
+  }
+
+ private:
+  void Run(Loop* loop) {
+    while (m_running_)
+      loop->processEvents(m_timeout_);
+  }
+
+  std::vector<std::unique_ptr<Loop>> m_loops_;
+  std::vector<std::thread> m_threads_;
+  std::atomic<bool> m_running_;
+  Duration m_timeout_;
+  size_t m_next_;
+};
+
+}  // end namespace ff
+
+#endif  // DDS_ROS_BRIDGE_EVENT_LOOP_REACTOR_H_
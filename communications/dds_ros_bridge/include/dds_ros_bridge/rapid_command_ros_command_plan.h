@@ -34,6 +34,7 @@ class RapidCommandRosCommand : public RapidSubRosPub {
   RapidCommandRosCommand(const std::string& subscribeTopic,
                          const std::string& pubTopic,
                          const ros::NodeHandle &nh,
+                         RapidSubReactor *reactor,
                          const unsigned int queueSize = 10);
 
   /**
@@ -21,6 +21,7 @@
 
 #include <string>
 
+#include "dds_ros_bridge/chunked_transfer.h"
 #include "dds_ros_bridge/rapid_sub_ros_pub.h"
 #include "CompressedFile.h"
 
@@ -31,10 +32,17 @@ class RapidCompressedFileRosCompressedFile : public RapidSubRosPub {
   RapidCompressedFileRosCompressedFile(const std::string& subscribeTopic,
                                        const std::string& pubTopic,
                                        const ros::NodeHandle &nh,
+                                       RapidSubReactor *reactor,
+                                       const bool chunked = false,
                                        const unsigned int queueSize = 10);
 
   // Callback for ddsEventLoop
   void operator() (rapid::ext::astrobee::CompressedFile const* file);
+
+ private:
+  // Whether files over kChunkSize arrive in chunks, or always whole
+  const bool m_chunked_;
+  ChunkReassembler m_reassembler_;
 };
 
 }  // end namespace ff
@@ -37,6 +37,10 @@ class PositionProviderRosHelper : public PositionProvider {
   PositionProviderRosHelper(PositionTopicPairParameters const& params,
                             const std::string& entityName);
   void Publish(const ff_msgs::EkfState::ConstPtr& poseVelCov);
+
+  // Publish in two steps, so the sample can be measured before it is sent
+  PositionSample const& Fill(const ff_msgs::EkfState::ConstPtr& poseVelCov);
+  void Send();
 };
 
 }  // end namespace rapid
@@ -21,47 +21,43 @@
 
 #include <memory>
 #include <string>
-#include <thread>
 
 #include "ros/ros.h"
 #include "knDds/DdsEventLoop.h"
+#include "knShare/Time.h"
+
+#include "dds_ros_bridge/event_loop_reactor.h"
 
 namespace ff {
 
+/**
+ * The event loops shared by the rapid subscribers
+ */
+typedef EventLoopReactor<kn::DdsEventLoop, decltype(kn::milliseconds(0))>
+  RapidSubReactor;
+
 /**
  * @brief base class for rapid subscriber to ros publisher
  * @details base class for rapid subscriber to ros publisher.
- *          A kn::DdsEventLoop is run within its own thread of execution.
+ *          The kn::DdsEventLoop is assigned by a RapidSubReactor, which
+ *          processes it along with the loops of other subscribers.
  *          Child classes must connect requeseted messege and callback
- *          to m_ddsEventLoop and call startThread()
+ *          to m_ddsEventLoop before the reactor is started
  */
 class RapidSubRosPub {
  protected:
   RapidSubRosPub(const std::string& subscribeTopic, const std::string& pubTopic,
-                 const ros::NodeHandle &nh, const std::string& entityName,
+                 const ros::NodeHandle &nh, RapidSubReactor *reactor,
                  const unsigned int queueSize);
   ~RapidSubRosPub();
 
-  /**
-   * Will start thread execution by calling threadExec()
-   */
-  virtual void StartThread();
-
   ros::NodeHandle m_nh_;
   ros::Publisher m_pub_;
   std::string m_subscribeTopic_;
   std::string m_publishTopic_;
   unsigned int m_queueSize_;
 
-  std::thread m_thread_;
-  kn::DdsEventLoop m_ddsEventLoop_;
-
- private:
-  /**
-  * Function to execute within seperate thread
-  *   process DdsEventLoop at 10Hz
-  */
-  virtual void ThreadExec();
+  kn::DdsEventLoop &m_ddsEventLoop_;
 };
 
 typedef std::shared_ptr<RapidSubRosPub> RapidSubRosPubPtr;
@@ -0,0 +1,66 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DDS_ROS_BRIDGE_RAPID_TELEMETRY_FRAME_H_
+#define DDS_ROS_BRIDGE_RAPID_TELEMETRY_FRAME_H_
+
+#include <ros/ros.h>
+
+#include <string>
+#include <vector>
+
+#include "dds_ros_bridge/rapid_pub.h"
+#include "dds_ros_bridge/telemetry_frame.h"
+
+#include "knDds/DdsTypedSupplier.h"
+#include "CompressedFileSupport.h"
+
+namespace ff {
+
+/**
+ * @brief publish the telemetry frames
+ * @details The filters of the state translators add the samples they send to
+ *          the writer, and its frames are published at the frame rate as
+ *          uncompressed CompressedFile samples on their own topic, so the
+ *          ground only sees them if it subscribes to it
+ */
+class RapidTelemetryFrame : public RapidPub {
+ public:
+  RapidTelemetryFrame(const std::string& pubTopic,
+                      const ros::NodeHandle &nh,
+                      float rate,
+                      double quantization,
+                      unsigned int keyframe_interval);
+
+  TelemetryFrameWriter* Writer();
+
+ private:
+  void PubFrame(const ros::TimerEvent& event);
+
+  TelemetryFrameWriter m_writer_;
+  kn::DdsTypedSupplier<rapid::ext::astrobee::CompressedFile> m_supplier_;
+  std::vector<uint8_t> m_frame_;
+  int m_id_;
+
+  ros::NodeHandle m_nh_;
+  ros::Timer m_timer_;
+};
+
+}  // end namespace ff
+
+#endif  // DDS_ROS_BRIDGE_RAPID_TELEMETRY_FRAME_H_
@@ -24,6 +24,8 @@
 
 #include "knDds/DdsTypedSupplier.h"
 
+#include "dds_ros_bridge/async_sender.h"
+#include "dds_ros_bridge/chunked_transfer.h"
 #include "dds_ros_bridge/ros_sub_rapid_pub.h"
 
 #include "ff_msgs/CompressedFile.h"
@@ -36,15 +38,22 @@ class RosCompressedFileToRapid : public RosSubRapidPub {
   RosCompressedFileToRapid(const std::string& subscribeTopic,
                            const std::string& pubTopic,
                            const ros::NodeHandle &nh,
+                           const bool chunked = false,
                            const unsigned int queueSize = 10);
 
   void Callback(ff_msgs::CompressedFile::ConstPtr const& file);
 
  private:
+  void Send(ff_msgs::CompressedFile::ConstPtr const& file);
+
   using Supplier = kn::DdsTypedSupplier<rapid::ext::astrobee::CompressedFile>;
   using SupplierPtr = std::unique_ptr<Supplier>;
 
   SupplierPtr m_supplier_;
+  // Whether files over kChunkSize are sent in chunks, rather than whole
+  const bool m_chunked_;
+  // Last, so the sender thread stops before the supplier is destroyed
+  AsyncSender<ff_msgs::CompressedFile::ConstPtr> m_sender_;
 };
 
 }  // end namespace ff
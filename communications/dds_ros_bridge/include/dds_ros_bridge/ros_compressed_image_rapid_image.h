@@ -20,7 +20,10 @@
 #define DDS_ROS_BRIDGE_ROS_COMPRESSED_IMAGE_RAPID_IMAGE_H_
 
 #include <string>
+#include <vector>
 
+#include "dds_ros_bridge/async_sender.h"
+#include "dds_ros_bridge/chunked_transfer.h"
 #include "dds_ros_bridge/ros_sub_rapid_pub.h"
 #include "sensor_msgs/CompressedImage.h"
 
@@ -38,15 +41,23 @@ class RosCompressedImageRapidImage : public RosSubRapidPub {
   RosCompressedImageRapidImage(const std::string& subscribeTopic,
                                const std::string& pubTopic,
                                const ros::NodeHandle &nh,
+                               const bool chunked = false,
                                const unsigned int queueSize = 10);
 
   void CallBack(const sensor_msgs::CompressedImage::ConstPtr& msg);
 
  private:
+  void Send(const sensor_msgs::CompressedImage::ConstPtr& msg);
   std::string GetRapidMimeType(const std::string& rosFormat);
   rapid::ImageSensorProviderParameters m_params_;
   std::shared_ptr<rapid::ImageSensorProvider> m_provider_;
-  const unsigned int MB_;
+  // Whether images over kChunkSize are sent in chunks, rather than dropped
+  const bool m_chunked_;
+  // Chunks of images over kChunkSize are put together here, allocated once
+  // and reused by the sender thread
+  std::vector<uint8_t> m_chunk_;
+  // Last, so the sender thread stops before the provider is destroyed
+  AsyncSender<sensor_msgs::CompressedImage::ConstPtr> m_sender_;
 };
 
 }  // end namespace ff
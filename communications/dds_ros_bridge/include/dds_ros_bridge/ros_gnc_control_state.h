@@ -4,6 +4,7 @@
 #define DDS_ROS_BRIDGE_ROS_GNC_CONTROL_STATE_H_
 
 #include <string>
+#include <vector>
 
 #include "knDds/DdsTypedSupplier.h"
 
@@ -31,9 +32,14 @@ class RosGncControlStateToRapid : public RosSubRapidPub {
   void MsgCallback(const ff_msgs::ControlStateConstPtr& msg);
   void PubGncControlState(const ros::TimerEvent& event);
   void SetGncPublishRate(float rate);
+  void SetTelemetryTolerances(const TelemetryTolerances& tolerances);
+  void SetTelemetryFrame(TelemetryFrameWriter* writer);
+  void GetTelemetryFilters(
+                  std::vector<const TelemetryFilter*>* filters) const override;
 
  private:
   ff_msgs::ControlStateConstPtr gnc_msg_;
+  TelemetryFilter filter_;
 
   using StateSupplier =
       kn::DdsTypedSupplier<rapid::ext::astrobee::GncControlState>;
@@ -21,6 +21,7 @@
 #define DDS_ROS_BRIDGE_ROS_GNC_FAM_CMD_STATE_H_
 
 #include <string>
+#include <vector>
 
 #include "knDds/DdsTypedSupplier.h"
 
@@ -48,9 +49,14 @@ class RosGncFamCmdStateToRapid : public RosSubRapidPub {
   void MsgCallback(const ff_msgs::FamCommandConstPtr& msg);
   void PubGncFamCmdState(const ros::TimerEvent& event);
   void SetGncPublishRate(float rate);
+  void SetTelemetryTolerances(const TelemetryTolerances& tolerances);
+  void SetTelemetryFrame(TelemetryFrameWriter* writer);
+  void GetTelemetryFilters(
+                  std::vector<const TelemetryFilter*>* filters) const override;
 
  private:
   ff_msgs::FamCommandConstPtr fam_msg_;
+  TelemetryFilter filter_;
 
   using StateSupplier =
       kn::DdsTypedSupplier<rapid::ext::astrobee::GncFamCmdState>;
@@ -20,6 +20,7 @@
 #define DDS_ROS_BRIDGE_ROS_ODOM_RAPID_POSITION_H_
 
 #include <string>
+#include <vector>
 #include <memory>
 
 #include "knDds/DdsTypedSupplier.h"
@@ -53,8 +54,15 @@ class RosOdomRapidPosition : public RosSubRapidPub {
   void PubPosition(const ros::TimerEvent& event);
   void SetEkfPublishRate(float rate);
   void SetPositionPublishRate(float rate);
+  void SetTelemetryTolerances(const TelemetryTolerances& tolerances);
+  void SetTelemetryFrame(TelemetryFrameWriter* writer);
+  void GetTelemetryFilters(
+                  std::vector<const TelemetryFilter*>* filters) const override;
 
  private:
+  // Adds the values of the ekf state shared by the position and ekf samples
+  void AddMotion(TelemetryFilter* filter);
+
   rapid::PositionTopicPairParameters m_params_;
   std::shared_ptr<rapid::PositionProviderRosHelper> m_provider_;
 
@@ -68,6 +76,8 @@ class RosOdomRapidPosition : public RosSubRapidPub {
 
   bool ekf_sent_, pub_ekf_;
 
+  TelemetryFilter ekf_filter_, position_filter_;
+
   ros::Timer ekf_timer_, position_timer_;
 };
 
@@ -22,12 +22,23 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "ros/ros.h"
 
+#include "dds_ros_bridge/telemetry_filter.h"
+
 namespace ff {
 
 class RosSubRapidPub {
+ public:
+  /**
+   * Appends the filters deciding which telemetry is sent, if any
+   */
+  virtual void GetTelemetryFilters(
+                          std::vector<const TelemetryFilter*>* filters) const {
+  }
+
  protected:
   RosSubRapidPub(const std::string& subscribeTopic,
       const std::string& pubTopic, const ros::NodeHandle &nh,
@@ -0,0 +1,41 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DDS_ROS_BRIDGE_SERIALIZED_SIZE_H_
+#define DDS_ROS_BRIDGE_SERIALIZED_SIZE_H_
+
+#include <stddef.h>
+
+#include "EkfStateSupport.h"
+#include "GncControlStateSupport.h"
+#include "GncFamCmdStateSupport.h"
+
+#include "rapidDds/PositionSupport.h"
+
+namespace util {
+
+  // Size of a sample serialized to CDR, encapsulation header included, which
+  // is what it takes on the wire less the RTPS headers
+  size_t SerializedSize(rapid::PositionSample const& sample);
+  size_t SerializedSize(rapid::ext::astrobee::EkfState const& sample);
+  size_t SerializedSize(rapid::ext::astrobee::GncControlState const& sample);
+  size_t SerializedSize(rapid::ext::astrobee::GncFamCmdState const& sample);
+
+}  // end namespace util
+
+#endif  // DDS_ROS_BRIDGE_SERIALIZED_SIZE_H_
@@ -0,0 +1,129 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DDS_ROS_BRIDGE_TELEMETRY_FILTER_H_
+#define DDS_ROS_BRIDGE_TELEMETRY_FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace ff {
+
+class TelemetryFrameWriter;
+
+/**
+ * How much telemetry may change before it is sent again, from the
+ * telemetry_filter table of the bridge config
+ */
+struct TelemetryTolerances {
+  TelemetryTolerances();
+
+  bool enabled;         // if false, every sample is sent
+  double max_interval;  // seconds after which a sample is sent regardless
+  double position;      // m
+  double attitude;      // quaternion components, or attitude error in rad
+  double velocity;      // m/s
+  double omega;         // rad/s
+  double accel;         // m/s^2
+  double alpha;         // rad/s^2
+  double force;         // N
+  double torque;        // Nm
+};
+
+/**
+ * @brief decides which telemetry samples are worth sending to the ground
+ * @details The values of each sample are added in the same order, each with
+ *          its tolerance, and compared to the values of the last sample that
+ *          was sent. A sample is sent when any value moved by more than its
+ *          tolerance, when the max interval has elapsed, or when the filter
+ *          is disabled, so the ground always holds a sample within the
+ *          tolerances of the current one and at most max interval old.
+ *          A tolerance of 0 sends any change. The filter also counts the
+ *          samples and bytes sent and dropped, and the latency from the stamp
+ *          of a sample to it being sent. With a frame writer, the samples
+ *          sent are also added to its frames, each value quantized to its
+ *          tolerance times the quantization of the writer.
+ */
+class TelemetryFilter {
+ public:
+  explicit TelemetryFilter(const std::string& name);
+
+  void SetTolerances(const TelemetryTolerances& tolerances);
+  const TelemetryTolerances& Tolerances() const;
+
+  // Not owned, NULL to stop framing samples
+  void SetFrameWriter(TelemetryFrameWriter* writer);
+
+  /**
+   * Adds a value of the sample being filtered
+   */
+  void Add(double value, double tolerance);
+  template <typename Vector3>
+  void AddVector(const Vector3& v, double tolerance) {
+    Add(v.x, tolerance);
+    Add(v.y, tolerance);
+    Add(v.z, tolerance);
+  }
+  template <typename Quaternion>
+  void AddQuaternion(const Quaternion& q, double tolerance) {
+    Add(q.x, tolerance);
+    Add(q.y, tolerance);
+    Add(q.z, tolerance);
+    Add(q.w, tolerance);
+  }
+
+  /**
+   * Adds a value that is framed with the sample but never decides whether it
+   * is sent, at the given resolution, 0 for exact
+   */
+  void Carry(double value, double resolution);
+
+  /**
+   * Decides whether to send the sample made of the values added since the
+   * last call. The sample is stamped at stamp, it is now now, both in
+   * seconds, and it is bytes large serialized.
+   */
+  bool Update(double now, double stamp, size_t bytes);
+
+  const std::string& Name() const;
+  uint64_t SentSamples() const;
+  uint64_t SentBytes() const;
+  uint64_t DroppedSamples() const;
+  uint64_t DroppedBytes() const;
+  double MeanLatency() const;  // of the samples sent, in seconds
+  double MaxLatency() const;
+  uint64_t FrameBytes() const;  // of the samples added to the frames
+
+ private:
+  std::string name_;
+  TelemetryTolerances tolerances_;
+  TelemetryFrameWriter* writer_;
+  std::vector<double> values_, limits_, resolutions_, sent_;
+  bool has_sent_;
+  double sent_time_;
+  uint64_t sent_samples_, sent_bytes_, dropped_samples_, dropped_bytes_;
+  double latency_sum_, latency_max_;
+  uint64_t frame_bytes_;
+};
+
+}  // end namespace ff
+
+#endif  // DDS_ROS_BRIDGE_TELEMETRY_FILTER_H_
@@ -0,0 +1,150 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DDS_ROS_BRIDGE_TELEMETRY_FRAME_H_
+#define DDS_ROS_BRIDGE_TELEMETRY_FRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace ff {
+
+/**
+ * @brief coalesces the telemetry samples of several topics into frames
+ * @details Each value of a sample is quantized to its resolution and sent as
+ *          the difference to the same value in the previous sample of its
+ *          topic, as a zigzag varint, so a value that barely changed takes a
+ *          byte. A resolution of 0 sends the value exactly, for counts, states
+ *          and values with no tolerance, as the exclusive or of its bits with
+ *          those of the previous value, bit reversed so the mantissa bits that
+ *          did not change cost nothing and an unchanged value a byte. A
+ *          keyframe holds the
+ *          differences to 0, the name of the topic and the resolutions. It is
+ *          sent for the first sample of a topic, every keyframe interval
+ *          samples, and when the number of values or the resolutions change,
+ *          so a receiver that lost a frame recovers at the next keyframe.
+ *
+ *          A frame is the magic "TLMF", a version byte, the frame sequence
+ *          as a varint, the stamp of its first sample in microseconds as 8
+ *          bytes little endian, the number of samples as a varint, and the
+ *          samples. A sample is the topic id, a flags byte, the sequence of
+ *          the sample in its topic, its stamp relative to the frame and its
+ *          number of values as varints, then for keyframes the topic name and
+ *          the resolutions as 4 byte floats, and the values.
+ *
+ *          Samples may be added from several threads.
+ */
+class TelemetryFrameWriter {
+ public:
+  static const uint32_t kMagic = 0x464d4c54;  // "TLMF", little endian
+  static const uint8_t kVersion = 1;
+
+  // quantization is the resolution of a value as a fraction of its tolerance
+  TelemetryFrameWriter(double quantization, uint32_t keyframe_interval);
+
+  double Quantization() const;
+
+  /**
+   * Adds a sample of a topic to the pending frame. Stamp is in seconds, and
+   * a value with a resolution of 0 is sent exactly. Returns the bytes the
+   * sample takes in the frame.
+   */
+  size_t Add(const std::string& topic, double stamp,
+             const std::vector<double>& values,
+             const std::vector<double>& resolutions);
+
+  // Size of the pending frame, header included, 0 if it holds no sample
+  size_t PendingSize() const;
+
+  /**
+   * Moves the pending frame to frame and starts a new one. Returns false,
+   * leaving frame empty, if no sample was added since the last frame.
+   */
+  bool Take(std::vector<uint8_t>* frame);
+
+  uint64_t Frames() const;
+  uint64_t Bytes() const;  // of all the frames taken
+
+ private:
+  struct Topic {
+    uint32_t id;
+    uint32_t sequence;
+    uint32_t since_keyframe;
+    std::vector<double> resolutions;
+    std::vector<int64_t> last;
+  };
+
+  size_t HeaderSize() const;
+
+  double quantization_;
+  uint32_t keyframe_interval_;
+  mutable std::mutex mutex_;
+  std::map<std::string, Topic> topics_;
+  std::vector<uint8_t> samples_;
+  uint32_t count_, sequence_;
+  int64_t base_;
+  uint64_t frames_, bytes_;
+};
+
+/**
+ * @brief reads the frames of a TelemetryFrameWriter back into samples
+ * @details A stand-in for a ground decoder. The samples of a topic are only
+ *          read from its first keyframe on, and when a sample of a topic is
+ *          missing, its next samples are skipped until a keyframe, as their
+ *          differences are to the sample that was lost.
+ */
+class TelemetryFrameReader {
+ public:
+  struct Sample {
+    std::string topic;
+    double stamp;
+    std::vector<double> values;
+  };
+
+  TelemetryFrameReader();
+
+  /**
+   * Appends the samples of a frame. Returns false if the frame is malformed,
+   * in which case the samples read before the error are still appended.
+   */
+  bool Read(uint8_t const* data, size_t size, std::vector<Sample>* samples);
+
+  uint64_t Skipped() const;  // samples that could not be read
+
+ private:
+  struct Topic {
+    Topic() : valid(false), next(0) {}
+    std::string name;
+    bool valid;
+    uint32_t next;
+    std::vector<double> resolutions;
+    std::vector<int64_t> last;
+  };
+
+  std::map<uint32_t, Topic> topics_;
+  uint64_t skipped_;
+};
+
+}  // end namespace ff
+
+#endif  // DDS_ROS_BRIDGE_TELEMETRY_FRAME_H_
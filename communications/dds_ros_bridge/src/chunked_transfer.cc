@@ -0,0 +1,171 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "dds_ros_bridge/chunked_transfer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+void Put32(uint32_t value, uint8_t* out) {
+  for (int i = 0; i < 4; i++)
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void Put64(uint64_t value, uint8_t* out) {
+  for (int i = 0; i < 8; i++)
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint32_t Get32(uint8_t const* in) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++)
+    value |= static_cast<uint32_t>(in[i]) << (8 * i);
+  return value;
+}
+
+uint64_t Get64(uint8_t const* in) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; i++)
+    value |= static_cast<uint64_t>(in[i]) << (8 * i);
+  return value;
+}
+
+}  // namespace
+
+namespace ff {
+
+const uint32_t ChunkHeader::kMagic;
+const size_t ChunkHeader::kSize;
+
+void ChunkHeader::Write(uint8_t* out) const {
+  Put32(kMagic, out);
+  Put32(transfer, out + 4);
+  Put32(sequence, out + 8);
+  Put32(count, out + 12);
+  Put32(length, out + 16);
+  Put64(offset, out + 20);
+  Put64(total, out + 28);
+}
+
+bool ChunkHeader::Read(uint8_t const* in, size_t size) {
+  if (size < kSize || Get32(in) != kMagic)
+    return false;
+  transfer = Get32(in + 4);
+  sequence = Get32(in + 8);
+  count = Get32(in + 12);
+  length = Get32(in + 16);
+  offset = Get64(in + 20);
+  total = Get64(in + 28);
+  return count > 0 && sequence < count && length == size - kSize
+    && offset <= total && length <= total - offset;
+}
+
+uint32_t TransferId(uint8_t const* data, size_t size) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+ChunkWriter::ChunkWriter(uint8_t const* data, size_t size, size_t chunk_size)
+  : data_(data), size_(size), slice_(chunk_size - ChunkHeader::kSize),
+    transfer_(TransferId(data, size)),
+    count_(std::max<size_t>(1, (size + slice_ - 1) / slice_)) {}
+
+uint32_t ChunkWriter::Count() const {
+  return count_;
+}
+
+size_t ChunkWriter::Size(uint32_t sequence) const {
+  size_t offset = sequence * slice_;
+  return ChunkHeader::kSize + std::min(slice_, size_ - offset);
+}
+
+void ChunkWriter::Write(uint32_t sequence, uint8_t* out) const {
+  ChunkHeader header;
+  header.transfer = transfer_;
+  header.sequence = sequence;
+  header.count = count_;
+  header.offset = sequence * slice_;
+  header.length = Size(sequence) - ChunkHeader::kSize;
+  header.total = size_;
+  header.Write(out);
+  std::memcpy(out + ChunkHeader::kSize, data_ + header.offset, header.length);
+}
+
+ChunkReassembler::ChunkReassembler(size_t max_transfers, uint64_t max_size)
+  : max_transfers_(max_transfers), max_size_(max_size) {}
+
+ChunkReassembler::Result ChunkReassembler::Add(uint8_t const* data,
+  size_t size, std::vector<uint8_t>* payload) {
+  ChunkHeader header;
+  if (!header.Read(data, size))
+    return NOT_CHUNKED;
+  // Every chunk but the one of an empty payload carries a byte at least
+  if (header.total > max_size_ || header.count > header.total + 1)
+    return INVALID;
+  auto it = transfers_.find(header.transfer);
+  if (it == transfers_.end()) {
+    // Make room by forgetting the oldest incomplete transfer
+    if (transfers_.size() >= max_transfers_) {
+      transfers_.erase(order_.front());
+      order_.pop_front();
+    }
+    Transfer transfer;
+    transfer.payload.resize(header.total);
+    transfer.received.resize(header.count, false);
+    transfer.remaining = header.count;
+    it = transfers_.emplace(header.transfer, std::move(transfer)).first;
+    order_.push_back(header.transfer);
+  }
+  Transfer & transfer = it->second;
+  if (transfer.payload.size() != header.total
+    || transfer.received.size() != header.count)
+    return INVALID;
+  // A chunk sent again, when a transfer is resumed, is already in place
+  if (transfer.received[header.sequence])
+    return INCOMPLETE;
+  std::memcpy(transfer.payload.data() + header.offset,
+    data + ChunkHeader::kSize, header.length);
+  transfer.received[header.sequence] = true;
+  if (--transfer.remaining > 0)
+    return INCOMPLETE;
+  *payload = std::move(transfer.payload);
+  transfers_.erase(it);
+  order_.erase(std::find(order_.begin(), order_.end(), header.transfer));
+  return COMPLETE;
+}
+
+std::vector<uint32_t> ChunkReassembler::Missing(uint32_t transfer) const {
+  std::vector<uint32_t> missing;
+  auto it = transfers_.find(transfer);
+  if (it == transfers_.end())
+    return missing;
+  for (uint32_t i = 0; i < it->second.received.size(); i++)
+    if (!it->second.received[i])
+      missing.push_back(i);
+  return missing;
+}
+
+}  // end namespace ff
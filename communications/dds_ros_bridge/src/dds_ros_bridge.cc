@@ -16,12 +16,16 @@
  * under the License.
  */
 
+#include <stdio.h>
+
+#include <map>
 #include <string>
 #include <vector>
 
 #include "dds_ros_bridge/dds_ros_bridge.h"
 #include "dds_ros_bridge/rapid_command_ros_command_plan.h"
 #include "dds_ros_bridge/rapid_compressed_file_ros_compressed_file.h"
+#include "dds_ros_bridge/rapid_telemetry_frame.h"
 #include "dds_ros_bridge/ros_access_control.h"
 #include "dds_ros_bridge/ros_ack.h"
 #include "dds_ros_bridge/ros_agent_state.h"
@@ -94,6 +98,9 @@ DdsRosBridge::DdsRosBridge() :
 }
 
 DdsRosBridge::~DdsRosBridge() {
+  // Stop dispatching rapid messages before the subscribers are destroyed
+  if (m_rapidSubReactor_)
+    m_rapidSubReactor_->Stop();
 }
 
 int DdsRosBridge::BuildAccessControlStateToRapid(const std::string& subTopic,
@@ -175,7 +182,8 @@ int DdsRosBridge::BuildCompressedImageToImage(const std::string& subTopic,
                                               const std::string& pubTopic,
                                               const std::string& name) {
   ff::RosSubRapidPubPtr compressedImageToImage(
-                new ff::RosCompressedImageRapidImage(subTopic, pubTopic, nh_));
+                new ff::RosCompressedImageRapidImage(subTopic, pubTopic, nh_,
+                                                     chunk_large_samples_));
   m_rosSubRapidPubs_[name] = compressedImageToImage;
   return m_rosSubRapidPubs_.size();
 }
@@ -302,7 +310,8 @@ int DdsRosBridge::BuildCommandToCommand(const std::string& subTopic,
                                         const std::string& pubTopic,
                                         const std::string& name) {
   ff::RapidSubRosPubPtr commandToCommand(
-                       new ff::RapidCommandRosCommand(subTopic, pubTopic, nh_));
+                       new ff::RapidCommandRosCommand(subTopic, pubTopic, nh_,
+                                                  m_rapidSubReactor_.get()));
   m_rapidSubRosPubs_.push_back(commandToCommand);
   return m_rapidSubRosPubs_.size();
 }
@@ -312,7 +321,9 @@ int DdsRosBridge::BuildCompressedFileToCompressedFile(
                                                     const std::string& pubTopic,
                                                     const std::string& name) {
   ff::RapidSubRosPubPtr compressedFileToCompressedFile(
-        new ff::RapidCompressedFileRosCompressedFile(subTopic, pubTopic, nh_));
+        new ff::RapidCompressedFileRosCompressedFile(subTopic, pubTopic, nh_,
+                                                  m_rapidSubReactor_.get(),
+                                                  chunk_large_samples_));
   m_rapidSubRosPubs_.push_back(compressedFileToCompressedFile);
   return m_rapidSubRosPubs_.size();
 }
@@ -321,7 +332,8 @@ int DdsRosBridge::BuildCompressedFileToRapid(const std::string& subTopic,
                                              const std::string& pubTopic,
                                              const std::string& name) {
   ff::RosSubRapidPubPtr compressedFileToRapid(
-          new ff::RosCompressedFileToRapid(subTopic, pubTopic, nh_));
+          new ff::RosCompressedFileToRapid(subTopic, pubTopic, nh_,
+                                           chunk_large_samples_));
   m_rosSubRapidPubs_[name] = compressedFileToRapid;
   return m_rosSubRapidPubs_.size();
 }
@@ -495,10 +507,29 @@ void DdsRosBridge::Initialize(ros::NodeHandle *nh) {
   m_ddsEntitiesFactory_.reset(new kn::DdsEntitiesFactorySvc());
   m_ddsEntitiesFactory_->init(ddsParams);
 
+  // The rapid subscribers share the event loops of a few worker threads
+  unsigned int workers;
+  if (!config_params_.GetUInt("rapid_sub_workers", &workers)) {
+    ROS_FATAL("DDS Bridge: rapid sub workers not specified!");
+    exit(EXIT_FAILURE);
+    return;
+  }
+  m_rapidSubReactor_.reset(new ff::RapidSubReactor("RapidSubRosPub", workers,
+                                                   kn::milliseconds(100)));
+
   if (!ReadParams()) {
     exit(EXIT_FAILURE);
     return;
   }
+
+  // All subscribers are connected, start dispatching their messages
+  m_rapidSubReactor_->Start();
+
+  // Report what the telemetry filters sent and dropped
+  diagnostics_timer_ = nh->createTimer(
+                              ros::Duration(ros::Rate(DEFAULT_DIAGNOSTICS_RATE)),
+                              &DdsRosBridge::DiagnosticsCallback, this, false,
+                              true);
 }
 
 bool DdsRosBridge::ReadParams() {
@@ -508,6 +539,11 @@ bool DdsRosBridge::ReadParams() {
 
   components_ = 0;
 
+  if (!config_params_.GetBool("chunk_large_samples", &chunk_large_samples_)) {
+    ROS_FATAL("DDS Bridge: chunk large samples not specified!");
+    return false;
+  }
+
   // rapid_command_ros_command => RCRC
   if (!config_params_.GetBool("use_RCRC", &use)) {
     ROS_FATAL("DDS Bridge: use RCRC not specified");
@@ -1079,9 +1115,131 @@ bool DdsRosBridge::ReadParams() {
 
   RBSRBS->SetBatteryTimeMultiple(multiple);
 
+  // Read in how much the state telemetry has to change before it is sent
+  ff::TelemetryTolerances tolerances;
+  if (!ReadTelemetryTolerances(&tolerances)) {
+    return false;
+  }
+  RGCC->SetTelemetryTolerances(tolerances);
+  RGCS->SetTelemetryTolerances(tolerances);
+  RGCT->SetTelemetryTolerances(tolerances);
+  RORP->SetTelemetryTolerances(tolerances);
+
+  // Coalesce the state telemetry that is sent into frames, on its own topic
+  if (!BuildTelemetryFrame()) {
+    return false;
+  }
+  if (telemetry_frame_) {
+    ff::TelemetryFrameWriter *writer = telemetry_frame_->Writer();
+    RGCC->SetTelemetryFrame(writer);
+    RGCS->SetTelemetryFrame(writer);
+    RGCT->SetTelemetryFrame(writer);
+    RORP->SetTelemetryFrame(writer);
+  }
+
+  return true;
+}
+
+bool DdsRosBridge::BuildTelemetryFrame() {
+  config_reader::ConfigReader::Table table;
+  if (!config_params_.GetTable("telemetry_frame", &table)) {
+    ROS_FATAL("DDS Bridge: telemetry frame not specified!");
+    return false;
+  }
+
+  bool enabled;
+  double rate, quantization;
+  unsigned int keyframe_interval;
+  std::string pubTopic;
+  if (!table.GetBool("enabled", &enabled) ||
+      !table.GetReal("rate", &rate) ||
+      !table.GetReal("quantization", &quantization) ||
+      !table.GetUInt("keyframe_interval", &keyframe_interval) ||
+      !table.GetStr("pub_topic", &pubTopic)) {
+    ROS_FATAL("DDS Bridge: telemetry frame parameters not specified!");
+    return false;
+  }
+
+  if (!enabled || telemetry_frame_) {
+    return true;
+  }
+
+  if (rate <= 0) {
+    ROS_FATAL("DDS Bridge: telemetry frame rate must be positive!");
+    return false;
+  }
+
+  telemetry_frame_.reset(new ff::RapidTelemetryFrame(pubTopic, nh_, rate,
+                                                     quantization,
+                                                     keyframe_interval));
+  m_rapidPubs_.push_back(telemetry_frame_);
+  return true;
+}
+
+bool DdsRosBridge::ReadTelemetryTolerances(ff::TelemetryTolerances *tol) {
+  config_reader::ConfigReader::Table table;
+  if (!config_params_.GetTable("telemetry_filter", &table)) {
+    ROS_FATAL("DDS Bridge: telemetry filter not specified!");
+    return false;
+  }
+
+  if (!table.GetBool("enabled", &tol->enabled) ||
+      !table.GetReal("max_interval", &tol->max_interval) ||
+      !table.GetReal("position", &tol->position) ||
+      !table.GetReal("attitude", &tol->attitude) ||
+      !table.GetReal("velocity", &tol->velocity) ||
+      !table.GetReal("omega", &tol->omega) ||
+      !table.GetReal("accel", &tol->accel) ||
+      !table.GetReal("alpha", &tol->alpha) ||
+      !table.GetReal("force", &tol->force) ||
+      !table.GetReal("torque", &tol->torque)) {
+    ROS_FATAL("DDS Bridge: telemetry filter tolerances not specified!");
+    return false;
+  }
+
   return true;
 }
 
+void DdsRosBridge::DiagnosticsCallback(const ros::TimerEvent& event) {
+  std::vector<const ff::TelemetryFilter*> filters;
+  std::map<std::string, ff::RosSubRapidPubPtr>::const_iterator it;
+  for (it = m_rosSubRapidPubs_.begin(); it != m_rosSubRapidPubs_.end(); it++)
+    it->second->GetTelemetryFilters(&filters);
+
+  std::vector<diagnostic_msgs::KeyValue> keyval;
+  diagnostic_msgs::KeyValue kv;
+  char value[160];
+  for (size_t i = 0; i < filters.size(); i++) {
+    const ff::TelemetryFilter *f = filters[i];
+    snprintf(value, sizeof(value),
+             "sent %llu (%.1f kB), dropped %llu (%.1f kB), "
+             "latency mean %.1f ms max %.1f ms",
+             static_cast<unsigned long long>(f->SentSamples()),  // NOLINT
+             f->SentBytes() / 1e3,
+             static_cast<unsigned long long>(f->DroppedSamples()),  // NOLINT
+             f->DroppedBytes() / 1e3, 1e3 * f->MeanLatency(),
+             1e3 * f->MaxLatency());
+    kv.key = f->Name();
+    kv.value = value;
+    if (telemetry_frame_) {
+      snprintf(value, sizeof(value), ", framed %.1f kB",
+               f->FrameBytes() / 1e3);
+      kv.value += value;
+    }
+    keyval.push_back(kv);
+  }
+  if (telemetry_frame_) {
+    const ff::TelemetryFrameWriter *writer = telemetry_frame_->Writer();
+    snprintf(value, sizeof(value), "%llu frames (%.1f kB)",
+             static_cast<unsigned long long>(writer->Frames()),  // NOLINT
+             writer->Bytes() / 1e3);
+    kv.key = "telemetry_frame";
+    kv.value = value;
+    keyval.push_back(kv);
+  }
+  SendDiagnostics(keyval);
+}
+
 }   // end namespace dds_ros_bridge
 
 PLUGINLIB_EXPORT_CLASS(dds_ros_bridge::DdsRosBridge, nodelet::Nodelet)
@@ -95,9 +95,9 @@ RapidCommandRosCommand::RapidCommandRosCommand(
     const std::string& subscribeTopic,
     const std::string& pubTopic,
     const ros::NodeHandle &nh,
+    RapidSubReactor *reactor,
     const unsigned int queueSize)
-  : RapidSubRosPub(subscribeTopic, pubTopic, nh,
-                   "RapidCommandRosCommand", queueSize) {
+  : RapidSubRosPub(subscribeTopic, pubTopic, nh, reactor, queueSize) {
   // advertise ros topic
   m_pub_ = m_nh_.advertise<ff_msgs::CommandStamped>(pubTopic, queueSize);
 
@@ -117,9 +117,6 @@ RapidCommandRosCommand::RapidCommandRosCommand(
     ROS_ERROR("RapidCommandRosCommand exception unknown");
     throw;
   }
-
-  // start thread
-  StartThread();
 }
 
 void RapidCommandRosCommand::operator() (rapid::Command const* rapid_cmd) {
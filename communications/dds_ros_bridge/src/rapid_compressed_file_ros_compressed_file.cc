@@ -51,15 +51,22 @@ RapidCompression2Ros(rapid::ext::astrobee::FileCompressionType const& t) {
   }
 }
 
+// Incomplete chunked files kept for resuming, and the largest file accepted
+const size_t kMaxTransfers = 4;
+const uint64_t kMaxFileSize = 64 * 1048576;
+
 }  // end namespace
 
 ff::RapidCompressedFileRosCompressedFile::RapidCompressedFileRosCompressedFile(
     const std::string& subscribeTopic,
     const std::string& pubTopic,
     const ros::NodeHandle &nh,
+    RapidSubReactor *reactor,
+    const bool chunked,
     const unsigned int queueSize)
-  : ff::RapidSubRosPub(subscribeTopic, pubTopic, nh,
-                       "RapidCompressedFileRosCompresesdFile", queueSize) {
+  : ff::RapidSubRosPub(subscribeTopic, pubTopic, nh, reactor, queueSize),
+    m_chunked_(chunked),
+    m_reassembler_(kMaxTransfers, kMaxFileSize) {
   m_pub_ = m_nh_.advertise<ff_msgs::CompressedFile>(pubTopic, queueSize);
 
   try {
@@ -74,9 +81,6 @@ ff::RapidCompressedFileRosCompressedFile::RapidCompressedFileRosCompressedFile(
     ROS_ERROR("RapidCompressedFileRosCompressedFile exception unknown");
     throw;
   }
-
-  // start thread
-  StartThread();
 }
 
 void ff::RapidCompressedFileRosCompressedFile::operator() (
@@ -89,9 +93,23 @@ void ff::RapidCompressedFileRosCompressedFile::operator() (
   msg.type = RapidCompression2Ros(file->compressionType);
 
   unsigned char* buf = file->compressedFile.get_contiguous_buffer();
-  msg.file.reserve(file->compressedFile.length());
-  msg.file.resize(file->compressedFile.length());
-  std::memmove(msg.file.data(), buf, file->compressedFile.length());
+  ChunkReassembler::Result result = ChunkReassembler::NOT_CHUNKED;
+  if (m_chunked_)
+    result = m_reassembler_.Add(buf, file->compressedFile.length(), &msg.file);
+  switch (result) {
+  case ChunkReassembler::NOT_CHUNKED:
+    msg.file.reserve(file->compressedFile.length());
+    msg.file.resize(file->compressedFile.length());
+    std::memmove(msg.file.data(), buf, file->compressedFile.length());
+    break;
+  case ChunkReassembler::INCOMPLETE:
+    return;
+  case ChunkReassembler::INVALID:
+    ROS_WARN("RapidCompressedFileRosCompressedFile: dropped an invalid chunk");
+    return;
+  case ChunkReassembler::COMPLETE:
+    break;
+  }
 
   m_pub_.publish(msg);
 }
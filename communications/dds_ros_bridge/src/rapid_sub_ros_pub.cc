@@ -19,33 +19,19 @@
 #include <string>
 
 #include "dds_ros_bridge/rapid_sub_ros_pub.h"
-#include "knShare/Time.h"
 
 namespace ff {
 
 RapidSubRosPub::RapidSubRosPub(const std::string& subscribeTopic,
                                const std::string& pubTopic,
                                const ros::NodeHandle &nh,
-                               const std::string& entityName,
+                               RapidSubReactor *reactor,
                                const unsigned int queueSize)
   : m_nh_(nh), m_subscribeTopic_(subscribeTopic), m_publishTopic_(pubTopic),
-    m_queueSize_(queueSize), m_thread_(), m_ddsEventLoop_(entityName) {
+    m_queueSize_(queueSize), m_ddsEventLoop_(reactor->Assign()) {
 }
 
 RapidSubRosPub::~RapidSubRosPub() {
-  m_thread_.join();
-}
-
-void RapidSubRosPub::StartThread() {
-  // start joinable thread
-  m_thread_ = std::thread(&RapidSubRosPub::ThreadExec, this);
-}
-
-void RapidSubRosPub::ThreadExec() {
-  while (ros::ok()) {
-    // process events at 10hz
-    m_ddsEventLoop_.processEvents(kn::milliseconds(100));
-  }
 }
 
 }  // end namespace ff
@@ -0,0 +1,73 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cstring>
+#include <string>
+
+#include "dds_ros_bridge/rapid_telemetry_frame.h"
+#include "dds_ros_bridge/util.h"
+
+#include "rapidUtil/RapidHelper.h"
+
+namespace ff {
+
+RapidTelemetryFrame::RapidTelemetryFrame(const std::string& pubTopic,
+                                         const ros::NodeHandle &nh,
+                                         float rate,
+                                         double quantization,
+                                         unsigned int keyframe_interval)
+  : RapidPub(pubTopic),
+    m_writer_(quantization, keyframe_interval),
+    m_supplier_("astrobee_telemetry_frame" + m_publishTopic_, "",
+                "RapidDefaultQos", ""),
+    m_id_(0),
+    m_nh_(nh) {
+  rapid::RapidHelper::initHeader(m_supplier_.event().hdr);
+  m_supplier_.event().compressionType =
+                              rapid::ext::astrobee::COMPRESSION_TYPE_NONE;
+
+  m_timer_ = m_nh_.createTimer(ros::Rate(rate),
+                               &RapidTelemetryFrame::PubFrame, this);
+}
+
+TelemetryFrameWriter* RapidTelemetryFrame::Writer() {
+  return &m_writer_;
+}
+
+void RapidTelemetryFrame::PubFrame(const ros::TimerEvent& event) {
+  // Nothing to send if every sample was filtered out
+  if (!m_writer_.Take(&m_frame_)) {
+    return;
+  }
+
+  rapid::ext::astrobee::CompressedFile &msg = m_supplier_.event();
+  msg.hdr.timeStamp = util::RosTime2RapidTime(ros::Time::now());
+  msg.id = m_id_++;
+
+  msg.compressedFile.ensure_length(m_frame_.size(), m_frame_.size());
+  unsigned char *buf = msg.compressedFile.get_contiguous_buffer();
+  if (buf == NULL) {
+    ROS_WARN("RTI wants to give me a discontinous buffer? out of here");
+    return;
+  }
+  std::memmove(buf, m_frame_.data(), m_frame_.size());
+
+  m_supplier_.sendEvent();
+}
+
+}  // end namespace ff
@@ -16,6 +16,7 @@
  * under the License.
  */
 
+#include <functional>
 #include <string>
 #include <cstring>
 #include <algorithm>
@@ -61,8 +62,12 @@ ff::RosCompressedFileToRapid::RosCompressedFileToRapid(
     const std::string& subscribeTopic,
     const std::string& pubTopic,
     const ros::NodeHandle &nh,
+    const bool chunked,
     const unsigned int queueSize)
-  : RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize) {
+  : RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize),
+    m_chunked_(chunked),
+    m_sender_(std::bind(&RosCompressedFileToRapid::Send, this,
+                        std::placeholders::_1), 0) {
   m_supplier_.reset(
     new ff::RosCompressedFileToRapid::Supplier(
       "astrobee_compressed_file" + pubTopic,
@@ -76,26 +81,47 @@ ff::RosCompressedFileToRapid::RosCompressedFileToRapid(
 
 void ff::RosCompressedFileToRapid::Callback(
     const ff_msgs::CompressedFile::ConstPtr& file) {
+  // Every file is sent, in order
+  m_sender_.Push(file);
+}
 
+void ff::RosCompressedFileToRapid::Send(
+    const ff_msgs::CompressedFile::ConstPtr& file) {
   rea::CompressedFile &msg = m_supplier_->event();
   msg.hdr.timeStamp = util::RosTime2RapidTime(file->header.stamp);
 
   msg.id = file->id;
   msg.compressionType = ConvertCompression(file->type);
 
-  // resize
-  msg.compressedFile.ensure_length(file->file.size(), file->file.size());
+  if (!m_chunked_ || file->file.size() <= ff::kChunkSize) {
+    // resize
+    msg.compressedFile.ensure_length(file->file.size(), file->file.size());
+
+    // get access to raw bytes
+    unsigned char *buf = msg.compressedFile.get_contiguous_buffer();
+    if (buf == NULL) {
+      ROS_WARN("RTI wants to give me a discontinous buffer? out of here");
+      return;
+    }
 
-  // get access to raw bytes
-  unsigned char *buf = msg.compressedFile.get_contiguous_buffer();
-  if (buf == NULL) {
-    ROS_WARN("RTI wants to give me a discontinous buffer? out of here");
+    // actually copy data
+    std::memmove(buf, file->file.data(), file->file.size());
+
+    m_supplier_->sendEvent();
     return;
   }
 
-  // actually copy data
-  std::memmove(buf, file->file.data(), file->file.size());
-
-  m_supplier_->sendEvent();
+  // Larger files are sent in chunks, each written straight into the sample
+  ff::ChunkWriter writer(file->file.data(), file->file.size(), ff::kChunkSize);
+  for (uint32_t i = 0; i < writer.Count(); i++) {
+    msg.compressedFile.ensure_length(writer.Size(i), writer.Size(i));
+    unsigned char *buf = msg.compressedFile.get_contiguous_buffer();
+    if (buf == NULL) {
+      ROS_WARN("RTI wants to give me a discontinous buffer? out of here");
+      return;
+    }
+    writer.Write(i, buf);
+    m_supplier_->sendEvent();
+  }
 }
 
@@ -16,6 +16,7 @@
  * under the License.
  */
 
+#include <functional>
 #include <string>
 
 #include "dds_ros_bridge/ros_compressed_image_rapid_image.h"
@@ -26,8 +27,12 @@ namespace ff {
 
 RosCompressedImageRapidImage::RosCompressedImageRapidImage(
   const std::string& subscribeTopic, const std::string& pubTopic,
-  const ros::NodeHandle &nh, const unsigned int queueSize)
-  : RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize), MB_(1048576) {
+  const ros::NodeHandle &nh, const bool chunked, const unsigned int queueSize)
+  : RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize),
+    m_chunked_(chunked),
+    m_chunk_(chunked ? kChunkSize : 0),
+    m_sender_(std::bind(&RosCompressedImageRapidImage::Send, this,
+                        std::placeholders::_1), 1) {
   std::string subscribeCompresedTopic = subscribeTopic + "/compressed";
   // TODO(all): confirm topic suffix has '-'
   m_params_.topicSuffix += pubTopic;
@@ -46,13 +51,33 @@ RosCompressedImageRapidImage::RosCompressedImageRapidImage(
 
 void RosCompressedImageRapidImage::CallBack(
                             const sensor_msgs::CompressedImage::ConstPtr& msg) {
+  if (msg->data.size() > 0) {
+    // Only the latest image is sent, an older one still queued is dropped
+    m_sender_.Push(msg);
+  } else {
+    ROS_ERROR("DDS ROS BRIDGE: Couldn't publish empty image!");
+  }
+}
+
+void RosCompressedImageRapidImage::Send(
+                            const sensor_msgs::CompressedImage::ConstPtr& msg) {
   m_provider_->setMimeType(GetRapidMimeType(msg->format).c_str());
-  if (msg->data.size() > 0 && msg->data.size() < MB_) {
+  if (msg->data.size() < kChunkSize) {
     m_provider_->publishData(&msg->data.front(), msg->data.size());
-  } else {
+    return;
+  }
+  if (!m_chunked_) {
     int size = msg->data.size();
     ROS_ERROR("DDS ROS BRIDGE: Couldn't publish image! image size: %i > %i",
-                                                                    size, MB_);
+                                            size, static_cast<int>(kChunkSize));
+    return;
+  }
+  // Images over the bound of the sample are sent in chunks, which the ground
+  // puts back together with a ChunkReassembler
+  ChunkWriter writer(&msg->data.front(), msg->data.size(), kChunkSize);
+  for (uint32_t i = 0; i < writer.Count(); i++) {
+    writer.Write(i, m_chunk_.data());
+    m_provider_->publishData(m_chunk_.data(), writer.Size(i));
   }
 }
 
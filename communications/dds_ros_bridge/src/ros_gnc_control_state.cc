@@ -19,6 +19,8 @@
 
 #include "dds_ros_bridge/ros_gnc_control_state.h"
 
+#include "dds_ros_bridge/serialized_size.h"
+
 #include "rapidDds/RapidConstants.h"
 
 namespace ff {
@@ -28,7 +30,8 @@ RosGncControlStateToRapid::RosGncControlStateToRapid(
                                               const std::string& pubTopic,
                                               const ros::NodeHandle& nh,
                                               const unsigned int queueSize) :
-    RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize) {
+    RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize),
+    filter_(rapid::ext::astrobee::GNC_CONTROL_STATE_TOPIC + pubTopic) {
   s_supplier_.reset(new RosGncControlStateToRapid::StateSupplier(
       rapid::ext::astrobee::GNC_CONTROL_STATE_TOPIC + pubTopic,
       "",
@@ -69,6 +72,11 @@ void RosGncControlStateToRapid::MsgCallback(
 
 void RosGncControlStateToRapid::PubGncControlState(
                                                 const ros::TimerEvent& event) {
+  // Make sure we have received a control state before trying to send it
+  if (gnc_msg_ == NULL) {
+    return;
+  }
+
   rapid::ext::astrobee::GncControlState &msg = s_supplier_->event();
 
   // Copy time
@@ -91,6 +99,19 @@ void RosGncControlStateToRapid::PubGncControlState(
 
   CopyVec3D(msg.accel.angular, gnc_msg_->accel.angular);
 
+  // Only send the state if it changed enough since the last one sent
+  const TelemetryTolerances& tolerances = filter_.Tolerances();
+  filter_.AddVector(gnc_msg_->pose.position, tolerances.position);
+  filter_.AddQuaternion(gnc_msg_->pose.orientation, tolerances.attitude);
+  filter_.AddVector(gnc_msg_->twist.linear, tolerances.velocity);
+  filter_.AddVector(gnc_msg_->twist.angular, tolerances.omega);
+  filter_.AddVector(gnc_msg_->accel.linear, tolerances.accel);
+  filter_.AddVector(gnc_msg_->accel.angular, tolerances.alpha);
+  if (!filter_.Update(ros::Time::now().toSec(), gnc_msg_->when.toSec(),
+                      util::SerializedSize(msg))) {
+    return;
+  }
+
   // Send message
   s_supplier_->sendEvent();
 }
@@ -104,4 +125,19 @@ void RosGncControlStateToRapid::SetGncPublishRate(float rate) {
   }
 }
 
+void RosGncControlStateToRapid::SetTelemetryTolerances(
+                                      const TelemetryTolerances& tolerances) {
+  filter_.SetTolerances(tolerances);
+}
+
+void RosGncControlStateToRapid::SetTelemetryFrame(
+                                          TelemetryFrameWriter* writer) {
+  filter_.SetFrameWriter(writer);
+}
+
+void RosGncControlStateToRapid::GetTelemetryFilters(
+                        std::vector<const TelemetryFilter*>* filters) const {
+  filters->push_back(&filter_);
+}
+
 }  // end namespace ff
@@ -19,6 +19,8 @@
 
 #include "dds_ros_bridge/ros_gnc_fam_cmd_state.h"
 
+#include "dds_ros_bridge/serialized_size.h"
+
 #include "rapidDds/RapidConstants.h"
 
 namespace ff {
@@ -28,7 +30,8 @@ RosGncFamCmdStateToRapid::RosGncFamCmdStateToRapid(
                                               const std::string& pubTopic,
                                               const ros::NodeHandle& nh,
                                               const unsigned int queueSize) :
-    RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize) {
+    RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize),
+    filter_(rapid::ext::astrobee::GNC_FAM_CMD_STATE_TOPIC + pubTopic) {
   s_supplier_.reset(new RosGncFamCmdStateToRapid::StateSupplier(
       rapid::ext::astrobee::GNC_FAM_CMD_STATE_TOPIC + pubTopic,
       "",
@@ -68,6 +71,11 @@ void RosGncFamCmdStateToRapid::MsgCallback(
 }
 
 void RosGncFamCmdStateToRapid::PubGncFamCmdState(const ros::TimerEvent& event) {
+  // Make sure we have received a fam command before trying to send it
+  if (fam_msg_ == NULL) {
+    return;
+  }
+
   rapid::ext::astrobee::GncFamCmdState &msg = s_supplier_->event();
 
   // Copy time
@@ -95,6 +103,25 @@ void RosGncFamCmdStateToRapid::PubGncFamCmdState(const ros::TimerEvent& event) {
 
   msg.control_mode = fam_msg_->control_mode;
 
+  // Only send the command if it changed enough since the last one sent
+  const TelemetryTolerances& tolerances = filter_.Tolerances();
+  filter_.AddVector(fam_msg_->wrench.force, tolerances.force);
+  filter_.AddVector(fam_msg_->wrench.torque, tolerances.torque);
+  filter_.AddVector(fam_msg_->accel, tolerances.accel);
+  filter_.AddVector(fam_msg_->alpha, tolerances.alpha);
+  filter_.Add(fam_msg_->status, 0.0);
+  filter_.AddVector(fam_msg_->position_error, tolerances.position);
+  filter_.AddVector(fam_msg_->position_error_integrated, tolerances.position);
+  filter_.AddVector(fam_msg_->attitude_error, tolerances.attitude);
+  filter_.AddVector(fam_msg_->attitude_error_integrated, tolerances.attitude);
+  filter_.Add(fam_msg_->attitude_error_mag, tolerances.attitude);
+  filter_.Add(fam_msg_->control_mode, 0.0);
+  if (!filter_.Update(ros::Time::now().toSec(),
+                      fam_msg_->header.stamp.toSec(),
+                      util::SerializedSize(msg))) {
+    return;
+  }
+
   // Send message
   s_supplier_->sendEvent();
 }
@@ -108,4 +135,19 @@ void RosGncFamCmdStateToRapid::SetGncPublishRate(float rate) {
   }
 }
 
+void RosGncFamCmdStateToRapid::SetTelemetryTolerances(
+                                      const TelemetryTolerances& tolerances) {
+  filter_.SetTolerances(tolerances);
+}
+
+void RosGncFamCmdStateToRapid::SetTelemetryFrame(
+                                          TelemetryFrameWriter* writer) {
+  filter_.SetFrameWriter(writer);
+}
+
+void RosGncFamCmdStateToRapid::GetTelemetryFilters(
+                        std::vector<const TelemetryFilter*>* filters) const {
+  filters->push_back(&filter_);
+}
+
 }  // end namespace ff
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "dds_ros_bridge/ros_odom_rapid_position.h"
+#include "dds_ros_bridge/serialized_size.h"
 
 #include "rapidDds/RapidConstants.h"
 
@@ -30,7 +31,9 @@ RosOdomRapidPosition::RosOdomRapidPosition(const std::string& subscribeTopic,
                                            const unsigned int queueSize) :
     RosSubRapidPub(subscribeTopic, pubTopic, nh, queueSize),
     ekf_sent_(false),
-    pub_ekf_(false) {
+    pub_ekf_(false),
+    ekf_filter_(rapid::ext::astrobee::EKF_STATE_TOPIC + pubTopic),
+    position_filter_("rapid_position_sample" + pubTopic) {
   m_params_.config.poseEncoding = rapid::RAPID_ROT_QUAT;
   m_params_.config.velocityEncoding = rapid::RAPID_ROT_XYZ;
 
@@ -130,9 +133,16 @@ void RosOdomRapidPosition::CopyVec3D(rapid::Vec3d& vecOut,
   vecOut[2] = vecIn.z;
 }
 
-void RosOdomRapidPosition::PubEkf(const ros::TimerEvent& event) {
-  ekf_sent_ = true;
+void RosOdomRapidPosition::AddMotion(TelemetryFilter* filter) {
+  const TelemetryTolerances& tolerances = filter->Tolerances();
+  filter->AddVector(ekf_msg_->pose.position, tolerances.position);
+  filter->AddQuaternion(ekf_msg_->pose.orientation, tolerances.attitude);
+  filter->AddVector(ekf_msg_->velocity, tolerances.velocity);
+  filter->AddVector(ekf_msg_->omega, tolerances.omega);
+  filter->Add(ekf_msg_->confidence, 0.0);
+}
 
+void RosOdomRapidPosition::PubEkf(const ros::TimerEvent& event) {
   // Make sure we have received an ekf message before trying to send it
   if (ekf_msg_ == NULL) {
     return;
@@ -170,15 +180,70 @@ void RosOdomRapidPosition::PubEkf(const ros::TimerEvent& event) {
   // Don't copy over ml_mahal_dists since it was copied over when we received
   // the message
 
+  // Only send the state if it changed enough since the last one sent. The
+  // feature counts are not compared, their max keeps accumulating until the
+  // state is sent. The covariance, counts and distances are only carried to
+  // the telemetry frames, exactly
+  const TelemetryTolerances& tolerances = ekf_filter_.Tolerances();
+  AddMotion(&ekf_filter_);
+  ekf_filter_.AddVector(ekf_msg_->accel, tolerances.accel);
+  ekf_filter_.AddVector(ekf_msg_->gyro_bias, tolerances.omega);
+  ekf_filter_.AddVector(ekf_msg_->accel_bias, tolerances.accel);
+  ekf_filter_.Add(ekf_msg_->status, 0.0);
+  ekf_filter_.AddVector(ekf_msg_->hr_global_pose.position, tolerances.position);
+  ekf_filter_.AddQuaternion(ekf_msg_->hr_global_pose.orientation,
+                            tolerances.attitude);
+  for (int i = 0; i < 15; i++) {
+    ekf_filter_.Carry(msg.cov_diag[i], 0.0);
+  }
+  ekf_filter_.Carry(msg.of_count, 0.0);
+  ekf_filter_.Carry(msg.ml_count, 0.0);
+  for (int i = 0; i < 50; i++) {
+    ekf_filter_.Carry(msg.ml_mahal_dists[i], 0.0);
+  }
+  if (!ekf_filter_.Update(ros::Time::now().toSec(),
+                          ekf_msg_->header.stamp.toSec(),
+                          util::SerializedSize(msg))) {
+    return;
+  }
+
+  ekf_sent_ = true;
+
   // Send message
   s_supplier_->sendEvent();
 }
 
 void RosOdomRapidPosition::PubPosition(const ros::TimerEvent& event) {
   // Make sure we have received an ekf message before trying to send it
-  if (ekf_msg_ != NULL) {
-    m_provider_->Publish(ekf_msg_);
+  if (ekf_msg_ == NULL) {
+    return;
   }
+
+  // Only send the position if it changed enough since the last one sent
+  const rapid::PositionSample& sample = m_provider_->Fill(ekf_msg_);
+  AddMotion(&position_filter_);
+  if (position_filter_.Update(ros::Time::now().toSec(),
+                              ekf_msg_->header.stamp.toSec(),
+                              util::SerializedSize(sample))) {
+    m_provider_->Send();
+  }
+}
+
+void RosOdomRapidPosition::SetTelemetryTolerances(
+                                      const TelemetryTolerances& tolerances) {
+  ekf_filter_.SetTolerances(tolerances);
+  position_filter_.SetTolerances(tolerances);
+}
+
+void RosOdomRapidPosition::SetTelemetryFrame(TelemetryFrameWriter* writer) {
+  ekf_filter_.SetFrameWriter(writer);
+  position_filter_.SetFrameWriter(writer);
+}
+
+void RosOdomRapidPosition::GetTelemetryFilters(
+                        std::vector<const TelemetryFilter*>* filters) const {
+  filters->push_back(&ekf_filter_);
+  filters->push_back(&position_filter_);
 }
 
 void RosOdomRapidPosition::SetEkfPublishRate(float rate) {
@@ -0,0 +1,53 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ndds/ndds_cpp.h>
+
+#include "dds_ros_bridge/serialized_size.h"
+
+#include "EkfStatePlugin.h"
+#include "GncControlStatePlugin.h"
+#include "GncFamCmdStatePlugin.h"
+
+#include "rapidDds/PositionPlugin.h"
+
+namespace util {
+
+// The generated plugins only read the endpoint data for keyed types, and
+// size the sequences to their current length
+size_t SerializedSize(rapid::PositionSample const& sample) {
+  return rapid::PositionSamplePlugin_get_serialized_sample_size(NULL,
+    RTI_TRUE, RTI_CDR_ENCAPSULATION_ID_CDR_BE, 0, &sample);
+}
+
+size_t SerializedSize(rapid::ext::astrobee::EkfState const& sample) {
+  return rapid::ext::astrobee::EkfStatePlugin_get_serialized_sample_size(NULL,
+    RTI_TRUE, RTI_CDR_ENCAPSULATION_ID_CDR_BE, 0, &sample);
+}
+
+size_t SerializedSize(rapid::ext::astrobee::GncControlState const& sample) {
+  return rapid::ext::astrobee::GncControlStatePlugin_get_serialized_sample_size(
+    NULL, RTI_TRUE, RTI_CDR_ENCAPSULATION_ID_CDR_BE, 0, &sample);
+}
+
+size_t SerializedSize(rapid::ext::astrobee::GncFamCmdState const& sample) {
+  return rapid::ext::astrobee::GncFamCmdStatePlugin_get_serialized_sample_size(
+    NULL, RTI_TRUE, RTI_CDR_ENCAPSULATION_ID_CDR_BE, 0, &sample);
+}
+
+}  // end namespace util
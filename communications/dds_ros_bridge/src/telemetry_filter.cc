@@ -0,0 +1,133 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "dds_ros_bridge/telemetry_filter.h"
+#include "dds_ros_bridge/telemetry_frame.h"
+
+namespace ff {
+
+TelemetryTolerances::TelemetryTolerances() :
+  enabled(false), max_interval(0.0), position(0.0), attitude(0.0),
+  velocity(0.0), omega(0.0), accel(0.0), alpha(0.0), force(0.0), torque(0.0) {
+}
+
+TelemetryFilter::TelemetryFilter(const std::string& name) :
+  name_(name), writer_(NULL), has_sent_(false), sent_time_(0.0), sent_samples_(0),
+  sent_bytes_(0), dropped_samples_(0), dropped_bytes_(0), latency_sum_(0.0),
+  latency_max_(0.0), frame_bytes_(0) {
+}
+
+void TelemetryFilter::SetTolerances(const TelemetryTolerances& tolerances) {
+  tolerances_ = tolerances;
+  // Send the next sample, so a change of tolerances reaches the ground
+  has_sent_ = false;
+}
+
+const TelemetryTolerances& TelemetryFilter::Tolerances() const {
+  return tolerances_;
+}
+
+void TelemetryFilter::SetFrameWriter(TelemetryFrameWriter* writer) {
+  writer_ = writer;
+}
+
+void TelemetryFilter::Add(double value, double tolerance) {
+  values_.push_back(value);
+  limits_.push_back(tolerance);
+  resolutions_.push_back(writer_ ? tolerance * writer_->Quantization() : 0.0);
+}
+
+void TelemetryFilter::Carry(double value, double resolution) {
+  values_.push_back(value);
+  limits_.push_back(std::numeric_limits<double>::infinity());
+  resolutions_.push_back(resolution);
+}
+
+bool TelemetryFilter::Update(double now, double stamp, size_t bytes) {
+  bool send = !tolerances_.enabled || !has_sent_
+    || now - sent_time_ >= tolerances_.max_interval
+    || values_.size() != sent_.size();
+  for (size_t i = 0; !send && i < values_.size(); i++) {
+    if (std::isinf(limits_[i]))
+      continue;
+    // A value that becomes or stops being a number is a change
+    if (std::isnan(values_[i]) || std::isnan(sent_[i]))
+      send = std::isnan(values_[i]) != std::isnan(sent_[i]);
+    else
+      send = std::fabs(values_[i] - sent_[i]) > limits_[i];
+  }
+
+  if (send) {
+    sent_.swap(values_);
+    has_sent_ = true;
+    sent_time_ = now;
+    sent_samples_++;
+    sent_bytes_ += bytes;
+    double latency = std::max(now - stamp, 0.0);
+    latency_sum_ += latency;
+    latency_max_ = std::max(latency_max_, latency);
+    if (writer_)
+      frame_bytes_ += writer_->Add(name_, stamp, sent_, resolutions_);
+  } else {
+    dropped_samples_++;
+    dropped_bytes_ += bytes;
+  }
+  values_.clear();
+  limits_.clear();
+  resolutions_.clear();
+  return send;
+}
+
+const std::string& TelemetryFilter::Name() const {
+  return name_;
+}
+
+uint64_t TelemetryFilter::SentSamples() const {
+  return sent_samples_;
+}
+
+uint64_t TelemetryFilter::SentBytes() const {
+  return sent_bytes_;
+}
+
+uint64_t TelemetryFilter::DroppedSamples() const {
+  return dropped_samples_;
+}
+
+uint64_t TelemetryFilter::DroppedBytes() const {
+  return dropped_bytes_;
+}
+
+double TelemetryFilter::MeanLatency() const {
+  return sent_samples_ ? latency_sum_ / sent_samples_ : 0.0;
+}
+
+double TelemetryFilter::MaxLatency() const {
+  return latency_max_;
+}
+
+uint64_t TelemetryFilter::FrameBytes() const {
+  return frame_bytes_;
+}
+
+}  // end namespace ff
@@ -0,0 +1,335 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "dds_ros_bridge/telemetry_frame.h"
+
+namespace ff {
+
+namespace {
+
+// Quantized value of a NaN
+const int64_t kNaN = std::numeric_limits<int64_t>::min();
+// Largest number of steps a value is quantized to, beyond which it saturates
+const double kMaxSteps = 4.0e18;
+
+int64_t Quantize(double value, double resolution) {
+  if (resolution <= 0.0) {
+    int64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+  if (isnan(value))
+    return kNaN;
+  double steps = std::max(-kMaxSteps, std::min(kMaxSteps,
+                                               round(value / resolution)));
+  return static_cast<int64_t>(steps);
+}
+
+double Dequantize(int64_t steps, double resolution) {
+  if (resolution <= 0.0) {
+    double value;
+    memcpy(&value, &steps, sizeof(value));
+    return value;
+  }
+  if (steps == kNaN)
+    return std::numeric_limits<double>::quiet_NaN();
+  return steps * resolution;
+}
+
+uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+// The difference between quantized values, wrapping rather than overflowing
+int64_t Delta(int64_t value, int64_t last) {
+  return static_cast<int64_t>(static_cast<uint64_t>(value) -
+                              static_cast<uint64_t>(last));
+}
+
+int64_t Apply(int64_t last, int64_t delta) {
+  return static_cast<int64_t>(static_cast<uint64_t>(last) +
+                              static_cast<uint64_t>(delta));
+}
+
+uint64_t Reverse(uint64_t value) {
+  uint64_t reversed = 0;
+  for (int i = 0; i < 64; i++, value >>= 1)
+    reversed = (reversed << 1) | (value & 1);
+  return reversed;
+}
+
+// Codes a value as the change from the previous value of the same topic
+uint64_t Encode(int64_t value, int64_t last, double resolution) {
+  if (resolution <= 0.0)
+    return Reverse(static_cast<uint64_t>(value ^ last));
+  return ZigZag(Delta(value, last));
+}
+
+int64_t Decode(uint64_t code, int64_t last, double resolution) {
+  if (resolution <= 0.0)
+    return last ^ static_cast<int64_t>(Reverse(code));
+  return Apply(last, UnZigZag(code));
+}
+
+size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+void PutVarint(uint64_t value, std::vector<uint8_t>* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+void PutFixed(uint64_t value, size_t size, std::vector<uint8_t>* out) {
+  for (size_t i = 0; i < size; i++)
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+// Reads from a frame, failing once past its end
+class Cursor {
+ public:
+  Cursor(uint8_t const* data, size_t size) : data_(data), size_(size), pos_(0) {}
+
+  bool Varint(uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64 && pos_ < size_; shift += 7) {
+      uint8_t byte = data_[pos_++];
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool Fixed(size_t size, uint64_t* value) {
+    if (size_ - pos_ < size)
+      return false;
+    *value = 0;
+    for (size_t i = 0; i < size; i++)
+      *value |= static_cast<uint64_t>(data_[pos_++]) << (8 * i);
+    return true;
+  }
+
+  bool Bytes(size_t size, std::string* value) {
+    if (size_ - pos_ < size)
+      return false;
+    value->assign(reinterpret_cast<char const*>(data_ + pos_), size);
+    pos_ += size;
+    return true;
+  }
+
+ private:
+  uint8_t const* data_;
+  size_t size_, pos_;
+};
+
+}  // namespace
+
+const uint32_t TelemetryFrameWriter::kMagic;
+const uint8_t TelemetryFrameWriter::kVersion;
+
+TelemetryFrameWriter::TelemetryFrameWriter(double quantization,
+                                           uint32_t keyframe_interval) :
+  quantization_(quantization), keyframe_interval_(keyframe_interval),
+  count_(0), sequence_(0), base_(0), frames_(0), bytes_(0) {
+}
+
+double TelemetryFrameWriter::Quantization() const {
+  return quantization_;
+}
+
+size_t TelemetryFrameWriter::Add(const std::string& topic, double stamp,
+                                 const std::vector<double>& values,
+                                 const std::vector<double>& resolutions) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<std::string, Topic>::iterator it = topics_.find(topic);
+  if (it == topics_.end()) {
+    Topic t;
+    t.id = topics_.size();
+    t.sequence = 0;
+    t.since_keyframe = 0;
+    it = topics_.insert(std::make_pair(topic, t)).first;
+  }
+  Topic& t = it->second;
+
+  // The receiver only gets the resolutions as floats, quantize with the same
+  std::vector<double> res(values.size(), 0.0);
+  for (size_t i = 0; i < values.size() && i < resolutions.size(); i++)
+    res[i] = static_cast<float>(resolutions[i]);
+  bool keyframe = t.sequence == 0 || t.since_keyframe >= keyframe_interval_ ||
+                  res != t.resolutions;
+
+  int64_t stamp_us = llround(stamp * 1e6);
+  if (count_ == 0)
+    base_ = stamp_us;
+
+  size_t start = samples_.size();
+  PutVarint(t.id, &samples_);
+  samples_.push_back(keyframe ? 1 : 0);
+  PutVarint(t.sequence, &samples_);
+  PutVarint(ZigZag(Delta(stamp_us, base_)), &samples_);
+  PutVarint(values.size(), &samples_);
+  if (keyframe) {
+    PutVarint(topic.size(), &samples_);
+    samples_.insert(samples_.end(), topic.begin(), topic.end());
+    for (size_t i = 0; i < res.size(); i++) {
+      float r = res[i];
+      uint32_t bits;
+      memcpy(&bits, &r, sizeof(bits));
+      PutFixed(bits, sizeof(bits), &samples_);
+    }
+    t.resolutions = res;
+    t.last.assign(values.size(), 0);
+    t.since_keyframe = 0;
+  }
+  for (size_t i = 0; i < values.size(); i++) {
+    int64_t q = Quantize(values[i], res[i]);
+    PutVarint(Encode(q, t.last[i], res[i]), &samples_);
+    t.last[i] = q;
+  }
+  t.sequence++;
+  t.since_keyframe++;
+  count_++;
+  return samples_.size() - start;
+}
+
+size_t TelemetryFrameWriter::HeaderSize() const {
+  return 4 + 1 + VarintSize(sequence_) + 8 + VarintSize(count_);
+}
+
+size_t TelemetryFrameWriter::PendingSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_ ? HeaderSize() + samples_.size() : 0;
+}
+
+bool TelemetryFrameWriter::Take(std::vector<uint8_t>* frame) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  frame->clear();
+  if (count_ == 0)
+    return false;
+  frame->reserve(HeaderSize() + samples_.size());
+  PutFixed(kMagic, 4, frame);
+  frame->push_back(kVersion);
+  PutVarint(sequence_, frame);
+  PutFixed(static_cast<uint64_t>(base_), 8, frame);
+  PutVarint(count_, frame);
+  frame->insert(frame->end(), samples_.begin(), samples_.end());
+  samples_.clear();
+  count_ = 0;
+  sequence_++;
+  frames_++;
+  bytes_ += frame->size();
+  return true;
+}
+
+uint64_t TelemetryFrameWriter::Frames() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return frames_;
+}
+
+uint64_t TelemetryFrameWriter::Bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+TelemetryFrameReader::TelemetryFrameReader() : skipped_(0) {
+}
+
+bool TelemetryFrameReader::Read(uint8_t const* data, size_t size,
+                                std::vector<Sample>* samples) {
+  Cursor in(data, size);
+  uint64_t magic, version, sequence, base, count;
+  if (!in.Fixed(4, &magic) || magic != TelemetryFrameWriter::kMagic ||
+      !in.Fixed(1, &version) || version != TelemetryFrameWriter::kVersion ||
+      !in.Varint(&sequence) || !in.Fixed(8, &base) || !in.Varint(&count))
+    return false;
+
+  for (uint64_t n = 0; n < count; n++) {
+    uint64_t id, flags, seq, stamp, num;
+    if (!in.Varint(&id) || !in.Fixed(1, &flags) || !in.Varint(&seq) ||
+        !in.Varint(&stamp) || !in.Varint(&num) || num > size)
+      return false;
+    Topic& t = topics_[id];
+    if (flags & 1) {
+      uint64_t length;
+      if (!in.Varint(&length) || !in.Bytes(length, &t.name))
+        return false;
+      t.resolutions.resize(num);
+      for (uint64_t i = 0; i < num; i++) {
+        uint64_t bits;
+        if (!in.Fixed(4, &bits))
+          return false;
+        uint32_t bits32 = bits;
+        float r;
+        memcpy(&r, &bits32, sizeof(r));
+        t.resolutions[i] = r;
+      }
+      t.last.assign(num, 0);
+      t.valid = true;
+    } else if (!t.valid || seq != t.next || num != t.last.size()) {
+      // The differences are to a sample that was lost
+      t.valid = false;
+    }
+
+    Sample sample;
+    sample.topic = t.name;
+    sample.stamp = Apply(static_cast<int64_t>(base), UnZigZag(stamp)) * 1e-6;
+    for (uint64_t i = 0; i < num; i++) {
+      uint64_t code;
+      if (!in.Varint(&code))
+        return false;
+      if (t.valid) {
+        t.last[i] = Decode(code, t.last[i], t.resolutions[i]);
+        sample.values.push_back(Dequantize(t.last[i], t.resolutions[i]));
+      }
+    }
+    if (t.valid) {
+      t.next = seq + 1;
+      samples->push_back(sample);
+    } else {
+      skipped_++;
+    }
+  }
+  return true;
+}
+
+uint64_t TelemetryFrameReader::Skipped() const {
+  return skipped_;
+}
+
+}  // end namespace ff
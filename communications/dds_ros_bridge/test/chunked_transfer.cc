@@ -0,0 +1,163 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Classes under test
+#include <dds_ros_bridge/async_sender.h>
+#include <dds_ros_bridge/chunked_transfer.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+using ff::ChunkReassembler;
+using ff::ChunkWriter;
+
+typedef std::vector<uint8_t> Sample;
+typedef std::shared_ptr<Sample const> PayloadPtr;
+
+// Payload of random bytes
+static PayloadPtr MakePayload(size_t size, unsigned int seed) {
+  std::mt19937 rng(seed);
+  std::shared_ptr<Sample> payload(new Sample(size));
+  for (auto & byte : *payload)
+    byte = static_cast<uint8_t>(rng());
+  return payload;
+}
+
+// Chunks of a payload, as the samples written to DDS
+static std::vector<Sample> Split(PayloadPtr const& payload) {
+  std::vector<Sample> samples;
+  ChunkWriter writer(payload->data(), payload->size(), ff::kChunkSize);
+  for (uint32_t i = 0; i < writer.Count(); i++) {
+    samples.emplace_back(writer.Size(i));
+    writer.Write(i, samples.back().data());
+  }
+  return samples;
+}
+
+// Payloads over 1 MB go through the sender thread in chunks that fit the
+// sample bound, and come back whole. The sender is destroyed before reading
+// the wire, so this also checks that queued payloads are sent on shutdown.
+TEST(chunked_transfer, LoopbackOverOneMegabyte) {
+  std::vector<PayloadPtr> payloads = {
+    MakePayload(5 * ff::kChunkSize / 2, 1),
+    MakePayload(ff::kChunkSize + 1, 2),
+    MakePayload(3 * ff::kChunkSize, 3)};
+  std::vector<Sample> wire;
+  {
+    ff::AsyncSender<PayloadPtr> sender([&wire](PayloadPtr const& payload) {
+      // Stand in for a slow DDS write, so payloads are still queued
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      for (Sample & sample : Split(payload))
+        wire.push_back(std::move(sample));
+    }, 0);
+    for (auto const& payload : payloads)
+      sender.Push(payload);
+  }
+  ChunkReassembler reassembler(4, 64 * ff::kChunkSize);
+  std::vector<Sample> received;
+  for (Sample const& sample : wire) {
+    EXPECT_LE(sample.size(), ff::kChunkSize);
+    Sample payload;
+    if (reassembler.Add(sample.data(), sample.size(), &payload)
+      == ChunkReassembler::COMPLETE)
+      received.push_back(payload);
+  }
+  ASSERT_EQ(received.size(), payloads.size());
+  for (size_t i = 0; i < payloads.size(); i++)
+    EXPECT_TRUE(received[i] == *payloads[i]);
+}
+
+// Chunks arriving out of order are put in place, and a payload sent again
+// after chunks were lost only needs the missing ones to complete
+TEST(chunked_transfer, ResumesAfterLostChunks) {
+  PayloadPtr payload = MakePayload(7 * ff::kChunkSize / 2, 4);
+  std::vector<Sample> samples = Split(payload);
+  ASSERT_EQ(samples.size(), 4u);
+  std::mt19937 rng(5);
+  std::vector<uint32_t> order = {0, 1, 2, 3};
+  std::shuffle(order.begin(), order.end(), rng);
+  ChunkReassembler reassembler(4, 64 * ff::kChunkSize);
+  Sample out;
+  // Lose the last two chunks sent
+  for (size_t i = 0; i < 2; i++)
+    EXPECT_EQ(reassembler.Add(samples[order[i]].data(),
+      samples[order[i]].size(), &out), ChunkReassembler::INCOMPLETE);
+  uint32_t transfer = ff::TransferId(payload->data(), payload->size());
+  std::vector<uint32_t> missing = reassembler.Missing(transfer);
+  std::sort(order.begin() + 2, order.end());
+  EXPECT_EQ(missing, std::vector<uint32_t>(order.begin() + 2, order.end()));
+  // The sender starts over, chunks already received are skipped, and the
+  // payload completes with the last missing chunk
+  size_t sent = 0;
+  ChunkReassembler::Result result = ChunkReassembler::INCOMPLETE;
+  while (result == ChunkReassembler::INCOMPLETE && sent < samples.size()) {
+    result = reassembler.Add(samples[sent].data(), samples[sent].size(), &out);
+    sent++;
+  }
+  EXPECT_EQ(result, ChunkReassembler::COMPLETE);
+  EXPECT_EQ(sent, missing.back() + 1u);
+  EXPECT_TRUE(out == *payload);
+  EXPECT_TRUE(reassembler.Missing(transfer).empty());
+}
+
+// Payloads sent whole, and samples that only look like chunks, are passed on
+TEST(chunked_transfer, SmallPayloadsAreNotChunked) {
+  PayloadPtr payload = MakePayload(1000, 6);
+  ChunkReassembler reassembler(4, 64 * ff::kChunkSize);
+  Sample out;
+  EXPECT_EQ(reassembler.Add(payload->data(), payload->size(), &out),
+    ChunkReassembler::NOT_CHUNKED);
+  // A chunk cut short does not match the length in its header
+  std::vector<Sample> samples = Split(MakePayload(2 * ff::kChunkSize, 7));
+  EXPECT_EQ(reassembler.Add(samples[0].data(), samples[0].size() - 1, &out),
+    ChunkReassembler::NOT_CHUNKED);
+}
+
+// Transfers over the maximum size are refused, and only the most recent
+// incomplete transfers are kept
+TEST(chunked_transfer, BoundsTransfers) {
+  ChunkReassembler small(1, ff::kChunkSize);
+  std::vector<Sample> first = Split(MakePayload(2 * ff::kChunkSize, 8));
+  Sample out;
+  EXPECT_EQ(small.Add(first[0].data(), first[0].size(), &out),
+    ChunkReassembler::INVALID);
+  ChunkReassembler one(1, 64 * ff::kChunkSize);
+  std::vector<Sample> second = Split(MakePayload(2 * ff::kChunkSize, 9));
+  EXPECT_EQ(one.Add(first[0].data(), first[0].size(), &out),
+    ChunkReassembler::INCOMPLETE);
+  EXPECT_EQ(one.Add(second[0].data(), second[0].size(), &out),
+    ChunkReassembler::INCOMPLETE);
+  // The first transfer was forgotten to make room for the second
+  EXPECT_EQ(one.Add(first[1].data(), first[1].size(), &out),
+    ChunkReassembler::INCOMPLETE);
+  EXPECT_EQ(one.Add(second[1].data(), second[1].size(), &out),
+    ChunkReassembler::INCOMPLETE);
+}
+
+// Required for the test framework
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Class under test
+#include <dds_ros_bridge/telemetry_filter.h>
+
+#include <limits>
+
+using ff::TelemetryFilter;
+using ff::TelemetryTolerances;
+
+static TelemetryTolerances Tolerances() {
+  TelemetryTolerances tolerances;
+  tolerances.enabled = true;
+  tolerances.max_interval = 1.0;
+  tolerances.position = 0.01;
+  return tolerances;
+}
+
+// Filters a sample of a single position at now, stamped a bit earlier
+static bool Filter(TelemetryFilter* filter, double now, double x) {
+  filter->Add(x, filter->Tolerances().position);
+  return filter->Update(now, now - 0.01, 100);
+}
+
+// The first sample is sent however little it differs from nothing
+TEST(telemetry_filter, FirstSampleForced) {
+  TelemetryFilter filter("test");
+  filter.SetTolerances(Tolerances());
+  EXPECT_TRUE(Filter(&filter, 0.0, 0.0));
+  EXPECT_FALSE(Filter(&filter, 0.1, 0.0));
+  EXPECT_EQ(filter.SentSamples(), 1u);
+  EXPECT_EQ(filter.DroppedSamples(), 1u);
+  EXPECT_EQ(filter.SentBytes(), 100u);
+  EXPECT_EQ(filter.DroppedBytes(), 100u);
+  EXPECT_NEAR(filter.MeanLatency(), 0.01, 1e-9);
+}
+
+// Changes within the tolerance of the last sample sent are dropped, even when
+// they add up, and the first change beyond it is sent
+TEST(telemetry_filter, Deadband) {
+  TelemetryFilter filter("test");
+  filter.SetTolerances(Tolerances());
+  EXPECT_TRUE(Filter(&filter, 0.0, 1.0));
+  EXPECT_FALSE(Filter(&filter, 0.1, 1.004));
+  EXPECT_FALSE(Filter(&filter, 0.2, 1.008));
+  EXPECT_FALSE(Filter(&filter, 0.3, 0.992));
+  EXPECT_TRUE(Filter(&filter, 0.4, 1.011));
+  // Compared to the sample just sent now
+  EXPECT_FALSE(Filter(&filter, 0.5, 1.02));
+  EXPECT_TRUE(Filter(&filter, 0.6, 0.99));
+  EXPECT_EQ(filter.SentSamples(), 3u);
+  EXPECT_EQ(filter.DroppedSamples(), 4u);
+}
+
+// A sample that did not change is still sent once max interval has elapsed
+// since the last one sent
+TEST(telemetry_filter, MaxInterval) {
+  TelemetryFilter filter("test");
+  filter.SetTolerances(Tolerances());
+  EXPECT_TRUE(Filter(&filter, 10.0, 0.0));
+  EXPECT_FALSE(Filter(&filter, 10.5, 0.0));
+  EXPECT_FALSE(Filter(&filter, 10.9, 0.0));
+  EXPECT_TRUE(Filter(&filter, 11.0, 0.0));
+  EXPECT_FALSE(Filter(&filter, 11.5, 0.0));
+  EXPECT_TRUE(Filter(&filter, 12.2, 0.0));
+}
+
+// A value that becomes or stops being a number is a change
+TEST(telemetry_filter, NaN) {
+  TelemetryFilter filter("test");
+  filter.SetTolerances(Tolerances());
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_TRUE(Filter(&filter, 0.0, 0.0));
+  EXPECT_TRUE(Filter(&filter, 0.1, nan));
+  EXPECT_FALSE(Filter(&filter, 0.2, nan));
+  EXPECT_TRUE(Filter(&filter, 0.3, 0.0));
+}
+
+// Disabled, every sample is sent
+TEST(telemetry_filter, Disabled) {
+  TelemetryFilter filter("test");
+  TelemetryTolerances tolerances = Tolerances();
+  tolerances.enabled = false;
+  filter.SetTolerances(tolerances);
+  for (int i = 0; i < 5; i++)
+    EXPECT_TRUE(Filter(&filter, 0.1 * i, 0.0));
+  EXPECT_EQ(filter.DroppedSamples(), 0u);
+}
+
+// Carried values never decide whether a sample is sent
+TEST(telemetry_filter, CarriedValuesNotCompared) {
+  TelemetryFilter filter("test");
+  filter.SetTolerances(Tolerances());
+  filter.Add(0.0, 0.01);
+  filter.Carry(1.0, 0.0);
+  EXPECT_TRUE(filter.Update(0.0, 0.0, 100));
+  filter.Add(0.0, 0.01);
+  filter.Carry(1000.0, 0.0);
+  EXPECT_FALSE(filter.Update(0.1, 0.1, 100));
+  filter.Add(0.0, 0.01);
+  filter.Carry(std::numeric_limits<double>::quiet_NaN(), 0.0);
+  EXPECT_FALSE(filter.Update(0.2, 0.2, 100));
+}
+
+// New tolerances force the next sample through
+TEST(telemetry_filter, TolerancesChangeSends) {
+  TelemetryFilter filter("test");
+  filter.SetTolerances(Tolerances());
+  EXPECT_TRUE(Filter(&filter, 0.0, 0.0));
+  EXPECT_FALSE(Filter(&filter, 0.1, 0.0));
+  filter.SetTolerances(Tolerances());
+  EXPECT_TRUE(Filter(&filter, 0.2, 0.0));
+}
+
+// Required for the test framework
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,252 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Classes under test
+#include <dds_ros_bridge/telemetry_filter.h>
+#include <dds_ros_bridge/telemetry_frame.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using ff::TelemetryFrameReader;
+using ff::TelemetryFrameWriter;
+
+typedef std::vector<uint8_t> Frame;
+typedef TelemetryFrameReader::Sample Sample;
+
+static std::vector<Sample> ReadAll(TelemetryFrameReader* reader,
+                                   std::vector<Frame> const& frames) {
+  std::vector<Sample> samples;
+  for (Frame const& frame : frames)
+    EXPECT_TRUE(reader->Read(frame.data(), frame.size(), &samples));
+  return samples;
+}
+
+// Values come back within half their resolution, exactly with a resolution of
+// 0, and not a number stays not a number
+TEST(telemetry_frame, RoundTrip) {
+  TelemetryFrameWriter writer(0.1, 10);
+  std::vector<double> res = {0.001, 0.0001, 0.0, 0.0};
+  std::mt19937 rng(1);
+  std::normal_distribution<double> step(0.0, 0.01);
+  std::vector<std::vector<double>> sent;
+  std::vector<Frame> frames;
+  std::vector<double> values = {1.0, -2.0, 0.25, 3.0};
+  for (int i = 0; i < 25; i++) {
+    values[0] += step(rng);
+    values[1] = (i == 7) ? std::numeric_limits<double>::quiet_NaN()
+                         : values[1] + step(rng);
+    values[2] += step(rng);
+    values[3] = i;
+    writer.Add("state", 100.0 + 0.1 * i, values, res);
+    sent.push_back(values);
+    if (i % 3 == 2) {
+      frames.emplace_back();
+      EXPECT_TRUE(writer.Take(&frames.back()));
+    }
+  }
+  frames.emplace_back();
+  EXPECT_TRUE(writer.Take(&frames.back()));
+  Frame empty;
+  EXPECT_FALSE(writer.Take(&empty));
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(writer.Frames(), frames.size());
+
+  TelemetryFrameReader reader;
+  std::vector<Sample> samples = ReadAll(&reader, frames);
+  ASSERT_EQ(samples.size(), sent.size());
+  EXPECT_EQ(reader.Skipped(), 0u);
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_EQ(samples[i].topic, "state");
+    EXPECT_NEAR(samples[i].stamp, 100.0 + 0.1 * i, 1e-6);
+    ASSERT_EQ(samples[i].values.size(), sent[i].size());
+    for (size_t j = 0; j < res.size(); j++) {
+      if (std::isnan(sent[i][j]))
+        EXPECT_TRUE(std::isnan(samples[i].values[j]));
+      else if (res[j] == 0.0)
+        EXPECT_EQ(samples[i].values[j], sent[i][j]);
+      else
+        EXPECT_LE(std::fabs(samples[i].values[j] - sent[i][j]),
+                  0.5 * res[j] * (1 + 1e-6));
+    }
+  }
+}
+
+// Only keyframes pay for the name and resolutions, and small changes take a
+// byte or two per value
+TEST(telemetry_frame, DeltasSmallerThanKeyframes) {
+  TelemetryFrameWriter writer(0.1, 4);
+  std::vector<double> res(13, 0.0001);
+  std::vector<double> values(13, 0.5);
+  std::vector<size_t> sizes;
+  for (int i = 0; i < 9; i++) {
+    values[0] += 0.001;
+    sizes.push_back(writer.Add("ekf", i, values, res));
+  }
+  for (int i = 0; i < 9; i++) {
+    if (i % 4 == 0) {
+      EXPECT_GT(sizes[i], 13 * 4u) << i;
+    } else {
+      EXPECT_LT(sizes[i], 13 * 2u) << i;
+    }
+  }
+  Frame frame;
+  EXPECT_TRUE(writer.Take(&frame));
+  EXPECT_EQ(writer.PendingSize(), 0u);
+  EXPECT_EQ(writer.Bytes(), frame.size());
+}
+
+// A sample lost with its frame makes the following samples of its topic
+// unreadable, until the next keyframe of the topic
+TEST(telemetry_frame, LostFrameSkippedUntilKeyframe) {
+  TelemetryFrameWriter writer(0.1, 4);
+  std::vector<double> res = {0.01};
+  std::vector<Frame> frames;
+  for (int i = 0; i < 10; i++) {
+    writer.Add("position", i, std::vector<double>(1, i), res);
+    frames.emplace_back();
+    writer.Take(&frames.back());
+  }
+  frames.erase(frames.begin() + 1);
+
+  TelemetryFrameReader reader;
+  std::vector<Sample> samples = ReadAll(&reader, frames);
+  EXPECT_EQ(reader.Skipped(), 2u);
+  ASSERT_EQ(samples.size(), 7u);
+  std::vector<double> expected = {0, 4, 5, 6, 7, 8, 9};
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_NEAR(samples[i].stamp, expected[i], 1e-6);
+    EXPECT_NEAR(samples[i].values[0], expected[i], 0.005);
+  }
+}
+
+// Samples of several topics share a frame, and each keeps its own state
+TEST(telemetry_frame, CoalescesTopics) {
+  TelemetryFrameWriter writer(0.1, 10);
+  std::vector<double> ekf = {1.0, 2.0, 3.0};
+  std::vector<double> gnc = {-1.0, 7.0};
+  for (int i = 0; i < 6; i++) {
+    ekf[0] += 0.01;
+    gnc[1] -= 0.02;
+    writer.Add("ekf", 0.1 * i, ekf, std::vector<double>(3, 0.001));
+    writer.Add("gnc", 0.1 * i + 0.05, gnc, std::vector<double>(2, 0.001));
+  }
+  Frame frame;
+  EXPECT_TRUE(writer.Take(&frame));
+  EXPECT_EQ(writer.Frames(), 1u);
+
+  TelemetryFrameReader reader;
+  std::vector<Sample> samples;
+  EXPECT_TRUE(reader.Read(frame.data(), frame.size(), &samples));
+  ASSERT_EQ(samples.size(), 12u);
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(samples[2 * i].topic, "ekf");
+    EXPECT_EQ(samples[2 * i + 1].topic, "gnc");
+    ASSERT_EQ(samples[2 * i].values.size(), 3u);
+    ASSERT_EQ(samples[2 * i + 1].values.size(), 2u);
+    EXPECT_NEAR(samples[2 * i].values[0], 1.0 + 0.01 * (i + 1), 0.0005);
+    EXPECT_NEAR(samples[2 * i + 1].values[1], 7.0 - 0.02 * (i + 1), 0.0005);
+    EXPECT_NEAR(samples[2 * i + 1].stamp, 0.1 * i + 0.05, 1e-6);
+  }
+}
+
+// Truncated or foreign frames are rejected
+TEST(telemetry_frame, Malformed) {
+  TelemetryFrameWriter writer(0.1, 10);
+  writer.Add("ekf", 1.0, std::vector<double>(3, 1.0),
+             std::vector<double>(3, 0.001));
+  Frame frame;
+  ASSERT_TRUE(writer.Take(&frame));
+  TelemetryFrameReader reader;
+  std::vector<Sample> samples;
+  for (size_t size = 0; size < frame.size(); size++)
+    EXPECT_FALSE(reader.Read(frame.data(), size, &samples)) << size;
+  EXPECT_TRUE(samples.empty());
+  frame[0] ^= 1;
+  EXPECT_FALSE(reader.Read(frame.data(), frame.size(), &samples));
+}
+
+// A state that wanders and holds still, filtered and framed as the bridge
+// does, reaches the stand-in ground within the tolerances, in fewer bytes
+// than the same samples as raw doubles
+TEST(telemetry_frame, FilteredStateSmallerThanRaw) {
+  ff::TelemetryTolerances tolerances;
+  tolerances.enabled = true;
+  tolerances.max_interval = 1.0;
+  tolerances.position = 0.001;
+  tolerances.attitude = 0.0005;
+  TelemetryFrameWriter writer(0.1, 10);
+  ff::TelemetryFilter filter("state");
+  filter.SetTolerances(tolerances);
+  filter.SetFrameWriter(&writer);
+
+  std::mt19937 rng(2);
+  std::normal_distribution<double> step(0.0, 0.0005);
+  double x = 0.0, y = 0.0, angle = 0.0;
+  std::vector<std::vector<double>> sent;
+  std::vector<Frame> frames;
+  for (int i = 0; i < 1000; i++) {
+    // Moving for a second in every three, holding still otherwise
+    if ((i / 100) % 3 == 0) {
+      x += 0.002 + step(rng);
+      y += step(rng);
+      angle += 0.001;
+    }
+    std::vector<double> values = {x, y, std::sin(angle), std::cos(angle),
+                                  static_cast<double>(i / 100)};
+    filter.Add(values[0], tolerances.position);
+    filter.Add(values[1], tolerances.position);
+    filter.Add(values[2], tolerances.attitude);
+    filter.Add(values[3], tolerances.attitude);
+    filter.Carry(values[4], 0.0);
+    if (filter.Update(0.01 * i, 0.01 * i, 8 * values.size()))
+      sent.push_back(values);
+    if (i % 100 == 99) {
+      frames.emplace_back();
+      writer.Take(&frames.back());
+    }
+  }
+
+  TelemetryFrameReader reader;
+  std::vector<Sample> samples = ReadAll(&reader, frames);
+  ASSERT_EQ(samples.size(), sent.size());
+  std::vector<double> limits = {
+    tolerances.position, tolerances.position,
+    tolerances.attitude, tolerances.attitude};
+  for (size_t i = 0; i < sent.size(); i++) {
+    for (size_t j = 0; j < limits.size(); j++)
+      EXPECT_LE(std::fabs(samples[i].values[j] - sent[i][j]),
+                0.05 * limits[j] * (1 + 1e-6));
+    EXPECT_EQ(samples[i].values[4], sent[i][4]);
+  }
+  EXPECT_LT(filter.SentSamples(), 1000u);
+  EXPECT_LT(filter.FrameBytes(), writer.Bytes());
+  EXPECT_LT(writer.Bytes(), filter.SentBytes() / 2);
+}
+
+// Required for the test framework
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
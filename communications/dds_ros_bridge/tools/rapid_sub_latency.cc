@@ -0,0 +1,183 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dds_ros_bridge/event_loop_reactor.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+// Measures the delay between publishing a sample and its callback running,
+// for the layouts of the rapid subscribers of the bridge, with a loopback
+// stand-in for the DDS transport: samples are posted straight into the queue
+// of the event loop a subscription is connected to.
+//   rapid_sub_latency [topics] [workers] [rate] [seconds]
+// Every topic publishes at the given rate, with random jitter, a sample of a
+// kilobyte that the callback copies, as the bridge copies compressed files.
+
+typedef std::chrono::steady_clock Clock;
+
+struct Sample {
+  Clock::time_point sent;
+  std::vector<unsigned char> payload;
+};
+
+typedef std::function<void(Sample const*)> Callback;
+
+// Dispatches the samples of its subscriptions from processEvents, either as
+// soon as they are posted, like a DDS wait set, or only once the timeout has
+// elapsed, like a loop polled at a fixed rate
+class LoopbackEventLoop {
+ public:
+  explicit LoopbackEventLoop(const std::string& name) {}
+
+  int connect(const Callback& callback) {
+    callbacks_.push_back(callback);
+    return callbacks_.size() - 1;
+  }
+
+  void Post(int subscription, const Sample& sample) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.emplace_back(subscription, sample);
+    }
+    cond_.notify_one();
+  }
+
+  void processEvents(const std::chrono::milliseconds& timeout) {
+    std::deque<std::pair<int, Sample>> ready;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (polled)
+        cond_.wait_for(lock, timeout, []() { return false; });
+      else
+        cond_.wait_for(lock, timeout, [this]() { return !queue_.empty(); });
+      ready.swap(queue_);
+    }
+    for (size_t i = 0; i < ready.size(); i++)
+      callbacks_[ready[i].first](&ready[i].second);
+  }
+
+  static bool polled;
+
+ private:
+  std::vector<Callback> callbacks_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::pair<int, Sample>> queue_;
+};
+
+bool LoopbackEventLoop::polled = false;
+
+typedef ff::EventLoopReactor<LoopbackEventLoop, std::chrono::milliseconds>
+  LoopbackReactor;
+
+// One subscription per topic, copying samples and recording their latency
+class Subscriber {
+ public:
+  Subscriber(LoopbackReactor* reactor, std::vector<double>* latencies)
+    : loop_(reactor->Assign()), latencies_(latencies) {
+    subscription_ = loop_.connect([this](Sample const* sample) {
+      copy_ = sample->payload;
+      latencies_->push_back(std::chrono::duration<double>(
+        Clock::now() - sample->sent).count());
+    });
+  }
+
+  void Post(const Sample& sample) {
+    loop_.Post(subscription_, sample);
+  }
+
+ private:
+  LoopbackEventLoop& loop_;
+  std::vector<double>* latencies_;
+  std::vector<unsigned char> copy_;
+  int subscription_;
+};
+
+void Run(const char* layout, int topics, int workers, bool polled, double rate,
+         double seconds) {
+  LoopbackEventLoop::polled = polled;
+  LoopbackReactor reactor("loopback", workers, std::chrono::milliseconds(100));
+  std::vector<std::vector<double>> latencies(topics);
+  std::vector<Subscriber*> subscribers;
+  for (int i = 0; i < topics; i++)
+    subscribers.push_back(new Subscriber(&reactor, &latencies[i]));
+  reactor.Start();
+
+  // Publish from one thread, in time order of the next sample of each topic
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> jitter(0.5, 1.5);
+  Clock::time_point start = Clock::now();
+  std::vector<Clock::time_point> next(topics, start);
+  Sample sample;
+  sample.payload.resize(1024);
+  while (true) {
+    int t = std::min_element(next.begin(), next.end()) - next.begin();
+    if (next[t] - start > std::chrono::duration<double>(seconds))
+      break;
+    std::this_thread::sleep_until(next[t]);
+    sample.sent = Clock::now();
+    subscribers[t]->Post(sample);
+    next[t] += std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(jitter(generator) / rate));
+  }
+  // Let the last samples through, polled loops wake up every timeout
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  reactor.Stop();
+
+  std::vector<double> all;
+  for (int i = 0; i < topics; i++) {
+    all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+    delete subscribers[i];
+  }
+  std::sort(all.begin(), all.end());
+  double mean = 0.0;
+  for (size_t i = 0; i < all.size(); i++)
+    mean += all[i] / all.size();
+  printf("%-28s threads: %3zu samples: %7zu mean: %9.1f us p99: %9.1f us max: %9.1f us\n",
+    layout, reactor.Workers(), all.size(), 1e6 * mean,
+    all.empty() ? 0.0 : 1e6 * all[all.size() * 99 / 100],
+    all.empty() ? 0.0 : 1e6 * all.back());
+}
+
+int main(int argc, char** argv) {
+  int topics = (argc > 1) ? atoi(argv[1]) : 8;
+  int workers = (argc > 2) ? atoi(argv[2]) : 2;
+  double rate = (argc > 3) ? atof(argv[3]) : 50.0;
+  double seconds = (argc > 4) ? atof(argv[4]) : 5.0;
+  if (topics < 1 || workers < 1 || rate <= 0.0 || seconds <= 0.0) {
+    fprintf(stderr, "Usage: %s [topics] [workers] [rate] [seconds]\n", argv[0]);
+    return 1;
+  }
+
+  Run("loop per topic, polled", topics, topics, true, rate, seconds);
+  Run("loop per topic", topics, topics, false, rate, seconds);
+  Run("shared loops", topics, workers, false, rate, seconds);
+  return 0;
+}
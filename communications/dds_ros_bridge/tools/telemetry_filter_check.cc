@@ -0,0 +1,109 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <dds_ros_bridge/telemetry_filter.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <random>
+
+// Checks that the ground state stays equivalent when the state telemetry goes
+// through a TelemetryFilter. A simulated robot alternates between holding
+// still, with sensor noise, and moving. Its state is sampled at the position
+// rate and filtered, and a stand-in for the ground keeps the last sample it
+// received, as GDS does. The ground must never be further from the robot than
+// the tolerances, nor hold a sample for longer than the max interval.
+//   telemetry_filter_check [rate] [seconds]
+
+struct Vec3 {
+  double x, y, z;
+};
+
+struct State {
+  Vec3 position, velocity;
+  int confidence;
+};
+
+int main(int argc, char** argv) {
+  double rate = (argc > 1) ? atof(argv[1]) : 30.0;
+  double seconds = (argc > 2) ? atof(argv[2]) : 600.0;
+  if (rate <= 0.0 || seconds <= 0.0) {
+    fprintf(stderr, "Usage: %s [rate] [seconds]\n", argv[0]);
+    return 1;
+  }
+
+  ff::TelemetryTolerances tolerances;
+  tolerances.enabled = true;
+  tolerances.max_interval = 1.0;
+  tolerances.position = 0.001;
+  tolerances.velocity = 0.001;
+  ff::TelemetryFilter filter("position");
+  filter.SetTolerances(tolerances);
+
+  std::mt19937 generator(0);
+  std::normal_distribution<double> noise(0.0, 0.0002);
+  State robot = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, 0}, ground = robot;
+  double ground_time = 0.0, max_error = 0.0, max_age = 0.0;
+  int samples = 0;
+  for (double t = 0.0; t < seconds; t += 1.0 / rate, samples++) {
+    // Move for 10 seconds of every 30, and lose localization now and then
+    bool moving = fmod(t, 30.0) < 10.0;
+    robot.velocity.x = (moving ? 0.05 : 0.0) + noise(generator);
+    robot.velocity.y = (moving ? 0.02 * sin(t) : 0.0) + noise(generator);
+    robot.velocity.z = noise(generator);
+    robot.position.x += robot.velocity.x / rate;
+    robot.position.y += robot.velocity.y / rate;
+    robot.position.z += robot.velocity.z / rate;
+    robot.confidence = (fmod(t, 97.0) < 2.0) ? 2 : 0;
+
+    filter.AddVector(robot.position, tolerances.position);
+    filter.AddVector(robot.velocity, tolerances.velocity);
+    filter.Add(robot.confidence, 0.0);
+    if (filter.Update(t, t, sizeof(State))) {
+      ground = robot;
+      ground_time = t;
+    }
+
+    // The ground is within tolerances and holds a recent sample
+    double error = std::max(
+      std::max(fabs(ground.position.x - robot.position.x),
+               fabs(ground.position.y - robot.position.y)),
+      fabs(ground.position.z - robot.position.z));
+    double age = t - ground_time;
+    max_error = std::max(max_error, error);
+    max_age = std::max(max_age, age);
+    if (ground.confidence != robot.confidence || error > tolerances.position ||
+        age > tolerances.max_interval + 0.5 / rate) {
+      fprintf(stderr, "Ground state diverged at %.3f s: error %.4f m, age %.3f s.\n",
+        t, error, age);
+      return 1;
+    }
+  }
+
+  printf("Filtered %d samples at %.1f Hz: sent %llu (%.1f kB), dropped %llu (%.1f kB).\n",
+    samples, rate, static_cast<unsigned long long>(filter.SentSamples()),  // NOLINT
+    filter.SentBytes() / 1e3,
+    static_cast<unsigned long long>(filter.DroppedSamples()),  // NOLINT
+    filter.DroppedBytes() / 1e3);
+  printf("Ground state error at most %.4f m, samples held at most %.3f s.\n",
+    max_error, max_age);
+  return 0;
+}
@@ -42,6 +42,7 @@
 #include <ff_util/ff_flight.h>
 #include <ff_util/ff_action.h>
 #include <ff_util/ff_fsm.h>
+#include <ff_util/ff_nodelet.h>
 #include <ff_util/perf_timer.h>
 
 // Libraries to read LIA config file
@@ -78,7 +79,8 @@ class Ctl {
   /**
    * Ctl allocate, register, initialize model
    */
-  explicit Ctl(ros::NodeHandle* nh, std::string const& name);
+  Ctl(ros::NodeHandle* nh, std::string const& name,
+    ff_util::FreeFlyerNodelet* nodelet = NULL);
   /**
    * destruct model
    */
@@ -163,6 +165,12 @@ class Ctl {
   ff_util::PerfTimer pt_ctl_;
   ros::Timer config_timer_;
 
+  // IMU time stamp of the last state estimate, and when it was received
+  ros::Time est_stamp_, est_received_;
+
+  // Serves the estimate callbacks, which step control, on a real-time thread
+  ff_util::FreeFlyerNodelet* nodelet_;
+
   std::string name_;
   bool inertia_received_;
   bool control_enabled_;
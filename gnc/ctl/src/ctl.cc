@@ -39,10 +39,12 @@ namespace mc = msg_conversions;
 
 namespace ctl {  // Nodehandle for <robot>/gnc/wrapper
 
-Ctl::Ctl(ros::NodeHandle* nh, std::string const& name) :
+Ctl::Ctl(ros::NodeHandle* nh, std::string const& name,
+  ff_util::FreeFlyerNodelet* nodelet) :
   fsm_(WAITING, std::bind(&Ctl::UpdateCallback,
     this, std::placeholders::_1, std::placeholders::_2)),
-      name_(name), inertia_received_(false), control_enabled_(false) {
+      nodelet_(nodelet), name_(name), inertia_received_(false),
+      control_enabled_(false) {
   // Add the state transition lambda functions - refer to the FSM diagram
   // [0]
   fsm_.Add(GOAL_NOMINAL,                          // These events move...
@@ -100,10 +102,12 @@ Ctl::Ctl(ros::NodeHandle* nh, std::string const& name) :
       config_.CheckFilesUpdated(std::bind(&Ctl::ReadParams, this));}, false, true);
   pt_ctl_.Initialize("ctl");
 
-  // Subscribers
-  ekf_sub_ = nh->subscribe(
+  // Subscribers. The estimates drive the control step, so they are served
+  // by a thread of the nodelet with its real-time scheduling policy
+  ros::NodeHandle* nh_rt = (nodelet_ != NULL ? nodelet_->GetRealtimeHandle() : nh);
+  ekf_sub_ = nh_rt->subscribe(
     TOPIC_GNC_EKF, 1, &Ctl::EkfCallback, this);
-  pose_sub_ = nh->subscribe(
+  pose_sub_ = nh_rt->subscribe(
     TOPIC_LOCALIZATION_POSE, 1, &Ctl::PoseCallback, this);
   twist_sub_ = nh->subscribe(
     TOPIC_LOCALIZATION_TWIST, 1, &Ctl::TwistCallback, this);
@@ -197,6 +201,8 @@ void Ctl::EkfCallback(const ff_msgs::EkfState::ConstPtr& state) {
     ctl.est_confidence = state->confidence;
     ctl.current_time_sec = state->header.stamp.sec;
     ctl.current_time_nsec = state->header.stamp.nsec;
+    est_stamp_ = state->header.stamp;
+    est_received_ = ros::Time::now();
     mutex_cmd_msg_.unlock();
     // advance control forward whenever the pose is updated
     pt_ctl_.Tick();
@@ -216,6 +222,8 @@ void Ctl::PoseCallback(const geometry_msgs::PoseStamped::ConstPtr& truth) {
     ctl.est_confidence = 0;  // Localization manager now deals with this
     ctl.current_time_sec = truth->header.stamp.sec;
     ctl.current_time_nsec = truth->header.stamp.nsec;
+    est_stamp_ = truth->header.stamp;
+    est_received_ = ros::Time::now();
     mutex_cmd_msg_.unlock();
     // advance control forward whenever the pose is updated
     pt_ctl_.Tick();
@@ -419,6 +427,7 @@ bool Ctl::Control(uint8_t mode, ff_msgs::ControlCommand const& poseVel) {
 
 bool Ctl::Step(void) {
   // Step GNC forward
+  ros::Time est_stamp, est_received;
   {
     if (!inertia_received_) {
       NODELET_DEBUG_STREAM_THROTTLE(10, "GNC step waiting for inertia");
@@ -430,6 +439,8 @@ bool Ctl::Step(void) {
     }
     std::lock_guard<std::mutex> cmd_lock(mutex_cmd_msg_);
     gnc_.Step();
+    est_stamp = est_stamp_;
+    est_received = est_received_;
   }
 
   // Output of the Step() function is FAM control (ctl)
@@ -452,6 +463,8 @@ bool Ctl::Step(void) {
   cmd_msg_.attitude_error_mag = ctl.att_err_mag;
   cmd_msg_.status = ctl.ctl_status;
   cmd_msg_.control_mode = cmd.cmd_mode;
+  cmd_msg_.est_stamp = est_stamp;
+  cmd_msg_.est_received = est_received;
   ctl_pub_.publish(cmd_msg_);
 
   // Publish the current setpoint,
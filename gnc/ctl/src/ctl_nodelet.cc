@@ -38,7 +38,7 @@ class CtlNodelet : public ff_util::FreeFlyerNodelet {
     // Bootstrap our environment
     common::InitFreeFlyerApplication(getMyArgv(), false);
     gnc_autocode::InitializeAutocode(this);
-    ctl_.reset(new ctl::Ctl(this->GetPlatformHandle(true), getName()));
+    ctl_.reset(new ctl::Ctl(this->GetPlatformHandle(true), getName(), this));
   }
 
  private:
@@ -41,6 +41,7 @@
 #include <ff_msgs/SetEkfInput.h>
 #include <ff_msgs/VisualLandmarks.h>
 #include <ff_msgs/FlightMode.h>
+#include <ff_util/ff_publisher.h>
 #include <ff_util/perf_timer.h>
 #include <std_srvs/Empty.h>
 
@@ -160,9 +161,10 @@ class EkfWrapper {
   ros::Subscriber flight_mode_sub_;
 
   // publisher
-  ros::Publisher state_pub_;
-  ros::Publisher feature_pub_;
-  ros::Publisher pose_pub_, twist_pub_;
+  ff_util::FreeFlyerPublisher<ff_msgs::EkfState> state_pub_;
+  ff_util::FreeFlyerPublisher<sensor_msgs::PointCloud2> feature_pub_;
+  ff_util::FreeFlyerPublisher<geometry_msgs::PoseStamped> pose_pub_;
+  ff_util::FreeFlyerPublisher<geometry_msgs::TwistStamped> twist_pub_;
   tf2_ros::TransformBroadcaster transform_pub_;
   ros::ServiceServer reset_srv_, bias_srv_, input_mode_srv_;
 
@@ -188,7 +190,6 @@ class EkfWrapper {
   /** Feature drawing **/
   std::string platform_name_;
   bool disp_features_;
-  sensor_msgs::PointCloud2 features_;
 };
 
 }  // end namespace ekf
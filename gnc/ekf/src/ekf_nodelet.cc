@@ -40,7 +40,11 @@ class EkfNodelet : public ff_util::FreeFlyerNodelet {
     common::InitFreeFlyerApplication(getMyArgv());
     gnc_autocode::InitializeAutocode(this);
     ekf_.reset(new ekf::EkfWrapper(this->GetPlatformHandle(true), GetPlatform()));
-    thread_.reset(new std::thread(&ekf::EkfWrapper::Run, ekf_.get()));
+    thread_.reset(new std::thread([this]() {
+      RegisterThread();
+      ApplyScheduling();
+      ekf_->Run();
+    }));
   }
 
  private:
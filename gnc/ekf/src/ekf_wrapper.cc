@@ -54,10 +54,10 @@ EkfWrapper::~EkfWrapper() {
 
 // wait to start up until the IMU is ready
 void EkfWrapper::InitializeEkf(void) {
-  state_pub_   = nh_->advertise<ff_msgs::EkfState>(TOPIC_GNC_EKF, 1);
-  pose_pub_    = nh_->advertise<geometry_msgs::PoseStamped>(TOPIC_LOCALIZATION_POSE, 1);
-  twist_pub_   = nh_->advertise<geometry_msgs::TwistStamped>(TOPIC_LOCALIZATION_TWIST, 1);
-  feature_pub_ = nh_->advertise<sensor_msgs::PointCloud2>(TOPIC_GNC_EKF_FEATURES, 1,
+  state_pub_.Create(nh_, TOPIC_GNC_EKF, 1);
+  pose_pub_.Create(nh_, TOPIC_LOCALIZATION_POSE, 1);
+  twist_pub_.Create(nh_, TOPIC_LOCALIZATION_TWIST, 1);
+  feature_pub_.Create(nh_, TOPIC_GNC_EKF_FEATURES, 1, false,
       boost::bind(&EkfWrapper::SubscriberCallback, this),
       boost::bind(&EkfWrapper::SubscriberCallback, this));
 
@@ -109,73 +109,75 @@ void EkfWrapper::ReadParams(void) {
 }
 
 void EkfWrapper::SubscriberCallback() {
-  disp_features_ = (feature_pub_.getNumSubscribers() > 0);
+  disp_features_ = (feature_pub_.GetNumSubscribers() > 0);
 }
 
 void EkfWrapper::PublishFeatures(ff_msgs::VisualLandmarks::ConstPtr const& l) {
   if (!disp_features_) return;
-  features_.header = std_msgs::Header();
-  features_.header.stamp = ros::Time::now();
-  features_.header.frame_id = "world";
-  features_.height = 1;
-  features_.width = l->landmarks.size();
-  features_.fields.resize(3);
-  features_.fields[0].name = "x";
-  features_.fields[0].offset = 0;
-  features_.fields[0].datatype = 7;
-  features_.fields[0].count = 1;
-  features_.fields[1].name = "y";
-  features_.fields[1].offset = 4;
-  features_.fields[1].datatype = 7;
-  features_.fields[1].count = 1;
-  features_.fields[2].name = "z";
-  features_.fields[2].offset = 8;
-  features_.fields[2].datatype = 7;
-  features_.fields[2].count = 1;
-  features_.is_bigendian = false;
-  features_.point_step = 12;
-  features_.row_step = features_.point_step * features_.width;
-  features_.is_dense = true;
-  features_.data.resize(features_.row_step);
+  sensor_msgs::PointCloud2Ptr features = feature_pub_.Allocate();
+  features->header = std_msgs::Header();
+  features->header.stamp = ros::Time::now();
+  features->header.frame_id = "world";
+  features->height = 1;
+  features->width = l->landmarks.size();
+  features->fields.resize(3);
+  features->fields[0].name = "x";
+  features->fields[0].offset = 0;
+  features->fields[0].datatype = 7;
+  features->fields[0].count = 1;
+  features->fields[1].name = "y";
+  features->fields[1].offset = 4;
+  features->fields[1].datatype = 7;
+  features->fields[1].count = 1;
+  features->fields[2].name = "z";
+  features->fields[2].offset = 8;
+  features->fields[2].datatype = 7;
+  features->fields[2].count = 1;
+  features->is_bigendian = false;
+  features->point_step = 12;
+  features->row_step = features->point_step * features->width;
+  features->is_dense = true;
+  features->data.resize(features->row_step);
   for (unsigned int i = 0; i < l->landmarks.size(); i++) {
-    memcpy(&features_.data[features_.point_step * i + 0], &l->landmarks[i].x, 4);
-    memcpy(&features_.data[features_.point_step * i + 4], &l->landmarks[i].y, 4);
-    memcpy(&features_.data[features_.point_step * i + 8], &l->landmarks[i].z, 4);
+    memcpy(&features->data[features->point_step * i + 0], &l->landmarks[i].x, 4);
+    memcpy(&features->data[features->point_step * i + 4], &l->landmarks[i].y, 4);
+    memcpy(&features->data[features->point_step * i + 8], &l->landmarks[i].z, 4);
   }
-  feature_pub_.publish(features_);
+  feature_pub_.Publish(features);
 }
 
 void EkfWrapper::PublishFeatures(ff_msgs::DepthLandmarks::ConstPtr const& l) {
   if (!disp_features_) return;
-  features_.header = std_msgs::Header();
-  features_.header.stamp = ros::Time::now();
-  features_.header.frame_id = platform_name_ + "perch_cam";
-  features_.height = 1;
-  features_.width = l->landmarks.size();
-  features_.fields.resize(3);
-  features_.fields[0].name = "x";
-  features_.fields[0].offset = 0;
-  features_.fields[0].datatype = 7;
-  features_.fields[0].count = 1;
-  features_.fields[1].name = "y";
-  features_.fields[1].offset = 4;
-  features_.fields[1].datatype = 7;
-  features_.fields[1].count = 1;
-  features_.fields[2].name = "z";
-  features_.fields[2].offset = 8;
-  features_.fields[2].datatype = 7;
-  features_.fields[2].count = 1;
-  features_.is_bigendian = false;
-  features_.point_step = 12;
-  features_.row_step = features_.point_step * features_.width;
-  features_.is_dense = true;
-  features_.data.resize(features_.row_step);
+  sensor_msgs::PointCloud2Ptr features = feature_pub_.Allocate();
+  features->header = std_msgs::Header();
+  features->header.stamp = ros::Time::now();
+  features->header.frame_id = platform_name_ + "perch_cam";
+  features->height = 1;
+  features->width = l->landmarks.size();
+  features->fields.resize(3);
+  features->fields[0].name = "x";
+  features->fields[0].offset = 0;
+  features->fields[0].datatype = 7;
+  features->fields[0].count = 1;
+  features->fields[1].name = "y";
+  features->fields[1].offset = 4;
+  features->fields[1].datatype = 7;
+  features->fields[1].count = 1;
+  features->fields[2].name = "z";
+  features->fields[2].offset = 8;
+  features->fields[2].datatype = 7;
+  features->fields[2].count = 1;
+  features->is_bigendian = false;
+  features->point_step = 12;
+  features->row_step = features->point_step * features->width;
+  features->is_dense = true;
+  features->data.resize(features->row_step);
   for (unsigned int i = 0; i < l->landmarks.size(); i++) {
-    memcpy(&features_.data[features_.point_step * i + 0], &l->landmarks[i].u, 4);
-    memcpy(&features_.data[features_.point_step * i + 4], &l->landmarks[i].v, 4);
-    memcpy(&features_.data[features_.point_step * i + 8], &l->landmarks[i].w, 4);
+    memcpy(&features->data[features->point_step * i + 0], &l->landmarks[i].u, 4);
+    memcpy(&features->data[features->point_step * i + 4], &l->landmarks[i].v, 4);
+    memcpy(&features->data[features->point_step * i + 8], &l->landmarks[i].w, 4);
   }
-  feature_pub_.publish(features_);
+  feature_pub_.Publish(features);
 }
 
 void EkfWrapper::ImuCallBack(sensor_msgs::Imu::ConstPtr const& imu) {
@@ -289,13 +291,13 @@ void EkfWrapper::GroundTruthCallback(geometry_msgs::PoseStamped::ConstPtr const&
   assert(truth->header.frame_id == "world");
   quat_ = truth->pose.orientation;
   if (input_mode_ == ff_msgs::SetEkfInputRequest::MODE_TRUTH) {
-    pose_pub_.publish(truth);
+    pose_pub_.Publish(truth);
   }
 }
 
 void EkfWrapper::GroundTruthTwistCallback(geometry_msgs::TwistStamped::ConstPtr const& truth) {
   if (input_mode_ == ff_msgs::SetEkfInputRequest::MODE_TRUTH) {
-    twist_pub_.publish(truth);
+    twist_pub_.Publish(truth);
   }
 }
 
@@ -323,7 +325,7 @@ int EkfWrapper::Step() {
       if (imus_dropped_ > 10 && ekf_initialized_) {
         state_.header.stamp = ros::Time::now();
         state_.confidence = 2;  // lost
-        state_pub_.publish<ff_msgs::EkfState>(state_);
+        state_pub_.Publish(state_pub_.Allocate(state_));
         ekf_.Reset();
       }
       return 0;   // Changed by Andrew due to 250Hz ctl messages when sim blocks (!)
@@ -356,7 +358,7 @@ int EkfWrapper::Step() {
 }
 
 void EkfWrapper::PublishState(const ff_msgs::EkfState & state) {
-  state_pub_.publish<ff_msgs::EkfState>(state);
+  state_pub_.Publish(state_pub_.Allocate(state));
 
   // publish transform for body frame
   geometry_msgs::TransformStamped transform;
@@ -369,16 +371,16 @@ void EkfWrapper::PublishState(const ff_msgs::EkfState & state) {
   transform_pub_.sendTransform(transform);
 
   if (input_mode_ != ff_msgs::SetEkfInputRequest::MODE_TRUTH) {
-    geometry_msgs::PoseStamped pose;
-    pose.header.stamp = state.header.stamp;
-    pose.pose = state.pose;
-    pose_pub_.publish(pose);
-
-    geometry_msgs::TwistStamped twist;
-    twist.header.stamp = state.header.stamp;
-    twist.twist.linear = state.velocity;
-    twist.twist.angular = state.omega;
-    twist_pub_.publish(twist);
+    geometry_msgs::PoseStampedPtr pose = pose_pub_.Allocate();
+    pose->header.stamp = state.header.stamp;
+    pose->pose = state.pose;
+    pose_pub_.Publish(pose);
+
+    geometry_msgs::TwistStampedPtr twist = twist_pub_.Allocate();
+    twist->header.stamp = state.header.stamp;
+    twist->twist.linear = state.velocity;
+    twist->twist.angular = state.omega;
+    twist_pub_.Publish(twist);
   }
 }
 
@@ -29,6 +29,8 @@
 #include <ff_msgs/FlightMode.h>
 
 #include <ff_util/ff_names.h>
+#include <ff_util/ff_nodelet.h>
+#include <ff_util/latency_monitor.h>
 #include <ff_util/perf_timer.h>
 
 #include <geometry_msgs/Inertia.h>
@@ -43,15 +45,17 @@ namespace fam {
 */
 class Fam {
  public:
-  explicit Fam(ros::NodeHandle* nh);
+  Fam(ros::NodeHandle* nh, ff_util::FreeFlyerNodelet* nodelet);
   ~Fam();
-  void Step(ex_time_msg* ex_time, cmd_msg* cmd, ctl_msg* ctl);
+  // Returns true if a PMC command was published
+  bool Step(ex_time_msg* ex_time, cmd_msg* cmd, ctl_msg* ctl);
 
  protected:
   void ReadParams(void);
   void CtlCallBack(const ff_msgs::FamCommand & c);
   void FlightModeCallback(const ff_msgs::FlightMode::ConstPtr& mode);
   void InertiaCallback(const geometry_msgs::Inertia::ConstPtr& inertia);
+  void CheckLatency(const ff_msgs::FamCommand & c);
 
   gnc_autocode::GncFamAutocode gnc_;
 
@@ -63,6 +67,15 @@ class Fam {
   ff_util::PerfTimer pt_fam_;
   ros::Timer config_timer_;
 
+  // Latency from IMU sample to PMC command. The nodelet is used to assert a
+  // fault when the deadline is missed, and serves commands on a real-time thread
+  ff_util::FreeFlyerNodelet* nodelet_;
+  ff_util::LatencyMonitor latency_;
+  ros::Timer latency_timer_;
+  ros::Time pmc_stamp_;
+  ros::Time last_deadline_miss_;
+  bool deadline_fault_;
+
   std::mutex mutex_speed_;
   uint8_t speed_;
   std::mutex mutex_mass_;
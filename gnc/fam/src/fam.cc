@@ -21,12 +21,29 @@
 #include <ff_util/ff_names.h>
 #include <ff_hw_msgs/PmcCommand.h>
 
+#include <string>
+#include <vector>
+
 // parameters fam_force_allocation_module_P are set in
 //  matlab/code_generation/fam_force_allocation_module_ert_rtw/fam_force_allocation_module_data.c
 
 namespace fam {
 
-Fam::Fam(ros::NodeHandle* nh) : inertia_received_(false) {
+// Upper edges of the latency histogram bins, in seconds
+static const std::vector<float> kLatencyBins = {
+  0.001, 0.002, 0.004, 0.006, 0.008, 0.010, 0.012, 0.016, 0.024, 0.032, 0.064};
+
+// Time without deadline misses after which the fault is cleared, in seconds
+static constexpr double kDeadlineFaultClearTime = 1.0;
+
+Fam::Fam(ros::NodeHandle* nh, ff_util::FreeFlyerNodelet* nodelet) :
+  inertia_received_(false), nodelet_(nodelet), deadline_fault_(false) {
+  // IMU sample -> estimate received by control -> command published by
+  // control -> PMC command published
+  latency_.Initialize(nh, TOPIC_GNC_FAM_LATENCY, {"ekf", "ctl", "fam"}, kLatencyBins);
+  latency_timer_ = nh->createTimer(ros::Duration(1), [this](ros::TimerEvent e) {
+      latency_.Send();}, false, true);
+
   config_.AddFile("gnc.config");
   config_.AddFile("geometry.config");
   ReadParams();
@@ -42,7 +59,10 @@ Fam::Fam(ros::NodeHandle* nh) : inertia_received_(false) {
   inertia_sub_ = nh->subscribe(
     TOPIC_MANAGEMENT_INERTIA, 1, &Fam::InertiaCallback, this);
 
-  ctl_sub_ = nh->subscribe(TOPIC_GNC_CTL_COMMAND, 5, &Fam::CtlCallBack, this, ros::TransportHints().tcpNoDelay());
+  // Commands are served by a thread of the nodelet with its real-time
+  // scheduling policy
+  ros::NodeHandle* nh_rt = (nodelet_ != NULL ? nodelet_->GetRealtimeHandle() : nh);
+  ctl_sub_ = nh_rt->subscribe(TOPIC_GNC_CTL_COMMAND, 5, &Fam::CtlCallBack, this, ros::TransportHints().tcpNoDelay());
 }
 
 Fam::~Fam() {}
@@ -66,7 +86,27 @@ void Fam::CtlCallBack(const ff_msgs::FamCommand & c) {
   ctl.ctl_status  = c.status;
   cmd.cmd_mode    = c.control_mode;
 
-  Step(&time, &cmd, &ctl);
+  if (Step(&time, &cmd, &ctl))
+    CheckLatency(c);
+}
+
+void Fam::CheckLatency(const ff_msgs::FamCommand & c) {
+  // Commands not computed from a state estimate are not timed
+  if (c.est_stamp.isZero())
+    return;
+  bool on_time = latency_.Add({c.est_stamp, c.est_received, c.header.stamp, pmc_stamp_});
+  if (!on_time) {
+    last_deadline_miss_ = pmc_stamp_;
+    if (!deadline_fault_ && nodelet_ != NULL) {
+      nodelet_->AssertFault("CONTROL_DEADLINE_MISSED", "PMC command published "
+        + std::to_string((pmc_stamp_ - c.est_stamp).toSec()) + "s after the IMU sample");
+    }
+    deadline_fault_ = true;
+  } else if (deadline_fault_ && (pmc_stamp_ - last_deadline_miss_).toSec() > kDeadlineFaultClearTime) {
+    if (nodelet_ != NULL)
+      nodelet_->ClearFault("CONTROL_DEADLINE_MISSED");
+    deadline_fault_ = false;
+  }
 }
 
 void Fam::FlightModeCallback(const ff_msgs::FlightMode::ConstPtr& mode) {
@@ -80,7 +120,7 @@ void Fam::InertiaCallback(const geometry_msgs::Inertia::ConstPtr& inertia) {
   inertia_received_ = true;
 }
 
-void Fam::Step(ex_time_msg* ex_time, cmd_msg* cmd, ctl_msg* ctl) {
+bool Fam::Step(ex_time_msg* ex_time, cmd_msg* cmd, ctl_msg* ctl) {
   {
     std::lock_guard<std::mutex> lock(mutex_speed_);
     // Overwrite the speed command with the cached value, provided
@@ -91,7 +131,7 @@ void Fam::Step(ex_time_msg* ex_time, cmd_msg* cmd, ctl_msg* ctl) {
     std::lock_guard<std::mutex> lock(mutex_mass_);
     if (!inertia_received_) {
       ROS_DEBUG_STREAM_THROTTLE(10, "FAM step waiting for inertia.");
-      return;
+      return false;
     }
     msg_conversions::ros_to_array_vector(center_of_mass_, gnc_.cmc_.center_of_mass);
   }
@@ -113,8 +153,10 @@ void Fam::Step(ex_time_msg* ex_time, cmd_msg* cmd, ctl_msg* ctl) {
   std::copy(gnc_.act_.act_servo_pwm_cmd + 6, gnc_.act_.act_servo_pwm_cmd + 12,
       pmc.goals[1].nozzle_positions.c_array());
   pmc_pub_.publish<ff_hw_msgs::PmcCommand>(pmc);
+  pmc_stamp_ = pmc.header.stamp;
 
   pt_fam_.Send();
+  return true;
 }
 
 void Fam::ReadParams(void) {
@@ -123,6 +165,11 @@ void Fam::ReadParams(void) {
     return;
   }
   gnc_.ReadParams(&config_);
+  double deadline;
+  if (!config_.GetReal("gnc_latency_deadline", &deadline))
+    ROS_FATAL("gnc_latency_deadline not specified.");
+  else
+    latency_.SetDeadline(deadline);
 }
 
 }  // end namespace fam
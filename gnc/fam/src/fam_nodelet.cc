@@ -38,7 +38,7 @@ class FamNodelet : public ff_util::FreeFlyerNodelet {
     // Bootstrap our environment
     common::InitFreeFlyerApplication(getMyArgv(), false);
     gnc_autocode::InitializeAutocode(this);
-    fam_.reset(new fam::Fam(this->GetPlatformHandle(true)));
+    fam_.reset(new fam::Fam(this->GetPlatformHandle(true), this));
   }
 
  private:
@@ -44,7 +44,7 @@ struct  GncBlowerState{
 class GncBlowersAutocode {
  public:
   GncBlowersAutocode();
-  ~GncBlowersAutocode();
+  virtual ~GncBlowersAutocode();
   virtual void Initialize();
   virtual void Step();
   virtual void SetAngularVelocity(float x, float y, float z);
@@ -0,0 +1,160 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GNC_AUTOCODE_BLOWERS_KERNEL_H_
+#define GNC_AUTOCODE_BLOWERS_KERNEL_H_
+
+#include <gnc_autocode/blowers.h>
+
+#include <stdint.h>
+
+namespace gnc_autocode {
+
+// A hand written replacement for the step functions of the two generated
+// bpm_blower_*_propulsion_module models. Both PMCs are stepped together, and
+// the twelve nozzles are laid out as structure of arrays so the servo, nozzle
+// area and thrust computations compile to SIMD loops. Inputs and outputs are
+// exchanged through states_ exactly as with GncBlowersAutocode, so the two
+// classes are interchangeable. Parameters and initial conditions are taken
+// from the autocode models on Initialize, including the random number seeds,
+// so the outputs match the autocode to within floating point rounding.
+class GncBlowersKernel : public GncBlowersAutocode {
+ public:
+  static const int kPmcs = 2;
+  static const int kNozzles = 6;
+  static const int kLanes = kPmcs * kNozzles;
+
+  GncBlowersKernel();
+  ~GncBlowersKernel();
+  virtual void Initialize();
+  virtual void Step();
+
+ private:
+  // the few parameters and states whose names differ between the two models
+  struct ModelAliases;
+
+  // copy parameters and states out of the autocode models
+  void Load(void);
+  template <class P, class DW, class B>
+  void LoadModel(int pmc, const P & p, const DW & dw, const B & b, const ModelAliases & a);
+  // recompute the thrust to force / torque matrices for the center of mass
+  void LatchThrustMatrices(int pmc, const float center_of_mass[3]);
+
+  // per PMC parameters
+  struct PmcParams {
+    float cmd_scale;
+    float rate_rising, rate_falling;
+    float speed_filt_num, speed_filt_den;
+    float imp_kp, imp_ki, imp_kd, imp_filt_n;
+    float imp_max_voltage, imp_min_voltage;
+    float imp_zero_gain, imp_clamp_value;
+    float imp_integ_gain, imp_filt_gain;
+    float battery_gain;
+    float motor_inv_speed_k, motor_inv_r, motor_torque_k, motor_friction;
+    float impeller_axis[3];
+    float impeller_inertia;
+    float speed_gain;
+    float accel_gain;
+    float speed_integ_gain;
+    float zero_thrust_area;
+    float aero_torque;
+    float impeller_diameter, air_density;
+    const float* cdp_lookup;
+    const float* area_lookup;
+    float skew_gain[3];
+    float skew_const;
+    double sensor_noise_scale;
+    float sensor_sf, sensor_resolution, sensor_min, sensor_max;
+    float sensor_integ_gain;
+    double sensor_noise_stddev[2], sensor_noise_mean[2];
+    float noise_on;
+    double cg_error[3];
+    double aero_integ_gain;
+    double aero_noise_mean;
+    // per nozzle position and unit thrust direction in the body frame
+    float nozzle_position[3][kNozzles];
+    float nozzle_direction[3][kNozzles];
+  } pmc_[kPmcs];
+
+  // per PMC state
+  struct PmcState {
+    float prev_speed_cmd;
+    float imp_integ, imp_filt;
+    float speed;
+    float sensor_delay, sensor_integ;
+    float prev_cm[3];
+    bool latch;
+    double sensor_noise[2];
+    uint32_t sensor_seed[2];
+    float thrust2force[3][kNozzles];
+    float thrust2torque[3][kNozzles];
+  } pmc_state_[kPmcs];
+
+  // per nozzle parameters, index = pmc * kNozzles + nozzle
+  alignas(16) float servo_bias_[kLanes];
+  alignas(16) float servo_pwm2angle_[kLanes];
+  alignas(16) float servo_kp_[kLanes];
+  alignas(16) float servo_ki_[kLanes];
+  alignas(16) float servo_kd_[kLanes];
+  alignas(16) float servo_filt_n_[kLanes];
+  alignas(16) float servo_max_voltage_[kLanes];
+  alignas(16) float servo_min_voltage_[kLanes];
+  alignas(16) float servo_zero_gain_[kLanes];
+  alignas(16) float servo_clamp_value_[kLanes];
+  alignas(16) float servo_integ_gain_[kLanes];
+  alignas(16) float servo_filt_gain_[kLanes];
+  alignas(16) float servo_half_backlash_[kLanes];
+  alignas(16) float servo_gear_ratio_[kLanes];
+  alignas(16) float servo_inv_r_[kLanes];
+  alignas(16) float servo_motor_k_[kLanes];
+  alignas(16) float servo_friction_[kLanes];
+  alignas(16) float servo_inv_inertia_[kLanes];
+  alignas(16) float servo_shaft_integ_gain_[kLanes];
+  alignas(16) float servo_shaft_max_[kLanes];
+  alignas(16) float servo_shaft_min_[kLanes];
+  alignas(16) float servo_speed_integ_gain_[kLanes];
+  alignas(16) float nozzle_inv_gear_ratio_[kLanes];
+  alignas(16) float nozzle_min_open_angle_[kLanes];
+  alignas(16) float nozzle_intake_height_[kLanes];
+  alignas(16) float nozzle_flap_length_[kLanes];
+  alignas(16) float nozzle_width_[kLanes];
+  alignas(16) float nozzle_flap_count_[kLanes];
+  alignas(16) float nozzle_cd_[kLanes];
+  alignas(16) float nozzle_thrust_gain_[kLanes];
+  double nozzle_noise_feedback_[kLanes];
+  double nozzle_noise_stddev_[kLanes];
+
+  // per nozzle state
+  alignas(16) float servo_cmd_[kLanes];
+  alignas(16) float servo_shaft_[kLanes];
+  alignas(16) float servo_speed_[kLanes];
+  alignas(16) float servo_backlash_[kLanes];
+  alignas(16) float servo_integ_[kLanes];
+  alignas(16) float servo_filt_[kLanes];
+  alignas(16) float servo_current_[kLanes];
+  alignas(16) float nozzle_theta_[kLanes];
+  alignas(16) float nozzle_area_[kLanes];
+  alignas(16) float nozzle_thrust_[kLanes];
+  double nozzle_noise_[kLanes];
+  double nozzle_noise_next_[kLanes];
+  uint32_t nozzle_seed_[kLanes];
+};
+
+}  // end namespace gnc_autocode
+
+#endif  // GNC_AUTOCODE_BLOWERS_KERNEL_H_
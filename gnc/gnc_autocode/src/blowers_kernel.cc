@@ -0,0 +1,504 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// The generated utility functions have C++ linkage, so they must be declared
+// before blowers.h pulls the same headers into an extern "C" block.
+#include <look1_iflf_binlxpw.h>
+#include <rt_nrand_Upu32_Yd_f_pw_snf.h>
+#include <rt_roundf_snf.h>
+
+#include <gnc_autocode/blowers_kernel.h>
+
+#include <math.h>
+
+// The block names in the comments refer to the Simulink subsystems of
+// bpm_blower_*_propulsion_module, to make it easy to compare against the
+// generated code when the model changes.
+
+namespace gnc_autocode {
+
+struct GncBlowersKernel::ModelAliases {
+  float cmd_scale;
+  float servo_min_voltage, servo_zero_gain, servo_clamp_value;
+  float servo_integ_gain, servo_filt_gain;
+  float skew_gain1, accel_threshold;
+  float rot_gain_a, rot_gain1_m, rot_gain2_i;
+  const float* nozzle_position;
+  const float* nozzle_position_error;
+  const float* nozzle_orientations;
+  const float* nozzle_misalignment;
+  const float* nozzle_widths;
+  const float* discharge_coeff;
+  const float* discharge_coeff_error;
+  const float* impeller_orientation;
+  const float* impeller_orientation_error;
+  float zero_thrust_area, zero_thrust_area_error;
+  const double* noise_feedback;
+  float prev_speed_cmd, imp_integ, imp_filt;
+  double sensor_noise;
+  uint32_t sensor_seed;
+};
+
+namespace {
+
+inline float Sign(float x) {
+  return (x < 0.0F) ? -1.0F : ((x > 0.0F) ? 1.0F : 0.0F);
+}
+
+// the saturation of a discrete PID controller, returns the portion of the
+// output above / below the limits
+inline float DeadZone(float x, float lo, float hi) {
+  return (x > hi) ? (x - hi) : ((x >= lo) ? 0.0F : (x - lo));
+}
+
+inline float Clamp(float x, float lo, float hi) {
+  return (x > hi) ? hi : ((x < lo) ? lo : x);
+}
+
+}  // namespace
+
+GncBlowersKernel::GncBlowersKernel(void) {
+  // the base constructor has already initialized the autocode models
+  Load();
+}
+
+GncBlowersKernel::~GncBlowersKernel() {}
+
+void GncBlowersKernel::Initialize(void) {
+  GncBlowersAutocode::Initialize();
+  Load();
+}
+
+template <class P, class DW, class B>
+void GncBlowersKernel::LoadModel(int k, const P & p, const DW & dw, const B & b, const ModelAliases & a) {
+  PmcParams & c = pmc_[k];
+  PmcState & s = pmc_state_[k];
+  float noise = p.tun_bpm_noise_on_flag;
+
+  // speed_controller and dc_motor_model
+  c.cmd_scale = a.cmd_scale;
+  c.rate_rising = p.RateLimiter_RisingLim;
+  c.rate_falling = p.RateLimiter_FallingLim;
+  c.speed_filt_num = p.bpm_imp_speed_filt_num;
+  c.speed_filt_den = p.bpm_imp_speed_filt_den;
+  c.imp_kp = p.bpm_imp_ctl_kp;
+  c.imp_ki = p.bpm_imp_ctl_ki;
+  c.imp_kd = p.bpm_imp_ctl_kd;
+  c.imp_filt_n = p.bpm_imp_ctl_filt_n;
+  c.imp_max_voltage = p.bpm_imp_max_voltage;
+  c.imp_min_voltage = p.DiscretePIDController_LowerSatu;
+  c.imp_zero_gain = p.ZeroGain_Gain;
+  c.imp_clamp_value = p.Constant_Value;
+  c.imp_integ_gain = p.Integrator_gainval;
+  c.imp_filt_gain = p.Filter_gainval;
+  c.battery_gain = p.Gain_Gain;
+  c.motor_inv_speed_k = 1.0F / p.bpm_imp_motor_speed_k;
+  c.motor_inv_r = 1.0F / p.bpm_imp_motor_r;
+  c.motor_torque_k = p.bpm_imp_motor_torque_k;
+  c.motor_friction = p.bpm_imp_motor_friction_coeff;
+
+  // blower_body_dynamics
+  float axis[3], norm = 0.0F;
+  for (int i = 0; i < 3; i++) {
+    axis[i] = noise * a.impeller_orientation_error[i] + a.impeller_orientation[i];
+    norm += axis[i] * axis[i];
+  }
+  norm = static_cast<float>(sqrt(static_cast<double>(norm)));
+  for (int i = 0; i < 3; i++)
+    c.impeller_axis[i] = (static_cast<double>(norm) > 1.0e-7) ? axis[i] / norm : axis[i];
+  c.impeller_inertia = noise * p.bpm_impeller_inertia_error + p.bpm_impeller_inertia;
+  c.speed_gain = p.Gain1_Gain;
+  if (noise > a.accel_threshold)
+    c.accel_gain = 1.0F / p.bpm_impeller_inertia;
+  else
+    c.accel_gain = 1.0F / (p.bpm_impeller_inertia + p.bpm_impeller_inertia_error);
+  c.speed_integ_gain = p.DiscreteTimeIntegrator_gainval;
+  c.skew_const = static_cast<float>(p.Constant3_Value);
+  c.skew_gain[0] = p.Gain_Gain_h;
+  c.skew_gain[1] = a.skew_gain1;
+  c.skew_gain[2] = p.Gain2_Gain;
+  c.noise_on = noise;
+  for (int i = 0; i < 3; i++)
+    c.cg_error[i] = p.abp_P_CG_B_B_error[i];
+
+  // blower_aerodynamics
+  c.zero_thrust_area = noise * a.zero_thrust_area_error + a.zero_thrust_area;
+  c.aero_torque = p.blower_aerodynamics.Constant7_Value;
+  c.impeller_diameter = p.abp_impeller_diameter;
+  c.air_density = p.const_air_density;
+  c.cdp_lookup = p.bpm_lookup_Cdp_data;
+  c.area_lookup = p.bpm_lookup_totalarea_breakpoints;
+  c.aero_integ_gain = p.blower_aerodynamics.DiscreteTimeIntegrator_gainval;
+  c.aero_noise_mean = p.blower_aerodynamics.random_noise_Mean;
+
+  // speed sensor
+  c.sensor_noise_scale = 1.0 / sqrt(p.astrobee_time_step_size);
+  c.sensor_sf = p.bpm_sensor_sf;
+  c.sensor_resolution = p.bpm_sensor_resolution;
+  c.sensor_min = p.bpm_sensor_min;
+  c.sensor_max = p.bpm_sensor_max;
+  c.sensor_integ_gain = p.DiscreteTimeIntegrator1_gainval;
+  c.sensor_noise_stddev[0] = p.random_noise1_StdDev;
+  c.sensor_noise_mean[0] = p.random_noise1_Mean;
+  c.sensor_noise_stddev[1] = p.random_noise_StdDev;
+  c.sensor_noise_mean[1] = p.random_noise_Mean;
+
+  // latch_nozzle_thrust_matricies, the nozzle directions only depend on parameters
+  const float* q = (noise > p.Switch_Threshold) ? a.nozzle_misalignment : p.Constant2_Value;
+  const float* o = a.nozzle_orientations;
+  for (int n = 0; n < kNozzles; n++) {
+    float w = q[18 + n];
+    float d = w * w * p.CoreSubsys.Gain_Gain - static_cast<float>(p.CoreSubsys.Constant1_Value);
+    float m[9], skew[9], outer[9], rot[9];
+    for (int i = 0; i < 9; i++)
+      m[i] = static_cast<float>(p.CoreSubsys.Constant2_Value[i]);
+    m[0] = m[4] = m[8] = d;
+    float g = w * p.CoreSubsys.Gain1_Gain;
+    float z = static_cast<float>(p.CoreSubsys.Constant3_Value);
+    skew[0] = z;
+    skew[1] = q[12 + n];
+    skew[2] = q[6 + n] * a.rot_gain_a;
+    skew[3] = q[12 + n] * a.rot_gain1_m;
+    skew[4] = z;
+    skew[5] = q[n];
+    skew[6] = q[6 + n];
+    skew[7] = p.CoreSubsys.Gain2_Gain * q[n];
+    skew[8] = z;
+    for (int i = 0; i < 3; i++) {
+      outer[i] = q[6 * i + n] * q[n];
+      outer[i + 3] = q[6 * i + n] * q[6 + n];
+      outer[i + 6] = q[6 * i + n] * q[12 + n];
+    }
+    for (int i = 0; i < 9; i++)
+      rot[i] = (m[i] - skew[i] * g) + outer[i] * a.rot_gain2_i;
+    for (int i = 0; i < 3; i++) {
+      c.nozzle_direction[i][n] = rot[i + 6] * o[n + 12] + (rot[i + 3] * o[n + 6] + rot[i] * o[n]);
+      c.nozzle_position[i][n] = noise * a.nozzle_position_error[6 * i + n] + a.nozzle_position[6 * i + n];
+    }
+  }
+
+  // servo_model, calc_nozzle_area and the per nozzle part of blower_aerodynamics
+  for (int n = 0; n < kNozzles; n++) {
+    int l = k * kNozzles + n;
+    servo_bias_[l] = p.bpm_servo_pwm2angle_bias;
+    servo_pwm2angle_[l] = p.bpm_servo_pwm2angle;
+    servo_kp_[l] = p.bpm_servo_ctl_kp;
+    servo_ki_[l] = p.bpm_servo_ctl_ki;
+    servo_kd_[l] = p.bpm_servo_ctl_kd;
+    servo_filt_n_[l] = p.bpm_servo_ctl_filt_n;
+    servo_max_voltage_[l] = p.bpm_servo_max_voltage;
+    servo_min_voltage_[l] = a.servo_min_voltage;
+    servo_zero_gain_[l] = a.servo_zero_gain;
+    servo_clamp_value_[l] = a.servo_clamp_value;
+    servo_integ_gain_[l] = a.servo_integ_gain;
+    servo_filt_gain_[l] = a.servo_filt_gain;
+    servo_half_backlash_[l] = p.bpm_servo_motor_backlash_deadband / 2.0F;
+    servo_gear_ratio_[l] = p.bpm_servo_motor_gear_ratio;
+    servo_inv_r_[l] = 1.0F / p.bpm_servo_motor_r;
+    servo_motor_k_[l] = p.bpm_servo_motor_k;
+    servo_friction_[l] = p.bpm_servo_motor_friction_coeff;
+    servo_inv_inertia_[l] = 1.0F / p.bpm_servo_motor_gear_box_inertia;
+    servo_shaft_integ_gain_[l] = p.DiscreteTimeIntegrator4_gainval;
+    servo_shaft_max_[l] = p.bpm_servo_max_theta / p.bpm_servo_motor_gear_ratio;
+    servo_shaft_min_[l] = static_cast<float>(p.bpm_servo_min_theta) / p.bpm_servo_motor_gear_ratio;
+    servo_speed_integ_gain_[l] = p.DiscreteTimeIntegrator3_gainval;
+    nozzle_inv_gear_ratio_[l] = 1.0F / p.abp_nozzle_gear_ratio;
+    nozzle_min_open_angle_[l] = p.abp_nozzle_min_open_angle;
+    nozzle_intake_height_[l] = p.abp_nozzle_intake_height;
+    nozzle_flap_length_[l] = p.abp_nozzle_flap_length;
+    nozzle_width_[l] = a.nozzle_widths[n];
+    nozzle_flap_count_[l] = p.abp_nozzle_flap_count;
+    nozzle_cd_[l] = noise * a.discharge_coeff_error[n] + a.discharge_coeff[n];
+    nozzle_thrust_gain_[l] = p.blower_aerodynamics.Constant4_Value;
+    nozzle_noise_feedback_[l] = a.noise_feedback[n];
+    nozzle_noise_stddev_[l] = p.blower_aerodynamics.random_noise_StdDev[n];
+
+    servo_shaft_[l] = dw.DiscreteTimeIntegrator4_DSTATE[n];
+    servo_speed_[l] = dw.DiscreteTimeIntegrator3_DSTATE[n];
+    servo_backlash_[l] = dw.PrevY[n];
+    servo_integ_[l] = dw.Integrator_DSTATE[n];
+    servo_filt_[l] = dw.Filter_DSTATE[n];
+    nozzle_noise_[l] = dw.blower_aerodynamics.DiscreteTimeIntegrator_DSTATE[n];
+    nozzle_noise_next_[l] = dw.blower_aerodynamics.NextOutput[n];
+    nozzle_seed_[l] = dw.blower_aerodynamics.RandSeed[n];
+  }
+
+  // per PMC states
+  s.prev_speed_cmd = a.prev_speed_cmd;
+  s.imp_integ = a.imp_integ;
+  s.imp_filt = a.imp_filt;
+  s.speed = dw.DiscreteTimeIntegrator_DSTATE;
+  s.sensor_delay = dw.Delay2_DSTATE;
+  s.sensor_integ = dw.DiscreteTimeIntegrator1_DSTATE;
+  for (int i = 0; i < 3; i++)
+    s.prev_cm[i] = dw.DelayInput1_DSTATE[i];
+  s.latch = dw.UnitDelay_DSTATE;
+  s.sensor_noise[0] = dw.NextOutput;
+  s.sensor_seed[0] = dw.RandSeed;
+  s.sensor_noise[1] = a.sensor_noise;
+  s.sensor_seed[1] = a.sensor_seed;
+  for (int n = 0; n < kNozzles; n++) {
+    for (int i = 0; i < 3; i++) {
+      s.thrust2force[i][n] = b.OutportBufferForthrust2force_B[3 * n + i];
+      s.thrust2torque[i][n] = b.OutportBufferForthrust2torque_B[3 * n + i];
+    }
+  }
+}
+
+void GncBlowersKernel::Load(void) {
+  const P_bpm_blower_1_propulsion_mod_T & p1 =
+    *reinterpret_cast<const P_bpm_blower_1_propulsion_mod_T*>(blower1_->defaultParam);
+  const DW_bpm_blower_1_propulsion_mo_T & dw1 =
+    *reinterpret_cast<const DW_bpm_blower_1_propulsion_mo_T*>(blower1_->dwork);
+  const B_bpm_blower_1_propulsion_mod_T & b1 =
+    *reinterpret_cast<const B_bpm_blower_1_propulsion_mod_T*>(blower1_->blockIO);
+  ModelAliases a1;
+  a1.cmd_scale = p1.bpm_blower_1_propulsion_module_;
+  a1.servo_min_voltage = p1.DiscretePIDController_LowerSa_b;
+  a1.servo_zero_gain = p1.ZeroGain_Gain_e;
+  a1.servo_clamp_value = p1.Constant_Value_n;
+  a1.servo_integ_gain = p1.Integrator_gainval_f;
+  a1.servo_filt_gain = p1.Filter_gainval_n;
+  a1.skew_gain1 = p1.Gain1_Gain_f;
+  a1.accel_threshold = p1.Switch_Threshold_j;
+  a1.rot_gain_a = p1.CoreSubsys.Gain_Gain_a;
+  a1.rot_gain1_m = p1.CoreSubsys.Gain1_Gain_m;
+  a1.rot_gain2_i = p1.CoreSubsys.Gain2_Gain_i;
+  a1.nozzle_position = p1.abp_PM1_P_nozzle_B_B;
+  a1.nozzle_position_error = p1.bpm_PM1_P_nozzle_B_B_error;
+  a1.nozzle_orientations = p1.abp_PM1_nozzle_orientations;
+  a1.nozzle_misalignment = p1.bpm_PM1_Q_nozzle2misaligned;
+  a1.nozzle_widths = p1.abp_PM1_nozzle_widths;
+  a1.discharge_coeff = p1.abp_PM1_discharge_coeff;
+  a1.discharge_coeff_error = p1.bpm_PM1_nozzle_discharge_coeff_error;
+  a1.impeller_orientation = p1.abp_pm1_impeller_orientation;
+  a1.impeller_orientation_error = p1.bmp_PM1_impeller_orientation_error;
+  a1.zero_thrust_area = p1.abp_pm1_zero_thrust_area;
+  a1.zero_thrust_area_error = p1.bpm_PM1_zero_thrust_area_error;
+  a1.noise_feedback = p1.bpm_PM1_nozzle_noise_feedback_gain;
+  a1.prev_speed_cmd = dw1.PrevY_l;
+  a1.imp_integ = dw1.Integrator_DSTATE_k;
+  a1.imp_filt = dw1.Filter_DSTATE_o;
+  a1.sensor_noise = dw1.NextOutput_e;
+  a1.sensor_seed = dw1.RandSeed_j;
+  LoadModel(0, p1, dw1, b1, a1);
+
+  const P_bpm_blower_2_propulsion_mod_T & p2 =
+    *reinterpret_cast<const P_bpm_blower_2_propulsion_mod_T*>(blower2_->defaultParam);
+  const DW_bpm_blower_2_propulsion_mo_T & dw2 =
+    *reinterpret_cast<const DW_bpm_blower_2_propulsion_mo_T*>(blower2_->dwork);
+  const B_bpm_blower_2_propulsion_mod_T & b2 =
+    *reinterpret_cast<const B_bpm_blower_2_propulsion_mod_T*>(blower2_->blockIO);
+  ModelAliases a2;
+  a2.cmd_scale = p2.bpm_blower_2_propulsion_module_;
+  a2.servo_min_voltage = p2.DiscretePIDController_LowerSa_d;
+  a2.servo_zero_gain = p2.ZeroGain_Gain_b;
+  a2.servo_clamp_value = p2.Constant_Value_e;
+  a2.servo_integ_gain = p2.Integrator_gainval_i;
+  a2.servo_filt_gain = p2.Filter_gainval_d;
+  a2.skew_gain1 = p2.Gain1_Gain_e;
+  a2.accel_threshold = p2.Switch_Threshold_f;
+  a2.rot_gain_a = p2.CoreSubsys.Gain_Gain_b;
+  a2.rot_gain1_m = p2.CoreSubsys.Gain1_Gain_a;
+  a2.rot_gain2_i = p2.CoreSubsys.Gain2_Gain_b;
+  a2.nozzle_position = p2.abp_PM2_P_nozzle_B_B;
+  a2.nozzle_position_error = p2.bpm_PM2_P_nozzle_B_B_error;
+  a2.nozzle_orientations = p2.abp_PM2_nozzle_orientations;
+  a2.nozzle_misalignment = p2.bpm_PM2_Q_nozzle2misaligned;
+  a2.nozzle_widths = p2.abp_PM2_nozzle_widths;
+  a2.discharge_coeff = p2.abp_PM2_discharge_coeff;
+  a2.discharge_coeff_error = p2.bpm_PM2_nozzle_discharge_coeff_error;
+  a2.impeller_orientation = p2.abp_pm2_impeller_orientation;
+  a2.impeller_orientation_error = p2.bmp_PM2_impeller_orientation_error;
+  a2.zero_thrust_area = p2.abp_pm2_zero_thrust_area;
+  a2.zero_thrust_area_error = p2.bpm_PM2_zero_thrust_area_error;
+  a2.noise_feedback = p2.bpm_PM2_nozzle_noise_feedback_gain;
+  a2.prev_speed_cmd = dw2.PrevY_c;
+  a2.imp_integ = dw2.Integrator_DSTATE_c;
+  a2.imp_filt = dw2.Filter_DSTATE_m;
+  a2.sensor_noise = dw2.NextOutput_p;
+  a2.sensor_seed = dw2.RandSeed_o;
+  LoadModel(1, p2, dw2, b2, a2);
+}
+
+void GncBlowersKernel::LatchThrustMatrices(int k, const float center_of_mass[3]) {
+  const PmcParams & c = pmc_[k];
+  PmcState & s = pmc_state_[k];
+  float arm[3][kNozzles];
+  for (int i = 0; i < 3; i++) {
+    float cg = static_cast<float>(static_cast<double>(c.noise_on) * c.cg_error[i] +
+                                  static_cast<double>(center_of_mass[i]));
+    for (int n = 0; n < kNozzles; n++)
+      arm[i][n] = c.nozzle_position[i][n] - cg;
+  }
+  const float (*r)[kNozzles] = c.nozzle_direction;
+  for (int n = 0; n < kNozzles; n++) {
+    s.thrust2torque[0][n] = -(arm[1][n] * r[2][n] - arm[2][n] * r[1][n]);
+    s.thrust2torque[1][n] = -(arm[2][n] * r[0][n] - r[2][n] * arm[0][n]);
+    s.thrust2torque[2][n] = -(r[1][n] * arm[0][n] - arm[1][n] * r[0][n]);
+    for (int i = 0; i < 3; i++)
+      s.thrust2force[i][n] = -r[i][n];
+  }
+}
+
+void GncBlowersKernel::Step(void) {
+  float torque_net[kPmcs], thrust_coeff[kPmcs];
+
+  // speed_controller and dc_motor_model, one per PMC
+  for (int k = 0; k < kPmcs; k++) {
+    const PmcParams & c = pmc_[k];
+    PmcState & s = pmc_state_[k];
+    GncBlowerState & io = states_[k];
+    float u = static_cast<float>(io.impeller_cmd) * c.cmd_scale;
+    float du = u - s.prev_speed_cmd;
+    if (du > c.rate_rising)
+      u = s.prev_speed_cmd + c.rate_rising;
+    else if (du < c.rate_falling)
+      u = s.prev_speed_cmd + c.rate_falling;
+    s.prev_speed_cmd = u;
+    float err = u - s.speed * c.speed_filt_num / c.speed_filt_den;
+    float filt = (c.imp_kd * err - s.imp_filt) * c.imp_filt_n;
+    float pid = (c.imp_kp * err + s.imp_integ) + filt;
+    float dz = DeadZone(pid, c.imp_min_voltage, c.imp_max_voltage);
+    bool saturated = (c.imp_zero_gain * pid != dz);
+    float integ = err * c.imp_ki;
+    float voltage = Clamp(pid, c.imp_min_voltage, c.imp_max_voltage);
+    if (voltage > io.battery_voltage) {
+      voltage = io.battery_voltage;
+    } else {
+      float lower = c.battery_gain * io.battery_voltage;
+      if (voltage < lower)
+        voltage = lower;
+    }
+    // anti windup, stop integrating while saturated in the direction of the error
+    if (saturated && Sign(integ) == Sign(dz))
+      integ = c.imp_clamp_value;
+    s.imp_integ += c.imp_integ_gain * integ;
+    s.imp_filt += c.imp_filt_gain * filt;
+    float current = (voltage - c.motor_inv_speed_k * s.speed) * c.motor_inv_r;
+    torque_net[k] = c.motor_torque_k * current - c.motor_friction * s.speed;
+    io.impeller_current = current;
+    for (int n = 0; n < kNozzles; n++)
+      servo_cmd_[k * kNozzles + n] = io.servo_cmd[n];
+  }
+
+  // servo_model and calc_nozzle_area for all twelve nozzles at once
+  for (int l = 0; l < kLanes; l++) {
+    float shaft = servo_shaft_[l];
+    float prev = servo_backlash_[l];
+    float half = servo_half_backlash_[l];
+    float backlash = (shaft < prev - half) ? (shaft + half) : ((shaft <= prev + half) ? prev : (shaft - half));
+    float angle = servo_gear_ratio_[l] * backlash;
+    float err = (servo_cmd_[l] + servo_bias_[l]) * servo_pwm2angle_[l] - angle;
+    float filt = (servo_kd_[l] * err - servo_filt_[l]) * servo_filt_n_[l];
+    float pid = (servo_kp_[l] * err + servo_integ_[l]) + filt;
+    float voltage = Clamp(pid, servo_min_voltage_[l], servo_max_voltage_[l]);
+    float current = (voltage - servo_motor_k_[l] * servo_speed_[l]) * servo_inv_r_[l];
+    float dz = DeadZone(pid, servo_min_voltage_[l], servo_max_voltage_[l]);
+    bool saturated = (servo_zero_gain_[l] * pid != dz);
+    float integ = err * servo_ki_[l];
+    integ = (saturated && Sign(integ) == Sign(dz)) ? servo_clamp_value_[l] : integ;
+    shaft += servo_shaft_integ_gain_[l] * servo_speed_[l];
+    servo_shaft_[l] = (shaft >= servo_shaft_max_[l]) ? servo_shaft_max_[l] :
+                      ((shaft <= servo_shaft_min_[l]) ? servo_shaft_min_[l] : shaft);
+    servo_backlash_[l] = backlash;
+    servo_integ_[l] += servo_integ_gain_[l] * integ;
+    servo_filt_[l] += servo_filt_gain_[l] * filt;
+    servo_speed_[l] += (servo_motor_k_[l] * current - servo_friction_[l] * servo_speed_[l]) *
+                       servo_inv_inertia_[l] * servo_speed_integ_gain_[l];
+    servo_current_[l] = current;
+    float theta = nozzle_inv_gear_ratio_[l] * angle;
+    nozzle_theta_[l] = theta;
+    nozzle_area_[l] = (nozzle_intake_height_[l] - cosf(theta + nozzle_min_open_angle_[l]) * nozzle_flap_length_[l]) *
+                      nozzle_width_[l] * nozzle_flap_count_[l];
+  }
+
+  // blower_aerodynamics, the pressure coefficient depends on the total open area of each PMC
+  for (int k = 0; k < kPmcs; k++) {
+    const PmcParams & c = pmc_[k];
+    const float* cd = nozzle_cd_ + k * kNozzles;
+    const float* area = nozzle_area_ + k * kNozzles;
+    float total = cd[0] * area[0];
+    for (int n = 1; n < kNozzles; n++)
+      total += cd[n] * area[n];
+    total += c.zero_thrust_area;
+    float cdp = look1_iflf_binlxpw(total, c.area_lookup, c.cdp_lookup, 333U);
+    float speed = pmc_state_[k].speed;
+    thrust_coeff[k] = speed * speed * cdp * c.impeller_diameter * c.impeller_diameter * c.air_density;
+  }
+  for (int l = 0; l < kLanes; l++) {
+    nozzle_thrust_[l] = nozzle_thrust_gain_[l] * nozzle_cd_[l] * nozzle_cd_[l] * thrust_coeff[l / kNozzles] *
+                        nozzle_area_[l] + static_cast<float>(nozzle_noise_[l]);
+    nozzle_noise_[l] += (nozzle_noise_next_[l] - nozzle_noise_feedback_[l] * nozzle_noise_[l]) *
+                        pmc_[l / kNozzles].aero_integ_gain;
+  }
+  for (int l = 0; l < kLanes; l++)
+    nozzle_noise_next_[l] = rt_nrand_Upu32_Yd_f_pw_snf(&nozzle_seed_[l]) * nozzle_noise_stddev_[l] +
+                            pmc_[l / kNozzles].aero_noise_mean;
+
+  // blower_body_dynamics and the speed sensor, one per PMC
+  for (int k = 0; k < kPmcs; k++) {
+    const PmcParams & c = pmc_[k];
+    PmcState & s = pmc_state_[k];
+    GncBlowerState & io = states_[k];
+    if (s.latch)
+      LatchThrustMatrices(k, io.center_of_mass);
+
+    // gyroscopic torque from the spinning impeller, plus the reaction torque of the motor
+    float h = c.impeller_inertia * s.speed;
+    float reaction = c.speed_gain * torque_net[k];
+    const float* w = io.omega_B_ECI_B;
+    float skew[9] = {c.skew_const, w[2], c.skew_gain[0] * w[1],
+                     c.skew_gain[1] * w[2], c.skew_const, w[0],
+                     w[1], c.skew_gain[2] * w[0], c.skew_const};
+    const float* thrust = nozzle_thrust_ + k * kNozzles;
+    for (int i = 0; i < 3; i++) {
+      float nozzle_torque = 0.0F, nozzle_force = 0.0F;
+      for (int n = 0; n < kNozzles; n++) {
+        nozzle_torque += s.thrust2torque[i][n] * thrust[n];
+        nozzle_force += s.thrust2force[i][n] * thrust[n];
+      }
+      io.torque_B[i] = ((c.impeller_axis[0] * h * skew[i] + skew[i + 3] * (c.impeller_axis[1] * h)) +
+                        skew[i + 6] * (c.impeller_axis[2] * h)) + c.impeller_axis[i] * reaction + nozzle_torque;
+      io.force_B[i] = nozzle_force;
+    }
+    io.motor_speed = s.speed;
+    for (int n = 0; n < kNozzles; n++) {
+      io.nozzle_theta[n] = nozzle_theta_[k * kNozzles + n];
+      io.servo_current[n] = servo_current_[k * kNozzles + n];
+    }
+
+    float drift = static_cast<float>(c.sensor_noise_scale * s.sensor_noise[0]);
+    float measured = rt_roundf_snf((static_cast<float>(c.sensor_noise_scale * s.sensor_noise[1]) +
+                     c.sensor_sf * s.speed + s.sensor_integ) / c.sensor_resolution) * c.sensor_resolution;
+    io.meas_motor_speed = s.sensor_delay;
+
+    s.speed += c.speed_integ_gain * ((torque_net[k] - c.aero_torque) * c.accel_gain);
+    s.latch = (io.center_of_mass[0] != s.prev_cm[0]) || (io.center_of_mass[1] != s.prev_cm[1]) ||
+              (io.center_of_mass[2] != s.prev_cm[2]);
+    for (int i = 0; i < 2; i++)
+      s.sensor_noise[i] = rt_nrand_Upu32_Yd_f_pw_snf(&s.sensor_seed[i]) * c.sensor_noise_stddev[i] +
+                          c.sensor_noise_mean[i];
+    s.sensor_delay = Clamp(measured, c.sensor_min, c.sensor_max);
+    s.sensor_integ += c.sensor_integ_gain * drift;
+    for (int i = 0; i < 3; i++)
+      s.prev_cm[i] = io.center_of_mass[i];
+  }
+}
+
+}  // namespace gnc_autocode
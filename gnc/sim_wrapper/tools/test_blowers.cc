@@ -0,0 +1,132 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gnc_autocode/blowers.h>
+#include <gnc_autocode/blowers_kernel.h>
+
+#include <math.h>
+#include <stdio.h>
+
+#include <chrono>
+
+// Checks the hand written blower kernel against the autocode. The inputs are
+// either read from a text file with one line per control tick:
+//   impeller_cmd[2] servo_cmd[12] omega_B_ECI_B[3] center_of_mass[3]
+// or, if no file is given, generated to sweep the impeller speeds and nozzles.
+
+#define COMPARE_FLOAT_VECTOR(a, b, len, tol) for (int unused_variable = 0; unused_variable < len; unused_variable++) \
+                    if (fabs(((a)[unused_variable]) - ((b)[unused_variable])) >= \
+                        (tol) * (1.0 + fabs((a)[unused_variable]))) {\
+                    fprintf(stderr, "Comparison failed at line %d vector element %d. (%g, %g)\n", __LINE__, \
+                    unused_variable, ((a)[unused_variable]), ((b)[unused_variable])); return 1;}
+
+int verify_blower_output(const gnc_autocode::GncBlowerState & a, const gnc_autocode::GncBlowerState & b) {
+  float tolerance = 1e-4;
+  COMPARE_FLOAT_VECTOR(&a.impeller_current, &b.impeller_current, 1, tolerance);
+  COMPARE_FLOAT_VECTOR(a.servo_current, b.servo_current, 6, tolerance);
+  COMPARE_FLOAT_VECTOR(a.torque_B, b.torque_B, 3, tolerance);
+  COMPARE_FLOAT_VECTOR(a.force_B, b.force_B, 3, tolerance);
+  COMPARE_FLOAT_VECTOR(&a.motor_speed, &b.motor_speed, 1, tolerance);
+  COMPARE_FLOAT_VECTOR(a.nozzle_theta, b.nozzle_theta, 6, tolerance);
+  COMPARE_FLOAT_VECTOR(&a.meas_motor_speed, &b.meas_motor_speed, 1, tolerance);
+  return 0;
+}
+
+bool read_inputs(FILE* f, gnc_autocode::GncBlowerState states[2]) {
+  unsigned int imp[2];
+  if (fscanf(f, "%u %u", &imp[0], &imp[1]) != 2)
+    return false;
+  for (int i = 0; i < 2; i++) {
+    states[i].impeller_cmd = imp[i];
+    for (int j = 0; j < 6; j++)
+      if (fscanf(f, "%f", &states[i].servo_cmd[j]) != 1)
+        return false;
+  }
+  float omega[3], cm[3];
+  if (fscanf(f, "%f %f %f %f %f %f", &omega[0], &omega[1], &omega[2], &cm[0], &cm[1], &cm[2]) != 6)
+    return false;
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 3; j++) {
+      states[i].omega_B_ECI_B[j] = omega[j];
+      states[i].center_of_mass[j] = cm[j];
+    }
+  }
+  return true;
+}
+
+void generate_inputs(int t, gnc_autocode::GncBlowerState states[2]) {
+  for (int i = 0; i < 2; i++) {
+    states[i].impeller_cmd = (t < 1000) ? 0 : (((t / 2000) % 2) ? 200 : 120);
+    for (int j = 0; j < 6; j++)
+      states[i].servo_cmd[j] = 50.0 + 45.0 * sin(0.001 * t * (j + 1) + i);
+    for (int j = 0; j < 3; j++) {
+      states[i].omega_B_ECI_B[j] = 0.1 * sin(0.002 * t + j);
+      states[i].center_of_mass[j] = (t < 5000) ? 0.0 : 0.01 * (j + 1);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  FILE* f = NULL;
+  if (argc > 1) {
+    f = fopen(argv[1], "r");
+    if (f == NULL) {
+      fprintf(stderr, "Failed to open %s.\n", argv[1]);
+      return 1;
+    }
+  }
+
+  gnc_autocode::GncBlowersAutocode autocode;
+  gnc_autocode::GncBlowersKernel kernel;
+  autocode.SetBatteryVoltage(14.0);
+  kernel.SetBatteryVoltage(14.0);
+
+  double autocode_time = 0.0, kernel_time = 0.0;
+  int t = 0;
+  for (; f != NULL || t < 10000; t++) {
+    if (f != NULL) {
+      if (!read_inputs(f, autocode.states_))
+        break;
+    } else {
+      generate_inputs(t, autocode.states_);
+    }
+    for (int i = 0; i < 2; i++)
+      kernel.states_[i] = autocode.states_[i];
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    autocode.Step();
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    kernel.Step();
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    autocode_time += std::chrono::duration<double>(t1 - t0).count();
+    kernel_time += std::chrono::duration<double>(t2 - t1).count();
+
+    for (int i = 0; i < 2; i++) {
+      if (verify_blower_output(autocode.states_[i], kernel.states_[i])) {
+        fprintf(stderr, "Blower %d failed at step %d.\n", i + 1, t);
+        return 1;
+      }
+    }
+  }
+  if (f != NULL)
+    fclose(f);
+
+  printf("Compared %d steps. Autocode: %.3f us / step, kernel: %.3f us / step.\n", t,
+         1e6 * autocode_time / t, 1e6 * kernel_time / t);
+  return 0;
+}
@@ -142,6 +142,7 @@ void EpsonImuNodelet::ReadParams(void) {
 }
 
 void EpsonImuNodelet::Run(void) {
+  RegisterThread();
   if (!InitGPIO()) {
     ROS_ERROR("Failed to initialize GPIO: %s", std::strerror(errno));
     Exit();
@@ -25,6 +25,7 @@
 #include <opencv2/imgproc/imgproc.hpp>
 #include <ff_msgs/SetBool.h>
 #include <ff_util/ff_nodelet.h>
+#include <ff_util/ff_publisher.h>
 
 #include <thread>
 #include <atomic>
@@ -46,18 +47,18 @@ struct V4LStruct;
 // Nodelet class
 class CameraNodelet : public ff_util::FreeFlyerNodelet {
  public:
-  static constexpr size_t kImageMsgBuffer = 15;  // 17.6 Mb of buffer space. This
-                                                 // number is so large because
-                                                 // this sets the life time for
-                                                 // each image message sent
-                                                 // out. Eventually we'll write
-                                                 // over the pointer we've
-                                                 // handed out. 15 frames means
-                                                 // .. an image will stay valid
-                                                 // for 1.0 seconds.
-                                                 // Localization can process at
-                                                 // 2 Hz, so it only needs an
-                                                 // image for 0.5 seconds.
+  static constexpr size_t kImageMsgBuffer = 15;  // 17.6 Mb of buffer space. The
+                                                 // images are published by
+                                                 // pointer, so subscribers in
+                                                 // the same process share them.
+                                                 // A buffer still held by a
+                                                 // subscriber when its turn
+                                                 // comes again is replaced
+                                                 // rather than written over.
+                                                 // 15 frames (1.0 seconds) is
+                                                 // enough for localization,
+                                                 // which processes at 2 Hz, to
+                                                 // never cause an allocation.
   static constexpr size_t kImageWidth = 1280;
   static constexpr size_t kImageHeight = 960;
 
@@ -70,13 +71,14 @@ class CameraNodelet : public ff_util::FreeFlyerNodelet {
 
  private:
   void PublishLoop();
+  sensor_msgs::ImagePtr AllocateImage();
   bool EnableService(ff_msgs::SetBool::Request& req, ff_msgs::SetBool::Response& res);  // NOLINT
 
   sensor_msgs::ImagePtr img_msg_buffer_[kImageMsgBuffer];
   size_t img_msg_buffer_idx_;
   std::thread thread_;
   std::atomic<bool> thread_running_;
-  ros::Publisher pub_;
+  ff_util::FreeFlyerPublisher<sensor_msgs::Image> pub_;
   std::shared_ptr<V4LStruct> v4l_;
 
   config_reader::ConfigReader config_;
@@ -195,23 +195,27 @@ namespace is_camera {
     config_timer_ = GetPrivateHandle()->createTimer(ros::Duration(1), [this](ros::TimerEvent e) {
       config_.CheckFilesUpdated(std::bind(&CameraNodelet::ReadParams, this));}, false, true);
 
-    pub_ = nh->advertise<sensor_msgs::Image>(camera_topic_, 1);
+    pub_.Create(nh, camera_topic_, 1);
 
     // Allocate space for our output msg buffer
-    for (size_t i = 0; i < kImageMsgBuffer; i++) {
-      img_msg_buffer_[i].reset(new sensor_msgs::Image());
-      img_msg_buffer_[i]->width  = kImageWidth;
-      img_msg_buffer_[i]->height = kImageHeight;
-      img_msg_buffer_[i]->encoding = "mono8";
-      img_msg_buffer_[i]->step   = kImageWidth;
-      img_msg_buffer_[i]->data.resize(kImageWidth * kImageHeight);
-    }
+    for (size_t i = 0; i < kImageMsgBuffer; i++)
+      img_msg_buffer_[i] = AllocateImage();
 
     v4l_.reset(new V4LStruct(camera_device_, camera_gain_, camera_exposure_));
     thread_running_ = true;
     thread_ = std::thread(&CameraNodelet::PublishLoop, this);
   }
 
+  sensor_msgs::ImagePtr CameraNodelet::AllocateImage() {
+    sensor_msgs::ImagePtr img = pub_.Allocate();
+    img->width  = kImageWidth;
+    img->height = kImageHeight;
+    img->encoding = "mono8";
+    img->step   = kImageWidth;
+    img->data.resize(kImageWidth * kImageHeight);
+    return img;
+  }
+
   void CameraNodelet::ReadParams(void) {
     if (!config_.ReadFiles()) {
       ROS_ERROR("Failed to read config files.");
@@ -257,13 +261,14 @@ namespace is_camera {
   }
 
   void CameraNodelet::PublishLoop() {
+    RegisterThread();
     bool camera_running = true;
     int cur_buf = 0;
 
     while (thread_running_) {
       cur_buf = (cur_buf + 1) % v4l_->req.count;
       if (!camera_running) {
-        while ((pub_.getNumSubscribers() == 0) && thread_running_)
+        while ((pub_.GetNumSubscribers() == 0) && thread_running_)
           usleep(100000);
         if (!thread_running_)
           break;
@@ -295,7 +300,7 @@ namespace is_camera {
       v4l_->buf.memory = V4L2_MEMORY_MMAP;
       v4l_->buf.index = cur_buf;
       xioctl(v4l_->fd, VIDIOC_DQBUF, &v4l_->buf);
-      if (pub_.getNumSubscribers() != 0)
+      if (pub_.GetNumSubscribers() != 0)
         xioctl(v4l_->fd, VIDIOC_QBUF, &v4l_->buf);
       else
         camera_running = false;
@@ -304,6 +309,10 @@ namespace is_camera {
       // Select our output msg buffer
       img_msg_buffer_idx_ = (img_msg_buffer_idx_ + 1) % kImageMsgBuffer;
 
+      // Never write over an image that a subscriber still holds
+      if (!img_msg_buffer_[img_msg_buffer_idx_].unique())
+        img_msg_buffer_[img_msg_buffer_idx_] = AllocateImage();
+
       // Wrap the buffer with cv::Mat so we can manipulate it.
       cv::Mat wrapped(v4l_->fmt.fmt.pix.height,
           v4l_->fmt.fmt.pix.width,
@@ -321,7 +330,7 @@ namespace is_camera {
       img_msg_buffer_[img_msg_buffer_idx_]->header = std_msgs::Header();
       img_msg_buffer_[img_msg_buffer_idx_]->header.stamp = timestamp;
 
-      pub_.publish(img_msg_buffer_[img_msg_buffer_idx_]);
+      pub_.Publish(img_msg_buffer_[img_msg_buffer_idx_]);
 
       ros::spinOnce();
     }
@@ -24,6 +24,7 @@
 // Shared libraries
 #include <ff_util/ff_names.h>
 #include <ff_util/ff_nodelet.h>
+#include <ff_util/ff_publisher.h>
 #include <config_reader/config_reader.h>
 
 // Royale SDK interface
@@ -211,7 +212,6 @@ class PicoDriverL1 : public PicoDriver, public royale::IDepthDataListener, publi
     cloud_.is_dense = true;
     cloud_.point_step = sizeof(struct royale::DepthPoint);
     cloud_.row_step = cloud_.width * cloud_.point_step;
-    cloud_.data.resize(cloud_.row_step * cloud_.height);
     // X, Y and Z
     sensor_msgs::PointField field;
     field.name = "x";
@@ -233,7 +233,7 @@ class PicoDriverL1 : public PicoDriver, public royale::IDepthDataListener, publi
     std::string topic_name_c = (std::string) TOPIC_HARDWARE_PICOFLEXX_PREFIX
                              + (std::string) topic
                              + (std::string) TOPIC_HARDWARE_PICOFLEXX_SUFFIX;
-    pub_cloud_ = nh->advertise<sensor_msgs::PointCloud2>(topic_name_c, 1,
+    pub_cloud_.Create(nh, topic_name_c, 1, false,
       boost::bind(&PicoDriverL1::ToggleCamera, this),
       boost::bind(&PicoDriverL1::ToggleCamera, this));
     // Register the data listener
@@ -247,11 +247,10 @@ class PicoDriverL1 : public PicoDriver, public royale::IDepthDataListener, publi
     depth_image_.is_bigendian = false;
     depth_image_.encoding = sensor_msgs::image_encodings::MONO16;
     depth_image_.step = depth_image_.width * sizeof(uint16_t);
-    depth_image_.data.resize(depth_image_.height * depth_image_.step);
     std::string topic_name_d = (std::string) TOPIC_HARDWARE_PICOFLEXX_PREFIX
                              + (std::string) topic
                              + (std::string) TOPIC_HARDWARE_PICOFLEXX_SUFFIX_DEPTH_IMAGE;
-    pub_depth_image_ = nh->advertise<sensor_msgs::Image>(topic_name_d, 1,
+    pub_depth_image_.Create(nh, topic_name_d, 1, false,
       boost::bind(&PicoDriverL1::ToggleCamera, this),
       boost::bind(&PicoDriverL1::ToggleCamera, this));
     // Register the depth image listener
@@ -268,9 +267,9 @@ class PicoDriverL1 : public PicoDriver, public royale::IDepthDataListener, publi
   // Turn camera on or off based on topic subscription
   void ToggleCamera() {
     if (!Ready()) return;
-    if (pub_cloud_.getNumSubscribers() > 0 || pub_depth_image_.getNumSubscribers() > 0)
+    if (pub_cloud_.GetNumSubscribers() > 0 || pub_depth_image_.GetNumSubscribers() > 0)
       Power(true);
-    else if (pub_cloud_.getNumSubscribers() == 0 && pub_depth_image_.getNumSubscribers() == 0)
+    else if (pub_cloud_.GetNumSubscribers() == 0 && pub_depth_image_.GetNumSubscribers() == 0)
       Power(false);
   }
 
@@ -286,13 +285,13 @@ class PicoDriverL1 : public PicoDriver, public royale::IDepthDataListener, publi
       return;
     }
     // If we have depth data, use the same mechanism as L1 to push it
-    if (pub_cloud_.getNumSubscribers() > 0) {
-      cloud_.header.stamp = ros::Time::now();
-      std::copy(
+    if (pub_cloud_.GetNumSubscribers() > 0) {
+      sensor_msgs::PointCloud2Ptr cloud = pub_cloud_.Allocate(cloud_);
+      cloud->header.stamp = ros::Time::now();
+      cloud->data.assign(
         reinterpret_cast<const uint8_t*>(data->points.data()),
-        reinterpret_cast<const uint8_t*>(data->points.data()) + cloud_.row_step * cloud_.height,
-        cloud_.data.begin());
-      pub_cloud_.publish(cloud_);
+        reinterpret_cast<const uint8_t*>(data->points.data()) + cloud_.row_step * cloud_.height);
+      pub_cloud_.Publish(cloud);
     }
   }
 
@@ -308,22 +307,22 @@ class PicoDriverL1 : public PicoDriver, public royale::IDepthDataListener, publi
       return;
     }
     // If we have depth data, use the same mechanism as L1 to push it
-    if (pub_depth_image_.getNumSubscribers() > 0) {
-      depth_image_.header.stamp = ros::Time::now();
-      std::copy(
+    if (pub_depth_image_.GetNumSubscribers() > 0) {
+      sensor_msgs::ImagePtr depth_image = pub_depth_image_.Allocate(depth_image_);
+      depth_image->header.stamp = ros::Time::now();
+      depth_image->data.assign(
         reinterpret_cast<const uint8_t*>(data->data.data()),
-        reinterpret_cast<const uint8_t*>(data->data.data()) + depth_image_.height * depth_image_.step,
-        depth_image_.data.begin());
-      pub_depth_image_.publish(depth_image_);
+        reinterpret_cast<const uint8_t*>(data->data.data()) + depth_image_.height * depth_image_.step);
+      pub_depth_image_.Publish(depth_image);
     }
   }
 
  private:
-  sensor_msgs::PointCloud2 cloud_;                        // The point cloud
+  sensor_msgs::PointCloud2 cloud_;                        // The point cloud fields, without data
   ff_msgs::PicoflexxIntermediateData extended_;           // The extended data
-  sensor_msgs::Image depth_image_;                        // The depth image
-  ros::Publisher pub_cloud_;                              // The point cloud publisher
-  ros::Publisher pub_depth_image_;                        // The depth image publisher
+  sensor_msgs::Image depth_image_;                        // The depth image format, without data
+  ff_util::FreeFlyerPublisher<sensor_msgs::PointCloud2> pub_cloud_;    // The point cloud publisher
+  ff_util::FreeFlyerPublisher<sensor_msgs::Image> pub_depth_image_;     // The depth image publisher
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -347,7 +346,7 @@ class PicoDriverL2 : public PicoDriver, public royale::IExtendedDataListener {
     std::string topic_name_e = (std::string) TOPIC_HARDWARE_PICOFLEXX_PREFIX
                              + (std::string) topic
                              + (std::string) TOPIC_HARDWARE_PICOFLEXX_SUFFIX_EXTENDED;
-    pub_extended_ = nh->advertise<ff_msgs::PicoflexxIntermediateData>(topic_name_e, 1,
+    pub_extended_.Create(nh, topic_name_e, 1, false,
       boost::bind(&PicoDriverL2::ToggleCamera, this),
       boost::bind(&PicoDriverL2::ToggleCamera, this));
     // Change the point cloud based on the frame id and sensor size
@@ -359,7 +358,6 @@ class PicoDriverL2 : public PicoDriver, public royale::IExtendedDataListener {
     cloud_.is_dense = true;
     cloud_.point_step = sizeof(struct royale::DepthPoint);
     cloud_.row_step = cloud_.width * cloud_.point_step;
-    cloud_.data.resize(cloud_.row_step * cloud_.height);
     // X, Y and Z
     sensor_msgs::PointField field;
     field.name = "x";
@@ -381,7 +379,7 @@ class PicoDriverL2 : public PicoDriver, public royale::IExtendedDataListener {
     std::string topic_name_c = (std::string) TOPIC_HARDWARE_PICOFLEXX_PREFIX
                              + (std::string) topic
                              + (std::string) TOPIC_HARDWARE_PICOFLEXX_SUFFIX;
-    pub_cloud_ = nh->advertise<sensor_msgs::PointCloud2>(topic_name_c, 1,
+    pub_cloud_.Create(nh, topic_name_c, 1, false,
       boost::bind(&PicoDriverL2::ToggleCamera, this),
       boost::bind(&PicoDriverL2::ToggleCamera, this));
     // Register the data listener
@@ -398,9 +396,9 @@ class PicoDriverL2 : public PicoDriver, public royale::IExtendedDataListener {
   // Turn camera on or off based on topic subscription
   void ToggleCamera() {
     if (!Ready()) return;
-    if ((pub_extended_.getNumSubscribers() > 0 || pub_cloud_.getNumSubscribers() > 0))
+    if ((pub_extended_.GetNumSubscribers() > 0 || pub_cloud_.GetNumSubscribers() > 0))
       Power(true);
-    else if (pub_extended_.getNumSubscribers() == 0 && pub_cloud_.getNumSubscribers() == 0)
+    else if (pub_extended_.GetNumSubscribers() == 0 && pub_cloud_.GetNumSubscribers() == 0)
       Power(false);
   }
 
@@ -412,49 +410,50 @@ class PicoDriverL2 : public PicoDriver, public royale::IExtendedDataListener {
       return;
     }
     // If we have depth data, use the same mechanism as L1 to push it
-    if (data->hasDepthData() && pub_cloud_.getNumSubscribers() > 0
+    if (data->hasDepthData() && pub_cloud_.GetNumSubscribers() > 0
       && data->getDepthData() != nullptr) {
-      cloud_.header.stamp = ros::Time::now();
-       std::copy(
-          reinterpret_cast<const uint8_t*>(data->getDepthData()->points.data()),
-          reinterpret_cast<const uint8_t*>(data->getDepthData()->points.data()) + cloud_.row_step * cloud_.height,
-          cloud_.data.begin());
-      pub_cloud_.publish(cloud_);
+      sensor_msgs::PointCloud2Ptr cloud = pub_cloud_.Allocate(cloud_);
+      cloud->header.stamp = ros::Time::now();
+      cloud->data.assign(
+        reinterpret_cast<const uint8_t*>(data->getDepthData()->points.data()),
+        reinterpret_cast<const uint8_t*>(data->getDepthData()->points.data()) + cloud_.row_step * cloud_.height);
+      pub_cloud_.Publish(cloud);
     }
     // If we have a listener and the extended data contains intermediate data, publish it
-    if (data->hasIntermediateData() && pub_extended_.getNumSubscribers() > 0
+    if (data->hasIntermediateData() && pub_extended_.GetNumSubscribers() > 0
         && data->getIntermediateData() != nullptr) {
-      extended_.header.stamp = ros::Time::now();
+      ff_msgs::PicoflexxIntermediateDataPtr extended = pub_extended_.Allocate(extended_);
+      extended->header.stamp = ros::Time::now();
       // Populate the modulation frequencies and exposures used to produce this data
-      extended_.frequency.resize(data->getIntermediateData()->modulationFrequencies.size());
+      extended->frequency.resize(data->getIntermediateData()->modulationFrequencies.size());
       for (size_t i = 0; i < data->getIntermediateData()->modulationFrequencies.size(); i++)
-        extended_.frequency[i] = data->getIntermediateData()->modulationFrequencies[i];
-      extended_.exposure.resize(data->getIntermediateData()->exposureTimes.size());
+        extended->frequency[i] = data->getIntermediateData()->modulationFrequencies[i];
+      extended->exposure.resize(data->getIntermediateData()->exposureTimes.size());
       for (size_t i = 0; i < data->getIntermediateData()->exposureTimes.size(); i++)
-        extended_.exposure[i] = data->getIntermediateData()->exposureTimes[i];
+        extended->exposure[i] = data->getIntermediateData()->exposureTimes[i];
       // Copy the data itself
-      extended_.raw.width = this->GetWidth();
-      extended_.raw.height = this->GetHeight();
-      extended_.raw.step = extended_.raw.width
+      extended->raw.width = this->GetWidth();
+      extended->raw.height = this->GetHeight();
+      extended->raw.step = extended->raw.width
         * sizeof(struct royale::IntermediatePoint);
-      extended_.raw.encoding = sensor_msgs::image_encodings::TYPE_32FC4;
-      extended_.raw.is_bigendian = false;
-      extended_.raw.data.resize(extended_.raw.step * extended_.raw.height);
+      extended->raw.encoding = sensor_msgs::image_encodings::TYPE_32FC4;
+      extended->raw.is_bigendian = false;
+      extended->raw.data.resize(extended->raw.step * extended->raw.height);
       std::copy(
         reinterpret_cast<const uint8_t*>(data->getIntermediateData()->points.data()),
         reinterpret_cast<const uint8_t*>(data->getIntermediateData()->points.data())
-          + extended_.raw.step * extended_.raw.height,
-        extended_.raw.data.begin());
+          + extended->raw.step * extended->raw.height,
+        extended->raw.data.begin());
       // Publish the extended data
-      pub_extended_.publish(extended_);
+      pub_extended_.Publish(extended);
     }
   }
 
  private:
-  sensor_msgs::PointCloud2 cloud_;                     // The point cloud
+  sensor_msgs::PointCloud2 cloud_;                     // The point cloud fields, without data
   ff_msgs::PicoflexxIntermediateData extended_;        // The extended data
-  ros::Publisher pub_extended_;                        // The cloud publisher
-  ros::Publisher pub_cloud_;                           // The cloud publisher
+  ff_util::FreeFlyerPublisher<ff_msgs::PicoflexxIntermediateData> pub_extended_;  // The extended publisher
+  ff_util::FreeFlyerPublisher<sensor_msgs::PointCloud2> pub_cloud_;                // The cloud publisher
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
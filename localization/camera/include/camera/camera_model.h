@@ -43,6 +43,8 @@ class CameraModel {
   // takes coordinates in relation to camera model, outputs image coordinates
   Eigen::Vector2d ImageCoordinates(const Eigen::Vector3d & p) const;
   Eigen::Vector2d ImageCoordinates(double x, double y, double z) const;
+  // the same for the points in the columns of p
+  void ImageCoordinates(const Eigen::Matrix3Xd & p, Eigen::Matrix2Xd * image) const;
   // outputs 3D coordinates in camera frame
   Eigen::Vector3d CameraCoordinates(const Eigen::Vector3d & p) const;
   Eigen::Vector3d CameraCoordinates(double x, double y, double z) const;
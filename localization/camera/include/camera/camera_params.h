@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 // Forward declare mat type so that we don't have to include OpenCV if we're
 // not going to use it.
@@ -79,6 +80,20 @@ namespace camera {
       throw("Please use the explicitly specified conversions by using the correct enum.");
     }
 
+    // Batch conversion of the points in the columns of input. The output may
+    // be the input. Conversions between the distorted and undistorted frames
+    // are evaluated over whole arrays instead of point by point, the others
+    // fall back to the single point conversion.
+    template <int SRC, int DEST>
+    void Convert(Eigen::Matrix2Xd const& input, Eigen::Matrix2Xd *output) const {
+      output->resize(2, input.cols());
+      Eigen::Vector2d point;
+      for (int i = 0; i < input.cols(); i++) {
+        Convert<SRC, DEST>(Eigen::Vector2d(input.col(i)), &point);
+        output->col(i) = point;
+      }
+    }
+
     // Utility to create intrinsic matrix for the correct coordinate frame
     template <int FRAME>
     Eigen::Matrix3d GetIntrinsicMatrix() const {
@@ -134,9 +149,20 @@ namespace camera {
     // Converts UNDISTORTED_C to DISTORTED_C
     void DistortCentered(Eigen::Vector2d const& undistorted_c,
                          Eigen::Vector2d* distorted_c) const;
+    void DistortCentered(Eigen::Matrix2Xd const& undistorted_c,
+                         Eigen::Matrix2Xd* distorted_c) const;
     // Converts DISTORTED_C to UNDISTORTED_C
     void UndistortCentered(Eigen::Vector2d const& distorted_c,
                            Eigen::Vector2d* undistorted_c) const;
+    void UndistortCentered(Eigen::Matrix2Xd const& distorted_c,
+                           Eigen::Matrix2Xd* undistorted_c) const;
+
+    // The TSAI model has no closed form inverse. For batch undistortion, the
+    // inverse is sampled on a grid over the DISTORTED image once per set of
+    // parameters, interpolated bilinearly and refined with Newton steps.
+    struct UndistortTable;
+    std::shared_ptr<const UndistortTable> GetUndistortTable() const;
+    void ClearUndistortTable();
 
     // Members
     Eigen::Vector2i
@@ -159,6 +185,8 @@ namespace camera {
     // or 5 = TSAI/OpenCV model.
     Eigen::VectorXd distortion_coeffs_;
     double distortion_precalc1_, distortion_precalc2_, distortion_precalc3_;
+    // Built on first use, shared between copies
+    mutable std::shared_ptr<const UndistortTable> undistort_table_;
   };
 
 #define DECLARE_CONVERSION(TYPEA, TYPEB) \
@@ -176,6 +204,17 @@ namespace camera {
   DECLARE_CONVERSION(UNDISTORTED_C, DISTORTED);
 #undef DECLARE_CONVERSION
 
+#define DECLARE_BATCH_CONVERSION(TYPEA, TYPEB) \
+  template <>  \
+  void CameraParameters::Convert<TYPEA, TYPEB>(Eigen::Matrix2Xd const& input, Eigen::Matrix2Xd *output) const
+  DECLARE_BATCH_CONVERSION(UNDISTORTED_C, DISTORTED_C);
+  DECLARE_BATCH_CONVERSION(DISTORTED_C, UNDISTORTED_C);
+  DECLARE_BATCH_CONVERSION(DISTORTED, UNDISTORTED);
+  DECLARE_BATCH_CONVERSION(UNDISTORTED, DISTORTED);
+  DECLARE_BATCH_CONVERSION(DISTORTED, UNDISTORTED_C);
+  DECLARE_BATCH_CONVERSION(UNDISTORTED_C, DISTORTED);
+#undef DECLARE_BATCH_CONVERSION
+
 #define DECLARE_INTRINSIC(TYPE) \
   template <>  \
   Eigen::Matrix3d CameraParameters::GetIntrinsicMatrix<TYPE>() const
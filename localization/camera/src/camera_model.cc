@@ -90,6 +90,13 @@ Eigen::Vector2d CameraModel::ImageCoordinates(const Eigen::Vector3d & p) const {
   return params_.GetFocalVector().cwiseProduct((cam_t_global_ * p).hnormalized());
 }
 
+void CameraModel::ImageCoordinates(const Eigen::Matrix3Xd & p, Eigen::Matrix2Xd * image) const {
+  Eigen::Matrix3Xd camera = (cam_t_global_.linear() * p).colwise() + cam_t_global_.translation();
+  image->resize(2, p.cols());
+  image->row(0) = params_.GetFocalVector()[0] * camera.row(0).cwiseQuotient(camera.row(2));
+  image->row(1) = params_.GetFocalVector()[1] * camera.row(1).cwiseQuotient(camera.row(2));
+}
+
 Eigen::Vector3d CameraModel::Ray(int x, int y) const {
   return cam_t_global_.rotation().inverse() * Eigen::Vector3d(x / params_.GetFocalVector()[0],
       y / params_.GetFocalVector()[1], 1.0).normalized();
@@ -30,6 +30,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 camera::CameraParameters::CameraParameters(Eigen::Vector2i const& image_size,
     Eigen::Vector2d const& focal_length,
@@ -151,6 +152,7 @@ camera::CameraParameters::CameraParameters(config_reader::ConfigReader* config,
 }
 
 void camera::CameraParameters::SetDistortedSize(Eigen::Vector2i const& image_size) {
+  ClearUndistortTable();
   distorted_image_size_ = image_size;
   distorted_half_size_ = image_size.cast<double>() / 2;
 }
@@ -164,6 +166,7 @@ const Eigen::Vector2d& camera::CameraParameters::GetDistortedHalfSize() const {
 }
 
 void camera::CameraParameters::SetUndistortedSize(Eigen::Vector2i const& image_size) {
+  ClearUndistortTable();
   undistorted_image_size_ = image_size;
   undistorted_half_size_ = image_size.cast<double>() / 2;
 }
@@ -185,6 +188,7 @@ const Eigen::Vector2i& camera::CameraParameters::GetCropOffset() const {
 }
 
 void camera::CameraParameters::SetOpticalOffset(Eigen::Vector2d const& offset) {
+  ClearUndistortTable();
   optical_offset_ = offset;
 }
 
@@ -193,6 +197,7 @@ const Eigen::Vector2d& camera::CameraParameters::GetOpticalOffset() const {
 }
 
 void camera::CameraParameters::SetFocalLength(Eigen::Vector2d const& f) {
+  ClearUndistortTable();
   focal_length_ = f;
 }
 
@@ -205,6 +210,7 @@ const Eigen::Vector2d& camera::CameraParameters::GetFocalVector() const {
 }
 
 void camera::CameraParameters::SetDistortion(Eigen::VectorXd const& distortion) {
+  ClearUndistortTable();
   distortion_coeffs_ = distortion;
 
   // Ensure variables are initialized
@@ -331,6 +337,175 @@ void camera::CameraParameters::UndistortCentered(Eigen::Vector2d const& distorte
   }
 }
 
+// Points in the columns of a matrix as coordinate arrays
+typedef Eigen::Array<double, 1, Eigen::Dynamic> PointArray;
+
+void camera::CameraParameters::DistortCentered(Eigen::Matrix2Xd const& undistorted_c,
+                                               Eigen::Matrix2Xd* distorted_c) const {
+  Eigen::Vector2d offset = optical_offset_ - distorted_half_size_;
+  if (distortion_coeffs_.size() == 0) {
+    *distorted_c = undistorted_c.colwise() + offset;
+    return;
+  }
+  PointArray x = undistorted_c.row(0).array() / focal_length_[0];
+  PointArray y = undistorted_c.row(1).array() / focal_length_[1];
+  if (distortion_coeffs_.size() == 1) {
+    // FOV model
+    PointArray ru = (x.square() + y.square()).sqrt();
+    PointArray rd = (ru * distortion_precalc2_).atan() * distortion_precalc1_;
+    PointArray conv = (ru > 1e-5).select(rd / ru, 1.0);
+    x *= conv;
+    y *= conv;
+  } else if (distortion_coeffs_.size() == 4 ||
+             distortion_coeffs_.size() == 5) {
+    // Tsai model
+    double k1 = distortion_coeffs_[0];
+    double k2 = distortion_coeffs_[1];
+    double p1 = distortion_coeffs_[2];
+    double p2 = distortion_coeffs_[3];
+    double k3 = 0;
+    if (distortion_coeffs_.size() == 5)
+      k3 = distortion_coeffs_[4];
+    PointArray r2 = x.square() + y.square();
+    PointArray radial = 1 + r2 * (k1 + r2 * (k2 + r2 * k3));
+    PointArray xy = 2 * x * y;
+    PointArray xd = radial * x + p1 * xy + p2 * (r2 + 2 * x.square());
+    PointArray yd = radial * y + p1 * (r2 + 2 * y.square()) + p2 * xy;
+    x = xd;
+    y = yd;
+  } else {
+    LOG(ERROR) << "Unknown distortion vector size!";
+  }
+  distorted_c->resize(2, x.cols());
+  distorted_c->row(0) = x * focal_length_[0] + offset[0];
+  distorted_c->row(1) = y * focal_length_[1] + offset[1];
+}
+
+// The inverse of the TSAI model, sampled at the corners of square cells of
+// the DISTORTED image. The samples are normalized undistorted coordinates.
+struct camera::CameraParameters::UndistortTable {
+  static constexpr int kCellSize = 8;
+  int cols, rows;
+  std::vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d> > samples;
+};
+
+std::shared_ptr<const camera::CameraParameters::UndistortTable>
+camera::CameraParameters::GetUndistortTable() const {
+  std::shared_ptr<const UndistortTable> table = std::atomic_load(&undistort_table_);
+  if (table)
+    return table;
+  // Undistort all the samples with a single call, as UndistortCentered does
+  std::shared_ptr<UndistortTable> t = std::make_shared<UndistortTable>();
+  t->cols = distorted_image_size_[0] / UndistortTable::kCellSize + 2;
+  t->rows = distorted_image_size_[1] / UndistortTable::kCellSize + 2;
+  cv::Mat src(1, t->cols * t->rows, CV_64FC2), dst;
+  for (int r = 0; r < t->rows; r++) {
+    for (int c = 0; c < t->cols; c++) {
+      src.at<cv::Vec2d>(0, r * t->cols + c) =
+        cv::Vec2d(c * UndistortTable::kCellSize, r * UndistortTable::kCellSize);
+    }
+  }
+  cv::Mat dist_int_mat, cvdist;
+  cv::eigen2cv(distortion_coeffs_, cvdist);
+  cv::eigen2cv(GetIntrinsicMatrix<DISTORTED>(), dist_int_mat);
+  cv::undistortPoints(src, dst, dist_int_mat, cvdist);
+  t->samples.resize(t->cols * t->rows);
+  for (size_t i = 0; i < t->samples.size(); i++)
+    t->samples[i] << dst.at<cv::Vec2d>(0, i)[0], dst.at<cv::Vec2d>(0, i)[1];
+  table = t;
+  std::atomic_store(&undistort_table_, table);
+  return table;
+}
+
+void camera::CameraParameters::ClearUndistortTable() {
+  std::atomic_store(&undistort_table_, std::shared_ptr<const UndistortTable>());
+}
+
+void camera::CameraParameters::UndistortCentered(Eigen::Matrix2Xd const& distorted_c,
+                                                 Eigen::Matrix2Xd* undistorted_c) const {
+  Eigen::Vector2d offset = optical_offset_ - distorted_half_size_;
+  if (distortion_coeffs_.size() == 0) {
+    *undistorted_c = distorted_c.colwise() - offset;
+    return;
+  }
+  if (distortion_coeffs_.size() == 1) {
+    // FOV model
+    PointArray x = (distorted_c.row(0).array() - offset[0]) / focal_length_[0];
+    PointArray y = (distorted_c.row(1).array() - offset[1]) / focal_length_[1];
+    PointArray rd = (x.square() + y.square()).sqrt();
+    PointArray ru = (rd * distortion_coeffs_[0]).tan() / distortion_precalc2_;
+    PointArray conv = (rd > 1e-5).select(ru / rd, 1.0);
+    undistorted_c->resize(2, x.cols());
+    undistorted_c->row(0) = conv * x * focal_length_[0];
+    undistorted_c->row(1) = conv * y * focal_length_[1];
+    return;
+  }
+  if (distortion_coeffs_.size() != 4 && distortion_coeffs_.size() != 5) {
+    LOG(ERROR) << "Unknown distortion vector size!";
+    return;
+  }
+
+  // Tsai model. Start from the interpolated table, which needs the points in
+  // the DISTORTED frame, and keep those outside of the table for later.
+  std::shared_ptr<const UndistortTable> table = GetUndistortTable();
+  const int n = distorted_c.cols();
+  PointArray xd = (distorted_c.row(0).array() - offset[0]) / focal_length_[0];
+  PointArray yd = (distorted_c.row(1).array() - offset[1]) / focal_length_[1];
+  PointArray x(n), y(n);
+  std::vector<int> outside;
+  const double scale = 1.0 / UndistortTable::kCellSize;
+  for (int i = 0; i < n; i++) {
+    double u = (distorted_c(0, i) + distorted_half_size_[0]) * scale;
+    double v = (distorted_c(1, i) + distorted_half_size_[1]) * scale;
+    int c = static_cast<int>(floor(u)), r = static_cast<int>(floor(v));
+    if (c < 0 || r < 0 || c + 1 >= table->cols || r + 1 >= table->rows) {
+      outside.push_back(i);
+      x[i] = xd[i];
+      y[i] = yd[i];
+      continue;
+    }
+    double a = u - c, b = v - r;
+    const Eigen::Vector2d* s = &table->samples[r * table->cols + c];
+    Eigen::Vector2d p = (1 - b) * ((1 - a) * s[0] + a * s[1])
+                      + b * ((1 - a) * s[table->cols] + a * s[table->cols + 1]);
+    x[i] = p[0];
+    y[i] = p[1];
+  }
+
+  // Newton steps on the distortion model, whose Jacobian is symmetric
+  double k1 = distortion_coeffs_[0];
+  double k2 = distortion_coeffs_[1];
+  double p1 = distortion_coeffs_[2];
+  double p2 = distortion_coeffs_[3];
+  double k3 = 0;
+  if (distortion_coeffs_.size() == 5)
+    k3 = distortion_coeffs_[4];
+  for (int iteration = 0; iteration < 2; iteration++) {
+    PointArray r2 = x.square() + y.square();
+    PointArray radial = 1 + r2 * (k1 + r2 * (k2 + r2 * k3));
+    PointArray dradial = 2 * (k1 + r2 * (2 * k2 + r2 * 3 * k3));
+    PointArray ex = radial * x + 2 * p1 * x * y + p2 * (r2 + 2 * x.square()) - xd;
+    PointArray ey = radial * y + p1 * (r2 + 2 * y.square()) + 2 * p2 * x * y - yd;
+    PointArray jxx = radial + dradial * x.square() + 2 * p1 * y + 6 * p2 * x;
+    PointArray jxy = dradial * x * y + 2 * p1 * x + 2 * p2 * y;
+    PointArray jyy = radial + dradial * y.square() + 6 * p1 * y + 2 * p2 * x;
+    PointArray det = jxx * jyy - jxy.square();
+    x -= (jyy * ex - jxy * ey) / det;
+    y -= (jxx * ey - jxy * ex) / det;
+  }
+
+  // Keep the single point results for the points outside of the table
+  Eigen::Vector2d point;
+  for (size_t i = 0; i < outside.size(); i++) {
+    UndistortCentered(Eigen::Vector2d(distorted_c.col(outside[i])), &point);
+    x[outside[i]] = point[0] / focal_length_[0];
+    y[outside[i]] = point[1] / focal_length_[1];
+  }
+  undistorted_c->resize(2, n);
+  undistorted_c->row(0) = x * focal_length_[0];
+  undistorted_c->row(1) = y * focal_length_[1];
+}
+
 void camera::CameraParameters::GenerateRemapMaps(cv::Mat* remap_map) {
   remap_map->create(undistorted_image_size_[1], undistorted_image_size_[0], CV_32FC2);
   Eigen::Vector2d undistorted, distorted;
@@ -389,6 +564,35 @@ namespace camera {
 
 #undef DEFINE_CONVERSION
 
+  // Batch conversions
+#define DEFINE_BATCH_CONVERSION(TYPEA, TYPEB) \
+  template <> \
+  void camera::CameraParameters::Convert<TYPEA, TYPEB>(Eigen::Matrix2Xd const& input, Eigen::Matrix2Xd *output) const
+
+  DEFINE_BATCH_CONVERSION(UNDISTORTED_C, DISTORTED_C) {
+    DistortCentered(input, output);
+  }
+  DEFINE_BATCH_CONVERSION(DISTORTED_C, UNDISTORTED_C) {
+    UndistortCentered(input, output);
+  }
+  DEFINE_BATCH_CONVERSION(DISTORTED, UNDISTORTED) {
+    UndistortCentered(input.colwise() - distorted_half_size_, output);
+    output->colwise() += undistorted_half_size_;
+  }
+  DEFINE_BATCH_CONVERSION(UNDISTORTED, DISTORTED) {
+    DistortCentered(input.colwise() - undistorted_half_size_, output);
+    output->colwise() += distorted_half_size_;
+  }
+  DEFINE_BATCH_CONVERSION(DISTORTED, UNDISTORTED_C) {
+    UndistortCentered(input.colwise() - distorted_half_size_, output);
+  }
+  DEFINE_BATCH_CONVERSION(UNDISTORTED_C, DISTORTED) {
+    DistortCentered(input, output);
+    output->colwise() += distorted_half_size_;
+  }
+
+#undef DEFINE_BATCH_CONVERSION
+
   // Helper functions to give the intrinsic matrix
 #define DEFINE_INTRINSIC(TYPE) \
   template <> \
@@ -195,3 +195,40 @@ TEST(camera_params, conversion) {
   EXPECT_NEAR(input[0], output2[0], 1e-6);
   EXPECT_NEAR(input[1], output2[1], 1e-6);
 }
+
+TEST(camera_params, batch_conversion) {
+  // The batch conversions should agree with the single point ones, for each
+  // of the lens distortion models. For the TSAI model, the single point
+  // undistortion stops after a few fixed point iterations, whereas the batch
+  // one converges, so they only agree to a fraction of a pixel.
+  std::vector<Eigen::VectorXd> distortions(3);
+  distortions[1].resize(1);
+  distortions[1] << 0.7;  // FOV model
+  distortions[2].resize(4);
+  distortions[2] << -0.1, 0.01, 0.001, -0.0005;  // TSAI model
+  Eigen::Matrix2Xd distorted = Eigen::Matrix2Xd::Random(2, 200);
+  distorted.row(0) = (distorted.row(0).array() + 1) * 600;
+  distorted.row(1) = (distorted.row(1).array() + 1) * 300;
+  for (size_t d = 0; d < distortions.size(); d++) {
+    camera::CameraParameters params(
+        Eigen::Vector2i(1200, 600),
+        Eigen::Vector2d(600, 600),
+        Eigen::Vector2d(610.5, 290.3), distortions[d]);
+    double tolerance = (distortions[d].size() == 4 ? 0.5 : 1e-6);
+    Eigen::Matrix2Xd undistorted_c, output;
+    params.Convert<camera::DISTORTED, camera::UNDISTORTED_C>(distorted, &undistorted_c);
+    ASSERT_EQ(distorted.cols(), undistorted_c.cols());
+    for (int i = 0; i < distorted.cols(); i++) {
+      Eigen::Vector2d point;
+      params.Convert<camera::DISTORTED, camera::UNDISTORTED_C>(Eigen::Vector2d(distorted.col(i)), &point);
+      EXPECT_VECTOR2D_NEAR(point, undistorted_c.col(i), tolerance);
+    }
+
+    // and the way back, in place, which is exact
+    output = undistorted_c;
+    params.Convert<camera::UNDISTORTED_C, camera::DISTORTED>(output, &output);
+    for (int i = 0; i < distorted.cols(); i++) {
+      EXPECT_VECTOR2D_NEAR(distorted.col(i), output.col(i), 1e-6);
+    }
+  }
+}
@@ -0,0 +1,82 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef HANDRAIL_DETECT_POINT_CLOUD_VIEW_H_
+#define HANDRAIL_DETECT_POINT_CLOUD_VIEW_H_
+
+#include <sensor_msgs/PointCloud2.h>
+#include <geometry_msgs/Point32.h>
+
+#include <string.h>
+
+#include <vector>
+
+namespace handrail_detect {
+
+// Random access to the x, y and z of the points of a PointCloud2, read in
+// place from the message buffer rather than converted to a PointCloud first.
+// Points can be overwritten: the new values are kept in an overlay, and the
+// message itself is never modified. The overlay is cleared on Reset.
+class PointCloudView {
+ public:
+  PointCloudView() : data_(NULL), point_step_(0), size_(0) {}
+
+  // View the points of a new message. Returns false, leaving the view empty,
+  // if the message does not have float32 x, y and z fields.
+  bool Reset(const sensor_msgs::PointCloud2ConstPtr& msg);
+
+  int size() const {
+    return size_;
+  }
+
+  // Header of the viewed message
+  const std_msgs::Header& header() const {
+    return msg_->header;
+  }
+
+  // The point at index i, from the overlay if it was overwritten
+  geometry_msgs::Point32 operator[](int i) const {
+    if (overlay_index_[i] >= 0)
+      return overlay_[overlay_index_[i]];
+    geometry_msgs::Point32 point;
+    const uint8_t* p = data_ + static_cast<size_t>(i) * point_step_;
+    memcpy(&point.x, p + offset_[0], sizeof(float));
+    memcpy(&point.y, p + offset_[1], sizeof(float));
+    memcpy(&point.z, p + offset_[2], sizeof(float));
+    return point;
+  }
+
+  // Overwrite the point at index i, or only its z
+  void Set(int i, const geometry_msgs::Point32& point);
+  void SetZ(int i, float z);
+
+ private:
+  sensor_msgs::PointCloud2ConstPtr msg_;  // holds on to the buffer
+  const uint8_t* data_;
+  int point_step_;
+  int offset_[3];
+  int size_;
+  // index of each point in overlay_, or -1 if it was not overwritten
+  std::vector<int> overlay_index_;
+  std::vector<geometry_msgs::Point32> overlay_;
+  std::vector<int> overlay_points_;
+};
+
+}  // namespace handrail_detect
+
+#endif  // HANDRAIL_DETECT_POINT_CLOUD_VIEW_H_
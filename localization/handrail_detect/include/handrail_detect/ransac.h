@@ -0,0 +1,68 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef HANDRAIL_DETECT_RANSAC_H_
+#define HANDRAIL_DETECT_RANSAC_H_
+
+#include <Eigen/Core>
+
+#include <array>
+#include <vector>
+
+namespace handrail_detect {
+
+// Points used for RANSAC, one row [x y z 1] per point. Eigen stores the matrix
+// column major, so every coordinate is a contiguous float array and the
+// residuals of a batch of models are a single matrix product.
+typedef Eigen::Matrix<float, Eigen::Dynamic, 4> RansacPoints;
+
+// Scores linear models, whose residual for a point p is |[p' 1] m|. This
+// covers planes (m = [a b c d]) as well as lines in the xy plane through a
+// point (x0, y0) with unit direction (vx, vy), for which
+// m = [vy -vx 0 (vx y0 - vy x0)]. Models are scored kBatch at a time, so the
+// points are read once per batch rather than once per model.
+class RansacScorer {
+ public:
+  static const int kBatch = 8;
+  typedef Eigen::Matrix<float, 4, kBatch> Models;
+  typedef std::array<int, kBatch> Counts;
+
+  // Count the inliers of the first num_models columns of models
+  void Score(const RansacPoints& points, const Models& models, int num_models,
+             float threshold, Counts* counts);
+
+  // Split the point ids into the inliers and, if requested, the outliers of a
+  // single model. ids[i] is the id of the point in row i.
+  static void Split(const RansacPoints& points, const std::vector<int>& ids,
+                    const Eigen::Vector4f& model, float threshold,
+                    std::vector<int>* inliers, std::vector<int>* outliers = NULL);
+
+  // Number of iterations needed to draw, with the given confidence, at least
+  // one sample of sample_size inliers when inliers out of total points fit the
+  // best model so far. Never more than max_iterations.
+  static int Iterations(int inliers, int total, int sample_size, float confidence,
+                        int max_iterations);
+
+ private:
+  // residuals of a block of points, reused between calls
+  Eigen::Matrix<float, Eigen::Dynamic, kBatch> residuals_;
+};
+
+}  // namespace handrail_detect
+
+#endif  // HANDRAIL_DETECT_RANSAC_H_
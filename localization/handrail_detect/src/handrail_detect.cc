@@ -27,12 +27,15 @@
 #include <nodelet/nodelet.h>
 #include <pluginlib/class_list_macros.h>
 
+// Handrail point access and RANSAC
+#include <handrail_detect/point_cloud_view.h>
+#include <handrail_detect/ransac.h>
+
 // ROS messages
 #include <sensor_msgs/Image.h>
 #include <sensor_msgs/image_encodings.h>
 #include <sensor_msgs/PointCloud2.h>
 #include <sensor_msgs/PointCloud.h>
-#include <sensor_msgs/point_cloud_conversion.h>
 #include <visualization_msgs/Marker.h>
 #include <geometry_msgs/TransformStamped.h>
 #include <geometry_msgs/Point.h>
@@ -199,6 +202,10 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     if (!config_.GetReal("RANSAC_plane_thres", &RANSAC_plane_thres_))
       ROS_FATAL("Unspecified RANSAC_plane_thres.");
 
+    // RANSAC stops early once an all inlier sample has been drawn with this probability
+    if (!config_.GetReal("RANSAC_confidence", &RANSAC_confidence_))
+      ROS_FATAL("Unspecified RANSAC_confidence.");
+
     // Frame name of the perch cam
     if (!config_.GetStr("perch_image_frame", &perch_image_frame_))
       ROS_FATAL("Unspecified perch_image_frame.");
@@ -229,9 +236,6 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     // Minimum rate of the num of inliner points of the plane from the total num of points
     pcd_plane_rate_ = std::max(static_cast<float>(0.1), pcd_plane_rate_);
 
-    // Set the point cloud header frame
-    cloud_.header.frame_id = perch_image_frame_;
-
     // Gap distance between the plane and the handrail
     ave_handrail_wall_gap_ = handrail_wall_min_gap_ + 1.5 * handrail_width_;
 
@@ -274,8 +278,11 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
 
   // Called when a new point cloud arrives
   void PointCloud2Callback(const sensor_msgs::PointCloud2ConstPtr& depth_msg) {
-    // Convert from pointcloud2 to pointcloud for easy access of the point cloud
-    sensor_msgs::convertPointCloud2ToPointCloud(*depth_msg, cloud_);
+    // Read the points in place rather than converting the whole cloud to a pointcloud
+    if (!cloud_.Reset(depth_msg)) {
+      ROS_ERROR("[Handrail] point cloud has no float x, y and z fields");
+      return;
+    }
     HandrailCallback();
   }
 
@@ -397,17 +404,19 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     int point_cnt = 0;
     int x_step_half = x_step_ / 2;
     int y_step_half = y_step_ / 2;
-    for (int i = 1; i < static_cast<int>(cloud_.points.size()); i += x_step_) {
+    for (int i = 1; i < static_cast<int>(cloud_.size()); i += x_step_) {
       int i_y = i / depth_width_;
       if (i_y % y_step_ == 0) {
         ++point_cnt;
         if (point_cnt % 2 == 0) i += y_step_half * depth_width_;
         if (point_cnt == 1) i += x_step_half;
         // Check whether the point is nan
-        if (i < static_cast<int>(cloud_.points.size())) {
-          if (cloud_.points[i].z < max_depth_dist_ && cloud_.points[i].z > min_depth_dist_ &&
-              !(std::isnan(cloud_.points[i].x) || std::isnan(cloud_.points[i].y) ||
-                std::isnan(cloud_.points[i].z))) {
+        if (i < static_cast<int>(cloud_.size())) {
+          // Read straight from the message, only the sampled points are ever copied out of it
+          geometry_msgs::Point32 point = cloud_[i];
+          if (point.z < max_depth_dist_ && point.z > min_depth_dist_ &&
+              !(std::isnan(point.x) || std::isnan(point.y) ||
+                std::isnan(point.z))) {
             downsample_points->push_back(i);
           }
           if (point_cnt % 2 == 0)
@@ -429,7 +438,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
   }
 
   bool FindPlane(const std::vector<int>& downsample_points,
-                                 const sensor_msgs::PointCloud& filtered_cloud,
+                                 const PointCloudView& filtered_cloud,
                                  std::vector<int>* plane_inliers, std::vector<int>* plane_outliers,
                                  Eigen::Vector4f* plane_parameter, Eigen::Vector3f* plane_vector,
                                  float* plane_vector_length) {
@@ -444,66 +453,70 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     Eigen::MatrixX4f A(3, 4);
     Eigen::Matrix4f ATA;
 
-    for (int i = 0; i < RANSAC_plane_iteration_; ++i) {
-      // Sample three points to model a normal vector of a plane
-      do {
-        r1 = rand_r(&seed_) % num_data;
-        r2 = rand_r(&seed_) % num_data;
-        r3 = rand_r(&seed_) % num_data;
-      } while (r1 == r2 || r1 == r3 || r2 == r3);
-      int ID1 = downsample_points[r1], ID2 = downsample_points[r2], ID3 = downsample_points[r3];
-      // Make a form Ap = 0 where A is the matrix of the homogeneous representation of three randomly selected points,
-      // and p is the plane parameter vector
-      // Since v is the null space of A and rank(A) = 3, null(A) = 1, a unique plane can be defined.
-      // Adding a constraint, |p| = 1, the null space p is the eigenvector of A'A that
-      // corresponds the smallest eigenvalue
-      A << filtered_cloud.points[ID1].x, filtered_cloud.points[ID1].y, filtered_cloud.points[ID1].z, 1,
-      filtered_cloud.points[ID2].x, filtered_cloud.points[ID2].y, filtered_cloud.points[ID2].z, 1,
-      filtered_cloud.points[ID3].x, filtered_cloud.points[ID3].y, filtered_cloud.points[ID3].z, 1;
-      ATA = A.transpose() * A;
-      Eigen::SelfAdjointEigenSolver<Eigen::Matrix4f> eigensolver(ATA);
-      Eigen::Vector4f tmp_plane_parameter = eigensolver.eigenvectors().col(0);  // Normalized plane parameter.
-      Eigen::Vector3f tmp_normal_vector;  // Normal vector to the plane (not normalized)
-      tmp_normal_vector << tmp_plane_parameter(0), tmp_plane_parameter(1), tmp_plane_parameter(2);
-
-      if (fabs(tmp_normal_vector(2)) < fabs(tmp_normal_vector(0)) + fabs(tmp_normal_vector(1)))
-        continue;
-      tmp_normal_vector /= tmp_normal_vector.norm();
-      std::vector<int> tmp_inliers, tmp_outliers;
-      tmp_inliers.reserve(downsample_points.size());
-      tmp_outliers.reserve(downsample_points.size());
-      Eigen::Vector4f pnt_homo;
-      for (auto const& itr : downsample_points) {
+    // Hypotheses are sampled in batches and scored together against the gathered points.
+    // Only the best plane parameter is kept, and its inliers are collected once at the end.
+    GatherPoints(downsample_points, filtered_cloud, &ransac_points_);
+    RansacScorer::Models models;
+    RansacScorer::Counts counts;
+    std::array<int, RansacScorer::kBatch> model_itr;
+    int best_size = 0, iterations = RANSAC_plane_iteration_;
+    bool converged = false;
+    for (int i = 0; i < iterations && !converged;) {
+      int num_models = 0;
+      for (; i < iterations && num_models < RansacScorer::kBatch; ++i) {
+        // Sample three points to model a normal vector of a plane
+        do {
+          r1 = rand_r(&seed_) % num_data;
+          r2 = rand_r(&seed_) % num_data;
+          r3 = rand_r(&seed_) % num_data;
+        } while (r1 == r2 || r1 == r3 || r2 == r3);
+        // Make a form Ap = 0 where A is the matrix of the homogeneous representation of three randomly selected
+        // points, and p is the plane parameter vector
+        // Since v is the null space of A and rank(A) = 3, null(A) = 1, a unique plane can be defined.
+        // Adding a constraint, |p| = 1, the null space p is the eigenvector of A'A that
+        // corresponds the smallest eigenvalue
+        A << ransac_points_.row(r1), ransac_points_.row(r2), ransac_points_.row(r3);
+        ATA = A.transpose() * A;
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix4f> eigensolver(ATA);
+        Eigen::Vector4f tmp_plane_parameter = eigensolver.eigenvectors().col(0);  // Normalized plane parameter.
+        if (fabs(tmp_plane_parameter(2)) < fabs(tmp_plane_parameter(0)) + fabs(tmp_plane_parameter(1)))
+          continue;
         // The dist between a point X=[x y z]' and a plane with parameter a, b, c, d is
         // res = |ax + by + cz + d| / sqrt(a^2 + b^2 + c^2)
         // If Y = [X' 1]', v = [a b c]', p = [v' d]' then
         // res = (Y' * p).norm / v.norm
-        pnt_homo << filtered_cloud.points[itr].x, filtered_cloud.points[itr].y, filtered_cloud.points[itr].z, 1;
-        if ((pnt_homo.transpose() * tmp_plane_parameter).norm() / tmp_normal_vector.norm() < RANSAC_plane_thres_)
-          tmp_inliers.push_back(itr);   // Plane inliers
-        else
-          tmp_outliers.push_back(itr);  // Plane outliers which contain potential line points
+        // Hypotheses are scored by (Y' * p).norm, with |p| = 1
+        models.col(num_models) = tmp_plane_parameter;
+        model_itr[num_models++] = i;
       }
-      // If tmp_inliers vector has more points than plane_inliers vector, update the plane_inliers vector
-      if (tmp_inliers.size() > plane_inliers->size()) {
-        // std::cout << "itr / pnt: " << i << "/" << tmp_inliers.size() << std::endl;
-        int prev_size = plane_inliers->size();
-        int curr_size = tmp_inliers.size();
-        *plane_inliers = tmp_inliers;
-        *plane_parameter = tmp_plane_parameter;
-        potential_plane_outliers = tmp_outliers;
+      if (num_models == 0)
+        continue;
+      scorer_.Score(ransac_points_, models, num_models, RANSAC_plane_thres_, &counts);
+      for (int m = 0; m < num_models && model_itr[m] < iterations; ++m) {
+        // If the hypothesis has more inliers than the best plane so far, update the plane parameter
+        if (counts[m] <= best_size)
+          continue;
+        int prev_size = best_size;
+        int curr_size = counts[m];
+        best_size = curr_size;
+        *plane_parameter = models.col(m);
 
         // Stop iteration if the plane has enough points or it converges
         if (curr_size > max_thres) {
-          // std::cout << "Enough points for plane! Finish at itr: " << i << "\n";
+          converged = true;
           break;
-        } else if (i > RANSAC_plane_iteration_ / 2 && curr_size > plane_size_thres
+        } else if (model_itr[m] > RANSAC_plane_iteration_ / 2 && curr_size > plane_size_thres
                    && curr_size - prev_size < diff_thres) {
-          // std::cout << "Plane converges! Finish at itr: " << i << "\n";
+          converged = true;
           break;
         }
+        // Otherwise stop once a better plane is unlikely to be sampled
+        iterations = RansacScorer::Iterations(curr_size, num_data, 3, RANSAC_confidence_, RANSAC_plane_iteration_);
       }
     }
+    if (best_size > 0)
+      RansacScorer::Split(ransac_points_, downsample_points, *plane_parameter, RANSAC_plane_thres_,
+                          plane_inliers, &potential_plane_outliers);
 
     // If the number of plane points is less than a threshold, discard the result
     if (static_cast<int>(plane_inliers->size()) < plane_size_thres) {
@@ -517,7 +530,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     Eigen::Matrix4f BTB;
     int row_cnt = 0;
     for (auto const& itr : (*plane_inliers)) {
-      B.row(row_cnt) << cloud_.points[itr].x, cloud_.points[itr].y, cloud_.points[itr].z, 1;
+      B.row(row_cnt) << cloud_[itr].x, cloud_[itr].y, cloud_[itr].z, 1;
       ++row_cnt;
     }
     BTB = B.transpose() * B;
@@ -535,7 +548,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     for (auto const& itr : potential_plane_outliers) {
       // Measure dist of the point from the plane
       Eigen::Vector4f test_point;
-      test_point << cloud_.points[itr].x, cloud_.points[itr].y, cloud_.points[itr].z, 1;
+      test_point << cloud_[itr].x, cloud_[itr].y, cloud_[itr].z, 1;
       float dist_to_plane = test_point.dot((*plane_parameter)) / (*plane_vector_length);
       if (fabs(dist_to_plane - ave_handrail_wall_gap_) < handrail_width_)
         plane_outliers->push_back(itr);
@@ -545,7 +558,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
 
   bool ClusterLinePoints(const std::array<std::vector<int>, 2>& line_inliers,
                                          const Eigen::Vector4f& plane_parameter,
-                                         const sensor_msgs::PointCloud& filtered_cloud, const int& line_size_thres,
+                                         const PointCloudView& filtered_cloud, const int& line_size_thres,
                                          std::array<std::vector<int>, 2>* clustered_line_inliers) {
     std::array<std::vector<int>, 2> tmp_clustered_line_inliers;
     std::array<bool, 2> cluster_chk = {true, true};
@@ -573,9 +586,9 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
       int min_idx = tmp_line_inliers[0], max_idx = tmp_line_inliers[tmp_line_inliers.size() - 1];
       float sort_min = 100000, sort_max = -sort_min;
       for (auto const& itr : tmp_line_inliers) {
-        float check_point_val = filtered_cloud.points[itr].y;
+        float check_point_val = filtered_cloud[itr].y;
         if (i == 0) {  // vertical case
-          check_point_val = filtered_cloud.points[itr].x;
+          check_point_val = filtered_cloud[itr].x;
         }
         if (check_point_val < sort_min) {
           sort_min = check_point_val;
@@ -611,7 +624,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
   }
 
   void ClusterPotentialLinePoints(const std::vector<int>& potential_line_inliers,
-      const sensor_msgs::PointCloud& filtered_cloud, bool x_check, float gap_dist,
+      const PointCloudView& filtered_cloud, bool x_check, float gap_dist,
       std::vector<int>* clustered_line_inliers) {
     std::vector<int> tmp_clustered_line_inliers;
     // 1. Sort the line inliers by their x or y values
@@ -619,9 +632,9 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     axis_vals.reserve(potential_line_inliers.size());
     for (auto const& itr : potential_line_inliers) {
       if (x_check)
-        axis_vals.push_back(filtered_cloud.points[itr].x);
+        axis_vals.push_back(filtered_cloud[itr].x);
       else
-        axis_vals.push_back(filtered_cloud.points[itr].y);
+        axis_vals.push_back(filtered_cloud[itr].y);
     }
     std::sort(axis_vals.begin(), axis_vals.end());
 
@@ -660,9 +673,9 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
       for (auto const& itr : potential_line_inliers) {
         float check_point_val;
         if (x_check)
-          check_point_val = filtered_cloud.points[itr].x;
+          check_point_val = filtered_cloud[itr].x;
         else
-          check_point_val = filtered_cloud.points[itr].y;
+          check_point_val = filtered_cloud[itr].y;
         if (check_point_val >= min_val[max_grofst_end_ID] && check_point_val <= max_val[max_grofst_end_ID]) {
           tmp_clustered_line_inliers.push_back(itr);  // not sorted!!!
         }
@@ -673,7 +686,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
 
 
   bool FilterCloud(const std::vector<int>& sample_points,
-                                   sensor_msgs::PointCloud* filtered_cloud) {
+                                   PointCloudView* filtered_cloud) {
     int filter_size = 15;
     // Filter-related matrices and vector
     Eigen::MatrixXf I_mat_sm = Eigen::MatrixXf::Identity(filter_size - 1, filter_size - 1);
@@ -705,10 +718,10 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
       end_idx = std::min(end_idx, sample_points_size - 1);
 
       // Set lambda matrix depending on the differential of data
-      b(0) = cloud_.points[sample_points[strt_idx]].z;
+      b(0) = cloud_[sample_points[strt_idx]].z;
       float filter_max_dist = handrail_wall_min_gap_ * 0.5;
       for (int cnt = 1, j = strt_idx + 1; j < end_idx; ++j, ++cnt) {
-        b(cnt) = cloud_.points[sample_points[j]].z;
+        b(cnt) = cloud_[sample_points[j]].z;
         if (fabs(b(cnt) - b(cnt-1)) < filter_max_dist)
           L_vec_sq(cnt - 1) = filter_max_lambda_sq;
         else
@@ -723,7 +736,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
       Eigen::VectorXf x = A_mat.llt().solve(b);
 
       for (int cnt = 0, j = strt_idx; j < end_idx; ++j, ++cnt) {
-        filtered_cloud->points[sample_points[j]].z = x(cnt);
+        filtered_cloud->SetZ(sample_points[j], x(cnt));
       }
     }
     return true;
@@ -791,7 +804,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
       // Measure dist of the point from the plane
       // Ted & Katie: Removed the 1. Crashed Eigen into a bus full of school
       // kids.
-      test_point << cloud_.points[itr].x, cloud_.points[itr].y, cloud_.points[itr].z;  // , 1;
+      test_point << cloud_[itr].x, cloud_[itr].y, cloud_[itr].z;  // , 1;
       std::array<int, 2> side_cnt = {0, 0}, behind_cnt = {0, 0};
       std::array<int, 4> side_index = {itr - y_minus_step * depth_width_, itr + y_plus_step * depth_width_,
                                        itr - side_step, itr + side_step
@@ -814,7 +827,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
             side_index[1] += (y_plus_step * depth_width_);
           }
           // +y side
-          if (side_index[1] >= static_cast<int>(cloud_.points.size())) {
+          if (side_index[1] >= static_cast<int>(cloud_.size())) {
             side_index[1] = depth_width_ * (depth_height_ - 1) + side_index[1] % depth_width_;
           }
           // -y side
@@ -842,20 +855,20 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
         }
 
         // Check garbage side points
-        if (cloud_.points[side_index[2 * yx_idx]].z == 0) {
+        if (cloud_[side_index[2 * yx_idx]].z == 0) {
           tmp_idx = itr;
           for (int ti = side_index[2 * yx_idx]; ti <= itr; ti += edge_step) {
-            if (cloud_.points[ti].z != 0) {
+            if (cloud_[ti].z != 0) {
               tmp_idx = ti;
               break;
             }
           }
           side_index[2 * yx_idx] = tmp_idx;
         }
-        if (cloud_.points[side_index[2 * yx_idx + 1]].z == 0) {
+        if (cloud_[side_index[2 * yx_idx + 1]].z == 0) {
           tmp_idx = itr;
           for (int ti = side_index[2 * yx_idx + 1]; ti >= itr; ti -= edge_step) {
-            if (cloud_.points[ti].z != 0) {
+            if (cloud_[ti].z != 0) {
               tmp_idx = ti;
               break;
             }
@@ -865,7 +878,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
 
         for (int j = 0; j < 2; ++j) {
           int side_itr = side_index[2 * yx_idx + j];
-          tmp_homo_point << cloud_.points[side_itr].x, cloud_.points[side_itr].y, cloud_.points[side_itr].z, 1;
+          tmp_homo_point << cloud_[side_itr].x, cloud_[side_itr].y, cloud_[side_itr].z, 1;
           float dist_side_plane = tmp_homo_point.dot(plane_parameter) / plane_vector_length;
           // using signed distance makes important role since one side of the handrail
           // has a deep gap back to the plane.
@@ -907,11 +920,11 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
 
           std::vector<int> tmp_edge_points;
           for (int i = side_index[2 * yx_idx] + edge_step; i < side_index[2 * yx_idx + 1]; i += edge_step) {
-            cloud_point << cloud_.points[i].x, cloud_.points[i].y, cloud_.points[i].z;
+            cloud_point << cloud_[i].x, cloud_[i].y, cloud_[i].z;
             float gap_dist = (test_point - cloud_point).norm();
             if (gap_dist <= handrail_width_ * 0.5) {
               tmp_edge_points.push_back(i);
-            } else if (cloud_.points[i].z == 0) {
+            } else if (cloud_[i].z == 0) {
               // Start filling out empty space by projecting 2D pixel to 3D position
               // Get fx (=focal_lehgth / x_scale) and fy from the test point (x_scale * u : focal_length = x : z)
               int itr_u = itr % depth_width_ - depth_width_ / 2;
@@ -928,9 +941,11 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
               float new_y = static_cast<float>(v) * test_point(2) / fy;
 
               // Set the 3D position of the zero point with new position
-              cloud_.points[i].x = new_x;
-              cloud_.points[i].y = new_y;
-              cloud_.points[i].z = test_point(2);
+              geometry_msgs::Point32 new_point;
+              new_point.x = new_x;
+              new_point.y = new_y;
+              new_point.z = test_point(2);
+              cloud_.Set(i, new_point);
 
               tmp_edge_points.push_back(i);
               fill_points.push_back(i);
@@ -940,10 +955,10 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
             std::vector<float> val_vect;
             if (yx_idx == 0) {
               for (auto const& edge_itr : tmp_edge_points)
-                val_vect.push_back(cloud_.points[edge_itr].y);
+                val_vect.push_back(cloud_[edge_itr].y);
             } else {
               for (auto const& edge_itr : tmp_edge_points)
-                val_vect.push_back(cloud_.points[edge_itr].x);
+                val_vect.push_back(cloud_[edge_itr].x);
             }
             std::sort(val_vect.begin(), val_vect.end());
             float gap_dist = fabs(val_vect[0] - val_vect[val_vect.size() - 1]);
@@ -976,112 +991,120 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
 
   bool FindBestLinePoints(const std::vector<int>& potential_line_inliers,
                                           const int& line_size_thres, const Eigen::Vector3f& plane_vector,
-                                          sensor_msgs::PointCloud* new_filtered_cloud,
+                                          const PointCloudView& filtered_cloud,
                                           std::array<std::vector<int>, 2>* best_line_inliers) {
-    sensor_msgs::PointCloud filtered_cloud = (*new_filtered_cloud);
     int num_potential_data = potential_line_inliers.size();
     int min_line_size_thres = line_size_thres / 2;
-    Eigen::Vector3f fst_line_point, scd_line_point, tmp_line_vector, point_diff, potential_point;
+    Eigen::Vector3f tmp_line_vector;
 
     // Line Estimation in xy plane since z values of the points are highly corrupted
     // due to unexpected interference and reflection
-    std::array<std::vector<int>, 2> both_line_inliers;
+    std::array<int, 2> both_line_sizes = {0, 0};
+    std::array<Eigen::Vector4f, 2> both_line_models;
     std::array<Eigen::Vector3f, 2> both_line_vectors;
     std::array<float, 2> both_line_angs = {M_PI_2, 0};
-    int r1, r2, ID1, ID2;
+    int r1, r2;
     float m_pi_8 = M_PI / 8.0;
-    for (int i = 0; i < RANSAC_line_iteration_; ++i) {
-      do {
-        r1 = rand_r(&seed_) % num_potential_data;
-        r2 = rand_r(&seed_) % num_potential_data;
-      } while (r1 == r2);
-      ID1 = potential_line_inliers[r1];
-      ID2 = potential_line_inliers[r2];
-
-      // Set z value to zero for xy plane line estimation
-      fst_line_point << filtered_cloud.points[ID1].x, filtered_cloud.points[ID1].y, 0;
-      scd_line_point << filtered_cloud.points[ID2].x, filtered_cloud.points[ID2].y, 0;
-      tmp_line_vector = fst_line_point - scd_line_point;
-      tmp_line_vector /= tmp_line_vector.norm();
-
-      // Calculate residual of potential points with respect to the sampled line vector
-      // The dist between a line that passes x1 and x2 and a point x0 is defined as
-      // d = |(x1 - x2) cross (x2 - x0)| / |(x1 - x2)|
-      std::vector<int> tmp_line_inliers;
-      tmp_line_inliers.reserve(num_potential_data);
-      for (auto const& itr : potential_line_inliers) {
+
+    // Hypotheses are sampled in batches and scored together against the gathered points,
+    // keeping only the best model for each direction.
+    GatherPoints(potential_line_inliers, filtered_cloud, &ransac_points_);
+    RansacScorer::Models models;
+    RansacScorer::Counts counts;
+    std::array<Eigen::Vector3f, RansacScorer::kBatch> line_vectors;
+    int iterations = RANSAC_line_iteration_;
+    for (int i = 0; i < iterations;) {
+      int num_models = 0;
+      for (; i < iterations && num_models < RansacScorer::kBatch; ++i) {
+        do {
+          r1 = rand_r(&seed_) % num_potential_data;
+          r2 = rand_r(&seed_) % num_potential_data;
+        } while (r1 == r2);
+
         // Set z value to zero for xy plane line estimation
-        potential_point << filtered_cloud.points[itr].x, filtered_cloud.points[itr].y, 0;
-        point_diff = scd_line_point - potential_point;
-        if ((tmp_line_vector.cross(point_diff)).norm() < RANSAC_line_thres_)
-          tmp_line_inliers.push_back(itr);
+        tmp_line_vector << ransac_points_(r1, 0) - ransac_points_(r2, 0),
+                           ransac_points_(r1, 1) - ransac_points_(r2, 1), 0;
+        tmp_line_vector /= tmp_line_vector.norm();
+
+        // Calculate residual of potential points with respect to the sampled line vector
+        // The dist between a line that passes x1 and x2 and a point x0 is defined as
+        // d = |(x1 - x2) cross (x2 - x0)| / |(x1 - x2)|
+        // which, in the xy plane and with v = (x1 - x2) / |(x1 - x2)|, is linear in x0:
+        // d = |vy * x0 - vx * y0 + (vx * y2 - vy * x2)|
+        models.col(num_models) << tmp_line_vector(1), -tmp_line_vector(0), 0,
+          tmp_line_vector(0) * ransac_points_(r2, 1) - tmp_line_vector(1) * ransac_points_(r2, 0);
+        line_vectors[num_models++] = tmp_line_vector;
       }
+      scorer_.Score(ransac_points_, models, num_models, RANSAC_line_thres_, &counts);
 
-      if (static_cast<int>(tmp_line_inliers.size()) < min_line_size_thres)
-        continue;
+      // Hypotheses of a batch are consecutive iterations, the first one being i - num_models
+      for (int m = 0; m < num_models && i - num_models + m < iterations; ++m) {
+        if (counts[m] < min_line_size_thres)
+          continue;
 
-      float tmp_line_ang = atan2(fabs(tmp_line_vector(0)), fabs(tmp_line_vector(1)));
+        float tmp_line_ang = atan2(fabs(line_vectors[m](0)), fabs(line_vectors[m](1)));
 
-      int idx = 0;
-      if (fabs(tmp_line_ang - both_line_angs[0]) > fabs(tmp_line_ang - both_line_angs[1])) {
-        if (max_num_handrails_ == 1)
-          continue;
-        idx = 1;
-      }
-      if (tmp_line_inliers.size() > both_line_inliers[idx].size()) {
-        both_line_inliers[idx] = tmp_line_inliers;
-        both_line_vectors[idx] = tmp_line_vector;
-        both_line_angs[idx] = tmp_line_ang;
-        if (max_num_handrails_ == 2 && both_line_inliers[idx].size() > both_line_inliers[1 - idx].size()) {
-          float tmp_scd_ang = M_PI_2 - tmp_line_ang;
-          if (fabs(both_line_angs[1 - idx] - tmp_scd_ang) > m_pi_8)
-            both_line_inliers[1- idx].clear();
-          both_line_angs[1 - idx] = tmp_scd_ang;
+        int idx = 0;
+        if (fabs(tmp_line_ang - both_line_angs[0]) > fabs(tmp_line_ang - both_line_angs[1])) {
+          if (max_num_handrails_ == 1)
+            continue;
+          idx = 1;
+        }
+        if (counts[m] > both_line_sizes[idx]) {
+          both_line_sizes[idx] = counts[m];
+          both_line_models[idx] = models.col(m);
+          both_line_vectors[idx] = line_vectors[m];
+          both_line_angs[idx] = tmp_line_ang;
+          if (max_num_handrails_ == 2 && both_line_sizes[idx] > both_line_sizes[1 - idx]) {
+            float tmp_scd_ang = M_PI_2 - tmp_line_ang;
+            if (fabs(both_line_angs[1 - idx] - tmp_scd_ang) > m_pi_8)
+              both_line_sizes[1 - idx] = 0;
+            both_line_angs[1 - idx] = tmp_scd_ang;
+          }
+          // With a single direction, stop once a better line is unlikely to be sampled
+          if (max_num_handrails_ == 1)
+            iterations = RansacScorer::Iterations(both_line_sizes[0], num_potential_data, 2,
+                                                  RANSAC_confidence_, RANSAC_line_iteration_);
         }
       }
     }
 
     std::array<std::vector<int>, 2> fin_line_inliers;
     for (int i = 0; i < max_num_handrails_; ++i) {
-      if (static_cast<int>(both_line_inliers[i].size()) < line_size_thres) {
-        both_line_inliers[i].clear();
+      if (both_line_sizes[i] < line_size_thres)
         continue;
-      }
 
       // Project the line vector to the plane using the normal vector of the plane
       both_line_vectors[i] = both_line_vectors[i] - (both_line_vectors[i].dot(plane_vector) * plane_vector);
       both_line_vectors[i] /= both_line_vectors[i].norm();
-      fin_line_inliers[i] = both_line_inliers[i];
+      RansacScorer::Split(ransac_points_, potential_line_inliers, both_line_models[i], RANSAC_line_thres_,
+                          &fin_line_inliers[i]);
     }
     PublishCloud(fin_line_inliers[0], filtered_cloud, &cloud_pub_[12]);
-    (*new_filtered_cloud) = filtered_cloud;
 
     if (fin_line_inliers[0].size() == 0 && fin_line_inliers[1].size() == 0)
       return false;
 
     if (fin_line_inliers[0].size() == 0) {
-      fin_line_inliers[0] = fin_line_inliers[1];
-      fin_line_inliers[1].clear();
+      fin_line_inliers[0].swap(fin_line_inliers[1]);
     } else if (both_line_angs[0] < M_PI_4) {
-      std::vector<int> swap_inliers = fin_line_inliers[0];
-      fin_line_inliers[0] = fin_line_inliers[1];
-      fin_line_inliers[1] = swap_inliers;
+      fin_line_inliers[0].swap(fin_line_inliers[1]);
     }
 
-    (*best_line_inliers) = fin_line_inliers;
+    best_line_inliers->swap(fin_line_inliers);
     return true;
   }
 
   float GetLineDist(const std::vector<int>& point_inliers,
-                                    const sensor_msgs::PointCloud& filtered_cloud, Eigen::Vector3f* center_pos) {
+                                    const PointCloudView& filtered_cloud, Eigen::Vector3f* center_pos) {
     if (static_cast<int>(point_inliers.size()) < 2)
       return 0;
 
     int fst_ID = point_inliers[0];
     int scd_ID = point_inliers[point_inliers.size() - 1];
     Eigen::Vector3f fst_line_point, scd_line_point;
-    fst_line_point << filtered_cloud.points[fst_ID].x, filtered_cloud.points[fst_ID].y, filtered_cloud.points[fst_ID].z;
-    scd_line_point << filtered_cloud.points[scd_ID].x, filtered_cloud.points[scd_ID].y, filtered_cloud.points[scd_ID].z;
+    fst_line_point << filtered_cloud[fst_ID].x, filtered_cloud[fst_ID].y, filtered_cloud[fst_ID].z;
+    scd_line_point << filtered_cloud[scd_ID].x, filtered_cloud[scd_ID].y, filtered_cloud[scd_ID].z;
     (*center_pos) = (fst_line_point + scd_line_point) / 2.0;
     return (fst_line_point - scd_line_point).norm();
   }
@@ -1109,7 +1132,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
       const Eigen::Vector3f& line_vector, const Eigen::Vector3f& line_center) {
     geometry_msgs::Point geo_point;
     Eigen::Vector3f tmp_vector, tmp_point;
-    tmp_point << cloud_.points[point_ID].x, cloud_.points[point_ID].y, cloud_.points[point_ID].z;
+    tmp_point << cloud_[point_ID].x, cloud_[point_ID].y, cloud_[point_ID].z;
     tmp_vector = tmp_point - line_center;
     tmp_point = line_center + tmp_vector.dot(line_vector) * line_vector;
     geo_point.x = tmp_point(0);
@@ -1164,7 +1187,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     // 2. Find a line model from potential_line_inliers using RANSAC
     std::array<std::vector<int>, 2> best_line_inliers;
     if (!FindBestLinePoints(potential_line_inliers, line_size_thres, plane_vector,
-                            &cloud_, &best_line_inliers)) {
+                            cloud_, &best_line_inliers)) {
       ROS_WARN("[Handrail] [Line Fail 2] no best line inliers");
       return false;
     }
@@ -1245,9 +1268,9 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     Eigen::Vector3f end_points_line_center = Eigen::Vector3f::Zero();
     std::array<std::vector<float>, 3> median_vec;
     for (auto const& itr : clustered_line_inliers) {
-      median_vec[0].push_back(cloud_.points[itr].x);
-      median_vec[1].push_back(cloud_.points[itr].y);
-      median_vec[2].push_back(cloud_.points[itr].z);
+      median_vec[0].push_back(cloud_[itr].x);
+      median_vec[1].push_back(cloud_[itr].y);
+      median_vec[2].push_back(cloud_[itr].z);
     }
     std::sort(median_vec[0].begin(), median_vec[0].end());
     std::sort(median_vec[1].begin(), median_vec[1].end());
@@ -1286,7 +1309,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     int row_cnt = 0;
     Eigen::Vector3f line_point, point_diff;
     for (auto const& itr : clustered_line_inliers) {
-      line_point << cloud_.points[itr].x, cloud_.points[itr].y, cloud_.points[itr].z;
+      line_point << cloud_[itr].x, cloud_[itr].y, cloud_[itr].z;
       point_diff = end_points_line_center - line_point;
 
       // Convert "v_s cross" to a matrix form
@@ -1360,7 +1383,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
       max_length_pixel = depth_width_;
     }
     int corner_cnt_thres = pixel_gap / check_step / 2;
-    int check_ID_max = static_cast<int>(cloud_.points.size()) - 1;
+    int check_ID_max = static_cast<int>(cloud_.size()) - 1;
     bool end_flags[2] = {false, false};
     float wall_gap = ave_handrail_wall_gap_ / 2;
     Eigen::Vector4f tmp_pnt;
@@ -1382,7 +1405,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
           if (k == 1)
             check_ID = end_ID + i * vertical_width + i * parallel_width * j;
           check_ID = std::min(std::max(check_ID, 0), check_ID_max);
-          tmp_pnt << cloud_.points[check_ID].x, cloud_.points[check_ID].y, cloud_.points[check_ID].z, 1;
+          tmp_pnt << cloud_[check_ID].x, cloud_[check_ID].y, cloud_[check_ID].z, 1;
           float measure_handrail_wall_gap = fabs(tmp_pnt.dot(plane_parameter)) / plane_vector_length;
           if (measure_handrail_wall_gap > wall_gap)
             break;
@@ -1473,7 +1496,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     float fov_x_half_tan = static_cast<float>(tan(fov_x * 0.5 * (M_PI / 180.0)));
     float fov_y_half_tan = static_cast<float>(tan(fov_y * 0.5 * (M_PI / 180.0)));
     float half_tan = std::min(fov_x_half_tan, fov_y_half_tan);
-    float feature_dist_thres = (half_tan * cloud_.points[plane_inliers[plane_inliers.size() / 2]].z)
+    float feature_dist_thres = (half_tan * cloud_[plane_inliers[plane_inliers.size() / 2]].z)
                                / sqrt(static_cast<float>((tot_features - num_line_features)));
 
     Eigen::Vector2f rp, tp;
@@ -1488,10 +1511,10 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
         g2g = true;
         rv = rand_r(&seed_) % plane_inliers.size();
 
-        if (!std::isnan(cloud_.points[plane_inliers[rv]].z)) {
-          rp << cloud_.points[plane_inliers[rv]].x, cloud_.points[plane_inliers[rv]].y;
+        if (!std::isnan(cloud_[plane_inliers[rv]].z)) {
+          rp << cloud_[plane_inliers[rv]].x, cloud_[plane_inliers[rv]].y;
           for (auto const& itr : feature_idx) {
-            tp << cloud_.points[itr].x, cloud_.points[itr].y;
+            tp << cloud_[itr].x, cloud_[itr].y;
             if ((rp - tp).norm() < feature_dist_thres) {
               g2g = false;
               ++escape_cnt2;  // count cnt2 when the selected point is close to any of previousl points
@@ -1519,15 +1542,15 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     dl_.landmarks.resize(feature_idx.size());
     int lm_cnt = 0;
     for (auto const& itr : feature_idx) {
-      dl_.landmarks[lm_cnt].u = cloud_.points[itr].x;
-      dl_.landmarks[lm_cnt].v = cloud_.points[itr].y;
-      dl_.landmarks[lm_cnt].w = cloud_.points[itr].z;
+      dl_.landmarks[lm_cnt].u = cloud_[itr].x;
+      dl_.landmarks[lm_cnt].v = cloud_[itr].y;
+      dl_.landmarks[lm_cnt].w = cloud_[itr].z;
       ++lm_cnt;
     }
   }
 
   bool GetXYScale(const std::vector<int>& plane_inliers) {
-    if (cloud_.points.size() == 0)
+    if (cloud_.size() == 0)
       return false;
 
     int rand_cnt = 0, escape_cnt = 0;
@@ -1539,8 +1562,8 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     while (rand_cnt < rand_cnt_max && escape_cnt < escape_cnt_max) {
       int rand_ID = rand_r(&seed_) % plane_inliers.size();
       rand_ID = plane_inliers[rand_ID];
-      if (!(cloud_.points[rand_ID].z == 0 || std::isnan(cloud_.points[rand_ID].x)
-            || std::isnan(cloud_.points[rand_ID].y) || std::isnan(cloud_.points[rand_ID].z))) {
+      if (!(cloud_[rand_ID].z == 0 || std::isnan(cloud_[rand_ID].x)
+            || std::isnan(cloud_[rand_ID].y) || std::isnan(cloud_[rand_ID].z))) {
         if (rand_cnt > 0) {
           int x_fst_ID = rand_ID % depth_width_;
           int x_scd_ID = prev_ID % depth_width_;
@@ -1554,16 +1577,16 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
             if (y_ID_diff == 0) {
               --rand_cnt;
             } else {
-              pixel_diff[0][rand_cnt - 1] = fabs(static_cast<float>(cloud_.points[rand_ID].x - prev_point[0])
+              pixel_diff[0][rand_cnt - 1] = fabs(static_cast<float>(cloud_[rand_ID].x - prev_point[0])
                                                  / x_ID_diff);
-              pixel_diff[1][rand_cnt - 1] = fabs(static_cast<float>(cloud_.points[rand_ID].y - prev_point[1])
+              pixel_diff[1][rand_cnt - 1] = fabs(static_cast<float>(cloud_[rand_ID].y - prev_point[1])
                                                  / y_ID_diff);
             }
           }
         }
         prev_ID = rand_ID;
-        prev_point[0] = cloud_.points[rand_ID].x;
-        prev_point[1] = cloud_.points[rand_ID].y;
+        prev_point[0] = cloud_[rand_ID].x;
+        prev_point[1] = cloud_[rand_ID].y;
         ++rand_cnt;
         ++escape_cnt;
       }
@@ -1587,18 +1610,31 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     return true;
   }
 
-  void PublishCloud(const std::vector<int>& idxs, const sensor_msgs::PointCloud& cloud_data,
+  // Copy the points with the given indices into the point matrix used by RANSAC
+  void GatherPoints(const std::vector<int>& idxs, const PointCloudView& cloud_data,
+                    RansacPoints* points) {
+    points->resize(idxs.size(), 4);
+    for (size_t i = 0; i < idxs.size(); ++i) {
+      geometry_msgs::Point32 point = cloud_data[idxs[i]];
+      (*points)(i, 0) = point.x;
+      (*points)(i, 1) = point.y;
+      (*points)(i, 2) = point.z;
+    }
+    points->col(3).setOnes();
+  }
+
+  void PublishCloud(const std::vector<int>& idxs, const PointCloudView& cloud_data,
                                     ros::Publisher* cloud_publisher) {
     if (!disp_pcd_and_tf_)
       return;
 
     sensor_msgs::PointCloud disp_cloud;
     disp_cloud.points.clear();
-    disp_cloud.header = cloud_data.header;
+    disp_cloud.header = cloud_data.header();
     disp_cloud.header.stamp = ros::Time::now();
     disp_cloud.points.reserve(idxs.size());
     for (auto const& itr : idxs) {
-      disp_cloud.points.push_back(cloud_data.points[itr]);
+      disp_cloud.points.push_back(cloud_data[itr]);
     }
     cloud_publisher->publish(disp_cloud);
   }
@@ -1612,7 +1648,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
     for (size_t i = 0; i < image_.data.size(); ++i) {
       int idx = (i % image_.height) * image_.width + i / image_.height;
       idx = ((idx / image_.width + 1) * image_.width - 1) - idx + (idx / image_.width) * image_.width;
-      float measure_dist = static_cast<float>(cloud_.points[i].z);
+      float measure_dist = static_cast<float>(cloud_[i].z);
       if (measure_dist == 0) {
         image_.data[idx] = 0;
       } else {
@@ -1790,6 +1826,7 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
   int RANSAC_plane_iteration_;
   float RANSAC_line_thres_;
   float RANSAC_plane_thres_;
+  float RANSAC_confidence_;
 
   // Frame name
   std::string body_frame_;
@@ -1800,8 +1837,12 @@ class HandrailDetect : public ff_util::FreeFlyerNodelet {
   Eigen::Affine3f r2i_;
   /// End of handrail_detect.config parameters
 
-  // Point cloud
-  sensor_msgs::PointCloud cloud_;
+  // Point cloud, viewed in place in the latest message
+  PointCloudView cloud_;
+
+  // Points and scorer for RANSAC, kept between frames to reuse their memory
+  RansacPoints ransac_points_;
+  RansacScorer scorer_;
 
   // Depth landmark msg
   ff_msgs::DepthLandmarks dl_;
@@ -0,0 +1,72 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <handrail_detect/point_cloud_view.h>
+
+#include <sensor_msgs/PointField.h>
+
+namespace handrail_detect {
+
+bool PointCloudView::Reset(const sensor_msgs::PointCloud2ConstPtr& msg) {
+  // only the points overwritten in the previous message need clearing
+  for (size_t i = 0; i < overlay_points_.size(); i++)
+    overlay_index_[overlay_points_[i]] = -1;
+  overlay_points_.clear();
+  overlay_.clear();
+
+  msg_ = msg;
+  data_ = NULL;
+  size_ = 0;
+  const char* names[3] = {"x", "y", "z"};
+  for (int f = 0; f < 3; f++) {
+    offset_[f] = -1;
+    for (size_t i = 0; i < msg->fields.size(); i++)
+      if (msg->fields[i].name == names[f] && msg->fields[i].datatype == sensor_msgs::PointField::FLOAT32)
+        offset_[f] = msg->fields[i].offset;
+    if (offset_[f] < 0)
+      return false;
+  }
+  size_t size = static_cast<size_t>(msg->width) * msg->height;
+  if (msg->data.size() < size * msg->point_step)
+    return false;
+
+  data_ = msg->data.data();
+  point_step_ = msg->point_step;
+  size_ = size;
+  if (static_cast<int>(overlay_index_.size()) < size_)
+    overlay_index_.resize(size_, -1);
+  return true;
+}
+
+void PointCloudView::Set(int i, const geometry_msgs::Point32& point) {
+  if (overlay_index_[i] < 0) {
+    overlay_index_[i] = overlay_.size();
+    overlay_.push_back(point);
+    overlay_points_.push_back(i);
+  } else {
+    overlay_[overlay_index_[i]] = point;
+  }
+}
+
+void PointCloudView::SetZ(int i, float z) {
+  geometry_msgs::Point32 point = (*this)[i];
+  point.z = z;
+  Set(i, point);
+}
+
+}  // namespace handrail_detect
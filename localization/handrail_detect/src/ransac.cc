@@ -0,0 +1,71 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <handrail_detect/ransac.h>
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace handrail_detect {
+
+// points scored per matrix product, small enough for the residuals to stay in cache
+static const int kBlock = 512;
+
+void RansacScorer::Score(const RansacPoints& points, const Models& models, int num_models,
+                         float threshold, Counts* counts) {
+  counts->fill(0);
+  if (residuals_.rows() != kBlock)
+    residuals_.resize(kBlock, kBatch);
+  for (int start = 0; start < points.rows(); start += kBlock) {
+    int n = std::min(kBlock, static_cast<int>(points.rows()) - start);
+    residuals_.topRows(n).noalias() = points.middleRows(start, n) * models;
+    for (int m = 0; m < num_models; m++)
+      (*counts)[m] += (residuals_.col(m).head(n).array().abs() < threshold).count();
+  }
+}
+
+void RansacScorer::Split(const RansacPoints& points, const std::vector<int>& ids,
+                         const Eigen::Vector4f& model, float threshold,
+                         std::vector<int>* inliers, std::vector<int>* outliers) {
+  Eigen::ArrayXf residuals = (points * model).array().abs();
+  inliers->clear();
+  if (outliers != NULL)
+    outliers->clear();
+  for (int i = 0; i < residuals.size(); i++) {
+    if (residuals[i] < threshold)
+      inliers->push_back(ids[i]);
+    else if (outliers != NULL)
+      outliers->push_back(ids[i]);
+  }
+}
+
+int RansacScorer::Iterations(int inliers, int total, int sample_size, float confidence,
+                             int max_iterations) {
+  if (total <= 0 || confidence <= 0 || confidence >= 1)
+    return max_iterations;
+  double p = pow(static_cast<double>(inliers) / total, sample_size);
+  if (p <= 0)
+    return max_iterations;
+  if (p >= 1)
+    return 1;
+  double n = ceil(log(1.0 - confidence) / log(1.0 - p));
+  return (n < max_iterations) ? static_cast<int>(n) : max_iterations;
+}
+
+}  // namespace handrail_detect
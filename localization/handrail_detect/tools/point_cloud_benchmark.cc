@@ -0,0 +1,180 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <handrail_detect/point_cloud_view.h>
+#include <handrail_detect/ransac.h>
+
+#include <sensor_msgs/PointCloud.h>
+#include <sensor_msgs/point_cloud_conversion.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <new>
+#include <random>
+#include <vector>
+
+// Times the first pass of the handrail detector over a perch cam sized cloud:
+// downsampling the points and gathering them for RANSAC, either after
+// converting the PointCloud2 to a PointCloud, as the detector used to, or
+// reading the message in place through a PointCloudView. Also counts the heap
+// allocations made per frame by each.
+//   point_cloud_benchmark [frames]
+
+typedef std::chrono::steady_clock Clock;
+
+// counts the calls to the global operator new, the default delete frees them
+static size_t allocations = 0, allocated_bytes = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  allocated_bytes += size;
+  void* p = malloc(size);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+
+static const int kWidth = 224, kHeight = 171, kStep = 2;
+static const float kMinDepth = 0.1, kMaxDepth = 1.5;
+
+// The sampling pattern of HandrailDetect::DownsamplePoints
+template <class Cloud>
+void Downsample(const Cloud& cloud, int size, std::vector<int>* samples) {
+  samples->clear();
+  int point_cnt = 0;
+  for (int i = 1; i < size; i += kStep) {
+    if ((i / kWidth) % kStep == 0) {
+      ++point_cnt;
+      if (point_cnt % 2 == 0) i += (kStep / 2) * kWidth;
+      if (point_cnt == 1) i += kStep / 2;
+      if (i >= size)
+        break;
+      geometry_msgs::Point32 point = cloud[i];
+      if (point.z < kMaxDepth && point.z > kMinDepth &&
+          !(std::isnan(point.x) || std::isnan(point.y) || std::isnan(point.z)))
+        samples->push_back(i);
+      if (point_cnt % 2 == 0)
+        i -= (kStep / 2) * kWidth;
+    } else {
+      point_cnt = 0;
+    }
+  }
+}
+
+template <class Cloud>
+void Gather(const Cloud& cloud, const std::vector<int>& samples, handrail_detect::RansacPoints* points) {
+  points->resize(samples.size(), 4);
+  for (size_t i = 0; i < samples.size(); i++) {
+    geometry_msgs::Point32 point = cloud[samples[i]];
+    (*points)(i, 0) = point.x;
+    (*points)(i, 1) = point.y;
+    (*points)(i, 2) = point.z;
+  }
+  points->col(3).setOnes();
+}
+
+// Indexing of the converted cloud, as the detector did
+struct ConvertedCloud {
+  const sensor_msgs::PointCloud& cloud;
+  const geometry_msgs::Point32& operator[](int i) const {
+    return cloud.points[i];
+  }
+};
+
+int main(int argc, char** argv) {
+  int frames = (argc > 1) ? atoi(argv[1]) : 100;
+
+  // A cloud laid out as the pico driver publishes it, with noise, gray value
+  // and confidence after x, y and z, and a few invalid points
+  struct DepthPoint {
+    float x, y, z, noise;
+    uint16_t gray;
+    uint8_t confidence;
+  };
+  sensor_msgs::PointCloud2Ptr msg(new sensor_msgs::PointCloud2());
+  msg->width = kWidth;
+  msg->height = kHeight;
+  msg->point_step = sizeof(DepthPoint);
+  msg->row_step = msg->width * msg->point_step;
+  msg->data.resize(msg->row_step * msg->height);
+  const char* names[3] = {"x", "y", "z"};
+  for (int f = 0; f < 3; f++) {
+    sensor_msgs::PointField field;
+    field.name = names[f];
+    field.offset = f * sizeof(float);
+    field.datatype = sensor_msgs::PointField::FLOAT32;
+    field.count = 1;
+    msg->fields.push_back(field);
+  }
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> uniform(0.0, 1.0);
+  for (int i = 0; i < kWidth * kHeight; i++) {
+    DepthPoint p = {0.0f, 0.0f, 0.0f, 0.0f, 0, 0};
+    if (uniform(generator) > 0.05) {
+      p.z = 0.5f + uniform(generator);
+      p.x = p.z * (i % kWidth - kWidth / 2) / 200.0f;
+      p.y = p.z * (i / kWidth - kHeight / 2) / 200.0f;
+    }
+    memcpy(&msg->data[i * msg->point_step], &p, sizeof(p));
+  }
+
+  sensor_msgs::PointCloud converted;
+  handrail_detect::PointCloudView view;
+  std::vector<int> samples[2];
+  handrail_detect::RansacPoints points[2];
+  double time[2] = {0.0, 0.0};
+  size_t calls[2] = {0, 0}, bytes[2] = {0, 0};
+  for (int frame = 0; frame < frames; frame++) {
+    // A new message every frame, as received from the driver
+    sensor_msgs::PointCloud2ConstPtr frame_msg(new sensor_msgs::PointCloud2(*msg));
+    for (int method = 0; method < 2; method++) {
+      size_t a = allocations, b = allocated_bytes;
+      Clock::time_point t0 = Clock::now();
+      if (method == 0) {
+        // converted into a cloud kept between frames, as the detector's member was
+        sensor_msgs::convertPointCloud2ToPointCloud(*frame_msg, converted);
+        ConvertedCloud cloud = {converted};
+        Downsample(cloud, converted.points.size(), &samples[0]);
+        Gather(cloud, samples[0], &points[0]);
+      } else {
+        view.Reset(frame_msg);
+        Downsample(view, view.size(), &samples[1]);
+        Gather(view, samples[1], &points[1]);
+      }
+      time[method] += std::chrono::duration<double>(Clock::now() - t0).count();
+      calls[method] += allocations - a;
+      bytes[method] += allocated_bytes - b;
+    }
+    if (samples[0] != samples[1] || points[0] != points[1]) {
+      fprintf(stderr, "Frame %d sampled differently when read in place.\n", frame);
+      return 1;
+    }
+  }
+
+  printf("%d frames of %d points, %zu sampled.\n", frames, kWidth * kHeight, samples[0].size());
+  printf("Converted: %.1f us, %.1f allocations, %.0f bytes per frame.\n", 1e6 * time[0] / frames,
+         static_cast<double>(calls[0]) / frames, static_cast<double>(bytes[0]) / frames);
+  printf("The converted cloud holds %zu bytes of points.\n",
+         converted.points.size() * sizeof(geometry_msgs::Point32));
+  printf("In place: %.1f us, %.1f allocations, %.0f bytes per frame.\n", 1e6 * time[1] / frames,
+         static_cast<double>(calls[1]) / frames, static_cast<double>(bytes[1]) / frames);
+  return 0;
+}
@@ -0,0 +1,131 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <handrail_detect/ransac.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Scores random plane hypotheses on a synthetic wall with a handrail, one
+// point at a time as the detector used to, and in batches with RansacScorer.
+// Checks that both agree and reports the time taken by each.
+//   ransac_benchmark [points] [hypotheses]
+
+typedef std::chrono::steady_clock Clock;
+
+struct Point {
+  float x, y, z;
+};
+
+int main(int argc, char** argv) {
+  int size = (argc > 1) ? atoi(argv[1]) : 9576;
+  int hypotheses = (argc > 2) ? atoi(argv[2]) : 1000;
+  const float threshold = 0.04;
+
+  // A wall one meter away, with a tenth of the points on a rail in front of it
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> uniform(-0.5, 0.5);
+  std::normal_distribution<float> noise(0.0, 0.01);
+  std::vector<Point> cloud(size);
+  std::vector<int> ids(size);
+  for (int i = 0; i < size; i++) {
+    cloud[i].x = uniform(generator);
+    cloud[i].y = (i % 10) ? uniform(generator) : 0.05f * uniform(generator);
+    cloud[i].z = ((i % 10) ? 1.0f : 0.9f) + noise(generator);
+    ids[i] = i;
+  }
+  handrail_detect::RansacPoints points(size, 4);
+  for (int i = 0; i < size; i++)
+    points.row(i) << cloud[i].x, cloud[i].y, cloud[i].z, 1;
+
+  // Plane hypotheses close to the wall
+  std::vector<Eigen::Vector4f> planes(hypotheses);
+  for (int h = 0; h < hypotheses; h++) {
+    planes[h] << 0.1f * uniform(generator), 0.1f * uniform(generator), 1, -1 - 0.1f * uniform(generator);
+    planes[h].normalize();
+  }
+
+  // Per point scoring, copying the inliers and outliers of every improvement
+  Clock::time_point t0 = Clock::now();
+  std::vector<int> reference(hypotheses), inliers, outliers;
+  for (int h = 0; h < hypotheses; h++) {
+    std::vector<int> tmp_inliers, tmp_outliers;
+    Eigen::Vector4f pnt_homo;
+    for (auto const& itr : ids) {
+      pnt_homo << cloud[itr].x, cloud[itr].y, cloud[itr].z, 1;
+      if ((pnt_homo.transpose() * planes[h]).norm() < threshold)
+        tmp_inliers.push_back(itr);
+      else
+        tmp_outliers.push_back(itr);
+    }
+    reference[h] = tmp_inliers.size();
+    if (tmp_inliers.size() > inliers.size()) {
+      inliers = tmp_inliers;
+      outliers = tmp_outliers;
+    }
+  }
+
+  // Batch scoring, splitting the points of the best plane once
+  Clock::time_point t1 = Clock::now();
+  handrail_detect::RansacScorer scorer;
+  handrail_detect::RansacScorer::Models models;
+  handrail_detect::RansacScorer::Counts counts;
+  std::vector<int> batch(hypotheses);
+  int best = 0;
+  for (int h = 0; h < hypotheses; h += handrail_detect::RansacScorer::kBatch) {
+    int n = std::min(handrail_detect::RansacScorer::kBatch, hypotheses - h);
+    for (int m = 0; m < n; m++)
+      models.col(m) = planes[h + m];
+    scorer.Score(points, models, n, threshold, &counts);
+    for (int m = 0; m < n; m++) {
+      batch[h + m] = counts[m];
+      if (counts[m] > batch[best])
+        best = h + m;
+    }
+  }
+  std::vector<int> batch_inliers, batch_outliers;
+  handrail_detect::RansacScorer::Split(points, ids, planes[best], threshold, &batch_inliers, &batch_outliers);
+  Clock::time_point t2 = Clock::now();
+
+  for (int h = 0; h < hypotheses; h++) {
+    // allow for rounding of points right on the threshold
+    if (abs(reference[h] - batch[h]) > 1) {
+      fprintf(stderr, "Hypothesis %d has %d inliers, %d when scored in batch.\n", h, reference[h], batch[h]);
+      return 1;
+    }
+  }
+  if (abs(static_cast<int>(inliers.size()) - static_cast<int>(batch_inliers.size())) > 1) {
+    fprintf(stderr, "Best plane has %zu inliers, %zu when scored in batch.\n", inliers.size(), batch_inliers.size());
+    return 1;
+  }
+
+  double reference_time = std::chrono::duration<double>(t1 - t0).count();
+  double batch_time = std::chrono::duration<double>(t2 - t1).count();
+  printf("Scored %d planes on %d points, %zu inliers. Per point: %.3f us, batch: %.3f us per plane.\n",
+         hypotheses, size, batch_inliers.size(), 1e6 * reference_time / hypotheses, 1e6 * batch_time / hypotheses);
+  printf("Iterations for 99%% confidence with 30%% / 50%% / 70%% inliers: %d / %d / %d.\n",
+         handrail_detect::RansacScorer::Iterations(3 * size / 10, size, 3, 0.99, 1000),
+         handrail_detect::RansacScorer::Iterations(5 * size / 10, size, 3, 0.99, 1000),
+         handrail_detect::RansacScorer::Iterations(7 * size / 10, size, 3, 0.99, 1000));
+  return 0;
+}
@@ -51,9 +51,11 @@ class LKOpticalFlow {
   void RefineCorners();
   void UpdateIdList(const size_t& num_itr);
 
+  // The downscaled frames, and their pyramids. Each pyramid is built once and
+  // used for the backward pass of its own frame and the forward pass of the next.
   cv::Mat image_curr_, image_prev_;
+  std::vector<cv::Mat> pyramid_curr_, pyramid_prev_;
 
-  sensor_msgs::ImageConstPtr image_prev_ptr_;
   std::vector<cv::Point2f> prev_corners_, curr_corners_, backwards_corners_;
 
   std::vector<uchar> status_, backwards_status_;
@@ -65,6 +67,9 @@ class LKOpticalFlow {
   int max_lk_pyr_level_;
   int max_lk_itr_;
   int max_gap_;
+  int grid_cols_, grid_rows_;
+  std::vector<int> grid_count_;
+  cv::Mat detect_mask_;
   float scale_factor_;
 
   float max_flow_magnitude_, font_size_, max_feature_rad_;
@@ -72,6 +77,7 @@ class LKOpticalFlow {
   std::vector<int> id_list_;
 
   camera::CameraParameters camera_param_;
+  Eigen::Matrix2Xd corners_;
 };
 }  // end namespace lk_optical_flow
 
@@ -27,6 +27,11 @@
 
 namespace lk_optical_flow {
 
+// Tracked corners closer than this to the border of the downscaled image, or
+// closer than the corner distance to both borders at a corner, are dropped
+constexpr int kBorderDist = 10;
+constexpr int kCornerDist = 60;
+
 LKOpticalFlow::LKOpticalFlow(void) :
   id_cnt_(0), camera_param_(Eigen::Vector2i::Zero(),
       Eigen::Vector2d::Ones(),
@@ -50,6 +55,10 @@ void LKOpticalFlow::ReadParams(config_reader::ConfigReader* config) {
     ROS_FATAL("Unspecified win_size_height.");
   if (!config->GetInt("max_feature", &max_feature))
     ROS_FATAL("Unspecified max_feature.");
+  if (!config->GetInt("detect_grid_cols", &grid_cols_))
+    ROS_FATAL("Unspecified detect_grid_cols.");
+  if (!config->GetInt("detect_grid_rows", &grid_rows_))
+    ROS_FATAL("Unspecified detect_grid_rows.");
   scale_factor_ = 2.0;
   max_feature_ = static_cast<size_t>(max_feature);
 
@@ -57,53 +66,56 @@ void LKOpticalFlow::ReadParams(config_reader::ConfigReader* config) {
   id_max_ = max_feature_ * 10000;
   ignored_last_frame_ = true;
   camera_param_ = camera::CameraParameters(config, "nav_cam");
+
+  // The pyramid depends on the window size and levels, so start over
+  pyramid_prev_.clear();
 }
 
 void LKOpticalFlow::OpticalFlow(const sensor_msgs::ImageConstPtr& msg,
                                   ff_msgs::Feature2dArray* features) {
   // Convert the ros image message type into cv::Mat
+  cv::Mat image;
   try {
-    image_curr_ = cv_bridge::toCvShare(msg, msg->encoding)->image;
+    image = cv_bridge::toCvShare(msg, msg->encoding)->image;
   } catch (cv_bridge::Exception& e) {
     ROS_ERROR("cv_bridge exception: %s", e.what());
     return;
   }
 
-  cv::resize(image_curr_, image_curr_, cv::Size(), 1.0 / scale_factor_, 1.0 / scale_factor_);
-  std::vector<cv::Point2f> new_corners;
-  GetNewFeatures(&new_corners);
-  if (!curr_corners_.empty()) {
+  // Downscale into our own buffer, and build the pyramid of the new frame
+  cv::resize(image, image_curr_, cv::Size(), 1.0 / scale_factor_, 1.0 / scale_factor_);
+  cv::buildOpticalFlowPyramid(image_curr_, pyramid_curr_, win_size_, max_lk_pyr_level_);
+  if (!prev_corners_.empty() && !pyramid_prev_.empty()) {
     // Run LK optical flow algorithm for consecutive image frames
     cv::TermCriteria termcrit(CV_TERMCRIT_ITER|CV_TERMCRIT_EPS, max_lk_itr_, 0.03);
-    cv::calcOpticalFlowPyrLK(image_prev_, image_curr_, prev_corners_, curr_corners_, status_, err_,
+    cv::calcOpticalFlowPyrLK(pyramid_prev_, pyramid_curr_, prev_corners_, curr_corners_, status_, err_,
                              win_size_, max_lk_pyr_level_, termcrit,
                              0, 0.001);
-    cv::calcOpticalFlowPyrLK(image_curr_, image_prev_, curr_corners_, backwards_corners_,
+    cv::calcOpticalFlowPyrLK(pyramid_curr_, pyramid_prev_, curr_corners_, backwards_corners_,
                              backwards_status_, backwards_err_, win_size_, max_lk_pyr_level_, termcrit,
                              0, 0.001);
 
     // Remove corners with false status and with large displacements
     RefineCorners();
-
-    // Add new corners from new_corners to maintain the maximum number of corners
-    AddNewFeatures(new_corners);
   } else {
-    // printf("COLD START!\n");
-    // Cold start, or we have all new features
-    curr_corners_ = new_corners;
-    prev_corners_ = new_corners;
-    UpdateIdList(curr_corners_.size());
+    // Cold start, or we lost all the features
+    curr_corners_.clear();
+    id_list_.clear();
   }
 
+  // Add new corners where the tracked corners have thinned out
+  std::vector<cv::Point2f> new_corners;
+  GetNewFeatures(&new_corners);
+  AddNewFeatures(new_corners);
+
   CreateFeatureArray(features);
   features->header.stamp = msg->header.stamp;
 
-  // Update previous features and image
+  // Update previous features, image and pyramid. The buffers of the old
+  // previous frame are reused for the next frame.
   prev_corners_ = curr_corners_;
-  // We swap and we also need to copy the ImageConstPtr so the data behind the
-  // cv::Mat will not be deallocated by the smart pointer.
-  image_prev_ptr_ = msg;
   cv::swap(image_prev_, image_curr_);
+  pyramid_prev_.swap(pyramid_curr_);
 }
 
 void LKOpticalFlow::GetNewFeatures(std::vector<cv::Point2f>* new_corners) {
@@ -116,11 +128,48 @@ void LKOpticalFlow::GetNewFeatures(std::vector<cv::Point2f>* new_corners) {
   if (curr_corners_.size() > 8 * max_feature_ / 10)
     return;
 
-  // Get new corners from LK
-  cv::goodFeaturesToTrack(image_curr_, *new_corners, 100, 0.01, max_gap_, cv::Mat(), 3, false, 0.04);
-  // printf("Get new corners.\n");
+  // Count the tracked corners in each cell of the detection grid. Each cell
+  // gets an equal share of the features, and corners are only detected in the
+  // cells that are short of their share, rather than over the whole image.
+  int cells = grid_cols_ * grid_rows_;
+  int share = (static_cast<int>(max_feature_) + cells - 1) / cells;
+  float cell_width = static_cast<float>(image_curr_.cols) / grid_cols_;
+  float cell_height = static_cast<float>(image_curr_.rows) / grid_rows_;
+  grid_count_.assign(cells, 0);
+  for (auto const& it : curr_corners_) {
+    int col = std::min(std::max(static_cast<int>(it.x / cell_width), 0), grid_cols_ - 1);
+    int row = std::min(std::max(static_cast<int>(it.y / cell_height), 0), grid_rows_ - 1);
+    grid_count_[row * grid_cols_ + col]++;
+  }
 
-  // printf("Found %lu new features, reduced to %lu.\n", raw_corners.size(), new_corners->size());
+  // Corners that RefineCorners would drop on the next frame are not detected,
+  // otherwise the cells at the corners of the image are refilled every frame
+  if (detect_mask_.size() != image_curr_.size()) {
+    int cols = image_curr_.cols, rows = image_curr_.rows;
+    detect_mask_ = cv::Mat::zeros(image_curr_.size(), CV_8UC1);
+    detect_mask_(cv::Rect(kBorderDist, kBorderDist, cols - 2 * kBorderDist,
+                          rows - 2 * kBorderDist)).setTo(cv::Scalar(255));
+    for (int y : {0, rows - kCornerDist})
+      for (int x : {0, cols - kCornerDist})
+        detect_mask_(cv::Rect(x, y, kCornerDist, kCornerDist)).setTo(cv::Scalar(0));
+  }
+
+  // A cell that is short of its share is asked for the whole share, because
+  // AddNewFeatures drops the corners that are too close to a tracked one
+  std::vector<cv::Point2f> cell_corners;
+  for (int row = 0; row < grid_rows_; row++) {
+    for (int col = 0; col < grid_cols_; col++) {
+      if (grid_count_[row * grid_cols_ + col] >= share)
+        continue;
+      int x0 = cvRound(col * cell_width), x1 = cvRound((col + 1) * cell_width);
+      int y0 = cvRound(row * cell_height), y1 = cvRound((row + 1) * cell_height);
+      cv::Rect cell(x0, y0, x1 - x0, y1 - y0);
+      cv::goodFeaturesToTrack(image_curr_(cell), cell_corners, share, 0.01, max_gap_,
+                              detect_mask_(cell), 3, false, 0.04);
+      for (auto const& it : cell_corners)
+        new_corners->push_back(cv::Point2f(it.x + x0, it.y + y0));
+    }
+  }
 }
 
 void LKOpticalFlow::AddNewFeatures(const std::vector<cv::Point2f>& new_corners) {
@@ -161,8 +210,8 @@ void LKOpticalFlow::RefineCorners() {
     bool too_far = cv::norm(prev_corners_[i] - curr_corners_[i]) > max_flow_magnitude_;
     int x_border_dist = std::min(curr_corners_[i].x, image_curr_.cols - curr_corners_[i].x);
     int y_border_dist = std::min(curr_corners_[i].y, image_curr_.rows - curr_corners_[i].y);
-    bool on_border = x_border_dist < 10 || y_border_dist < 10;
-    bool on_corner = x_border_dist < 60 && y_border_dist < 60;
+    bool on_border = x_border_dist < kBorderDist || y_border_dist < kBorderDist;
+    bool on_corner = x_border_dist < kCornerDist && y_border_dist < kCornerDist;
     bool backwards_ok = cv::norm(prev_corners_[i] - backwards_corners_[i]) < 0.5 &&
                         backwards_status_[i];
 
@@ -194,17 +243,17 @@ void LKOpticalFlow::UpdateIdList(const size_t& num_itr) {
 void LKOpticalFlow::CreateFeatureArray(ff_msgs::Feature2dArray* features) {
   features->header = std_msgs::Header();
   features->feature_array.resize(id_list_.size());
-  for (size_t i = 0; i < id_list_.size(); ++i) {
-    features->feature_array[i].id = id_list_[i];
 
-    // EKF expects measurements in the UNDISTORTED_C coordinate frame
-    Eigen::Vector2d undistorted_c;
-    camera_param_.Convert<camera::DISTORTED, camera::UNDISTORTED_C>
-    (Eigen::Vector2d(curr_corners_[i].x * scale_factor_, curr_corners_[i].y * scale_factor_),
-     &undistorted_c);
+  // EKF expects measurements in the UNDISTORTED_C coordinate frame
+  corners_.resize(2, id_list_.size());
+  for (size_t i = 0; i < id_list_.size(); ++i)
+    corners_.col(i) << curr_corners_[i].x * scale_factor_, curr_corners_[i].y * scale_factor_;
+  camera_param_.Convert<camera::DISTORTED, camera::UNDISTORTED_C>(corners_, &corners_);
 
-    features->feature_array[i].x = undistorted_c[0];
-    features->feature_array[i].y = undistorted_c[1];
+  for (size_t i = 0; i < id_list_.size(); ++i) {
+    features->feature_array[i].id = id_list_[i];
+    features->feature_array[i].x = corners_(0, i);
+    features->feature_array[i].y = corners_(1, i);
   }
 }
 
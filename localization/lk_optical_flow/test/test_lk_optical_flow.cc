@@ -0,0 +1,248 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Required for the test cases
+#include <ros/ros.h>
+
+#include <config_reader/config_reader.h>
+#include <lk_optical_flow/lk_optical_flow.h>
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+// The nav cam resolution, and the length of the sequence
+constexpr int kWidth = 1280;
+constexpr int kHeight = 960;
+constexpr int kFrames = 150;
+
+// Renders a sequence of nav cam frames of a textured wall, with the camera moving and rolling
+// slowly, as it does when the robot flies along a wall
+class Sequence {
+ public:
+  Sequence() : texture_(2 * kHeight, 2 * kWidth, CV_8UC1) {
+    cv::RNG rng(0x1f2e3d4c);
+    texture_.setTo(cv::Scalar(128));
+    for (int i = 0; i < 1500; i++) {
+      cv::Point center(rng.uniform(0, texture_.cols), rng.uniform(0, texture_.rows));
+      cv::Size size(rng.uniform(8, 60), rng.uniform(8, 60));
+      cv::RotatedRect rect(center, size, rng.uniform(0.f, 180.f));
+      cv::Point2f vertices[4];
+      rect.points(vertices);
+      std::vector<cv::Point> polygon(vertices, vertices + 4);
+      cv::fillConvexPoly(texture_, polygon, cv::Scalar(rng.uniform(0, 256)));
+    }
+    cv::GaussianBlur(texture_, texture_, cv::Size(5, 5), 1.0);
+  }
+
+  // The frame at an index, which moves by a few pixels and a fraction of a degree every frame, so
+  // that features leave the frame and have to be replaced within the sequence
+  cv::Mat Frame(int index) const {
+    cv::Point2f center(texture_.cols / 2.0f + 8.0f * index, texture_.rows / 2.0f + 4.0f * index);
+    cv::Mat warp = cv::getRotationMatrix2D(center, 0.3 * index, 1.0);
+    warp.at<double>(0, 2) -= center.x - kWidth / 2.0;
+    warp.at<double>(1, 2) -= center.y - kHeight / 2.0;
+    cv::Mat frame;
+    cv::warpAffine(texture_, frame, warp, cv::Size(kWidth, kHeight), cv::INTER_LINEAR);
+    return frame;
+  }
+
+ private:
+  cv::Mat texture_;
+};
+
+// The tracker as it was before the pyramids were reused: both pyramids are rebuilt by every
+// calcOpticalFlowPyrLK call, and corners are detected over the whole frame before tracking.
+class ReferenceFlow {
+ public:
+  explicit ReferenceFlow(config_reader::ConfigReader *config) : id_cnt_(0) {
+    int max_feature;
+    EXPECT_TRUE(config->GetReal("max_flow_magnitude", &max_flow_magnitude_));
+    EXPECT_TRUE(config->GetInt("max_lk_pyr_level", &max_lk_pyr_level_));
+    EXPECT_TRUE(config->GetInt("max_lk_itr", &max_lk_itr_));
+    EXPECT_TRUE(config->GetInt("max_gap", &max_gap_));
+    EXPECT_TRUE(config->GetInt("win_size_width", &win_size_.width));
+    EXPECT_TRUE(config->GetInt("win_size_height", &win_size_.height));
+    EXPECT_TRUE(config->GetInt("max_feature", &max_feature));
+    max_feature_ = static_cast<size_t>(max_feature);
+  }
+
+  // Track a frame, returning the ids of the tracked corners
+  std::vector<int> Track(cv::Mat const& frame) {
+    cv::resize(frame, image_curr_, cv::Size(), 0.5, 0.5);
+    std::vector<cv::Point2f> new_corners;
+    if (curr_corners_.size() < max_feature_ && curr_corners_.size() <= 8 * max_feature_ / 10)
+      cv::goodFeaturesToTrack(image_curr_, new_corners, 100, 0.01, max_gap_, cv::Mat(), 3, false, 0.04);
+    if (!curr_corners_.empty()) {
+      cv::TermCriteria termcrit(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, max_lk_itr_, 0.03);
+      std::vector<cv::Point2f> backwards_corners;
+      std::vector<uchar> status, backwards_status;
+      std::vector<float> err, backwards_err;
+      cv::calcOpticalFlowPyrLK(image_prev_, image_curr_, prev_corners_, curr_corners_, status, err,
+                               win_size_, max_lk_pyr_level_, termcrit, 0, 0.001);
+      cv::calcOpticalFlowPyrLK(image_curr_, image_prev_, curr_corners_, backwards_corners,
+                               backwards_status, backwards_err, win_size_, max_lk_pyr_level_, termcrit,
+                               0, 0.001);
+      size_t k = 0;
+      for (size_t i = 0; i < curr_corners_.size(); ++i) {
+        bool too_far = cv::norm(prev_corners_[i] - curr_corners_[i]) > max_flow_magnitude_;
+        int x_border_dist = std::min(curr_corners_[i].x, image_curr_.cols - curr_corners_[i].x);
+        int y_border_dist = std::min(curr_corners_[i].y, image_curr_.rows - curr_corners_[i].y);
+        bool on_border = x_border_dist < 10 || y_border_dist < 10;
+        bool on_corner = x_border_dist < 60 && y_border_dist < 60;
+        bool backwards_ok = cv::norm(prev_corners_[i] - backwards_corners[i]) < 0.5 &&
+                            backwards_status[i];
+        if (status[i] && !too_far && !on_border && !on_corner && backwards_ok) {
+          curr_corners_[k] = curr_corners_[i];
+          ids_[k] = ids_[i];
+          ++k;
+        }
+      }
+      curr_corners_.resize(k);
+      ids_.resize(k);
+      for (auto const& it1 : new_corners) {
+        if (curr_corners_.size() >= max_feature_)
+          break;
+        bool add_flag = true;
+        for (auto const& it2 : curr_corners_) {
+          if (cv::norm(it1 - it2) < max_gap_) {
+            add_flag = false;
+            break;
+          }
+        }
+        if (add_flag) {
+          curr_corners_.push_back(it1);
+          ids_.push_back(id_cnt_++);
+        }
+      }
+    } else {
+      curr_corners_ = new_corners;
+      for (size_t i = 0; i < curr_corners_.size(); ++i)
+        ids_.push_back(id_cnt_++);
+    }
+    prev_corners_ = curr_corners_;
+    cv::swap(image_prev_, image_curr_);
+    return ids_;
+  }
+
+ private:
+  cv::Mat image_curr_, image_prev_;
+  std::vector<cv::Point2f> prev_corners_, curr_corners_;
+  std::vector<int> ids_;
+  cv::Size win_size_;
+  size_t max_feature_;
+  int max_lk_pyr_level_, max_lk_itr_, max_gap_, id_cnt_;
+  double max_flow_magnitude_;
+};
+
+// Track counts and lifetimes over a sequence
+class Tracks {
+ public:
+  Tracks() : features_(0), frames_(0), seconds_(0.0) {}
+
+  void Add(std::vector<int> const& ids, double seconds) {
+    features_ += ids.size();
+    frames_++;
+    seconds_ += seconds;
+    for (int id : ids)
+      lifetime_[id]++;
+  }
+
+  // Mean number of features per frame
+  double Count() const {
+    return static_cast<double>(features_) / frames_;
+  }
+
+  // Mean number of frames a feature is tracked for
+  double Lifetime() const {
+    return static_cast<double>(features_) / lifetime_.size();
+  }
+
+  // Mean time to track a frame, in milliseconds
+  double Milliseconds() const {
+    return 1000.0 * seconds_ / frames_;
+  }
+
+ private:
+  std::map<int, int> lifetime_;
+  size_t features_, frames_;
+  double seconds_;
+};
+
+// Reusing the pyramids and detecting corners per grid cell keeps tracks for as long as the tracker
+// it replaced, on the same frames and with the flight configuration. The reference keeps a few more
+// tracks, because it takes every corner it detects on a cold start, beyond max_feature.
+TEST(lk_optical_flow, SameTracksAsReference) {
+  config_reader::ConfigReader config;
+  config.AddFile("optical_flow.config");
+  config.AddFile("cameras.config");
+  ASSERT_TRUE(config.ReadFiles());
+
+  lk_optical_flow::LKOpticalFlow flow;
+  flow.ReadParams(&config);
+  ReferenceFlow reference(&config);
+
+  Sequence sequence;
+  Tracks tracks_flow, tracks_reference;
+  for (int i = 0; i < kFrames; i++) {
+    cv::Mat frame = sequence.Frame(i);
+    std_msgs::Header header;
+    header.stamp = ros::Time(1.0 + i / 15.0);
+    sensor_msgs::ImageConstPtr msg = cv_bridge::CvImage(header, "mono8", frame).toImageMsg();
+
+    ff_msgs::Feature2dArray features;
+    ros::WallTime start = ros::WallTime::now();
+    flow.OpticalFlow(msg, &features);
+    double seconds = (ros::WallTime::now() - start).toSec();
+    std::vector<int> ids;
+    for (auto const& feature : features.feature_array)
+      ids.push_back(feature.id);
+    tracks_flow.Add(ids, seconds);
+
+    start = ros::WallTime::now();
+    ids = reference.Track(frame);
+    tracks_reference.Add(ids, (ros::WallTime::now() - start).toSec());
+  }
+
+  std::cout << "Features per frame " << tracks_flow.Count()
+            << " (reference " << tracks_reference.Count() << ")" << std::endl;
+  std::cout << "Frames per track " << tracks_flow.Lifetime()
+            << " (reference " << tracks_reference.Lifetime() << ")" << std::endl;
+  std::cout << "Time per frame " << tracks_flow.Milliseconds() << " ms"
+            << " (reference " << tracks_reference.Milliseconds() << " ms), speedup "
+            << tracks_reference.Milliseconds() / tracks_flow.Milliseconds()
+            << ". The time includes undistorting the features, which the reference skips." << std::endl;
+
+  EXPECT_GT(tracks_reference.Count(), 20.0);
+  EXPECT_GE(tracks_flow.Count(), 0.8 * tracks_reference.Count());
+  EXPECT_GE(tracks_flow.Lifetime(), 0.9 * tracks_reference.Lifetime());
+}
+
+// Required for the test framework
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_lk_optical_flow");
+  return RUN_ALL_TESTS();
+}
@@ -31,6 +31,7 @@
 
 #include <camera/camera_params.h>
 
+#include <opencv2/core/core.hpp>
 #include <opencv2/core/core_c.h>
 #include <alvar/Alvar.h>
 #include <alvar/Util.h>
@@ -45,9 +46,9 @@ namespace marker_tracking {
 class ALVAR_EXPORT Labeling {
  protected :
   /**
-   * \brief Pointer to binary image that is then labeled.
+   * \brief Binary image that is then labeled.
    */
-  IplImage *bw_;
+  cv::Mat bw_;
 
   camera::CameraParameters cam_;
   int thresh_param1_, thresh_param2_;
@@ -69,9 +70,27 @@ class ALVAR_EXPORT Labeling {
   /**
    * \brief Labels image and filters blobs to obtain square-shaped objects from the scene.
    */
-  virtual void LabelSquares(IplImage* image) = 0;
+  virtual void LabelSquares(cv::Mat const& image) = 0;
 
-  bool CheckBorder(CvSeq* contour, int width, int height);
+  /**
+   * \brief Labels only the given regions of the image. The regions should not
+   * overlap. Corners are in full image coordinates.
+   */
+  virtual void LabelSquares(cv::Mat const& image, std::vector<cv::Rect> const& rois) = 0;
+
+  /**
+   * \brief Labels the whole image, finding candidate squares at the top of an
+   * image pyramid with the given number of levels and then labeling only their
+   * regions, dilated by roi_dilation times their size, at full resolution.
+   */
+  virtual void LabelSquaresPyramid(cv::Mat const& image, int levels, float roi_dilation) = 0;
+
+  bool CheckBorder(std::vector<cv::Point> const& contour, int width, int height);
+
+  /**
+   * \brief Checks that no point of the contour is on the border of the region.
+   */
+  bool CheckBorder(std::vector<cv::Point> const& contour, cv::Rect const& roi);
 
   void SetThreshParams(int param1, int param2);
 
@@ -81,6 +100,62 @@ class ALVAR_EXPORT Labeling {
 
 /**
  * \brief Labeling class that uses OpenCV routines to find connected components.
+ *
+ * All the buffers are kept between frames, so once they have grown to the
+ * largest image and contour count seen, labeling does not allocate.
+ */
+class ALVAR_EXPORT LabelingCvMat : public Labeling {
+ protected :
+  int n_blobs_;
+  int min_edge_;
+  int min_area_;
+  // downsampled images, and the binary image of the smallest one
+  std::vector<cv::Mat> pyramid_;
+  cv::Mat pyramid_bw_;
+  // replicated border copy of a region and its integral image, for the threshold
+  cv::Mat padded_, integral_;
+  // contours of the last region
+  std::vector<std::vector<cv::Point> > contours_;
+  // contours long enough to be squares, from all regions, with their region,
+  // approximating polygon (empty if not a square) and fitted corners
+  size_t n_candidates_;
+  std::vector<std::vector<cv::Point> > candidates_;
+  std::vector<cv::Rect> candidate_rois_;
+  std::vector<std::vector<cv::Point> > polygons_;
+  std::vector<std::vector<alvar::PointDouble> > corners_;
+
+  // Thresholds a region with the mean of the block_size window around each
+  // pixel, exactly as cv::adaptiveThreshold with ADAPTIVE_THRESH_MEAN_C and
+  // THRESH_BINARY_INV, but with the means taken from an integral image
+  void AdaptiveThreshold(cv::Mat const& image, int block_size, int delta, cv::Mat* bw);
+  // Thresholds a region of an image at the given pyramid level and appends
+  // the contours long enough to be squares to the candidates
+  void FindCandidates(cv::Mat const& image, cv::Mat* bw, cv::Rect const& roi, int level);
+  // Approximates every candidate by a polygon, in parallel, keeping the four
+  // sided ones and fitting their corners if asked
+  void FindSquares(int level, bool fit_corners);
+  void FindSquare(size_t candidate, int level, bool fit_corners);
+  // Fits the corners of a square to the edges of its contour
+  void FitCorners(std::vector<cv::Point> const& contour, std::vector<cv::Point> const& square,
+                  std::vector<alvar::PointDouble>* corners);
+
+  class FindSquaresBody;
+
+ public:
+  explicit LabelingCvMat(camera::CameraParameters const& cam);
+  virtual ~LabelingCvMat();
+
+  void LabelSquares(cv::Mat const& image);
+  void LabelSquares(cv::Mat const& image, std::vector<cv::Rect> const& rois);
+  void LabelSquaresPyramid(cv::Mat const& image, int levels, float roi_dilation);
+};
+
+/**
+ * \brief The IplImage and CvSeq labeling that LabelingCvMat replaced.
+ *
+ * Kept as the reference LabelingCvMat is tested and timed against. It
+ * allocates its contours in a CvMemStorage that is cleared every frame, and
+ * labels the candidates one after another.
  */
 class ALVAR_EXPORT LabelingCvSeq : public Labeling {
  protected :
@@ -88,14 +163,34 @@ class ALVAR_EXPORT LabelingCvSeq : public Labeling {
   int min_edge_;
   int min_area_;
   CvMemStorage* storage_;
+  // downsampled images, and the binary image of the smallest one
+  std::vector<cv::Mat> pyramid_;
+  cv::Mat pyramid_bw_;
+
+  // Checks that no point of the contour is on the border of the region
+  static bool CheckSeqBorder(CvSeq* contour, CvRect const& roi);
+  // Appends the four sided contours found in a region of an image at the
+  // given pyramid level, and their approximating polygons, to the sequences
+  void FindSquares(cv::Mat const& image, cv::Mat* bw, CvRect const& roi, int level,
+                   CvSeq* squares, CvSeq* square_contours);
+  // Fits the corners of the squares into blob_corners
+  void FitCorners(CvSeq* squares, CvSeq* square_contours);
 
  public:
   explicit LabelingCvSeq(camera::CameraParameters const& cam);
   virtual ~LabelingCvSeq();
 
-  void LabelSquares(IplImage* image);
+  void LabelSquares(cv::Mat const& image);
+  void LabelSquares(cv::Mat const& image, std::vector<cv::Rect> const& rois);
+  void LabelSquaresPyramid(cv::Mat const& image, int levels, float roi_dilation);
 };
 
+/**
+ * \brief Grows rect by margin on every side, clips it to an image of the given
+ * size and adds it to rois, merged with any region it overlaps.
+ */
+void AddRoi(cv::Rect const& rect, int margin, cv::Size size, std::vector<cv::Rect>* rois);
+
 }  // namespace marker_tracking
 
 #endif  // MARKER_TRACKING_LABELLING_METHOD_H_
@@ -41,17 +41,44 @@ namespace marker_tracking {
   class MarkerCornerDetector {
    protected:
     std::vector<alvar::MarkerData> *markers_, *markers_old_;
-    marker_tracking::LabelingCvSeq labeling_;
+    marker_tracking::LabelingCvMat labeling_;
     alvar::Camera* alvar_cam_;
 
+    // Between full frame searches only the regions around the markers of the
+    // previous frame are labeled
+    int full_search_interval_;
+    int pyramid_levels_;
+    float roi_dilation_;
+    int frames_since_search_;
+    bool full_search_;
+    std::vector<cv::Rect> rois_;
+
+    // Matches the labeled squares to the previous markers, then decodes the
+    // remaining ones. Returns the number of previous markers found again.
+    size_t Identify(IplImage *image,
+                    float max_new_marker_error,
+                    float max_track_error);
+
    public:
     explicit MarkerCornerDetector(camera::CameraParameters const& camera);
     ~MarkerCornerDetector();
 
-    void Detect(IplImage *image,
+    void Detect(cv::Mat const& image,
                 float max_new_marker_error,
                 float max_track_error);
 
+    // Search the whole frame every full_search_interval frames, or when a
+    // marker is lost, and in between only the regions of the markers already
+    // found, dilated by roi_dilation times their size. Full searches start at
+    // the top of an image pyramid with pyramid_levels levels. The default of
+    // 1 and 0 searches every whole frame at full resolution.
+    void SetTracking(int full_search_interval, int pyramid_levels, float roi_dilation);
+
+    // Whether the last Detect searched the whole frame, and otherwise the
+    // regions that it labeled
+    bool FullSearch() const;
+    std::vector<cv::Rect> const& Regions() const;
+
     size_t NumMarkers() const;
     alvar::MarkerData& GetMarker(size_t i) const;
 
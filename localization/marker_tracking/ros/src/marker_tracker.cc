@@ -45,6 +45,7 @@ MarkerTracker::MarkerTracker(ros::NodeHandle* nh, ros::NodeHandle* private_nh,
                     Eigen::Vector2d::Ones(),  // default constructor
                     Eigen::Vector2d::Zero()) {
   config_.AddFile("cameras.config");
+  config_.AddFile("localization/marker_tracking.config");
   ReadParams();
 
   // Resolve the full path to the AR tag file specified for the current world
@@ -105,6 +106,17 @@ void MarkerTracker::ReadParams(void) {
 
   camera_param_ = camera::CameraParameters(&config_, "dock_cam");
   detector_.reset(new marker_tracking::MarkerCornerDetector(camera_param_));
+
+  // Track the markers between searches of the whole frame
+  int full_search_interval, pyramid_levels;
+  float roi_dilation;
+  if (!config_.GetInt("ar_full_search_interval", &full_search_interval, 1, 1000) ||
+      !config_.GetInt("ar_pyramid_levels", &pyramid_levels, 0, 4) ||
+      !config_.GetReal("ar_roi_dilation", &roi_dilation, 0.0, 10.0)) {
+    ROS_ERROR("Cannot read AR marker tracking parameters, searching every whole frame.");
+    return;
+  }
+  detector_->SetTracking(full_search_interval, pyramid_levels, roi_dilation);
 }
 
 bool MarkerTracker::EnableService(ff_msgs::SetBool::Request& req,
@@ -185,10 +197,9 @@ void MarkerTracker::VideoCallback(const sensor_msgs::ImageConstPtr& image_msg) {
   // Convert the image
   cv_bridge::CvImageConstPtr cv_ptr_ =
       cv_bridge::toCvShare(image_msg, sensor_msgs::image_encodings::MONO8);
-  IplImage ipl_image = cv_ptr_->image;
 
   // Detect our AR Tags
-  detector_->Detect(&ipl_image, 0.08, 0.2);
+  detector_->Detect(cv_ptr_->image, 0.08, 0.2);
 
   // No markers? Early exit.
   if (!detector_->NumMarkers()) return;
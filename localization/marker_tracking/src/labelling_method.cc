@@ -25,23 +25,30 @@
 
 #include <Eigen/Core>
 #include <alvar/Line.h>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/imgproc/imgproc_c.h>
+
+#include <algorithm>
 
 marker_tracking::Labeling::Labeling(camera::CameraParameters const& cam) :
-  bw_(NULL), cam_(cam) {
+  cam_(cam) {
   thresh_param1_ = 31;
   thresh_param2_ = 5;
 }
 
 marker_tracking::Labeling::~Labeling() {
-  if (bw_)
-    cvReleaseImage(&bw_);
 }
 
-bool marker_tracking::Labeling::CheckBorder(CvSeq* contour, int width, int height) {
+bool marker_tracking::Labeling::CheckBorder(std::vector<cv::Point> const& contour, int width, int height) {
+  return CheckBorder(contour, cv::Rect(0, 0, width, height));
+}
+
+bool marker_tracking::Labeling::CheckBorder(std::vector<cv::Point> const& contour, cv::Rect const& roi) {
   bool ret = true;
-  for (int i = 0; i < contour->total; ++i) {
-    CvPoint* pt = reinterpret_cast<CvPoint*>(cvGetSeqElem(contour, i));
-    if ((pt->x <= 1) || (pt->x >= width-2) || (pt->y <= 1) || (pt->y >= height-2)) ret = false;
+  for (size_t i = 0; i < contour.size(); ++i) {
+    cv::Point const& pt = contour[i];
+    if ((pt.x <= roi.x + 1) || (pt.x >= roi.x + roi.width - 2) ||
+        (pt.y <= roi.y + 1) || (pt.y >= roi.y + roi.height - 2)) ret = false;
   }
   return ret;
 }
@@ -51,6 +58,223 @@ void marker_tracking::Labeling::SetThreshParams(int param1, int param2) {
   thresh_param2_ = param2;
 }
 
+// Approximates a range of candidates, on the OpenCV worker threads. Every
+// candidate only writes its own polygon and corners.
+class marker_tracking::LabelingCvMat::FindSquaresBody : public cv::ParallelLoopBody {
+ public:
+  FindSquaresBody(LabelingCvMat* labeling, int level, bool fit_corners) :
+    labeling_(labeling), level_(level), fit_corners_(fit_corners) {}
+
+  void operator()(cv::Range const& range) const {
+    for (int i = range.start; i < range.end; ++i)
+      labeling_->FindSquare(i, level_, fit_corners_);
+  }
+
+ private:
+  LabelingCvMat* labeling_;
+  int level_;
+  bool fit_corners_;
+};
+
+marker_tracking::LabelingCvMat::LabelingCvMat(camera::CameraParameters const& cam) :
+  Labeling(cam), n_blobs_(0), min_edge_(20), min_area_(25), n_candidates_(0) {
+}
+
+marker_tracking::LabelingCvMat::~LabelingCvMat() {
+}
+
+void marker_tracking::LabelingCvMat::LabelSquares(cv::Mat const& image) {
+  LabelSquares(image, std::vector<cv::Rect>(1, cv::Rect(0, 0, image.cols, image.rows)));
+}
+
+void marker_tracking::LabelingCvMat::LabelSquares(cv::Mat const& image, std::vector<cv::Rect> const& rois) {
+  assert(image.type() == CV_8UC1);
+  bw_.create(image.size(), CV_8UC1);
+
+  // Threshold every region, then find the squares among all their contours
+  n_candidates_ = 0;
+  for (size_t i = 0; i < rois.size(); ++i)
+    FindCandidates(image, &bw_, rois[i], 0);
+  FindSquares(0, true);
+
+  // Keep the corners of the squares in contour order. Assigning to the
+  // previous corner vectors reuses their storage.
+  n_blobs_ = 0;
+  for (size_t i = 0; i < n_candidates_; ++i)
+    if (!polygons_[i].empty()) n_blobs_++;
+  blob_corners.resize(n_blobs_);
+  for (size_t i = 0, b = 0; i < n_candidates_; ++i)
+    if (!polygons_[i].empty()) blob_corners[b++] = corners_[i];
+}
+
+void marker_tracking::LabelingCvMat::LabelSquaresPyramid(cv::Mat const& image, int levels, float roi_dilation) {
+  if (levels <= 0) {
+    LabelSquares(image);
+    return;
+  }
+  assert(image.type() == CV_8UC1);
+
+  // Downsample, reusing the images of the previous frame when the sizes match
+  if (static_cast<int>(pyramid_.size()) < levels)
+    pyramid_.resize(levels);
+  cv::Mat const* top = &image;
+  for (int l = 0; l < levels; ++l) {
+    cv::pyrDown(*top, pyramid_[l]);
+    top = &pyramid_[l];
+  }
+  pyramid_bw_.create(top->size(), CV_8UC1);
+
+  // Find the candidate squares at the top level
+  n_candidates_ = 0;
+  FindCandidates(*top, &pyramid_bw_, cv::Rect(0, 0, top->cols, top->rows), levels);
+  FindSquares(levels, false);
+
+  // and label their regions at full resolution
+  std::vector<cv::Rect> rois;
+  int scale = 1 << levels;
+  for (size_t i = 0; i < n_candidates_; ++i) {
+    if (polygons_[i].empty()) continue;
+    cv::Rect r = cv::boundingRect(polygons_[i]);
+    r = cv::Rect(r.x * scale, r.y * scale, r.width * scale, r.height * scale);
+    int margin = scale + static_cast<int>(roi_dilation * std::max(r.width, r.height));
+    AddRoi(r, margin, image.size(), &rois);
+  }
+  LabelSquares(image, rois);
+}
+
+void marker_tracking::LabelingCvMat::AdaptiveThreshold(cv::Mat const& image, int block_size, int delta,
+                                                       cv::Mat* bw) {
+  // The buffers only grow, and every region uses their top left corner
+  int r = block_size / 2;
+  cv::Size size(image.cols + 2 * r, image.rows + 2 * r);
+  if (padded_.cols < size.width || padded_.rows < size.height) {
+    padded_.create(std::max(padded_.rows, size.height), std::max(padded_.cols, size.width), CV_8UC1);
+    integral_.create(padded_.rows + 1, padded_.cols + 1, CV_32SC1);
+  }
+  cv::Mat padded = padded_(cv::Rect(0, 0, size.width, size.height));
+  cv::Mat integral = integral_(cv::Rect(0, 0, size.width + 1, size.height + 1));
+  cv::copyMakeBorder(image, padded, r, r, r, r, cv::BORDER_REPLICATE | cv::BORDER_ISOLATED);
+  cv::integral(padded, integral, CV_32S);
+
+  // As in cv::adaptiveThreshold, the mean is rounded to a byte and a pixel is
+  // set when it is at least delta below it
+  double scale = 1.0 / (block_size * block_size);
+  for (int y = 0; y < image.rows; ++y) {
+    const int* top = integral.ptr<int>(y);
+    const int* bottom = integral.ptr<int>(y + block_size);
+    const uchar* src = image.ptr<uchar>(y);
+    uchar* dst = bw->ptr<uchar>(y);
+    for (int x = 0; x < image.cols; ++x) {
+      int sum = bottom[x + block_size] - bottom[x] - top[x + block_size] + top[x];
+      int mean = cv::saturate_cast<uchar>(sum * scale);
+      dst[x] = (src[x] - mean <= -delta) ? 255 : 0;
+    }
+  }
+}
+
+void marker_tracking::LabelingCvMat::FindCandidates(cv::Mat const& image, cv::Mat* bw, cv::Rect const& roi,
+                                                    int level) {
+  // The threshold window and the size limits shrink with the pyramid level
+  int block_size = std::max(3, (thresh_param1_ >> level) | 1);
+  int min_edge = min_edge_ >> level;
+
+  // Headers on the region, leaving the images themselves untouched
+  cv::Mat roi_bw = (*bw)(roi);
+  AdaptiveThreshold(image(roi), block_size, thresh_param2_, &roi_bw);
+
+  // Contours are offset by the region origin, so they are in image coordinates
+  cv::findContours(roi_bw, contours_, cv::RETR_LIST, cv::CHAIN_APPROX_NONE, roi.tl());
+
+  // Swapping hands the contour to the candidate and its old storage back to
+  // the contour buffer for the next region
+  for (size_t c = 0; c < contours_.size(); ++c) {
+    if (static_cast<int>(contours_[c].size()) < min_edge) continue;
+    if (candidates_.size() <= n_candidates_) {
+      candidates_.resize(n_candidates_ + 1);
+      candidate_rois_.resize(n_candidates_ + 1);
+      polygons_.resize(n_candidates_ + 1);
+      corners_.resize(n_candidates_ + 1);
+    }
+    candidates_[n_candidates_].swap(contours_[c]);
+    candidate_rois_[n_candidates_] = roi;
+    n_candidates_++;
+  }
+}
+
+void marker_tracking::LabelingCvMat::FindSquares(int level, bool fit_corners) {
+  cv::parallel_for_(cv::Range(0, static_cast<int>(n_candidates_)), FindSquaresBody(this, level, fit_corners));
+}
+
+void marker_tracking::LabelingCvMat::FindSquare(size_t candidate, int level, bool fit_corners) {
+  int min_area = min_area_ >> (2 * level);
+  std::vector<cv::Point> const& contour = candidates_[candidate];
+  std::vector<cv::Point>& square = polygons_[candidate];
+
+  cv::approxPolyDP(contour, square, cv::arcLength(contour, true) * 0.035, true);
+  if (square.size() != 4 || !CheckBorder(square, candidate_rois_[candidate]) ||
+      fabs(cv::contourArea(square)) <= min_area || !cv::isContourConvex(square)) {
+    square.clear();
+    return;
+  }
+  if (fit_corners)
+    FitCorners(contour, square, &corners_[candidate]);
+}
+
+void marker_tracking::LabelingCvMat::FitCorners(std::vector<cv::Point> const& contour,
+                                                std::vector<cv::Point> const& square,
+                                                std::vector<alvar::PointDouble>* corners) {
+  // Undistort the whole contour at once
+  int total = contour.size();
+  Eigen::Matrix2Xd undistorted(2, total);
+  for (int k = 0; k < total; k++)
+    undistorted.col(k) << contour[k].x, contour[k].y;
+  cam_.Convert<camera::DISTORTED, camera::UNDISTORTED>(undistorted, &undistorted);
+
+  std::vector<alvar::Line> fitted_lines(4);
+  std::vector<cv::Point2f> line_data;
+  line_data.reserve(total);
+  for (int j = 0; j < 4; ++j) {
+    cv::Point const& pt0 = square[j];
+    cv::Point const& pt1 = square[(j+1)%4];
+    int k0 = -1, k1 = -1;
+    for (int k = 0; k < total; k++) {
+      if (contour[k] == pt0) k0 = k;
+      if (contour[k] == pt1) k1 = k;
+    }
+    int len;
+    if (k1 >= k0)
+      len = k1 - k0 - 1;  // neither k0 nor k1 are included
+    else
+      len = total - k0 + k1 - 1;
+    if (len == 0) len = 1;
+
+    line_data.resize(len);
+    for (int l = 0; l < len; l++) {
+      int ll = (k0 + l + 1) % total;
+      line_data[l] = cv::Point2f(undistorted(0, ll), undistorted(1, ll));
+    }
+
+    // Fit edge and put to vector of edges
+    cv::Vec4f params;
+    cv::fitLine(line_data, params, cv::DIST_L2, 0, 0.01, 0.01);
+    fitted_lines[j] = alvar::Line(params.val);
+  }
+
+  // Calculated four intersection points
+  corners->resize(4);
+  for (size_t j = 0; j < 4; ++j) {
+    alvar::PointDouble intc = alvar::Intersection(fitted_lines[j], fitted_lines[(j + 1) % 4]);
+
+    Eigen::Vector2d distorted;
+    cam_.Convert<camera::UNDISTORTED, camera::DISTORTED>(Eigen::Vector2d(intc.x, intc.y), &distorted);
+    intc.x = distorted[0];
+    intc.y = distorted[1];
+
+    // Should we make this always counter-clockwise or clockwise?
+    (*corners)[j] = intc;
+  }
+}
+
 marker_tracking::LabelingCvSeq::LabelingCvSeq(camera::CameraParameters const& cam) :
   Labeling(cam), n_blobs_(0), min_edge_(20), min_area_(25) {
   storage_ = cvCreateMemStorage(0);
@@ -61,25 +285,93 @@ marker_tracking::LabelingCvSeq::~LabelingCvSeq() {
     cvReleaseMemStorage(&storage_);
 }
 
-void marker_tracking::LabelingCvSeq::LabelSquares(IplImage* image) {
-  if (bw_ == NULL) {
-    bw_ = cvCreateImage(cvSize(image->width, image->height), IPL_DEPTH_8U, 1);
+bool marker_tracking::LabelingCvSeq::CheckSeqBorder(CvSeq* contour, CvRect const& roi) {
+  bool ret = true;
+  for (int i = 0; i < contour->total; ++i) {
+    CvPoint* pt = reinterpret_cast<CvPoint*>(cvGetSeqElem(contour, i));
+    if ((pt->x <= roi.x + 1) || (pt->x >= roi.x + roi.width - 2) ||
+        (pt->y <= roi.y + 1) || (pt->y >= roi.y + roi.height - 2)) ret = false;
   }
+  return ret;
+}
 
-  // Convert grayscale and threshold
-  assert(image->nChannels == 1);
+void marker_tracking::LabelingCvSeq::LabelSquares(cv::Mat const& image) {
+  LabelSquares(image, std::vector<cv::Rect>(1, cv::Rect(0, 0, image.cols, image.rows)));
+}
 
-  cvAdaptiveThreshold(image, bw_, 255, CV_ADAPTIVE_THRESH_MEAN_C, CV_THRESH_BINARY_INV, thresh_param1_, thresh_param2_);
+void marker_tracking::LabelingCvSeq::LabelSquares(cv::Mat const& image, std::vector<cv::Rect> const& rois) {
+  assert(image.type() == CV_8UC1);
+  bw_.create(image.size(), CV_8UC1);
 
-  CvSeq* contours;
+  // Threshold and find the squares in every region
   CvSeq* squares = cvCreateSeq(0, sizeof(CvSeq), sizeof(CvSeq), storage_);
   CvSeq* square_contours = cvCreateSeq(0, sizeof(CvSeq), sizeof(CvSeq), storage_);
+  for (size_t i = 0; i < rois.size(); ++i)
+    FindSquares(image, &bw_, rois[i], 0, squares, square_contours);
+  FitCorners(squares, square_contours);
 
-  cvFindContours(bw_, storage_, &contours, sizeof(CvContour),
-                 CV_RETR_LIST, CV_CHAIN_APPROX_NONE, cvPoint(0, 0));
+  cvClearMemStorage(storage_);
+}
+
+void marker_tracking::LabelingCvSeq::LabelSquaresPyramid(cv::Mat const& image, int levels, float roi_dilation) {
+  if (levels <= 0) {
+    LabelSquares(image);
+    return;
+  }
+  assert(image.type() == CV_8UC1);
+
+  // Downsample, reusing the images of the previous frame when the sizes match
+  if (static_cast<int>(pyramid_.size()) < levels)
+    pyramid_.resize(levels);
+  cv::Mat const* top = &image;
+  for (int l = 0; l < levels; ++l) {
+    pyramid_[l].create(cv::Size((top->cols + 1) / 2, (top->rows + 1) / 2), CV_8UC1);
+    IplImage src = *top, dst = pyramid_[l];
+    cvPyrDown(&src, &dst, CV_GAUSSIAN_5x5);
+    top = &pyramid_[l];
+  }
+  pyramid_bw_.create(top->size(), CV_8UC1);
+
+  // Find the candidate squares at the top level
+  CvSeq* squares = cvCreateSeq(0, sizeof(CvSeq), sizeof(CvSeq), storage_);
+  CvSeq* square_contours = cvCreateSeq(0, sizeof(CvSeq), sizeof(CvSeq), storage_);
+  FindSquares(*top, &pyramid_bw_, cvRect(0, 0, top->cols, top->rows), levels, squares, square_contours);
+
+  // and label their regions at full resolution
+  std::vector<cv::Rect> rois;
+  int scale = 1 << levels;
+  for (int i = 0; i < squares->total; ++i) {
+    cv::Rect r = cvBoundingRect(cvGetSeqElem(squares, i), 0);
+    r = cv::Rect(r.x * scale, r.y * scale, r.width * scale, r.height * scale);
+    int margin = scale + static_cast<int>(roi_dilation * std::max(r.width, r.height));
+    AddRoi(r, margin, image.size(), &rois);
+  }
+  cvClearMemStorage(storage_);
+  LabelSquares(image, rois);
+}
+
+void marker_tracking::LabelingCvSeq::FindSquares(cv::Mat const& image, cv::Mat* bw, CvRect const& roi, int level,
+                                                 CvSeq* squares, CvSeq* square_contours) {
+  // The threshold window and the size limits shrink with the pyramid level
+  int block_size = std::max(3, (thresh_param1_ >> level) | 1);
+  int min_edge = min_edge_ >> level;
+  int min_area = min_area_ >> (2 * level);
+
+  // Headers on the region, leaving the images themselves untouched
+  CvMat full_image = image, full_bw = *bw;
+  CvMat roi_image, roi_bw;
+  cvGetSubRect(&full_image, &roi_image, roi);
+  cvGetSubRect(&full_bw, &roi_bw, roi);
+  cvAdaptiveThreshold(&roi_image, &roi_bw, 255, CV_ADAPTIVE_THRESH_MEAN_C, CV_THRESH_BINARY_INV,
+                      block_size, thresh_param2_);
+
+  // Contours are offset by the region origin, so they are in image coordinates
+  CvSeq* contours = NULL;
+  cvFindContours(&roi_bw, storage_, &contours, sizeof(CvContour),
+                 CV_RETR_LIST, CV_CHAIN_APPROX_NONE, cvPoint(roi.x, roi.y));
 
   while (contours) {
-    if (contours->total < min_edge_) {
+    if (contours->total < min_edge) {
       contours = contours->h_next;
       continue;
     }
@@ -87,15 +379,17 @@ void marker_tracking::LabelingCvSeq::LabelSquares(IplImage* image) {
     CvSeq* result = cvApproxPoly(contours, sizeof(CvContour), storage_,
                                  CV_POLY_APPROX_DP, cvContourPerimeter(contours) * 0.035, 0);
 
-    if ( result->total == 4 && CheckBorder(result, image->width, image->height) &&
-         fabs(cvContourArea(result, CV_WHOLE_SEQ)) > min_area_ &&
+    if ( result->total == 4 && CheckSeqBorder(result, roi) &&
+         fabs(cvContourArea(result, CV_WHOLE_SEQ)) > min_area &&
          cvCheckContourConvexity(result) ) {
       cvSeqPush(squares, result);
       cvSeqPush(square_contours, contours);
     }
     contours = contours->h_next;
   }
+}
 
+void marker_tracking::LabelingCvSeq::FitCorners(CvSeq* squares, CvSeq* square_contours) {
   n_blobs_ = squares->total;
   blob_corners.resize(n_blobs_);
 
@@ -153,15 +447,31 @@ void marker_tracking::LabelingCvSeq::LabelSquares(IplImage* image) {
       intc.x = distorted[0];
       intc.y = distorted[1];
 
-      // Should we make this always counter-clockwise or clockwise?
-      /*
-        if (image->origin && j == 1) blob_corners[i][3] = intc;
-        else if (image->origin && j == 3) blob_corners[i][1] = intc;
-        else blob_corners[i][j] = intc;
-      */
       blob_corners[i][j] = intc;
     }
   }
+}
 
-  cvClearMemStorage(storage_);
+void marker_tracking::AddRoi(cv::Rect const& rect, int margin, cv::Size size, std::vector<cv::Rect>* rois) {
+  int x0 = std::max(rect.x - margin, 0);
+  int y0 = std::max(rect.y - margin, 0);
+  int x1 = std::min(rect.x + rect.width + margin, size.width);
+  int y1 = std::min(rect.y + rect.height + margin, size.height);
+  if (x1 <= x0 || y1 <= y0)
+    return;
+  // Merge with the regions it overlaps, starting over as the merged region grows
+  for (size_t i = 0; i < rois->size(); ) {
+    cv::Rect const& r = (*rois)[i];
+    if (x0 < r.x + r.width && r.x < x1 && y0 < r.y + r.height && r.y < y1) {
+      x0 = std::min(x0, r.x);
+      y0 = std::min(y0, r.y);
+      x1 = std::max(x1, r.x + r.width);
+      y1 = std::max(y1, r.y + r.height);
+      rois->erase(rois->begin() + i);
+      i = 0;
+    } else {
+      ++i;
+    }
+  }
+  rois->push_back(cv::Rect(x0, y0, x1 - x0, y1 - y0));
 }
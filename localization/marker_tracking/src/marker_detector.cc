@@ -25,12 +25,17 @@
 #include <alvar/ConnectedComponents.h>
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <vector>
 
 namespace marker_tracking {
 
+// pixels added around the regions of tracked markers, on top of the dilation
+static const int kMinRoiMargin = 8;
+
 MarkerCornerDetector::MarkerCornerDetector(camera::CameraParameters const& camera) :
-  labeling_(camera) {
+  labeling_(camera), full_search_interval_(1), pyramid_levels_(0), roi_dilation_(0.5),
+  frames_since_search_(0), full_search_(false) {
   markers_ = new std::vector<alvar::MarkerData>();
   markers_old_ = new std::vector<alvar::MarkerData>();
   alvar_cam_ = new alvar::Camera();
@@ -44,15 +49,70 @@ MarkerCornerDetector::~MarkerCornerDetector() {
   if (alvar_cam_) delete alvar_cam_;
 }
 
-void MarkerCornerDetector::Detect(IplImage *image,
+void MarkerCornerDetector::SetTracking(int full_search_interval, int pyramid_levels, float roi_dilation) {
+  full_search_interval_ = full_search_interval;
+  pyramid_levels_ = pyramid_levels;
+  roi_dilation_ = roi_dilation;
+}
+
+void MarkerCornerDetector::Detect(cv::Mat const& image,
                                   float max_new_marker_error,
                                   float max_track_error) {
-  assert(image->origin == 0);
+  // ALVAR reads the marker content from an IplImage header on the same pixels
+  IplImage ipl_image = image;
   std::swap(markers_, markers_old_);
   markers_->clear();
 
-  labeling_.LabelSquares(image);
+  // Look for the markers of the previous frame around where they were
+  bool full_search = (++frames_since_search_ >= full_search_interval_);
+  if (!full_search) {
+    size_t tracked = 0;
+    rois_.clear();
+    for (size_t m = 0; m < markers_old_->size(); m++) {
+      alvar::MarkerData* marker = &markers_old_->operator[](m);
+      if (marker->GetError(alvar::Marker::DECODE_ERROR | alvar::Marker::MARGIN_ERROR) > 0) continue;
+      std::vector<alvar::PointDouble> const& corners = marker->marker_corners_img;
+      double x0 = image.cols, y0 = image.rows, x1 = 0, y1 = 0;
+      for (size_t c = 0; c < corners.size(); c++) {
+        x0 = std::min(x0, corners[c].x);
+        y0 = std::min(y0, corners[c].y);
+        x1 = std::max(x1, corners[c].x);
+        y1 = std::max(y1, corners[c].y);
+      }
+      if (x1 < x0 || y1 < y0) continue;
+      cv::Rect r(static_cast<int>(floor(x0)), static_cast<int>(floor(y0)),
+                 static_cast<int>(ceil(x1 - x0)) + 1, static_cast<int>(ceil(y1 - y0)) + 1);
+      int margin = kMinRoiMargin + static_cast<int>(roi_dilation_ * std::max(r.width, r.height));
+      AddRoi(r, margin, image.size(), &rois_);
+      tracked++;
+    }
+
+    // Nothing to track, or a marker left its region: search the whole frame
+    if (tracked == 0) {
+      full_search = true;
+    } else {
+      labeling_.LabelSquares(image, rois_);
+      if (Identify(&ipl_image, max_new_marker_error, max_track_error) < tracked) {
+        markers_->clear();
+        full_search = true;
+      }
+    }
+  }
+
+  full_search_ = full_search;
+  if (full_search) {
+    frames_since_search_ = 0;
+    rois_.clear();
+    labeling_.LabelSquaresPyramid(image, pyramid_levels_, roi_dilation_);
+    Identify(&ipl_image, max_new_marker_error, max_track_error);
+  }
+}
+
+size_t MarkerCornerDetector::Identify(IplImage *image,
+                                      float max_new_marker_error,
+                                      float max_track_error) {
   std::vector<std::vector<alvar::PointDouble> >& blob_corners = labeling_.blob_corners;
+  size_t tracked = 0;
 
   int orientation;
   double error;
@@ -89,6 +149,7 @@ void MarkerCornerDetector::Detect(IplImage *image,
       marker->UpdatePose(blob_corners[track_b], NULL, track_orientation, 0 /*frame num*/, false/*update pose*/);
       markers_->push_back(*marker);  // copy I guess
       blob_corners[track_b].clear();
+      tracked++;
     }
   }
 
@@ -116,6 +177,15 @@ void MarkerCornerDetector::Detect(IplImage *image,
       markers_->push_back(marker);
     }
   }
+  return tracked;
+}
+
+bool MarkerCornerDetector::FullSearch() const {
+  return full_search_;
+}
+
+std::vector<cv::Rect> const& MarkerCornerDetector::Regions() const {
+  return rois_;
 }
 
 size_t MarkerCornerDetector::NumMarkers() const {
@@ -0,0 +1,107 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <marker_tracking/labelling_method.h>
+#include <camera/camera_params.h>
+
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <opencv2/highgui/highgui.hpp>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <string>
+#include <vector>
+
+typedef std::vector<std::vector<alvar::PointDouble> > Squares;
+
+// Largest distance between the corners of two squares, starting from any corner
+static double CornerDistance(std::vector<alvar::PointDouble> const& a,
+                             std::vector<alvar::PointDouble> const& b) {
+  double best = HUGE_VAL;
+  for (size_t r = 0; r < b.size(); ++r) {
+    double worst = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+      alvar::PointDouble const& q = b[(i + r) % b.size()];
+      worst = std::max(worst, std::hypot(a[i].x - q.x, a[i].y - q.y));
+    }
+    best = std::min(best, worst);
+  }
+  return best;
+}
+
+// Every square of one labeling has a square of the other with its corners
+static void ExpectSameSquares(Squares const& expected, Squares const& actual, double tolerance) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(4u, expected[i].size());
+    double nearest = HUGE_VAL;
+    for (size_t j = 0; j < actual.size(); ++j)
+      nearest = std::min(nearest, CornerDistance(expected[i], actual[j]));
+    EXPECT_LT(nearest, tolerance) << "square " << i;
+  }
+}
+
+// Milliseconds taken by a labeling of the image, averaged over a few runs
+template <typename Label>
+static double Time(Label label) {
+  const int runs = 20;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i)
+    label();
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / runs;
+}
+
+TEST(LabellingMethod, CvMatMatchesCvSeq) {
+  std::string data_dir = std::string(TEST_DIR) + "/data/";
+
+  camera::CameraParameters cam(Eigen::Vector2i(816, 612),
+      Eigen::Vector2d::Constant(2), Eigen::Vector2d(408, 306));
+
+  std::vector<std::string> image_filenames;
+  image_filenames.push_back("IMG_20141217_160451.small.opt.jpg");
+  image_filenames.push_back("IMG_20141217_160458.small.opt.jpg");
+  image_filenames.push_back("IMG_20141217_160509.small.opt.jpg");
+
+  marker_tracking::LabelingCvMat labeling(cam);
+  marker_tracking::LabelingCvSeq reference(cam);
+  for (std::string const& image_filename : image_filenames) {
+    cv::Mat image = cv::imread(data_dir + image_filename, CV_LOAD_IMAGE_GRAYSCALE);
+    ASSERT_FALSE(image.empty()) << image_filename;
+
+    // The whole image, as on a full search
+    labeling.LabelSquares(image);
+    reference.LabelSquares(image);
+    EXPECT_LT(0u, reference.blob_corners.size());
+    ExpectSameSquares(reference.blob_corners, labeling.blob_corners, 0.1);
+
+    // Regions of the image found at the top of a one level pyramid
+    labeling.LabelSquaresPyramid(image, 1, 0.5);
+    reference.LabelSquaresPyramid(image, 1, 0.5);
+    EXPECT_LT(0u, reference.blob_corners.size());
+    ExpectSameSquares(reference.blob_corners, labeling.blob_corners, 0.1);
+
+    // Not asserted, as it depends on the machine, but logged for comparison
+    double mat_ms = Time([&labeling, &image]() { labeling.LabelSquares(image); });
+    double seq_ms = Time([&reference, &image]() { reference.LabelSquares(image); });
+    LOG(INFO) << image_filename << ": LabelingCvMat " << mat_ms << " ms, LabelingCvSeq "
+              << seq_ms << " ms, speedup " << seq_ms / mat_ms;
+  }
+}
@@ -23,6 +23,7 @@
 #include <glog/logging.h>
 #include <opencv2/highgui/highgui.hpp>
 
+#include <chrono>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -52,12 +53,10 @@ TEST(MarkerDetector, TestDetection) {
   expected_corner_loc.push_back(std::make_pair(52, 537));
 
   cv::Mat image;
-  IplImage ipl_image;
   std::vector<std::pair<int, int> >::iterator expected_it = expected_corner_loc.begin();
   for (std::string const& image_filename : image_filenames) {
     image = cv::imread(data_dir + image_filename, CV_LOAD_IMAGE_GRAYSCALE);
-    ipl_image = image;
-    detector.Detect(&ipl_image, 0.08, 0.2);
+    detector.Detect(image, 0.08, 0.2);
     EXPECT_EQ(1u, detector.NumMarkers());
 
     alvar::MarkerData& marker = detector.GetMarker(0);
@@ -68,3 +67,87 @@ TEST(MarkerDetector, TestDetection) {
     expected_it++;
   }
 }
+
+// Runs the detector with tracking on the test images, feeding each image twice
+// so that the second detection comes from the region found in the first, and
+// checks every detection against a detector searching every whole frame at
+// full resolution
+void RunTracking(int pyramid_levels) {
+  std::string data_dir = std::string(TEST_DIR) + "/data/";
+
+  camera::CameraParameters cam(Eigen::Vector2i(816, 612),
+      Eigen::Vector2d::Constant(2), Eigen::Vector2d(408, 306));
+
+  // Only search the regions of the markers already found, unless one is lost
+  marker_tracking::MarkerCornerDetector detector(cam);
+  detector.SetTracking(10, pyramid_levels, 0.5);
+  marker_tracking::MarkerCornerDetector reference(cam);
+
+  std::vector<std::string> image_filenames;
+  image_filenames.push_back("IMG_20141217_160451.small.opt.jpg");
+  image_filenames.push_back("IMG_20141217_160458.small.opt.jpg");
+  image_filenames.push_back("IMG_20141217_160509.small.opt.jpg");
+
+  std::vector<std::pair<int, int> > expected_corner_loc;
+  expected_corner_loc.push_back(std::make_pair(318, 465));
+  expected_corner_loc.push_back(std::make_pair(350, 482));
+  expected_corner_loc.push_back(std::make_pair(52, 537));
+
+  cv::Mat image;
+  std::vector<std::pair<int, int> >::iterator expected_it = expected_corner_loc.begin();
+  for (std::string const& image_filename : image_filenames) {
+    image = cv::imread(data_dir + image_filename, CV_LOAD_IMAGE_GRAYSCALE);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    reference.Detect(image, 0.08, 0.2);
+    double reference_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(1u, reference.NumMarkers());
+    alvar::MarkerData& expected = reference.GetMarker(0);
+
+    // The second time round the marker is found in its region from the first
+    double ms[2];
+    for (int pass = 0; pass < 2; pass++) {
+      start = std::chrono::steady_clock::now();
+      detector.Detect(image, 0.08, 0.2);
+      ms[pass] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      ASSERT_EQ(1u, detector.NumMarkers());
+
+      alvar::MarkerData& marker = detector.GetMarker(0);
+      EXPECT_EQ(2u, marker.GetId());
+      EXPECT_NEAR(expected_it->first, marker.marker_corners_img[0].x, 1);
+      EXPECT_NEAR(expected_it->second, marker.marker_corners_img[0].y, 1);
+      ASSERT_EQ(expected.marker_corners_img.size(), marker.marker_corners_img.size());
+      for (size_t c = 0; c < marker.marker_corners_img.size(); c++) {
+        EXPECT_NEAR(expected.marker_corners_img[c].x, marker.marker_corners_img[c].x, 0.5);
+        EXPECT_NEAR(expected.marker_corners_img[c].y, marker.marker_corners_img[c].y, 0.5);
+      }
+
+      // Nothing is tracked in the first frame, so the whole of it is searched
+      if (expected_it == expected_corner_loc.begin() && pass == 0) {
+        EXPECT_TRUE(detector.FullSearch());
+        EXPECT_TRUE(detector.Regions().empty());
+      }
+      if (pass == 1) {
+        EXPECT_FALSE(detector.FullSearch());
+        ASSERT_EQ(1u, detector.Regions().size());
+        cv::Rect const& roi = detector.Regions()[0];
+        EXPECT_LT(roi.area(), image.cols * image.rows / 4);
+        for (size_t c = 0; c < marker.marker_corners_img.size(); c++) {
+          EXPECT_TRUE(roi.contains(cv::Point(marker.marker_corners_img[c].x,
+                                             marker.marker_corners_img[c].y)));
+        }
+      }
+    }
+    LOG(INFO) << image_filename << ", pyramid levels " << pyramid_levels << ": whole frame at full resolution "
+              << reference_ms << " ms, first detection " << ms[0] << " ms, tracked " << ms[1] << " ms";
+    expected_it++;
+  }
+}
+
+TEST(MarkerDetector, TestTracking) {
+  RunTracking(0);
+}
+
+// As the dock cam tracker is configured, whole frame searches start one level up the pyramid
+TEST(MarkerDetector, TestTrackingPyramid) {
+  RunTracking(1);
+}
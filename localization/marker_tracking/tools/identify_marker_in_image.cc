@@ -25,6 +25,8 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <chrono>
+
 DEFINE_string(camera_calibration, "",
               "The camera calibration file, in OpenCV's XML format.");
 
@@ -44,13 +46,14 @@ int main(int argc, char** argv) {
   colors[3] = cv::Scalar(255);
 
   cv::Mat image;
-  IplImage ipl_image;
   for (int i = 1; i < argc; i++) {
     std::string image_filename(argv[i]);
     image = cv::imread(image_filename, CV_LOAD_IMAGE_GRAYSCALE);
-    ipl_image = image;
-    detector.Detect(&ipl_image, 0.08, 0.2);
-    LOG(INFO) << image_filename << " : Detected " << detector.NumMarkers() << " markers.";
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    detector.Detect(image, 0.08, 0.2);
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    LOG(INFO) << image_filename << " : Detected " << detector.NumMarkers() << " markers in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms.";
 
     for (size_t m_id = 0; m_id < detector.NumMarkers(); m_id++) {
       alvar::MarkerData& marker = detector.GetMarker(m_id);
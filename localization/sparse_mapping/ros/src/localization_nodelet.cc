@@ -158,6 +158,7 @@ void LocalizationNodelet::Localize(void) {
 }
 
 void LocalizationNodelet::Run(void) {
+  RegisterThread();
   struct timespec ts;
   bool running = false;
   while (ros::ok()) {
@@ -335,10 +335,18 @@ size_t CountInliers(const std::vector<Eigen::Vector3d> & landmarks, const std::v
   }
 
   double tolerance_sq = tolerance * tolerance;
-
+  if (landmarks.empty())
+    return 0;
+
+  // Project all the landmarks at once. The vectors are contiguous, so they can
+  // be viewed as matrices without copying.
+  Eigen::Map<const Eigen::Matrix3Xd> xyz(landmarks[0].data(), 3, landmarks.size());
+  Eigen::Map<const Eigen::Matrix2Xd> obs(observations[0].data(), 2, landmarks.size());
+  Eigen::Matrix2Xd pos;
+  camera.ImageCoordinates(xyz, &pos);
+  Eigen::Array<double, 1, Eigen::Dynamic> err = (obs - pos).colwise().squaredNorm();
   for (size_t i = 0; i < landmarks.size(); i++) {
-    Eigen::Vector2d pos = camera.ImageCoordinates(landmarks[i]);
-    if ((observations[i] - pos).squaredNorm() <= tolerance_sq) {
+    if (err[i] <= tolerance_sq) {
       num_inliers++;
       if (inliers)
         inliers->push_back(i);
@@ -521,13 +521,9 @@ void SparseMap::DetectFeatures(const cv::Mat & image, cv::Mat* descriptors,
   std::vector<cv::KeyPoint> storage;
   detector_.Detect(image, &storage, descriptors);
   keypoints->resize(2, storage.size());
-  Eigen::Vector2d output;
-
-  for (size_t j = 0; j < storage.size(); j++) {
-    camera_params_.Convert<camera::DISTORTED_C, camera::UNDISTORTED_C>
-      (Eigen::Vector2d(storage[j].pt.x, storage[j].pt.y), &output);
-    keypoints->col(j) = output;
-  }
+  for (size_t j = 0; j < storage.size(); j++)
+    keypoints->col(j) << storage[j].pt.x, storage[j].pt.y;
+  camera_params_.Convert<camera::DISTORTED_C, camera::UNDISTORTED_C>(*keypoints, keypoints);
 }
 
 // A non-member Localize() function that can be invoked for a non-fully
@@ -1341,14 +1341,9 @@ void RegistrationOrVerification(std::vector<std::string> const& data_files,
   }
 
   // Shift the keypoints. Undistort if necessary.
-  Eigen::Vector2d output;
-  for (size_t cid = 0; cid < map->user_cid_to_keypoint_map_.size(); cid++) {
-    for (int i = 0; i < map->user_cid_to_keypoint_map_[cid].cols(); i++) {
-      map->camera_params_.Convert<camera::DISTORTED, camera::UNDISTORTED_C>
-        (map->user_cid_to_keypoint_map_[cid].col(i), &output);
-      map->user_cid_to_keypoint_map_[cid].col(i) = output;
-    }
-  }
+  for (size_t cid = 0; cid < map->user_cid_to_keypoint_map_.size(); cid++)
+    map->camera_params_.Convert<camera::DISTORTED, camera::UNDISTORTED_C>
+      (map->user_cid_to_keypoint_map_[cid], &map->user_cid_to_keypoint_map_[cid]);
 
   // Initialize user_pid_to_xyz_
   map->user_pid_to_xyz_.resize(user_xyz.cols());
@@ -24,10 +24,13 @@
 
 namespace cpu_monitor {
 
+// The sys files of cores and thermal zones are opened once by Init, and read
+// again from the start at each sample.
 class Core {
  private:
   std::string sys_cpu_path_;
   int id_;
+  int online_fd_, min_freq_fd_, cur_freq_fd_, max_freq_fd_;
 
  public:
   explicit Core(const std::string sys_cpu_path, int id);
@@ -39,15 +42,13 @@ class Core {
   int GetMinFreq(void);
   int GetCurFreq(void);
   int GetMaxFreq(void);
-
- private:
-  int GetIntValue(const std::string &file);
 };
 
 class ThermalZone {
  private:
   std::string sys_thermal_path_;
   int id_;
+  int temp_fd_;
 
  public:
   explicit ThermalZone(const std::string sys_thermal_path, int id);
@@ -35,12 +35,17 @@
 
 #include <config_reader/config_reader.h>
 #include <cpu_monitor/cpu.h>
+#include <cpu_monitor/thread_monitor.h>
 #include <ff_msgs/CpuState.h>
 #include <ff_msgs/CpuStateStamped.h>
+#include <ff_msgs/Heartbeat.h>
+#include <ff_msgs/NodeletCpuState.h>
 #include <ff_util/ff_names.h>
 #include <ff_util/ff_nodelet.h>
 
 #include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -81,6 +86,18 @@ class CpuMonitor : public ff_util::FreeFlyerNodelet {
 
   LoadVector load_cpus_;
 
+  // Nodelet manager running on this processor, with the threads each of its
+  // nodes reported in their last heartbeat
+  struct Manager {
+    std::shared_ptr<ThreadMonitor> threads;
+    std::map<std::string, std::vector<pid_t>> nodes;
+  };
+
+  std::map<std::string, Manager> managers_;
+
+  int stat_fd_;
+  std::vector<char> stat_buffer_;
+
   Cpu freq_cpus_;
 
   config_reader::ConfigReader config_params_;
@@ -93,6 +110,7 @@ class CpuMonitor : public ff_util::FreeFlyerNodelet {
   unsigned int ncpus_;
 
   ros::Publisher cpu_state_pub_;
+  ros::Subscriber heartbeat_sub_;
   ros::Timer reload_params_timer_, stats_timer_;
 
   std::string processor_name_;
@@ -102,6 +120,12 @@ class CpuMonitor : public ff_util::FreeFlyerNodelet {
     * regular intervals for the numbers to make sense over time. */
   int CollectLoadStats();
 
+  /** Collect the cpu used by the threads of the nodelet managers, and
+    * attribute it to the nodes that own the threads. */
+  void CollectNodeletStats();
+
+  void HeartbeatCallback(ff_msgs::HeartbeatConstPtr const& hb);
+
   void PublishStatsCallback(ros::TimerEvent const &te);
 };
 
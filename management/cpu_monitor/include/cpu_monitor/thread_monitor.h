@@ -0,0 +1,80 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CPU_MONITOR_THREAD_MONITOR_H_
+#define CPU_MONITOR_THREAD_MONITOR_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace cpu_monitor {
+
+// Measures the cpu used by each thread of a process. The stat and status
+// files of every thread are kept open and read again with pread at each
+// update, so sampling does not open, parse paths or allocate per thread.
+// Threads that appear are opened when the task directory is listed, and
+// threads that exit are closed when their files can't be read anymore.
+class ThreadMonitor {
+ public:
+  struct Thread {
+    pid_t tid;
+    // Name of the thread, at most 15 characters
+    std::string name;
+    // Percentage of one cpu used since the previous update
+    double load;
+    // Context switches per second since the previous update
+    double voluntary_switches, involuntary_switches;
+
+    // Start time of the thread in clock ticks after boot, which changes when
+    // the tid is reused by a new thread
+    std::uint64_t start;
+    std::uint64_t ticks, voluntary, involuntary;
+    int stat_fd, status_fd;
+  };
+
+  using ThreadMap = std::map<pid_t, Thread>;
+
+  explicit ThreadMonitor(pid_t pid);
+  ~ThreadMonitor(void);
+
+  // Samples all threads, returns false if the process is gone
+  bool Update(void);
+
+  pid_t GetPid(void) const;
+  const ThreadMap& GetThreads(void) const;
+
+  // Finds the process started with the given ros node name, 0 if none
+  static pid_t FindNode(const std::string &name);
+
+ private:
+  bool ListThreads(void);
+  bool ReadThread(Thread *thread, double period);
+
+  pid_t pid_;
+  std::string task_path_;
+  ThreadMap threads_;
+  double last_update_;
+  long ticks_per_second_;  // NOLINT
+};
+
+}  // namespace cpu_monitor
+
+#endif  // CPU_MONITOR_THREAD_MONITOR_H_
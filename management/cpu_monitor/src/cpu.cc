@@ -18,7 +18,11 @@
 
 #include <cpu_monitor/cpu.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -26,101 +30,100 @@
 
 namespace cpu_monitor {
 
-Core::Core(const std::string sys_cpu_path, int id)
-  : sys_cpu_path_(sys_cpu_path)
-  , id_(id) {
+namespace {
+// Opens a sys file, or returns -1 after printing why it couldn't be opened
+int OpenFile(const std::string &file) {
+  int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    std::cerr << "Error opening file '" << file << "': " <<
+      std::strerror(errno) << std::endl;
+  return fd;
 }
 
-Core::~Core(void) {
+// Reads the integer a sys file holds, from the start of the file
+bool ReadIntValue(int fd, int *value) {
+  char buffer[32];
+  ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+  if (n <= 0)
+    return false;
+  buffer[n] = '\0';
+  *value = std::atoi(buffer);
+  return true;
 }
 
-bool Core::Init(void) {
-  // Check if sys files are there.
-  std::vector<std::string> files;
-
-  files.push_back(sys_cpu_path_ + "/online");
-  files.push_back(sys_cpu_path_ + "/cpufreq/scaling_cur_freq");
-  files.push_back(sys_cpu_path_ + "/cpufreq/scaling_max_freq");
-  files.push_back(sys_cpu_path_ + "/cpufreq/scaling_min_freq");
+int GetIntValue(int fd) {
+  int value;
+  return ReadIntValue(fd, &value) ? value : -1;
+}
 
-  for (int i = 0; i < static_cast<int>(files.size()); i++) {
-    std::ifstream is(files[i]);
+void CloseFile(int fd) {
+  if (fd >= 0)
+    close(fd);
+}
+}  // namespace
 
-    if (!is.is_open()) {
-      std::cerr << "Error opening file '" << files[i] << "': " <<
-        std::strerror(errno) << std::endl;
+Core::Core(const std::string sys_cpu_path, int id)
+  : sys_cpu_path_(sys_cpu_path)
+  , id_(id)
+  , online_fd_(-1)
+  , min_freq_fd_(-1)
+  , cur_freq_fd_(-1)
+  , max_freq_fd_(-1) {
+}
 
-      return false;
-    }
+Core::~Core(void) {
+  CloseFile(online_fd_);
+  CloseFile(min_freq_fd_);
+  CloseFile(cur_freq_fd_);
+  CloseFile(max_freq_fd_);
+}
 
-    is.close();
-  }
+bool Core::Init(void) {
+  // Check if sys files are there, and keep them open
+  online_fd_ = OpenFile(sys_cpu_path_ + "/online");
+  cur_freq_fd_ = OpenFile(sys_cpu_path_ + "/cpufreq/scaling_cur_freq");
+  max_freq_fd_ = OpenFile(sys_cpu_path_ + "/cpufreq/scaling_max_freq");
+  min_freq_fd_ = OpenFile(sys_cpu_path_ + "/cpufreq/scaling_min_freq");
 
-  return true;
+  return online_fd_ >= 0 && cur_freq_fd_ >= 0 &&
+         max_freq_fd_ >= 0 && min_freq_fd_ >= 0;
 }
 
 int Core::GetMinFreq(void) {
-  return GetIntValue(sys_cpu_path_ + "/cpufreq/scaling_min_freq");
+  return GetIntValue(min_freq_fd_);
 }
 
 int Core::GetCurFreq(void) {
-  return GetIntValue(sys_cpu_path_ + "/cpufreq/scaling_cur_freq");
+  return GetIntValue(cur_freq_fd_);
 }
 
 int Core::GetMaxFreq(void) {
-  return GetIntValue(sys_cpu_path_ + "/cpufreq/scaling_max_freq");
+  return GetIntValue(max_freq_fd_);
 }
 
 bool Core::IsOn(void) {
-  return GetIntValue(sys_cpu_path_ + "/online") == 1 ? true : false;
+  return GetIntValue(online_fd_) == 1 ? true : false;
 }
 
 int Core::GetId(void) {
   return id_;
 }
 
-int Core::GetIntValue(const std::string &file) {
-  std::string line;
-  std::ifstream is(file);
-
-  if (!is.is_open()) {
-    std::cerr << "error opening file '" << file << "': " <<
-      std::strerror(errno) << std::endl;
-
-    return -1;
-  }
-
-  std::getline(is, line);
-
-  int value = std::stoi(line);
-
-  is.close();
-
-  return value;
-}
-
 ThermalZone::ThermalZone(const std::string sys_thermal_path, int id)
   : sys_thermal_path_(sys_thermal_path)
-  , id_(id) {
+  , id_(id)
+  , temp_fd_(-1) {
 }
 
 ThermalZone::~ThermalZone(void) {
+  CloseFile(temp_fd_);
 }
 
 bool ThermalZone::Init(void) {
-  // Check if 'temp' file exists.
-  std::ifstream temp(sys_thermal_path_ + "/temp");
+  // Check if 'temp' file exists, and keep it open
+  temp_fd_ = OpenFile(sys_thermal_path_ + "/temp");
 
-  if (!temp.is_open()) {
-    std::cerr << "Error opening file: "
-      << std::strerror(errno) << std::endl;
-
-    return false;
-  }
-
-  temp.close();
-
-  return true;
+  return temp_fd_ >= 0;
 }
 
 int ThermalZone::GetId(void) {
@@ -128,22 +131,15 @@ int ThermalZone::GetId(void) {
 }
 
 double ThermalZone::GetTemperature(double scale) {
-  std::string line;
-  std::ifstream is(sys_thermal_path_ + "/temp");
+  int value;
 
-  if (!is.is_open()) {
-    std::cerr << "Error opening file: " <<
+  if (!ReadIntValue(temp_fd_, &value)) {
+    std::cerr << "Error reading file '" << sys_thermal_path_ << "/temp': " <<
       std::strerror(errno) << std::endl;
 
     return -1.0;
   }
 
-  std::getline(is, line);
-
-  int value = std::stoi(line);
-
-  is.close();
-
   return value * scale;
 }
 
@@ -2,6 +2,9 @@
 
 #include <cpu_monitor/cpu_monitor.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace cpu_monitor {
 
 namespace {
@@ -16,10 +19,13 @@ CpuMonitor::CpuMonitor() :
   temperature_scale_(1.0),
   pub_queue_size_(10),
   update_freq_hz_(1),
-  cpu_ave_load_limit_(95) {
+  cpu_ave_load_limit_(95),
+  stat_fd_(-1) {
 }
 
 CpuMonitor::~CpuMonitor() {
+  if (stat_fd_ >= 0)
+    close(stat_fd_);
 }
 
 void CpuMonitor::Initialize(ros::NodeHandle *nh) {
@@ -51,6 +57,20 @@ void CpuMonitor::Initialize(ros::NodeHandle *nh) {
 
   load_cpus_.resize(ncpus_ + 1);
 
+  // Keep the stat file open, with room for the line of each cpu
+  stat_fd_ = open(kProcStat, O_RDONLY | O_CLOEXEC);
+  if (stat_fd_ < 0) {
+    ROS_FATAL("CPU Monitor: Unable to open %s: %s", kProcStat,
+                                                        std::strerror(errno));
+    exit(EXIT_FAILURE);
+    return;
+  }
+  stat_buffer_.resize((ncpus_ + 1) * 256);
+
+  // The heartbeats tell which threads belong to which node
+  heartbeat_sub_ = nh->subscribe(TOPIC_HEARTBEAT, 100,
+                                 &CpuMonitor::HeartbeatCallback, this);
+
   // Intialize cpu freq class
   if (!freq_cpus_.Init()) {
     ROS_FATAL("CPU Monitor: Cpu.init failed: %s", std::strerror(errno));
@@ -131,18 +151,24 @@ int CpuMonitor::CollectLoadStats() {
                 guest_period, system_all_period;
 
   uint32_t cpuid = 0;
-  char buffer[256];
 
-  FILE * statf = fopen(kProcStat, "r");
-  if (statf == NULL) {
-    perror("fopen");
+  // The file stays open, and the cpu lines are at its start
+  ssize_t size = pread(stat_fd_, &stat_buffer_[0], stat_buffer_.size() - 1, 0);
+  if (size <= 0) {
+    perror("pread");
     return -1;
   }
+  stat_buffer_[size] = '\0';
 
+  char *buffer = &stat_buffer_[0];
   for (unsigned int i = 0; i < load_cpus_.size(); i++) {
-    if (fgets(buffer, sizeof(buffer), statf) == NULL) {
-      fprintf(stderr, "fgets screwed up\n");
-      break;
+    if (i > 0) {
+      buffer = strchr(buffer, '\n');
+      if (buffer == NULL) {
+        fprintf(stderr, "%s is missing cpus\n", kProcStat);
+        break;
+      }
+      buffer++;
     }
 
     if (i == 0) {
@@ -209,10 +235,79 @@ int CpuMonitor::CollectLoadStats() {
                             cpu->virt_percentage;
   }
 
-  fclose(statf);
   return 0;
 }
 
+void CpuMonitor::HeartbeatCallback(ff_msgs::HeartbeatConstPtr const& hb) {
+  // Only the nodelet managers of this processor, whose name starts with the
+  // name of the processor, can be measured
+  std::string manager = hb->nodelet_manager.substr(
+                                      hb->nodelet_manager.rfind('/') + 1);
+  if (manager.compare(0, processor_name_.size(), processor_name_) != 0)
+    return;
+
+  std::vector<pid_t> &threads = managers_[manager].nodes[hb->node];
+  threads.clear();
+  for (unsigned int i = 0; i < hb->threads.size(); i++)
+    threads.push_back(hb->threads[i].tid);
+}
+
+void CpuMonitor::CollectNodeletStats() {
+  cpu_state_msg_.nodelets.clear();
+  for (auto & m : managers_) {
+    Manager &manager = m.second;
+
+    // Find the process of the manager the first time, and after a restart
+    if (!manager.threads) {
+      pid_t pid = ThreadMonitor::FindNode(m.first);
+      if (pid == 0)
+        continue;
+      manager.threads.reset(new ThreadMonitor(pid));
+    }
+    if (!manager.threads->Update()) {
+      manager.threads.reset();
+      continue;
+    }
+
+    // A thread belongs to the node that registered it in its heartbeat. The
+    // worker threads of the manager run the callbacks of every node, so their
+    // time can't be split between nodes, and is counted for the manager along
+    // with threads reported by several nodes or by none. Registered threads
+    // are named after their node, which tells a worker that reused the tid of
+    // an exited thread from the thread itself.
+    std::map<pid_t, std::string> owners;
+    for (auto & node : manager.nodes) {
+      for (pid_t tid : node.second) {
+        auto owner = owners.find(tid);
+        if (owner == owners.end())
+          owners[tid] = node.first;
+        else if (owner->second != node.first)
+          owner->second = m.first;
+      }
+    }
+
+    std::map<std::string, ff_msgs::NodeletCpuState> nodelets;
+    for (auto & t : manager.threads->GetThreads()) {
+      const ThreadMonitor::Thread &thread = t.second;
+      std::string name = m.first;
+      auto owner = owners.find(thread.tid);
+      if (owner != owners.end() &&
+          owner->second.compare(0, 15, thread.name) == 0)
+        name = owner->second;
+
+      ff_msgs::NodeletCpuState &nodelet = nodelets[name];
+      nodelet.name = name;
+      nodelet.nodelet_manager = m.first;
+      nodelet.threads++;
+      nodelet.load += thread.load;
+      nodelet.voluntary_switches += thread.voluntary_switches;
+      nodelet.involuntary_switches += thread.involuntary_switches;
+    }
+    for (auto & nodelet : nodelets)
+      cpu_state_msg_.nodelets.push_back(nodelet.second);
+  }
+}
+
 void CpuMonitor::PublishStatsCallback(ros::TimerEvent const &te) {
   // Get cpu load stats first
   if (CollectLoadStats() < 0) {
@@ -251,6 +346,9 @@ void CpuMonitor::PublishStatsCallback(ros::TimerEvent const &te) {
     this->ClearFault("LOAD_TOO_HIGH");
   }
 
+  // Get the cpu used by each node
+  CollectNodeletStats();
+
   // Get cpu temperature stats
   cpu_state_msg_.temp = freq_cpus_.GetTemperature(temperature_scale_);
 
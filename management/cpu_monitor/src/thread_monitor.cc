@@ -0,0 +1,226 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <cpu_monitor/thread_monitor.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace cpu_monitor {
+
+namespace {
+constexpr char kProc[] = "/proc";
+
+double Now() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Reads a whole proc file from the start into buffer, null terminated
+ssize_t ReadFile(int fd, char *buffer, size_t size) {
+  ssize_t n = pread(fd, buffer, size - 1, 0);
+  if (n > 0)
+    buffer[n] = '\0';
+  return n;
+}
+
+// Returns the value of a "key:\tvalue" line of a status file
+bool GetStatusValue(const char *status, const char *key, std::uint64_t *value) {
+  const char *line = strstr(status, key);
+  if (line == NULL)
+    return false;
+  *value = strtoull(line + strlen(key) + 1, NULL, 10);
+  return true;
+}
+}  // namespace
+
+ThreadMonitor::ThreadMonitor(pid_t pid)
+  : pid_(pid)
+  , task_path_(std::string(kProc) + "/" + std::to_string(pid) + "/task")
+  , last_update_(0.0)
+  , ticks_per_second_(sysconf(_SC_CLK_TCK)) {
+}
+
+ThreadMonitor::~ThreadMonitor(void) {
+  for (auto & t : threads_) {
+    close(t.second.stat_fd);
+    close(t.second.status_fd);
+  }
+}
+
+bool ThreadMonitor::Update(void) {
+  double now = Now();
+  double period = (last_update_ > 0.0) ? now - last_update_ : 0.0;
+  last_update_ = now;
+
+  // Sample the threads we know, and forget the ones that exited
+  for (auto it = threads_.begin(); it != threads_.end();) {
+    if (ReadThread(&it->second, period)) {
+      ++it;
+    } else {
+      close(it->second.stat_fd);
+      close(it->second.status_fd);
+      it = threads_.erase(it);
+    }
+  }
+
+  // Threads started since the last update only get a first sample
+  return ListThreads();
+}
+
+pid_t ThreadMonitor::GetPid(void) const {
+  return pid_;
+}
+
+const ThreadMonitor::ThreadMap& ThreadMonitor::GetThreads(void) const {
+  return threads_;
+}
+
+pid_t ThreadMonitor::FindNode(const std::string &name) {
+  DIR *dir = opendir(kProc);
+  if (dir == NULL)
+    return 0;
+
+  // Nodes are started by roslaunch with a __name:= argument
+  std::string arg = "__name:=" + name;
+  pid_t found = 0;
+  char buffer[4096];
+  while (struct dirent *entry = readdir(dir)) {
+    pid_t pid = atoi(entry->d_name);
+    if (pid <= 0)
+      continue;
+    std::string path = std::string(kProc) + "/" + entry->d_name + "/cmdline";
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      continue;
+    ssize_t n = ReadFile(fd, buffer, sizeof(buffer));
+    close(fd);
+    // The arguments are separated by null characters
+    for (ssize_t i = 0; i < n; i += strlen(buffer + i) + 1) {
+      if (arg == buffer + i) {
+        found = pid;
+        break;
+      }
+    }
+    if (found)
+      break;
+  }
+  closedir(dir);
+  return found;
+}
+
+bool ThreadMonitor::ListThreads(void) {
+  DIR *dir = opendir(task_path_.c_str());
+  if (dir == NULL)
+    return false;
+
+  while (struct dirent *entry = readdir(dir)) {
+    pid_t tid = atoi(entry->d_name);
+    if (tid <= 0 || threads_.count(tid) > 0)
+      continue;
+    std::string path = task_path_ + "/" + entry->d_name;
+    Thread thread = Thread();
+    thread.tid = tid;
+    thread.stat_fd = open((path + "/stat").c_str(), O_RDONLY | O_CLOEXEC);
+    thread.status_fd = open((path + "/status").c_str(), O_RDONLY | O_CLOEXEC);
+    if (thread.stat_fd >= 0 && thread.status_fd >= 0 &&
+        ReadThread(&thread, 0.0)) {
+      threads_[tid] = thread;
+    } else {
+      if (thread.stat_fd >= 0)
+        close(thread.stat_fd);
+      if (thread.status_fd >= 0)
+        close(thread.status_fd);
+    }
+  }
+  closedir(dir);
+  return true;
+}
+
+bool ThreadMonitor::ReadThread(Thread *thread, double period) {
+  // The status file of a thread is under 2 kB, the stat file much smaller
+  char buffer[4096];
+
+  // stat is "tid (name) state ...", and the name may itself contain spaces
+  // or parentheses, so the fields are counted from the last parenthesis.
+  if (ReadFile(thread->stat_fd, buffer, sizeof(buffer)) <= 0)
+    return false;
+  char *name_begin = strchr(buffer, '(');
+  char *name_end = strrchr(buffer, ')');
+  if (name_begin == NULL || name_end == NULL || name_end < name_begin)
+    return false;
+  std::string name(name_begin + 1, name_end);
+
+  // utime and stime are the 14th and 15th fields, and the start time of the
+  // thread the 22nd, counting from the state which is the 3rd
+  char *field = name_end + 2;
+  for (int i = 3; i < 14 && field != NULL; i++) {
+    field = strchr(field, ' ');
+    if (field != NULL)
+      field++;
+  }
+  if (field == NULL)
+    return false;
+  char *end;
+  std::uint64_t ticks = strtoull(field, &end, 10);
+  ticks += strtoull(end, &end, 10);
+  for (int i = 16; i < 22 && end != NULL; i++)
+    end = strchr(end + 1, ' ');
+  if (end == NULL)
+    return false;
+  std::uint64_t start = strtoull(end, NULL, 10);
+
+  std::uint64_t voluntary, involuntary;
+  if (ReadFile(thread->status_fd, buffer, sizeof(buffer)) <= 0 ||
+      !GetStatusValue(buffer, "\nvoluntary_ctxt_switches:", &voluntary) ||
+      !GetStatusValue(buffer, "\nnonvoluntary_ctxt_switches:", &involuntary))
+    return false;
+
+  // The files stay open on the tid, so when the thread exits and the kernel
+  // gives its tid to a new thread the counters start again from zero. Take
+  // a new baseline then, rather than a difference that wraps around.
+  if (start != thread->start || ticks < thread->ticks ||
+      voluntary < thread->voluntary || involuntary < thread->involuntary)
+    period = 0.0;
+
+  if (period > 0.0) {
+    thread->load = (ticks - thread->ticks) * 100.0 /
+                   (ticks_per_second_ * period);
+    thread->voluntary_switches = (voluntary - thread->voluntary) / period;
+    thread->involuntary_switches = (involuntary - thread->involuntary) / period;
+  } else {
+    thread->load = 0.0;
+    thread->voluntary_switches = 0.0;
+    thread->involuntary_switches = 0.0;
+  }
+  thread->start = start;
+  thread->name = name;
+  thread->ticks = ticks;
+  thread->voluntary = voluntary;
+  thread->involuntary = involuntary;
+  return true;
+}
+
+}  // namespace cpu_monitor
@@ -14,7 +14,14 @@
 #include <ff_msgs/EnableCamera.h>
 #include <ff_msgs/CameraState.h>
 
+#include <opencv2/core/core.hpp>
+
+#include <condition_variable>  // NOLINT
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #define NUM_CAMERAS 2
 #define NAV_CAM_ID  0
@@ -41,6 +48,19 @@ class ImageSampler : public ff_util::FreeFlyerNodelet {
   void ImageCallback(const sensor_msgs::ImageConstPtr & msg, int camera);
   void UpdateState(int camera, bool streaming, int width, int height, float rate);
 
+  // An image waiting to be resampled, with the sizes of the outputs that are
+  // due. The size of an output that is not due is empty.
+  struct Frame {
+    sensor_msgs::ImageConstPtr msg;
+    cv::Size record_size, stream_size;
+  };
+  // Resamples the pending frames off the image transport callback thread
+  void ResampleThread();
+  void Resample(Frame const& frame, int camera);
+  // Returns the image of the frame being resampled at the given size. Every
+  // size is computed once per frame and shared by the outputs that use it.
+  sensor_msgs::ImageConstPtr Resize(const sensor_msgs::ImageConstPtr & msg, cv::Size const& size);
+
  private:
   image_transport::Subscriber image_sub_[NUM_CAMERAS];
   image_transport::CameraPublisher record_image_pub_[NUM_CAMERAS];
@@ -58,6 +78,13 @@ class ImageSampler : public ff_util::FreeFlyerNodelet {
   ros::Time stream_last_publish_time_[NUM_CAMERAS];
 
   ff_msgs::CameraState camera_states_[2 * NUM_CAMERAS];
+
+  std::thread resample_thread_;
+  std::mutex resample_mutex_;
+  std::condition_variable resample_cond_;
+  bool resample_stop_;
+  Frame pending_[NUM_CAMERAS];
+  std::vector<std::pair<cv::Size, sensor_msgs::ImageConstPtr> > resized_;
 };
 
 }  // namespace image_sampler
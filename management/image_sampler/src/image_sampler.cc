@@ -23,15 +23,24 @@
 #include <cv_bridge/cv_bridge.h>
 #include <gflags/gflags.h>
 #include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
 #include <ff_msgs/CameraStatesStamped.h>
 
 namespace image_sampler {
 
 ImageSampler::ImageSampler() :
-    ff_util::FreeFlyerNodelet(NODE_IMG_SAMPLER) {
+    ff_util::FreeFlyerNodelet(NODE_IMG_SAMPLER), resample_stop_(false) {
 }
 
 ImageSampler::~ImageSampler() {
+  if (resample_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(resample_mutex_);
+      resample_stop_ = true;
+    }
+    resample_cond_.notify_one();
+    resample_thread_.join();
+  }
 }
 
 void ImageSampler::Initialize(ros::NodeHandle *nh) {
@@ -77,6 +86,8 @@ void ImageSampler::Initialize(ros::NodeHandle *nh) {
                                                      &ImageSampler::EnableServiceNavCam,  this);
   enable_srv_[DOCK_CAM_ID] = nh->advertiseService(SERVICE_MANAGEMENT_IMG_SAMPLER_ENABLE_DOCK,
                                                      &ImageSampler::EnableServiceDockCam,  this);
+
+  resample_thread_ = std::thread(&ImageSampler::ResampleThread, this);
 }
 
 void ImageSampler::UpdateState(int camera, bool streaming, int width, int height, float rate) {
@@ -184,34 +195,95 @@ void ImageSampler::DockCamCallback(const sensor_msgs::ImageConstPtr & msg) {
   ImageCallback(msg, DOCK_CAM_ID);
 }
 
+// Only decides which outputs are due, the images are resampled by ResampleThread
 void ImageSampler::ImageCallback(const sensor_msgs::ImageConstPtr & msg, int camera) {
   assert(camera >= 0 && camera < NUM_CAMERAS);
+  Frame frame;
+  frame.msg = msg;
   if (camera_states_[camera].recording &&
       msg->header.stamp - record_last_publish_time_[camera] >= record_publication_interval_[camera]) {
     record_last_publish_time_[camera] = msg->header.stamp;
-    cv::Mat image_curr = cv_bridge::toCvShare(msg, msg->encoding)->image;
-
-    cv::Mat rescaled_image;
-    cv::resize(image_curr, rescaled_image, cv::Size(record_output_width_[camera], record_output_height_[camera]));
-
-    sensor_msgs::Image::Ptr out_img = cv_bridge::CvImage(msg->header, msg->encoding, rescaled_image).toImageMsg();
-    sensor_msgs::CameraInfo cinfo;
-    cinfo.header = msg->header;
-    record_image_pub_[camera].publish(*out_img, cinfo);
+    frame.record_size = cv::Size(record_output_width_[camera], record_output_height_[camera]);
   }
   if (camera_states_[camera].streaming &&
       msg->header.stamp - stream_last_publish_time_[camera] >= stream_publication_interval_[camera]) {
     stream_last_publish_time_[camera] = msg->header.stamp;
-    cv::Mat image_curr = cv_bridge::toCvShare(msg, msg->encoding)->image;
+    frame.stream_size = cv::Size(stream_output_width_[camera], stream_output_height_[camera]);
+  }
+  if (frame.record_size.area() == 0 && frame.stream_size.area() == 0)
+    return;
+
+  // A frame still waiting is replaced by this newer one, which takes over
+  // the outputs it had due
+  {
+    std::lock_guard<std::mutex> lock(resample_mutex_);
+    Frame & pending = pending_[camera];
+    if (frame.record_size.area() == 0)
+      frame.record_size = pending.record_size;
+    if (frame.stream_size.area() == 0)
+      frame.stream_size = pending.stream_size;
+    pending = frame;
+  }
+  resample_cond_.notify_one();
+}
 
-    cv::Mat rescaled_image;
-    cv::resize(image_curr, rescaled_image, cv::Size(stream_output_width_[camera], stream_output_height_[camera]));
+void ImageSampler::ResampleThread() {
+  RegisterThread();
+  std::unique_lock<std::mutex> lock(resample_mutex_);
+  while (true) {
+    resample_cond_.wait(lock, [this] {
+      return resample_stop_ || pending_[NAV_CAM_ID].msg || pending_[DOCK_CAM_ID].msg;
+    });
+    if (resample_stop_)
+      return;
+    for (int camera = 0; camera < NUM_CAMERAS; camera++) {
+      if (!pending_[camera].msg)
+        continue;
+      Frame frame = pending_[camera];
+      pending_[camera] = Frame();
+      lock.unlock();
+      Resample(frame, camera);
+      lock.lock();
+    }
+  }
+}
+
+void ImageSampler::Resample(Frame const& frame, int camera) {
+  resized_.clear();
+  sensor_msgs::CameraInfoPtr cinfo(new sensor_msgs::CameraInfo());
+  cinfo->header = frame.msg->header;
+  if (frame.record_size.area() > 0)
+    record_image_pub_[camera].publish(Resize(frame.msg, frame.record_size), cinfo);
+  if (frame.stream_size.area() > 0)
+    stream_image_pub_[camera].publish(Resize(frame.msg, frame.stream_size), cinfo);
+}
 
-    sensor_msgs::Image::Ptr out_img = cv_bridge::CvImage(msg->header, msg->encoding, rescaled_image).toImageMsg();
-    sensor_msgs::CameraInfo cinfo;
-    cinfo.header = msg->header;
-    stream_image_pub_[camera].publish(*out_img, cinfo);
+sensor_msgs::ImageConstPtr ImageSampler::Resize(const sensor_msgs::ImageConstPtr & msg, cv::Size const& size) {
+  for (size_t i = 0; i < resized_.size(); i++)
+    if (resized_[i].first == size)
+      return resized_[i].second;
+
+  // At the input size the incoming message is published as is. Otherwise the
+  // image is resized straight into the data of the outgoing message, shrinking
+  // with area interpolation.
+  sensor_msgs::ImageConstPtr out = msg;
+  cv::Mat image_curr = cv_bridge::toCvShare(msg, msg->encoding)->image;
+  if (size != image_curr.size()) {
+    sensor_msgs::ImagePtr out_img(new sensor_msgs::Image());
+    out_img->header = msg->header;
+    out_img->encoding = msg->encoding;
+    out_img->is_bigendian = msg->is_bigendian;
+    out_img->width = size.width;
+    out_img->height = size.height;
+    out_img->step = size.width * image_curr.elemSize();
+    out_img->data.resize(out_img->step * size.height);
+    cv::Mat rescaled_image(size, image_curr.type(), out_img->data.data(), out_img->step);
+    bool shrink = size.width <= image_curr.cols && size.height <= image_curr.rows;
+    cv::resize(image_curr, rescaled_image, size, 0, 0, shrink ? cv::INTER_AREA : cv::INTER_LINEAR);
+    out = out_img;
   }
+  resized_.push_back(std::make_pair(size, out));
+  return out;
 }
 
 }  // namespace image_sampler
@@ -33,11 +33,15 @@
 #include <ff_msgs/FaultConfig.h>
 #include <ff_msgs/FaultInfo.h>
 #include <ff_msgs/FaultState.h>
+#include <ff_msgs/FaultStateUpdate.h>
 #include <ff_msgs/UnloadLoadNodelet.h>
 #include <ff_util/ff_names.h>
 #include <ff_util/ff_nodelet.h>
 
+#include <sys_monitor/watchdog_wheel.h>
+
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -50,7 +54,8 @@ class SysMonitor : public ff_util::FreeFlyerNodelet {
   ~SysMonitor();
 
   /** 
-   * Add fault to fault state and publish fault state.
+   * Add fault to fault state. The change is published with the next
+   * PublishFaultState(), along with the other changes of the same callback.
    * @param fault_id        unique fault id
    * @param fault_msg       message containing fault information   
    * @param time_occurred   time fault occurred
@@ -67,6 +72,7 @@ class SysMonitor : public ff_util::FreeFlyerNodelet {
    public:
     Watchdog(SysMonitor *const sys_monitor, ros::Duration const& timeout,
              uint const allowed_misses, uint const fault_id);
+    size_t index();
     uint fault_id();
     uint misses_allowed();
     ff_msgs::HeartbeatConstPtr previous_hb();
@@ -79,19 +85,16 @@ class SysMonitor : public ff_util::FreeFlyerNodelet {
     void nodelet_manager(std::string manager_name);
     void nodelet_type(std::string type);
     void unloaded(bool is_unloaded);
-    void ResetTimer();
-    void StopTimer();
+    void Feed(ros::Time const& time);
+    void Disarm();
     void previous_hb(ff_msgs::HeartbeatConstPtr hb);
-    void TimerCallBack(ros::TimerEvent const& te);
 
    private:
-    ros::Timer timer_;
     SysMonitor *const monitor_;
-    uint missed_count_;
+    size_t const index_;
     uint const misses_allowed_;
     uint const fault_id_;
     bool hb_fault_occurring_;
-    bool heartbeat_started_;
     bool unloaded_;
     std::string nodelet_manager_;
     std::string nodelet_type_;
@@ -128,6 +131,14 @@ class SysMonitor : public ff_util::FreeFlyerNodelet {
    */
   void HeartbeatCallback(ff_msgs::HeartbeatConstPtr const& heartbeat);
 
+  void ProcessHeartbeat(ff_msgs::HeartbeatConstPtr const& heartbeat);
+
+  /**
+   * Checks the deadlines of all the heartbeats, and triggers the faults of the
+   * ones that were missed
+   */
+  void WatchdogTimerCallback(ros::TimerEvent const& te);
+
   virtual void Initialize(ros::NodeHandle *nh);
 
   void OutputFaultTables();
@@ -136,6 +147,10 @@ class SysMonitor : public ff_util::FreeFlyerNodelet {
 
   void PublishFaultConfig();
 
+  /**
+   * Publishes the fault state, and an update with the faults added and removed
+   * since the last time, if the state changed since the last time
+   */
   void PublishFaultState();
 
   void PublishFaultResponse(unsigned int fault_id);
@@ -162,21 +177,31 @@ class SysMonitor : public ff_util::FreeFlyerNodelet {
   int UnloadNodelet(std::string const& nodelet, std::string const& manager);
 
   ff_msgs::FaultState fault_state_;
+  ff_msgs::FaultStateUpdate fault_update_;
   ff_msgs::FaultConfig fault_config_;
 
+  // Faults and state in the last fault state published
+  std::set<unsigned int> published_faults_;
+  int published_state_;
+
   nodelet::NodeletLoad load_service_;
   nodelet::NodeletUnload unload_service_;
 
   ros::NodeHandle nh_;
   ros::Publisher pub_cmd_;
-  ros::Publisher pub_fault_config_, pub_fault_state_;
-  ros::Timer reload_params_timer_, startup_timer_;
+  ros::Publisher pub_fault_config_, pub_fault_state_, pub_fault_update_;
+  ros::Timer reload_params_timer_, startup_timer_, watchdog_timer_;
   ros::ServiceServer unload_load_nodelet_service_;
   ros::Subscriber sub_hb_;
 
   std::map<unsigned int, std::shared_ptr<Fault>> all_faults_;
   std::map<std::string, WatchdogPtr> watch_dogs_;
 
+  // All heartbeat deadlines, and the watchdog of each index of the wheel
+  WatchdogWheel wheel_;
+  std::vector<WatchdogPtr> wheel_watch_dogs_;
+  std::vector<size_t> expired_;
+
   // TODO(Katie) possibly remove this
   std::vector<std::string> unwatched_heartbeats_;
 
@@ -0,0 +1,126 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SYS_MONITOR_WATCHDOG_WHEEL_H_
+#define SYS_MONITOR_WATCHDOG_WHEEL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sys_monitor {
+
+/**
+ * Heartbeat deadlines of many nodes, checked together on a timing wheel.
+ *
+ * A watchdog expires when no heartbeat was fed to it for (misses + 1) times
+ * its timeout. Feed() only stores the time of the heartbeat, without a lock,
+ * so heartbeats can be fed from any thread and never touch the wheel. The
+ * deadlines are checked by Advance(), which must always be called from the
+ * same thread, every tick or so. The wheel has a bucket per tick, and a
+ * watchdog sits in the bucket of its deadline. When a bucket is reached, a
+ * watchdog that was fed in the meantime is moved to the bucket of its new
+ * deadline, and one that wasn't expires. The cost of a tick is the number of
+ * deadlines in its bucket, instead of a timer being reset per heartbeat.
+ *
+ * A watchdog only runs once it got its first heartbeat. After it expired, or
+ * was disarmed, it runs again from its next heartbeat.
+ */
+class WatchdogWheel {
+ public:
+  /**
+   * @param tick    resolution of the deadlines, in seconds
+   * @param slots   number of buckets, the wheel turns every tick * slots
+   */
+  WatchdogWheel(double tick, size_t slots);
+
+  /**
+   * Adds a watchdog and returns its index. Must not run concurrently with
+   * Advance().
+   */
+  size_t Add(double timeout, unsigned int misses);
+
+  /**
+   * Removes all watchdogs. Must not run concurrently with Feed or Advance().
+   */
+  void Clear();
+
+  /**
+   * Records a heartbeat at now, in seconds. Lock free, from any thread.
+   */
+  void Feed(size_t index, double now);
+
+  /**
+   * Stops a watchdog until its next heartbeat, from the thread of Advance().
+   */
+  void Disarm(size_t index);
+
+  /**
+   * Checks the deadlines up to now, in seconds. Adds the watchdogs that
+   * expired to expired and, if not null, the ones that were fed again after
+   * they expired to recovered.
+   */
+  void Advance(double now, std::vector<size_t> *expired,
+               std::vector<size_t> *recovered = nullptr);
+
+  /**
+   * Whether a watchdog ever got a heartbeat
+   */
+  bool Started(size_t index) const;
+
+  size_t Size() const;
+
+ private:
+  enum State { IDLE, ARMED, EXPIRED };
+
+  struct Watchdog {
+    explicit Watchdog(int64_t span);
+
+    // Time of the last heartbeat in ticks, 0 before the first one. Written
+    // by Feed(), everything else only by the thread of Advance().
+    std::atomic<int64_t> fed;
+    int64_t span;
+    State state;
+    // Last heartbeat seen when the watchdog stopped running
+    int64_t stopped_fed;
+    // Deadline of the bucket entry that is current
+    int64_t deadline;
+    uint32_t generation;
+  };
+
+  struct Entry {
+    size_t index;
+    uint32_t generation;
+  };
+
+  int64_t ToTicks(double seconds) const;
+  void Arm(size_t index, int64_t deadline);
+  void Stop(size_t index, State state);
+
+  double tick_;
+  std::vector<std::vector<Entry>> buckets_;
+  std::vector<Entry> due_;
+  std::vector<std::unique_ptr<Watchdog>> watchdogs_;
+  std::vector<size_t> stopped_;
+  int64_t now_;
+};
+
+}  // namespace sys_monitor
+
+#endif  // SYS_MONITOR_WATCHDOG_WHEEL_H_
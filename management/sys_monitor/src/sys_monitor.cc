@@ -19,8 +19,19 @@
 #include "sys_monitor/sys_monitor.h"
 
 namespace sys_monitor {
+
+namespace {
+// Heartbeat deadlines are checked every tick, so faults are triggered at most
+// one tick late. The wheel turns every 6.4 s, and longer deadlines wait in
+// their bucket for as many turns as needed.
+constexpr double kWatchdogTick = 0.1;
+constexpr size_t kWatchdogSlots = 64;
+}  // namespace
+
 SysMonitor::SysMonitor() :
   ff_util::FreeFlyerNodelet(NODE_SYS_MONITOR, true),
+  published_state_(-1),
+  wheel_(kWatchdogTick, kWatchdogSlots),
   pub_queue_size_(10),
   sub_queue_size_(10) {
 }
@@ -51,8 +62,6 @@ void SysMonitor::AddFault(unsigned int fault_id,
 
     fault_state_.faults.push_back(fault);
     SetFaultState(fault_id, true);
-
-    PublishFaultState();
   }
 }
 
@@ -72,8 +81,6 @@ void SysMonitor::AddFault(ff_msgs::Fault const& fault, bool check_added) {
   if (!found) {
     fault_state_.faults.push_back(fault);
     SetFaultState(fault_id, true);
-
-    PublishFaultState();
   }
 }
 
@@ -86,8 +93,6 @@ void SysMonitor::RemoveFault(unsigned int fault_id) {
   }
 
   SetFaultState(fault_id, false);
-
-  PublishFaultState();
 }
 
 void SysMonitor::AddWatchDog(ros::Duration const& timeout,
@@ -98,6 +103,7 @@ void SysMonitor::AddWatchDog(ros::Duration const& timeout,
     SysMonitor::WatchdogPtr watchDog(new SysMonitor::Watchdog(this, timeout,
                                                     allowed_misses, fault_id));
     watch_dogs_.emplace(node_name, watchDog);
+    wheel_watch_dogs_.push_back(watchDog);
   } else {
     NODELET_INFO("AddWatchDog() already exists for %s",
                                                           node_name.c_str());
@@ -134,6 +140,27 @@ void SysMonitor::SetFaultState(unsigned int fault_id, bool adding_fault) {
 }
 
 void SysMonitor::HeartbeatCallback(ff_msgs::HeartbeatConstPtr const& hb) {
+  ProcessHeartbeat(hb);
+
+  // Publish all the faults the heartbeat added or removed at once
+  PublishFaultState();
+}
+
+void SysMonitor::WatchdogTimerCallback(ros::TimerEvent const& te) {
+  expired_.clear();
+  wheel_.Advance(ros::Time::now().toSec(), &expired_);
+  for (size_t index : expired_) {
+    WatchdogPtr wd = wheel_watch_dogs_[index];
+    AddFault(wd->fault_id());
+    PublishFaultResponse(wd->fault_id());
+    // The fault is only triggered once. The watchdog runs again, and the
+    // fault is removed, once a heartbeat from the node is received.
+    wd->hb_fault_occurring(true);
+  }
+  PublishFaultState();
+}
+
+void SysMonitor::ProcessHeartbeat(ff_msgs::HeartbeatConstPtr const& hb) {
   uint i = 0, j = 0, tmp_id;
   bool fault_found = true;
 
@@ -145,7 +172,7 @@ void SysMonitor::HeartbeatCallback(ff_msgs::HeartbeatConstPtr const& hb) {
   // Check to see if node heartbeat is set up in watchdogs
   if (watch_dogs_.count(hb->node) > 0) {
     WatchdogPtr wd = watch_dogs_.at(hb->node);
-    wd->ResetTimer();
+    wd->Feed(ros::Time::now());
     if (wd->nodelet_manager() == "") {
       wd->nodelet_manager(hb->nodelet_manager);
     }
@@ -276,6 +303,13 @@ void SysMonitor::Initialize(ros::NodeHandle *nh) {
   sub_hb_ = nh_.subscribe(TOPIC_HEARTBEAT, sub_queue_size_,
                                           &SysMonitor::HeartbeatCallback, this);
 
+  // A single timer checks the deadlines of all the heartbeats
+  watchdog_timer_ = nh_.createTimer(ros::Duration(kWatchdogTick),
+                                    &SysMonitor::WatchdogTimerCallback,
+                                    this,
+                                    false,
+                                    true);
+
   pub_cmd_ = nh_.advertise<ff_msgs::CommandStamped>(TOPIC_COMMAND,
                                                         pub_queue_size_, false);
 
@@ -287,6 +321,10 @@ void SysMonitor::Initialize(ros::NodeHandle *nh) {
   pub_fault_state_ = nh_.advertise<ff_msgs::FaultState>(
                     TOPIC_MANAGEMENT_SYS_MONITOR_STATE, pub_queue_size_, true);
 
+  // Updates are not latching, as they only make sense in sequence
+  pub_fault_update_ = nh_.advertise<ff_msgs::FaultStateUpdate>(
+                    TOPIC_MANAGEMENT_SYS_MONITOR_UPDATES, pub_queue_size_);
+
   fault_state_.state = ff_msgs::FaultState::FUNCTIONAL;
 
   // Set up service
@@ -366,8 +404,34 @@ void SysMonitor::PublishFaultConfig() {
 }
 
 void SysMonitor::PublishFaultState() {
+  // Find the faults added and removed since the last fault state
+  fault_update_.added.clear();
+  fault_update_.removed.clear();
+  std::set<unsigned int> faults;
+  for (unsigned int i = 0; i < fault_state_.faults.size(); i++) {
+    faults.insert(fault_state_.faults[i].id);
+    if (published_faults_.count(fault_state_.faults[i].id) == 0)
+      fault_update_.added.push_back(fault_state_.faults[i]);
+  }
+  for (unsigned int id : published_faults_) {
+    if (faults.count(id) == 0)
+      fault_update_.removed.push_back(id);
+  }
+
+  // Nothing to publish if nothing changed
+  if (published_state_ == fault_state_.state && fault_update_.added.empty() &&
+      fault_update_.removed.empty()) {
+    return;
+  }
+  published_faults_.swap(faults);
+  published_state_ = fault_state_.state;
+
   fault_state_.header.stamp = ros::Time::now();
   pub_fault_state_.publish(fault_state_);
+
+  fault_update_.header.stamp = fault_state_.header.stamp;
+  fault_update_.state = fault_state_.state;
+  pub_fault_update_.publish(fault_update_);
 }
 
 void SysMonitor::PublishFaultResponse(unsigned int fault_id) {
@@ -404,12 +468,15 @@ void SysMonitor::StartupTimerCallback(ros::TimerEvent const& te) {
       it->second->hb_fault_occurring(true);
     }
   }
+  PublishFaultState();
 }
 
 bool SysMonitor::ReadParams() {
   // Reset/reload watch dogs when config file changes
   if (watch_dogs_.size() > 0) {
     watch_dogs_.clear();
+    wheel_watch_dogs_.clear();
+    wheel_.Clear();
   }
 
   // Read config files into lua
@@ -843,8 +910,8 @@ int SysMonitor::UnloadNodelet(std::string const& nodelet,
     return ff_msgs::UnloadLoadNodelet::Response::ROS_SERVICE_FAILED;
   }
 
-  // Stop timer so we don't get a heartbeat missing fault
-  watch_dogs_.at(nodelet)->StopTimer();
+  // Stop watchdog so we don't get a heartbeat missing fault
+  watch_dogs_.at(nodelet)->Disarm();
   // Set unloaded to true so that if it gets restarted, we remove the previous
   // faults
   watch_dogs_.at(nodelet)->unloaded(true);
@@ -858,16 +925,17 @@ SysMonitor::Watchdog::Watchdog(SysMonitor *const sys_monitor,
                                 uint const allowed_misses,
                                 uint const fault_id) :
   monitor_(sys_monitor),
-  missed_count_(0),
+  index_(sys_monitor->wheel_.Add(timeout.toSec(), allowed_misses)),
   misses_allowed_(allowed_misses),
   fault_id_(fault_id),
   hb_fault_occurring_(false),
-  heartbeat_started_(false),
   unloaded_(false),
   nodelet_manager_(""),
   previous_hb_() {
-  timer_ = monitor_->nh_.createTimer(timeout,
-                      &SysMonitor::Watchdog::TimerCallBack, this, false, false);
+}
+
+size_t SysMonitor::Watchdog::index() {
+  return index_;
 }
 
 uint SysMonitor::Watchdog::fault_id() {
@@ -887,7 +955,7 @@ bool SysMonitor::Watchdog::hb_fault_occurring() {
 }
 
 bool SysMonitor::Watchdog::heartbeat_started() {
-  return heartbeat_started_;
+  return monitor_->wheel_.Started(index_);
 }
 
 bool SysMonitor::Watchdog::unloaded() {
@@ -918,35 +986,18 @@ void SysMonitor::Watchdog::unloaded(bool is_unloaded) {
   unloaded_ = is_unloaded;
 }
 
-void SysMonitor::Watchdog::ResetTimer() {
-  if (!heartbeat_started_) {
-    heartbeat_started_ = true;
-  }
-
-  timer_.stop();
-  timer_.start();
-  missed_count_ = 0;
+void SysMonitor::Watchdog::Feed(ros::Time const& time) {
+  monitor_->wheel_.Feed(index_, time.toSec());
 }
 
-void SysMonitor::Watchdog::StopTimer() {
-  timer_.stop();
+void SysMonitor::Watchdog::Disarm() {
+  monitor_->wheel_.Disarm(index_);
 }
 
 void SysMonitor::Watchdog::previous_hb(ff_msgs::HeartbeatConstPtr hb) {
   previous_hb_ = hb;
 }
 
-void SysMonitor::Watchdog::TimerCallBack(ros::TimerEvent const& te) {
-  if (missed_count_++ >= misses_allowed_) {
-    monitor_->AddFault(fault_id_);
-    monitor_->PublishFaultResponse(fault_id_);
-    // Stop timer so the fault is only triggered once. Timer will be restarted
-    // once a heartbeart from the node is received
-    timer_.stop();
-    hb_fault_occurring_ = true;
-  }
-}
-
 SysMonitor::Fault::Fault(std::string const& node_name,
                          bool const blocking,
                          bool const warning,
@@ -0,0 +1,150 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "sys_monitor/watchdog_wheel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sys_monitor {
+
+WatchdogWheel::Watchdog::Watchdog(int64_t span) :
+  fed(0),
+  span(span),
+  state(IDLE),
+  stopped_fed(0),
+  deadline(0),
+  generation(0) {
+}
+
+WatchdogWheel::WatchdogWheel(double tick, size_t slots) :
+  tick_(tick),
+  buckets_(std::max<size_t>(slots, 1)),
+  now_(0) {
+}
+
+size_t WatchdogWheel::Add(double timeout, unsigned int misses) {
+  int64_t span = std::ceil(timeout * (misses + 1) / tick_);
+  watchdogs_.emplace_back(new Watchdog(std::max<int64_t>(span, 1)));
+  // Watchdogs wait for their first heartbeat
+  stopped_.push_back(watchdogs_.size() - 1);
+  return watchdogs_.size() - 1;
+}
+
+void WatchdogWheel::Clear() {
+  for (auto & bucket : buckets_)
+    bucket.clear();
+  watchdogs_.clear();
+  stopped_.clear();
+}
+
+void WatchdogWheel::Feed(size_t index, double now) {
+  // Ticks are stored plus one, so that 0 means no heartbeat yet. Heartbeats
+  // fed concurrently only ever move the time forward.
+  Watchdog &w = *watchdogs_[index];
+  int64_t fed = ToTicks(now) + 1;
+  int64_t previous = w.fed.load(std::memory_order_relaxed);
+  while (previous < fed &&
+         !w.fed.compare_exchange_weak(previous, fed, std::memory_order_release,
+                                      std::memory_order_relaxed)) {}
+}
+
+void WatchdogWheel::Disarm(size_t index) {
+  Stop(index, IDLE);
+}
+
+void WatchdogWheel::Advance(double now, std::vector<size_t> *expired,
+                            std::vector<size_t> *recovered) {
+  int64_t target = ToTicks(now);
+
+  // Start the watchdogs that got a heartbeat since they stopped
+  for (size_t i = 0; i < stopped_.size();) {
+    size_t index = stopped_[i];
+    Watchdog &w = *watchdogs_[index];
+    int64_t fed = w.fed.load(std::memory_order_acquire);
+    if (fed == w.stopped_fed) {
+      i++;
+      continue;
+    }
+    if (w.state == EXPIRED && recovered != nullptr)
+      recovered->push_back(index);
+    stopped_[i] = stopped_.back();
+    stopped_.pop_back();
+    Arm(index, fed - 1 + w.span);
+  }
+
+  // Every bucket is visited at most once, even after a long pause
+  int64_t slots = buckets_.size();
+  int64_t first = std::max(now_ + 1, target - slots + 1);
+  for (int64_t t = first; t <= target; t++) {
+    std::vector<Entry> &bucket = buckets_[t % slots];
+    due_.swap(bucket);
+    for (const Entry &e : due_) {
+      Watchdog &w = *watchdogs_[e.index];
+      // Entries left behind by a watchdog that moved or stopped
+      if (e.generation != w.generation || w.state != ARMED)
+        continue;
+      // Deadlines of a later turn of the wheel
+      if (w.deadline > target) {
+        bucket.push_back(e);
+        continue;
+      }
+      int64_t deadline = w.fed.load(std::memory_order_acquire) - 1 + w.span;
+      if (deadline > target) {
+        Arm(e.index, deadline);
+      } else {
+        Stop(e.index, EXPIRED);
+        expired->push_back(e.index);
+      }
+    }
+    due_.clear();
+  }
+  now_ = std::max(now_, target);
+}
+
+bool WatchdogWheel::Started(size_t index) const {
+  return watchdogs_[index]->fed.load(std::memory_order_relaxed) != 0;
+}
+
+size_t WatchdogWheel::Size() const {
+  return watchdogs_.size();
+}
+
+int64_t WatchdogWheel::ToTicks(double seconds) const {
+  return std::floor(seconds / tick_);
+}
+
+void WatchdogWheel::Arm(size_t index, int64_t deadline) {
+  Watchdog &w = *watchdogs_[index];
+  // A deadline that already passed is checked at the next bucket
+  w.deadline = std::max(deadline, now_ + 1);
+  w.state = ARMED;
+  w.generation++;
+  buckets_[w.deadline % buckets_.size()].push_back({index, w.generation});
+}
+
+void WatchdogWheel::Stop(size_t index, State state) {
+  Watchdog &w = *watchdogs_[index];
+  if (w.state == ARMED)
+    stopped_.push_back(index);
+  w.state = state;
+  w.stopped_fed = w.fed.load(std::memory_order_acquire);
+  w.generation++;
+}
+
+}  // namespace sys_monitor
@@ -0,0 +1,171 @@
+// Copyright 2017 Intelligent Robotics Group, NASA ARC
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Required for the test cases
+#include <sys_monitor/watchdog_wheel.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+// Ticks are a power of two fraction of a second, so times are exact
+constexpr double kTick = 0.125;
+
+TEST(watchdog_wheel, ExpiresAfterMisses) {
+  sys_monitor::WatchdogWheel wheel(kTick, 16);
+  // Expires 3 seconds, or 24 ticks, after its last heartbeat
+  size_t index = wheel.Add(1.0, 2);
+  std::vector<size_t> expired, recovered;
+
+  // Nothing runs before the first heartbeat
+  wheel.Advance(10.0, &expired, &recovered);
+  EXPECT_FALSE(wheel.Started(index));
+  EXPECT_TRUE(expired.empty());
+
+  wheel.Feed(index, 10.0);
+  EXPECT_TRUE(wheel.Started(index));
+  for (double t = 10.0; t < 13.0; t += kTick)
+    wheel.Advance(t, &expired, &recovered);
+  EXPECT_TRUE(expired.empty());
+  wheel.Advance(13.0, &expired, &recovered);
+  ASSERT_EQ(expired.size(), 1u);
+  EXPECT_EQ(expired[0], index);
+
+  // Only expires once, and recovers with the next heartbeat
+  wheel.Advance(20.0, &expired, &recovered);
+  EXPECT_EQ(expired.size(), 1u);
+  wheel.Feed(index, 20.0);
+  wheel.Advance(20.0, &expired, &recovered);
+  ASSERT_EQ(recovered.size(), 1u);
+  wheel.Advance(22.875, &expired, &recovered);
+  EXPECT_EQ(expired.size(), 1u);
+  wheel.Advance(23.0, &expired, &recovered);
+  EXPECT_EQ(expired.size(), 2u);
+}
+
+TEST(watchdog_wheel, Disarm) {
+  sys_monitor::WatchdogWheel wheel(kTick, 16);
+  size_t index = wheel.Add(1.0, 0);
+  std::vector<size_t> expired, recovered;
+
+  wheel.Feed(index, 0.0);
+  wheel.Advance(0.0, &expired, &recovered);
+  wheel.Disarm(index);
+  wheel.Advance(5.0, &expired, &recovered);
+  EXPECT_TRUE(expired.empty());
+
+  // Runs again from its next heartbeat, without recovering
+  wheel.Feed(index, 5.0);
+  wheel.Advance(5.0, &expired, &recovered);
+  EXPECT_TRUE(recovered.empty());
+  wheel.Advance(6.0, &expired, &recovered);
+  EXPECT_EQ(expired.size(), 1u);
+}
+
+TEST(watchdog_wheel, LongPause) {
+  // Deadlines several turns of the wheel away, and an advance over many turns
+  sys_monitor::WatchdogWheel wheel(kTick, 4);
+  size_t near = wheel.Add(1.0, 0);
+  size_t far = wheel.Add(10.0, 0);
+  std::vector<size_t> expired;
+
+  wheel.Feed(near, 0.0);
+  wheel.Feed(far, 0.0);
+  wheel.Advance(0.0, &expired);
+  wheel.Advance(9.875, &expired);
+  ASSERT_EQ(expired.size(), 1u);
+  EXPECT_EQ(expired[0], near);
+  wheel.Advance(100.0, &expired);
+  ASSERT_EQ(expired.size(), 2u);
+  EXPECT_EQ(expired[1], far);
+}
+
+// Hundreds of nodelets beat once a second, from several threads, while the
+// wheel is advanced every tick on another. Nodelets go silent and come back
+// at random. A silent nodelet must expire exactly when its deadline passes,
+// and recover with its next heartbeat, and a beating one must never expire.
+TEST(watchdog_wheel, Stress) {
+  const size_t nodelets = 600, threads = 4, steps = 2000, slots = 64;
+  const int64_t period = 8;
+  sys_monitor::WatchdogWheel wheel(kTick, slots);
+  for (size_t i = 0; i < nodelets; i++)
+    wheel.Add(1.1, 2);
+  const int64_t span = 27;  // ceil(3.3 / 0.125)
+
+  // Outage of each nodelet, as [start, end) steps
+  std::mt19937 generator(0);
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> outages(nodelets);
+  for (size_t i = 0; i < nodelets; i++) {
+    for (int64_t t = 50 + generator() % 200; t < static_cast<int64_t>(steps);
+         t += 100 + generator() % 200) {
+      int64_t length = 5 + generator() % 60;
+      outages[i].emplace_back(t, t + length);
+      t += length;
+    }
+  }
+  auto beats = [&outages, period](size_t i, int64_t step) {
+    if ((step + static_cast<int64_t>(i)) % period != 0)
+      return false;
+    for (auto & o : outages[i])
+      if (step >= o.first && step < o.second)
+        return false;
+    return true;
+  };
+
+  std::vector<int64_t> last_beat(nodelets, -1);
+  std::vector<bool> is_expired(nodelets, false);
+  size_t expiries = 0, recoveries = 0;
+  std::vector<size_t> expired, recovered;
+  for (int64_t step = 0; step < static_cast<int64_t>(steps); step++) {
+    // Heartbeats of this step, concurrent with the check of the last step
+    std::vector<std::thread> feeders;
+    for (size_t f = 0; f < threads; f++) {
+      feeders.emplace_back([&wheel, &beats, f, step, nodelets, threads]() {
+        for (size_t i = f; i < nodelets; i += threads)
+          if (beats(i, step))
+            wheel.Feed(i, step * kTick);
+      });
+    }
+    int64_t target = step - 1;
+    expired.clear();
+    recovered.clear();
+    wheel.Advance(target * kTick, &expired, &recovered);
+    for (auto & f : feeders)
+      f.join();
+
+    for (size_t i : expired) {
+      // The last heartbeat that could have been seen
+      ASSERT_FALSE(is_expired[i]);
+      ASSERT_EQ(last_beat[i] + span, target) << "nodelet " << i;
+      is_expired[i] = true;
+      expiries++;
+    }
+    for (size_t i : recovered) {
+      ASSERT_TRUE(is_expired[i]);
+      is_expired[i] = false;
+      recoveries++;
+    }
+    for (size_t i = 0; i < nodelets; i++) {
+      // Every deadline that passed was caught, unless the check may have
+      // seen the heartbeat of this step, which moves the deadline
+      if (last_beat[i] >= 0 && !is_expired[i] && !beats(i, step)) {
+        ASSERT_GT(last_beat[i] + span, target) << "nodelet " << i;
+      }
+      if (beats(i, step))
+        last_beat[i] = step;
+    }
+  }
+  EXPECT_GT(expiries, nodelets);
+  EXPECT_GT(recoveries, nodelets);
+}
+
+// Run all the tests that were declared with TEST()
+int main(int argc, char **argv) {
+  // Initialize the gtest framework
+  testing::InitGoogleTest(&argc, argv);
+
+  // Run all test procedures
+  return RUN_ALL_TESTS();
+}
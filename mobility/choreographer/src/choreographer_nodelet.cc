@@ -1153,8 +1153,8 @@ class ChoreographerNodelet : public ff_util::FreeFlyerNodelet {
       // Zach's planner in GDS (as well as other planners) do not respect
       // the minimum control period required by GNC. This segment of code
       // numerically resamples the input segment, so control accepts it.
-      if (ff_util::FlightUtil::Resample(goal->segment, segment_)
-        != ff_util::SUCCESS) {
+      if (ff_util::FlightUtil::Resample(goal->segment, segment_, -1.0,
+        segment_view_) != ff_util::SUCCESS) {
         result.response = RESPONSE::COULD_NOT_RESAMPLE;
         server_.SendResult(ff_util::FreeFlyerActionState::ABORTED, result);
         return;
@@ -1215,6 +1215,7 @@ class ChoreographerNodelet : public ff_util::FreeFlyerNodelet {
   ff_msgs::FlightMode flight_mode_;                   // Desired flight mode
   std::vector<geometry_msgs::PoseStamped> states_;    // Plan request
   ff_util::Segment segment_;                          // Segment
+  ff_util::SegmentView segment_view_;                 // Resampling scratch
   geometry_msgs::PointStamped obstacle_;              // Obstacle
   bool prep_required_;                                // Check if prep needed
 };
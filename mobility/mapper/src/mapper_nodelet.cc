@@ -23,17 +23,13 @@
 #include <ff_util/ff_nodelet.h>
 #include <ff_util/ff_action.h>
 #include <ff_util/ff_flight.h>
-#include <ff_util/ff_serialization.h>
+#include <ff_util/serialized_store.h>
 #include <ff_util/config_server.h>
 
 // For plugin loading
 #include <nodelet/nodelet.h>
 #include <pluginlib/class_list_macros.h>
 
-// Keepout zones for the planner
-#include <boost/filesystem.hpp>
-#include <boost/range/iterator_range_core.hpp>
-
 // For plotting to RVIZ
 #include <visualization_msgs/MarkerArray.h>
 
@@ -56,8 +52,6 @@
  */
 namespace mapper {
 
-namespace fs = boost::filesystem;
-
 // Convenience declarations
 using RESPONSE = ff_msgs::ValidateResult;
 
@@ -113,30 +107,14 @@ class MapperNodelet : public ff_util::FreeFlyerNodelet {
     if (!handle->GetStr("zone_directory", &zone_dir))
       NODELET_FATAL_STREAM("Cannot read zone directory from LUA config");
 
-    // Resolve the zone directory and load the keepins and keepouts files
-    fs::path dir(zone_dir);
-    if (!fs::exists(dir) || !fs::is_directory(dir))
+    // Open the zone directory and load the newest zones saved in it. Once zones
+    // were saved, only the index of the directory and that file are read. The
+    // store only writes when zones are saved, so an installed directory that
+    // is read-only can still be opened.
+    if (!zone_store_.Open(zone_dir, ".bin", &MapperNodelet::ZoneStamp))
       NODELET_FATAL_STREAM("Cannot open zone directory");
-    // Set the default time to 1 to check if this changed on read
-    bool found = false;
-    // Try and read the zone
-    auto files = boost::make_iterator_range(fs::directory_iterator(dir),
-      fs::directory_iterator());
-    for (fs::path const& e : files) {
-      if (e.extension() != ".bin")
-        continue;
-      ff_msgs::SetZones::Request zones;
-      if (ff_util::Serialization::ReadFile(e.native(), zones)) {
-        if (zones.timestamp >= zones_.timestamp) {
-          found = true;
-          zones_ = zones;
-        }
-      } else {
-        NODELET_WARN_STREAM("Cannot open zone file " << e.native());
-      }
-    }
     // Special case: nothing was loaded.
-    if (!found)
+    if (!zone_store_.LoadNewest(zones_))
       NODELET_WARN_STREAM("No zone files loaded");
     // Update the RVIZ markers
     UpdateMarkers();
@@ -157,6 +135,11 @@ class MapperNodelet : public ff_util::FreeFlyerNodelet {
     return true;
   }
 
+  // The zones saved last are loaded on startup
+  static ros::Time ZoneStamp(ff_msgs::SetZones::Request const& zones) {
+    return zones.timestamp;
+  }
+
   // Callback to get the zones
   bool GetZonesCallback(ff_msgs::GetZones::Request& req,
     ff_msgs::GetZones::Response& res) {
@@ -170,9 +153,8 @@ class MapperNodelet : public ff_util::FreeFlyerNodelet {
   ff_msgs::SetZones::Response& res) {  //NOLINT
     if (req.timestamp >= zones_.timestamp) {
       zones_ = req;
-      fs::path zone_file(std::to_string(zones_.timestamp.sec) + ".bin");
-      if (!ff_util::Serialization::WriteFile(
-        (zone_dir_ / zone_file).native(), zones_)) return false;
+      // Written in the background, so the caller does not wait on the disk
+      zone_store_.Save(zones_);
       UpdateMarkers();
       return true;
     }
@@ -274,7 +256,8 @@ class MapperNodelet : public ff_util::FreeFlyerNodelet {
       state_ = VALIDATING;
       // For now, just do the usual validation tricks
       ff_util::SegmentResult r = ff_util::FlightUtil::Check(ff_util::CHECK_ALL,
-        segment_, validate_goal->flight_mode, validate_goal->faceforward);
+        segment_, validate_goal->flight_mode, validate_goal->faceforward,
+        segment_view_);
       // Print a nice readable error error
       if (r != ff_util::SUCCESS) {
         NODELET_DEBUG_STREAM(*validate_goal);
@@ -324,10 +307,11 @@ class MapperNodelet : public ff_util::FreeFlyerNodelet {
 
  protected:
   State state_;                            // State of the mapper
-  std::string zone_dir_;                   // Zone file directory
+  ff_util::SerializedStore<ff_msgs::SetZones::Request> zone_store_;  // Zone files
   ff_msgs::SetZones::Request zones_;       // Zone set request
   ff_util::FreeFlyerActionServer <ff_msgs::ValidateAction> server_v_;
   ff_util::Segment segment_;               // Segment
+  ff_util::SegmentView segment_view_;      // Validation scratch space
   ros::Publisher pub_m_;                   // Visualization of map
   ros::ServiceServer srv_g_;               // Get zone service
   ros::ServiceServer srv_s_;               // Set zone service
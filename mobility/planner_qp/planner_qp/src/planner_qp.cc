@@ -44,6 +44,12 @@
 #include <tf/tf.h>
 // #include "pcl_ros/point_cloud.h"  //  NO_LINT()
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
 #define DEBUG false
 #define OUTPUT_DEBUG NODELET_DEBUG_STREAM
 /**
@@ -78,6 +84,17 @@ class Planner : public planner::PlannerImplementation {
     // Grab some configuration parameters for this node from the LUA config
     cfg_.Initialize(GetPrivateHandle(), "mobility/planner_qp.config");
     cfg_.Listen(boost::bind(&Planner::ReconfigureCallback, this, _1));
+    // Resolve the parameters read while planning, to skip the lookups by name
+    cfg_.Resolve("two_d", cfg_two_d_);
+    cfg_.Resolve("reduced_kkt", cfg_reduced_kkt_);
+    cfg_.Resolve("warm_start", cfg_warm_start_);
+    cfg_.Resolve("publish_trajectory", cfg_publish_trajectory_);
+    cfg_.Resolve("candidates", cfg_candidates_);
+    cfg_.Resolve("map_resolution", cfg_map_resolution_);
+    cfg_.Resolve("robot_radius", cfg_robot_radius_);
+    cfg_.Resolve("candidate_dilation", cfg_candidate_dilation_);
+    cfg_.Resolve("candidate_budget", cfg_candidate_budget_);
+    cfg_.Resolve("warm_start_tolerance", cfg_warm_start_tolerance_);
 
     // Setup a timer to forward diagnostics
     timer_d_ =
@@ -148,19 +165,13 @@ class Planner : public planner::PlannerImplementation {
 
     // set z to be the same if in granite lab
     bool use_2d;
-    if (!cfg_.Get<bool>("two_d", use_2d)) use_2d = true;
+    if (!cfg_two_d_.Get(use_2d)) use_2d = true;
     if (use_2d) end_eig(2) = start_eig(2);
 
-    // try to optimize trajectory, return on failure
+    // try to optimize trajectory, scaled to the limits, return on failure
     if (!generate_trajectory(start_eig, end_eig, &plan_result))
       return PlanResult(plan_result);
 
-    // Check face forward
-    if (!calculate_time_scale()) {
-      plan_result.response = RESPONSE::BAD_ARGUMENTS;
-      return PlanResult(plan_result);
-    }
-
     sample_trajectory(&plan_result.segment);
 
     if (faceforward_)
@@ -175,6 +186,12 @@ class Planner : public planner::PlannerImplementation {
 
  protected:
   ff_util::ConfigServer cfg_;
+  ff_util::ConfigParam<bool> cfg_two_d_, cfg_reduced_kkt_, cfg_warm_start_,
+      cfg_publish_trajectory_;
+  ff_util::ConfigParam<int> cfg_candidates_;
+  ff_util::ConfigParam<double> cfg_map_resolution_, cfg_robot_radius_,
+      cfg_candidate_dilation_, cfg_candidate_budget_,
+      cfg_warm_start_tolerance_;
   ros::Timer timer_d_;
   boost::shared_ptr<traj_opt::NonlinearTrajectory> trajectory_;
   tf::Quaternion start_orientation_;
@@ -184,9 +201,44 @@ class Planner : public planner::PlannerImplementation {
   double map_res_{0.5};     // map resolution
 
  private:
-  std::shared_ptr<JPS::VoxelMapUtil> jps_map_util_;
-  std::unique_ptr<EllipseDecomp> decomp_util_;
-  std::unique_ptr<JPS::JPS3DUtil> jps_planner_;
+  // An occupancy map dilated by some radius, with its obstacles for the
+  // corridor decomposition. The first is dilated by the robot radius, and each
+  // next one by a further candidate_dilation factor.
+  struct DilatedMap {
+    std::shared_ptr<JPS::VoxelMapUtil> util;
+    vec_Vec3f cloud;
+  };
+  std::vector<DilatedMap> maps_;
+
+  // One of the paths and corridors solved for a plan. JPS is given a mutable
+  // map, and candidates are searched concurrently, so each one works on its
+  // own copy of its dilated map rather than the one in maps_.
+  struct Candidate {
+    const DilatedMap *map{NULL};
+    std::shared_ptr<JPS::VoxelMapUtil> util;
+    bool reverse{false};  // search from the goal to the start
+    vec_Vec3f path;
+    std::vector<std::pair<traj_opt::MatD, traj_opt::VecD> > cons;
+    boost::shared_ptr<traj_opt::NonlinearTrajectory> trajectory;
+    boost::shared_ptr<const std::vector<double> > solution;
+  };
+  // Settings shared by all candidates of a plan
+  struct CandidateSettings {
+    traj_opt::Vec4 start, goal;
+    bool close;  // start and goal are within a map cell
+    traj_opt::SolverOptions options;
+    bool warm_start;
+    double warm_start_tolerance;
+  };
+
+  // The last solved problem, whose solution seeds the next solve when the
+  // replan has the same goal and a similar path and corridor
+  struct WarmStart {
+    traj_opt::Vec4 goal;
+    vec_Vec3f path;
+    std::vector<std::pair<traj_opt::MatD, traj_opt::VecD> > cons;
+    boost::shared_ptr<const std::vector<double> > values;
+  } warm_start_;
 
   double norm_vector3(const geometry_msgs::Vector3 &vec) {
     return std::sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z);
@@ -326,15 +378,17 @@ class Planner : public planner::PlannerImplementation {
     // clear trajectory
     trajectory_ = boost::shared_ptr<traj_opt::NonlinearTrajectory>();
 
+    // get the number of candidates first, as it sets how many maps to build
+    int num_candidates;
+    if (!cfg_candidates_.Get(num_candidates)) num_candidates = 1;
+    num_candidates = std::max(num_candidates, 1);
+
     // try to get zones
     std::vector<ff_msgs::Zone> zones;
-    if (!load_map()) {
+    if (!load_map((num_candidates + 1) / 2)) {
       ROS_ERROR("Planner::QP: Planner failed to load keepins and keepouts");
       return false;
     }
-    // get sample increment
-    double radius;
-    if (!cfg_.Get<double>("robot_radius", radius)) radius = 0.26;
 
     traj_opt::Vec3 start3 = start.block<3, 1>(0, 0);
     traj_opt::Vec3 goal3 = goal.block<3, 1>(0, 0);
@@ -343,38 +397,168 @@ class Planner : public planner::PlannerImplementation {
     diff << std::abs(diff(0)), std::abs(diff(1)), std::abs(diff(2));
     diff -= traj_opt::Vec3::Ones() * map_res_;
 
-    vec_Vec3f path;
-    bool close = false;
-
-    if (diff(0) < 0 && diff(1) < 0 && diff(2) < 0) {
+    // Candidates alternate between searching from the start and from the goal,
+    // in maps dilated by increasing radii
+    std::vector<Candidate> candidates;
+    bool close = diff(0) < 0 && diff(1) < 0 && diff(2) < 0;
+    if (close) {
       ROS_INFO_STREAM(
           "Start and goal are within map resolution: " << diff.transpose());
-      path.push_back(start3);
-      path.push_back(goal3);
-      close = true;
+      Candidate c;
+      c.map = &maps_.front();
+      c.path.push_back(start3);
+      c.path.push_back(goal3);
+      candidates.push_back(c);
       // result->response = RESPONSE::ALREADY_THERE;
     } else {
-      OUTPUT_DEBUG("PlannerQP: JPS running");
-      if (!jps_planner_->plan(start3, goal3)) {
-        ROS_ERROR("Planner::QP: Jump point search failed!");
-        return false;
+      for (int i = 0; i < num_candidates; i++) {
+        Candidate c;
+        c.map = &maps_.at(i / 2);
+        c.reverse = (i % 2 == 1);
+        candidates.push_back(c);
       }
-      path = jps_planner_->getPath();
     }
+    for (auto &c : candidates)
+      c.util.reset(new JPS::VoxelMapUtil(*c.map->util));
+
+    // solver settings are read here, as the candidates run on other threads
+    CandidateSettings settings;
+    settings.start = start;
+    settings.goal = goal;
+    settings.close = close;
+    bool reduced_kkt;
+    if (!cfg_reduced_kkt_.Get(reduced_kkt)) reduced_kkt = true;
+    settings.options.backend = reduced_kkt
+                                   ? traj_opt::NonlinearSolver::KKT_LDLT
+                                   : traj_opt::NonlinearSolver::KKT_LU;
+    double budget;
+    if (!cfg_candidate_budget_.Get(budget)) budget = 0.5;
+    if (max_time_ > 0.0)
+      settings.options.deadline =
+          std::chrono::steady_clock::now() +
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(budget * max_time_));
+    if (!cfg_warm_start_.Get(settings.warm_start))
+      settings.warm_start = true;
+    if (!cfg_warm_start_tolerance_.Get(settings.warm_start_tolerance))
+      settings.warm_start_tolerance = 0.2;
+
+    // search and decompose, then solve the distinct corridors
+    if (!close) {
+      OUTPUT_DEBUG("PlannerQP: JPS running for " << candidates.size()
+                                                 << " candidates");
+      run_parallel(candidates.size(),
+                   [this, &settings, &candidates](size_t i) {
+                     search_candidate(settings, &candidates[i]);
+                   });
+    }
+    for (uint i = 0; i < candidates.size(); i++) {
+      if (candidates[i].path.empty()) continue;
+      for (uint j = 0; j < i; j++)
+        if (candidates[j].path == candidates[i].path)
+          candidates[i].path.clear();
+    }
+    run_parallel(candidates.size(), [this, &settings, &candidates](size_t i) {
+      if (!candidates[i].path.empty())
+        solve_candidate(settings, &candidates[i]);
+    });
+    warm_start_.values.reset();
+
+    // keep the solved trajectory that is fastest once scaled to the limits
+    Candidate *best = NULL;
+    bool found_path = false, solved = false;
+    for (auto &c : candidates) {
+      found_path = found_path || !c.path.empty();
+      if (c.trajectory == NULL || !c.trajectory->isSolved()) continue;
+      solved = true;
+      trajectory_ = c.trajectory;
+      if (!calculate_time_scale()) continue;
+      OUTPUT_DEBUG("PlannerQP: Candidate with " << c.path.size()
+                                                << " waypoints takes "
+                                                << trajectory_->getTotalTime());
+      if (best == NULL ||
+          trajectory_->getTotalTime() < best->trajectory->getTotalTime())
+        best = &c;
+    }
+    trajectory_ = boost::shared_ptr<traj_opt::NonlinearTrajectory>();
+    if (!found_path) {
+      ROS_ERROR("Planner::QP: Jump point search failed!");
+      return false;
+    }
+    if (best == NULL) {
+      if (solved) result->response = RESPONSE::BAD_ARGUMENTS;
+      return false;
+    }
+    trajectory_ = best->trajectory;
+
+    // publish visualization
+    bool pub_traj;
+    if (!cfg_publish_trajectory_.Get(pub_traj)) pub_traj = true;
+    if (pub_traj)
+      TrajRosBridge::publish_msg(
+          trajectory_->serialize(), "world",
+          nh_->getNamespace() + std::string("/mob/planner_qp/trajectory"));
+    // ROS_ERROR_STREAM("name resolution " << nh_->getNamespace() );
+    warm_start_.goal = goal;
+    warm_start_.path = best->path;
+    warm_start_.cons = best->cons;
+    warm_start_.values = best->solution;
+    return true;
+  }
+  // Runs fn(i) for every i < n, on up to one thread per core
+  static void run_parallel(size_t n, const std::function<void(size_t)> &fn) {
+    size_t workers = std::min<size_t>(
+        n, std::max<size_t>(std::thread::hardware_concurrency(), 1));
+    std::atomic<size_t> next(0);
+    auto work = [n, &next, &fn]() {
+      for (size_t i = next++; i < n; i = next++) fn(i);
+    };
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; w++) threads.emplace_back(work);
+    work();
+    for (auto &t : threads) t.join();
+  }
+  // Finds the path of a candidate, leaving it empty if there is none.
+  // Candidates run concurrently, so this only reads the planner state, and
+  // searches the map copy of the candidate.
+  void search_candidate(const CandidateSettings &settings, Candidate *c) {
+    traj_opt::Vec3 start3 = settings.start.block<3, 1>(0, 0);
+    traj_opt::Vec3 goal3 = settings.goal.block<3, 1>(0, 0);
+    JPS::JPS3DUtil jps(false);
+    jps.setMapUtil(c->util.get());
+    if (c->reverse) {
+      if (!jps.plan(goal3, start3)) return;
+      c->path = jps.getPath();
+      std::reverse(c->path.begin(), c->path.end());
+    } else {
+      if (!jps.plan(start3, goal3)) return;
+      c->path = jps.getPath();
+    }
+  }
+  // Decomposes the corridor of a candidate and solves its trajectory, which is
+  // left unset on failure. Candidates run concurrently, so this only reads the
+  // planner state.
+  void solve_candidate(const CandidateSettings &settings, Candidate *c) {
+    const vec_Vec3f &path = c->path;
     // get constraints and repackage as dynamic sized arrays
     OUTPUT_DEBUG("PlannerQP: decomp running on path length " << path.size());
-    decomp_util_->decomp(path);
+    EllipseDecomp decomp(c->util->getOrigin(),
+                         c->util->getDim().cast<decimal_t>() *
+                             c->util->getRes(),
+                         false);
+    decomp.set_obstacles(c->map->cloud);
+    decomp.decomp(path);
 
     for (auto &p : path) OUTPUT_DEBUG("PlannerQP: Path: " << p.transpose());
-    vec_LinearConstraint3f cons_3d = decomp_util_->get_constraints();
-    std::vector<std::pair<traj_opt::MatD, traj_opt::VecD> > cons;
+    vec_LinearConstraint3f cons_3d = decomp.get_constraints();
+    std::vector<std::pair<traj_opt::MatD, traj_opt::VecD> > &cons = c->cons;
     for (auto &ci : cons_3d) {
       traj_opt::MatD A = traj_opt::MatD::Zero(ci.first.rows(), 4);
       traj_opt::VecD b =
           traj_opt::VecD::Zero(ci.second.rows(), ci.second.cols());
       // OUTPUT_DEBUG("PlannerQP: Ci size " << ci.second.rows() << " "<<
       // ci.second.cols() );
-      if (!close) {
+      if (!settings.close) {
         A.block(0, 0, ci.first.rows(), ci.first.cols()) = ci.first;
         b.block(0, 0, ci.second.rows(), ci.second.cols()) = ci.second;
       }
@@ -385,14 +569,14 @@ class Planner : public planner::PlannerImplementation {
 
     // Package higher order waypoints
     traj_opt::Waypoint start_way, goal_way;
-    start_way.pos = start;
+    start_way.pos = settings.start;
     start_way.use_pos = true;
     start_way.use_vel = true;
     start_way.use_acc = true;
     start_way.use_jrk = true;
     start_way.knot_id = 0;
 
-    goal_way.pos = goal;
+    goal_way.pos = settings.goal;
     goal_way.use_pos = true;
     goal_way.use_vel = true;
     goal_way.use_acc = true;
@@ -405,7 +589,6 @@ class Planner : public planner::PlannerImplementation {
 
     boost::shared_ptr<std::vector<double> > ds =
         boost::make_shared<std::vector<double> >(cons.size(), 1.0);
-
     for (uint i = 1; i < path.size(); i++) {
       // ds->at(i-1) = (path.at(i)- path.at(i-1)).norm();
       traj_opt::VecD p1(traj_opt::VecD::Zero(4, 1));
@@ -420,33 +603,74 @@ class Planner : public planner::PlannerImplementation {
       // diff2: " << diff2.transpose());
     }
 
+    traj_opt::SolverOptions options = settings.options;
+    if (settings.warm_start &&
+        similar_to_last(settings.warm_start_tolerance, settings.goal, path,
+                        cons))
+      options.warm_start = warm_start_.values;
+
+    boost::shared_ptr<traj_opt::NonlinearTrajectory> trajectory;
     try {
-      trajectory_.reset(new traj_opt::NonlinearTrajectory(con, cons, 7, 3, ds));
+      trajectory.reset(new traj_opt::NonlinearTrajectory(
+          con, cons, 7, 3, ds, boost::shared_ptr<traj_opt::VecDVec>(),
+          options));
     } catch (std::runtime_error &e) {
       ROS_ERROR_STREAM("QP::Planner failed with error: " << e.what());
-      return false;
+      return;
     } catch (...) {
       ROS_ERROR_STREAM("QP::Planner failed with unknown error");
-      return false;
+      return;
     }
-    std::string pass = trajectory_->isSolved() ? "solved" : "failed";
+    std::string pass = trajectory->isSolved() ? "solved" : "failed";
     // viz topics
     // VisualizeRectangularPolytopes::fromGraph(graph.get(),
     // path_solver->spath);
     // QPRosBridge::publish_msg(trajectory_->serialize());
 
-    OUTPUT_DEBUG(
-        "PlannerQP: Planner::QP: Finished solving with status: " << pass);
-
-    // publish visualization
-    bool pub_traj;
-    if (!cfg_.Get<bool>("publish_trajectory", pub_traj)) pub_traj = true;
-    if (pub_traj)
-      TrajRosBridge::publish_msg(
-          trajectory_->serialize(), "world",
-          nh_->getNamespace() + std::string("/mob/planner_qp/trajectory"));
-    // ROS_ERROR_STREAM("name resolution " << nh_->getNamespace() );
-    return trajectory_->isSolved();
+    OUTPUT_DEBUG("PlannerQP: Planner::QP: Finished solving with status: "
+                 << pass << (trajectory->isWarmStarted() ? " (warm)" : ""));
+    const traj_opt::SolverStats &stats = trajectory->getSolverStats();
+    OUTPUT_DEBUG("PlannerQP: Solver took "
+                 << stats.total_time * 1000.0 << " ms in " << stats.iterations
+                 << " iterations, evaluation " << stats.evaluate_time * 1000.0
+                 << " ms, factorization " << stats.factor_time * 1000.0
+                 << " ms, LU fallbacks " << stats.fallbacks
+                 << (stats.timed_out ? ", out of time" : ""));
+    // the solution is kept before time scaling, to seed the next plan
+    if (trajectory->isSolved())
+      c->solution = boost::make_shared<const std::vector<double> >(
+          trajectory->getSolution());
+    c->trajectory = trajectory;
+  }
+  // Whether the last solution can seed this problem. The goal position must
+  // not have moved, and every path point and corridor half space must be
+  // within the tolerance of the last one. The number of variables is checked
+  // by the solver itself.
+  bool similar_to_last(
+      double tol, const traj_opt::Vec4 &goal, const vec_Vec3f &path,
+      const std::vector<std::pair<traj_opt::MatD, traj_opt::VecD> > &cons) {
+    if (warm_start_.values == NULL) return false;
+    // the yaw is relative to the start orientation, so only the position
+    if ((goal - warm_start_.goal).head<3>().norm() > 1e-6) return false;
+    if (path.size() != warm_start_.path.size()) return false;
+    for (uint i = 0; i < path.size(); i++)
+      if ((path[i] - warm_start_.path[i]).norm() > tol) return false;
+    if (cons.size() != warm_start_.cons.size()) return false;
+    for (uint i = 0; i < cons.size(); i++) {
+      const traj_opt::MatD &A = cons[i].first;
+      const traj_opt::MatD &A_last = warm_start_.cons[i].first;
+      if (A.rows() != A_last.rows()) return false;
+      // compare the half spaces as unit normal and distance
+      for (int j = 0; j < A.rows(); j++) {
+        double n = A.row(j).norm(), n_last = A_last.row(j).norm();
+        if (n < 1e-9 || n_last < 1e-9) return false;
+        if ((A.row(j) / n - A_last.row(j) / n_last).norm() > tol ||
+            std::abs(cons[i].second(j) / n -
+                     warm_start_.cons[i].second(j) / n_last) > tol)
+          return false;
+      }
+    }
+    return true;
   }
   tf::Quaternion calculate_face_foward(const traj_opt::Vec4 &vel) {
     // x axis of body is alligend with velocity, if velocity is zero, use
@@ -635,8 +859,8 @@ class Planner : public planner::PlannerImplementation {
       }
     }
   }
-  bool load_map() {
-    if (!cfg_.Get<double>("map_resolution", map_res_)) map_res_ = 0.5;
+  bool load_map(int num_maps) {
+    if (!cfg_map_resolution_.Get(map_res_)) map_res_ = 0.5;
 
     std::vector<ff_msgs::Zone> zones;
     bool got = GetZones(zones);
@@ -673,8 +897,9 @@ class Planner : public planner::PlannerImplementation {
 
     std::vector<signed char> map(num_cell, 0);
 
-    jps_map_util_.reset(new JPS::VoxelMapUtil());
-    jps_map_util_->setMap(origin, dim, map, map_res_);
+    // only used to index the map while it is filled in
+    std::shared_ptr<JPS::VoxelMapUtil> index_util(new JPS::VoxelMapUtil());
+    index_util->setMap(origin, dim, map, map_res_);
 
     vec_Vec3f keepout_points = haz_cam_points_;
 
@@ -694,10 +919,10 @@ class Planner : public planner::PlannerImplementation {
               tmp(j) = zx;
               tmp(k) = zy;
               tmp(i) = zmin(i) - map_res_ * 1.001;
-              map[jps_map_util_->getIndex(jps_map_util_->floatToInt(tmp))] =
+              map[index_util->getIndex(index_util->floatToInt(tmp))] =
                   100;
               tmp(i) = zmax(i) + map_res_ * 1.001;
-              map[jps_map_util_->getIndex(jps_map_util_->floatToInt(tmp))] =
+              map[index_util->getIndex(index_util->floatToInt(tmp))] =
                   100;
             }
           }
@@ -729,7 +954,7 @@ class Planner : public planner::PlannerImplementation {
                 tmp(j) = zx;
                 tmp(k) = zy;
                 tmp(i) = zz;
-                map[jps_map_util_->getIndex(jps_map_util_->floatToInt(tmp))] =
+                map[index_util->getIndex(index_util->floatToInt(tmp))] =
                     0;
               }
             }
@@ -738,40 +963,38 @@ class Planner : public planner::PlannerImplementation {
       OUTPUT_DEBUG("PlannerQP: Keepout: " << zmin.transpose() << " to "
                                           << zmax.transpose());
     }
-    // reset map
-    jps_map_util_->setMap(origin, dim, map, map_res_);
     // for(auto &p:keepout_points)
     // OUTPUT_DEBUG("PlannerQP: Keepout point: " << p.transpose());
     OUTPUT_DEBUG("PlannerQP: add3DPoints: " << keepout_points.size());
     // dialate
     double radius;
-    if (!cfg_.Get<double>("robot_radius", radius)) radius = 0.26;
-
-    jps_map_util_->freeUnKnown();
-    jps_map_util_->dilate(radius, radius);
-    jps_map_util_->add3DPoints(keepout_points);
-    OUTPUT_DEBUG("PlannerQP: Map origin " << origin.transpose() << " dim "
-                                          << dim.transpose() << " resolution "
-                                          << map_res_);
-    OUTPUT_DEBUG("PlannerQP: Dilating");
-    jps_map_util_->dilating();
-
-    jps_planner_.reset(new JPS::JPS3DUtil(false));
-    jps_planner_->setMapUtil(jps_map_util_.get());
-
-    decomp_util_.reset(new EllipseDecomp(
-        jps_map_util_->getOrigin(),
-        jps_map_util_->getDim().cast<decimal_t>() * jps_map_util_->getRes(),
-        false));
-    decomp_util_->set_obstacles(jps_map_util_->getCloud());
+    if (!cfg_robot_radius_.Get(radius)) radius = 0.26;
+    double dilation;
+    if (!cfg_candidate_dilation_.Get(dilation)) dilation = 1.5;
+
+    maps_.resize(num_maps);
+    for (auto &m : maps_) {
+      m.util.reset(new JPS::VoxelMapUtil());
+      m.util->setMap(origin, dim, map, map_res_);
+      m.util->freeUnKnown();
+      m.util->dilate(radius, radius);
+      m.util->add3DPoints(keepout_points);
+      OUTPUT_DEBUG("PlannerQP: Map origin " << origin.transpose() << " dim "
+                                            << dim.transpose() << " resolution "
+                                            << map_res_);
+      OUTPUT_DEBUG("PlannerQP: Dilating by " << radius);
+      m.util->dilating();
+      m.cloud = m.util->getCloud();
+      radius *= dilation;
+    }
 
     // debugCloud();
 
     return true;
   }
   /*  void debugCloud(){
-      // vec_Vec3f free = jps_map_util_->getFreeCloud();
-      vec_Vec3f free = jps_map_util_->getCloud();
+      // vec_Vec3f free = maps_.front().util->getFreeCloud();
+      vec_Vec3f free = maps_.front().cloud;
       pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new
     pcl::PointCloud<pcl::PointXYZ>);
       cloud->header.frame_id = "world";
@@ -32,6 +32,7 @@
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <chrono>
 #include <exception>
 #include <iostream>
 #include <utility>
@@ -121,7 +122,41 @@ class CostFunction {
   friend class NonlinearSolver;
 };
 
+// A sparse matrix assembled from triplet lists whose sparsity pattern rarely
+// changes. The compressed pattern is built on the first fill, along with the
+// position of every triplet in it, after which fills with the same triplet
+// structure only write values.
+class KktPattern {
+ public:
+  // returns true if the pattern was rebuilt, so any symbolic analysis of the
+  // previous pattern is no longer valid
+  bool fill(const ETV &triplets, int rows, int cols, SpMat *mat);
+  void clear();
+
+ private:
+  std::vector<int> rows_, cols_, slots_;
+};
+
+// Statistics of the last call to NonlinearSolver::solve, times in seconds
+struct SolverStats {
+  int iterations{0};
+  int analyses{0};             // symbolic factorizations performed
+  int fallbacks{0};            // reduced solves that fell back to LU
+  bool timed_out{false};       // stopped by the deadline
+  decimal_t total_time{0.0};
+  decimal_t evaluate_time{0.0};  // evaluating cost and constraint derivatives
+  decimal_t factor_time{0.0};    // forming, factorizing and solving the system
+  std::vector<decimal_t> iteration_times;
+};
+
 class NonlinearSolver {
+ public:
+  // How each newton step is solved. KKT_LU factorizes the full unsymmetric
+  // KKT system. KKT_LDLT eliminates the slack and inequality dual variables
+  // and factorizes the symmetric reduced system [H + G'(U/S)G, A'; A, 0],
+  // falling back to KKT_LU for any iteration where that fails.
+  enum KktBackend { KKT_LU, KKT_LDLT };
+
  private:
   std::vector<Variable> vars;
   std::vector<boost::shared_ptr<IneqConstraint> > ineq_con;
@@ -138,6 +173,24 @@ class NonlinearSolver {
   bool presolved_{false};
   decimal_t epsilon_;
 
+  // newton step backends, whose patterns and symbolic factorizations are kept
+  // across iterations and solves
+  bool factorLU(const ETV &A, const ETV &G, const ETV &H);
+  bool factorReduced(const ETV &A, const ETV &G, const std::vector<int> &G_end,
+                     const ETV &H);
+  VecD solveReduced(const VecD &rhs, const ETV &G,
+                    const std::vector<int> &G_end);
+  KktBackend backend_{KKT_LU};
+  SpMat kkt_, reduced_;
+  KktPattern kkt_pattern_, reduced_pattern_;
+  Eigen::SparseLU<SpMat> lu_;
+  Eigen::SimplicialLDLT<SpMat> ldlt_;
+  std::vector<int> reduced_id_;  // index in the reduced system, -1 if eliminated
+  VecD reduced_reg_;             // quasi definite regularization of the diagonal
+  SolverStats stats_;
+  std::chrono::steady_clock::time_point deadline_{
+      std::chrono::steady_clock::time_point::max()};
+
  public:
   static ETV transpose(const ETV &vec);
   explicit NonlinearSolver(uint max_vars) : max_vars_(max_vars) {
@@ -159,11 +212,35 @@ class NonlinearSolver {
   void addConstraint(std::vector<EqConstraint::EqPair> con, decimal_t rhs);
 
   void setCost(boost::shared_ptr<CostFunction> func) { cost = func; }
+  void setBackend(KktBackend backend) { backend_ = backend; }
+  // values of all variables, in order of creation
+  std::vector<decimal_t> getValues() const;
+  // Seeds all variables with the values of a previous solve of a problem with
+  // the same structure, returning false if the structure differs. The slacks
+  // are recomputed for the new constraints, and each slack and inequality dual
+  // pair is moved so that its product is at least min_gap.
+  bool warmStart(const std::vector<decimal_t> &values,
+                 decimal_t min_gap = 1e-2);
+  // the solve stops, unsolved, once the deadline has passed
+  void setDeadline(std::chrono::steady_clock::time_point deadline) {
+    deadline_ = deadline;
+  }
+  const SolverStats &getStats() const { return stats_; }
 
   bool solve(bool verbose = false,
              decimal_t epsilon = 1e-8);  // returns sucess / failure
 };
 
+// Options for the solve done by NonlinearTrajectory
+struct SolverOptions {
+  NonlinearSolver::KktBackend backend{NonlinearSolver::KKT_LU};
+  // solution of a problem with the same structure to start from, see
+  // NonlinearSolver::warmStart
+  boost::shared_ptr<const std::vector<decimal_t> > warm_start;
+  std::chrono::steady_clock::time_point deadline{
+      std::chrono::steady_clock::time_point::max()};
+};
+
 }  // namespace traj_opt
 
 #endif  // TRAJ_OPT_PRO_NONLINEAR_SOLVER_H_
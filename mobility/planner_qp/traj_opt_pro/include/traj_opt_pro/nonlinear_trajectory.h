@@ -85,7 +85,8 @@ class NonlinearTrajectory : public Trajectory {
       const std::vector<std::pair<MatD, VecD> > &cons, int deg = 7,
       int min_dim = 3, boost::shared_ptr<std::vector<decimal_t> > ds =
                            boost::shared_ptr<std::vector<decimal_t> >(),
-      boost::shared_ptr<VecDVec> path = boost::shared_ptr<VecDVec>());
+      boost::shared_ptr<VecDVec> path = boost::shared_ptr<VecDVec>(),
+      const SolverOptions &options = SolverOptions());
   // nonconvex pointcloud test
   NonlinearTrajectory(const std::vector<Waypoint> &waypoints,
                       const Vec3Vec &points, int segs, decimal_t dt);
@@ -96,6 +97,10 @@ class NonlinearTrajectory : public Trajectory {
   decimal_t getCost();
   TrajData serialize();
   bool isSolved() { return solved_; }
+  const SolverStats &getSolverStats() const { return solver.getStats(); }
+  // solver state, which seeds later solves of a problem with the same structure
+  std::vector<decimal_t> getSolution() const { return solver.getValues(); }
+  bool isWarmStarted() const { return warm_started_; }
   Vec4Vec getBeads();
   void scaleTime(decimal_t ratio);
 
@@ -126,6 +131,7 @@ class NonlinearTrajectory : public Trajectory {
   int seg_, deg_;
   BasisBundlePro basis;
   bool solved_{false};
+  bool warm_started_{false};
   friend class AxbConstraint;
   friend class BallConstraint;
 };
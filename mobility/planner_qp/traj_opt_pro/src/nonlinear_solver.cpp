@@ -19,11 +19,16 @@
 #include <traj_opt_pro/nonlinear_solver.h>
 // move to cpp
 #include <algorithm>
+#include <cmath>
 #include <utility>
 #include <vector>
 
 namespace traj_opt {
 
+// diagonal regularization of the reduced system, which makes it quasi definite
+// so that LDL' exists for any symmetric ordering
+static const decimal_t kRegularization = 1e-9;
+
 // outstreams
 std::ostream &operator<<(std::ostream &os, const Variable &var) {
   os << "V" << var.id << " : " << var.val << " ";
@@ -131,6 +136,36 @@ void NonlinearSolver::addConstraint(std::vector<EqConstraint::EqPair> con,
   addConstraint(c);
 }
 
+std::vector<decimal_t> NonlinearSolver::getValues() const {
+  std::vector<decimal_t> values;
+  values.reserve(vars.size());
+  for (auto &v : vars) values.push_back(v.val);
+  return values;
+}
+bool NonlinearSolver::warmStart(const std::vector<decimal_t> &values,
+                                decimal_t min_gap) {
+  if (values.size() != vars.size()) return false;
+  for (uint i = 0; i < vars.size(); i++) vars.at(i).val = values.at(i);
+  // the slacks follow the new constraints, then the smaller of s and u is
+  // raised wherever su < min_gap, so every pair starts strictly interior and
+  // close to the central path
+  for (auto &con : ineq_con) {
+    con->update_slack();
+    decimal_t &s = con->var_s->val;
+    decimal_t &u = con->var_u->val;
+    s = std::max(s, 0.0);
+    u = std::max(u, 0.0);
+    if (s * u >= min_gap) continue;
+    if (std::max(s, u) < std::sqrt(min_gap))
+      s = u = std::sqrt(min_gap);
+    else if (s > u)
+      u = min_gap / s;
+    else
+      s = min_gap / u;
+  }
+  return true;
+}
+
 // transposes sparse triple
 ETV NonlinearSolver::transpose(const ETV &vec) {
   ETV res;
@@ -148,16 +183,157 @@ decimal_t NonlinearSolver::duality() {
   return gap;
 }
 
+// Sparse pattern cache
+bool KktPattern::fill(const ETV &triplets, int rows, int cols, SpMat *mat) {
+  bool same = mat->rows() == rows && mat->cols() == cols &&
+              mat->isCompressed() && triplets.size() == slots_.size();
+  for (size_t i = 0; same && i < triplets.size(); i++)
+    same = triplets[i].row() == rows_[i] && triplets[i].col() == cols_[i];
+  if (same) {
+    // duplicates are summed, as setFromTriplets does
+    decimal_t *values = mat->valuePtr();
+    std::fill(values, values + mat->nonZeros(), 0.0);
+    for (size_t i = 0; i < triplets.size(); i++)
+      values[slots_[i]] += triplets[i].value();
+    return false;
+  }
+  mat->resize(rows, cols);
+  mat->setFromTriplets(triplets.begin(), triplets.end());
+  rows_.resize(triplets.size());
+  cols_.resize(triplets.size());
+  slots_.resize(triplets.size());
+  const int *outer = mat->outerIndexPtr();
+  const int *inner = mat->innerIndexPtr();
+  for (size_t i = 0; i < triplets.size(); i++) {
+    rows_[i] = triplets[i].row();
+    cols_[i] = triplets[i].col();
+    slots_[i] = static_cast<int>(
+        std::lower_bound(inner + outer[cols_[i]], inner + outer[cols_[i] + 1],
+                         rows_[i]) -
+        inner);
+  }
+  return true;
+}
+void KktPattern::clear() {
+  rows_.clear();
+  cols_.clear();
+  slots_.clear();
+}
+
+// Newton step backends
+bool NonlinearSolver::factorLU(const ETV &A, const ETV &G, const ETV &H) {
+  int total_v = vars.size();
+  ETV coeffs;
+  coeffs.reserve(2 * A.size() + 2 * G.size() + 3 * ineq_con.size() +
+                 H.size());
+  ETV AT = transpose(A);
+  coeffs.insert(coeffs.end(), A.begin(), A.end());
+  coeffs.insert(coeffs.end(), AT.begin(), AT.end());
+  // S,I and Z
+  for (auto &ineq : ineq_con) {
+    coeffs.push_back(
+        ET(ineq->var_s->id, ineq->var_u->id, ineq->var_s->val));  // S
+    coeffs.push_back(ET(ineq->var_u->id, ineq->var_s->id, 1.0));  // I
+    coeffs.push_back(
+        ET(ineq->var_s->id, ineq->var_s->id, ineq->var_u->val));  // Z
+  }
+  ETV GT = transpose(G);
+  coeffs.insert(coeffs.end(), G.begin(), G.end());
+  coeffs.insert(coeffs.end(), GT.begin(), GT.end());
+  coeffs.insert(coeffs.end(), H.begin(), H.end());
+
+  // the symbolic analysis only depends on the pattern, so is only redone when
+  // the pattern changes
+  if (kkt_pattern_.fill(coeffs, total_v, total_v, &kkt_)) {
+    lu_.analyzePattern(kkt_);
+    stats_.analyses++;
+  }
+  lu_.factorize(kkt_);
+  return lu_.info() == Eigen::Success;
+}
+bool NonlinearSolver::factorReduced(const ETV &A, const ETV &G,
+                                    const std::vector<int> &G_end,
+                                    const ETV &H) {
+  int size = reduced_reg_.size();
+  ETV coeffs;
+  coeffs.reserve(size + 2 * A.size() + H.size() + 4 * G.size());
+  for (int i = 0; i < size; i++) coeffs.push_back(ET(i, i, reduced_reg_(i)));
+  for (auto &h : H)
+    coeffs.push_back(ET(reduced_id_[h.row()], reduced_id_[h.col()], h.value()));
+  for (auto &a : A) {
+    int r = reduced_id_[a.row()], c = reduced_id_[a.col()];
+    coeffs.push_back(ET(r, c, a.value()));
+    coeffs.push_back(ET(c, r, a.value()));
+  }
+  // G' (U/S) G, one outer product per constraint
+  int begin = 0;
+  for (uint k = 0; k < ineq_con.size(); k++) {
+    decimal_t d = ineq_con[k]->var_u->val / ineq_con[k]->var_s->val;
+    for (int i = begin; i < G_end[k]; i++)
+      for (int j = begin; j < G_end[k]; j++)
+        coeffs.push_back(ET(reduced_id_[G[i].col()], reduced_id_[G[j].col()],
+                            d * G[i].value() * G[j].value()));
+    begin = G_end[k];
+  }
+
+  if (reduced_pattern_.fill(coeffs, size, size, &reduced_)) {
+    ldlt_.analyzePattern(reduced_);
+    stats_.analyses++;
+  }
+  ldlt_.factorize(reduced_);
+  return ldlt_.info() == Eigen::Success;
+}
+VecD NonlinearSolver::solveReduced(const VecD &rhs, const ETV &G,
+                                   const std::vector<int> &G_end) {
+  // with d = u/s, the rows of each inequality give
+  //   du = d (G dz - rhs_u) + rhs_s / s
+  //   ds = (rhs_s - s du) / u
+  // which are substituted into the stationarity rows
+  int total_v = vars.size();
+  VecD r = VecD::Zero(reduced_reg_.size());
+  for (int i = 0; i < total_v; i++)
+    if (reduced_id_[i] >= 0) r(reduced_id_[i]) = rhs(i);
+  int begin = 0;
+  for (uint k = 0; k < ineq_con.size(); k++) {
+    const IneqConstraint &con = *ineq_con[k];
+    decimal_t u = con.var_u->val, s = con.var_s->val;
+    decimal_t c = u / s * rhs(con.var_u->id) - rhs(con.var_s->id) / s;
+    for (int i = begin; i < G_end[k]; i++)
+      r(reduced_id_[G[i].col()]) += G[i].value() * c;
+    begin = G_end[k];
+  }
+
+  // one step of iterative refinement removes the regularization error
+  VecD x = ldlt_.solve(r);
+  VecD res = r - reduced_ * x + reduced_reg_.cwiseProduct(x);
+  x += ldlt_.solve(res);
+
+  VecD delta(total_v);
+  for (int i = 0; i < total_v; i++)
+    if (reduced_id_[i] >= 0) delta(i) = x(reduced_id_[i]);
+  begin = 0;
+  for (uint k = 0; k < ineq_con.size(); k++) {
+    const IneqConstraint &con = *ineq_con[k];
+    decimal_t u = con.var_u->val, s = con.var_s->val;
+    decimal_t gdz = 0.0;
+    for (int i = begin; i < G_end[k]; i++)
+      gdz += G[i].value() * delta(G[i].col());
+    decimal_t du = u / s * (gdz - rhs(con.var_u->id)) + rhs(con.var_s->id) / s;
+    delta(con.var_u->id) = du;
+    delta(con.var_s->id) = (rhs(con.var_s->id) - s * du) / u;
+    begin = G_end[k];
+  }
+  return delta;
+}
+
 bool NonlinearSolver::iterate() {
+  Timer tm;
   // get variable sizes
   // int num_v = eq_con.size();
   int num_u = ineq_con.size();
   int total_v = vars.size();
   // int num_z = total_v - 2*num_u - num_v;
 
-  SpMat M(total_v, total_v);
-  SpMat b(total_v, 1);
-  ETV coeffs;
   ETV bcoeffs;
 
   VecD nu = VecD::Zero(num_u);
@@ -165,41 +341,24 @@ bool NonlinearSolver::iterate() {
   ETV A;
   for (auto &eq : eq_con) {
     ETV ai = eq->ai();
-    //        for(auto &aii:ai)
-    //            std::cout << aii.row() << " , " << aii.col() << " : " <<
-    //            aii.value() << std::endl;
-    //        std::cout << "rhs " << eq->rhs << std::endl;
     A.insert(A.end(), ai.begin(), ai.end());
     bcoeffs.push_back(eq->bi());
   }
-  ETV AT = transpose(A);
-  coeffs.insert(coeffs.end(), A.begin(), A.end());
-  coeffs.insert(coeffs.end(), AT.begin(), AT.end());
 
-  // add G
+  // add G, G_end marks where the rows of each constraint end
   ETV G;
+  std::vector<int> G_end;
+  G_end.reserve(num_u);
   for (auto &ineq : ineq_con) {
     ETV Gi = ineq->gradient();
     G.insert(G.end(), Gi.begin(), Gi.end());
+    G_end.push_back(static_cast<int>(G.size()));
     bcoeffs.push_back(ineq->slack());
     bcoeffs.push_back(ineq->sports_util(nu(ineq->id)));
-    // S,I and Z
-    coeffs.push_back(
-        ET(ineq->var_s->id, ineq->var_u->id, ineq->var_s->val));  // S
-    coeffs.push_back(ET(ineq->var_u->id, ineq->var_s->id, 1.0));  // I
-    coeffs.push_back(
-        ET(ineq->var_s->id, ineq->var_s->id, ineq->var_u->val));  // Z
   }
-  ETV GT = transpose(G);
-  coeffs.insert(coeffs.end(), G.begin(), G.end());
-  coeffs.insert(coeffs.end(), GT.begin(), GT.end());
 
   // add Cost
-
-  // add to left hand side
-
-  ETV co = cost->hessian();
-  coeffs.insert(coeffs.end(), co.begin(), co.end());
+  ETV H = cost->hessian();
   ETV na = cost->gradient();
   bcoeffs.insert(bcoeffs.end(), na.begin(), na.end());
   // end Add Cost
@@ -209,7 +368,7 @@ bool NonlinearSolver::iterate() {
     ETV coi = ineq->hessian();
     ETV gu = ineq->gradientS();
 
-    coeffs.insert(coeffs.end(), coi.begin(), coi.end());
+    H.insert(H.end(), coi.begin(), coi.end());
     bcoeffs.insert(bcoeffs.end(), gu.begin(), gu.end());
   }
   for (auto &eq : eq_con) {
@@ -218,35 +377,30 @@ bool NonlinearSolver::iterate() {
   }
 
   // pack non summands
-  M.setFromTriplets(coeffs.begin(), coeffs.end());
-  b.setFromTriplets(bcoeffs.begin(), bcoeffs.end());
+  VecD b = VecD::Zero(total_v);
+  for (auto &t : bcoeffs) b(t.row()) += t.value();
+  stats_.evaluate_time += tm.toc();
+  tm.tic();
 
   // pass to backend
-
-  //    std::cout << "Frontend took " << tm.toc() << std::endl;
-  //    tm.tic();
-
-  // backend bottleneck
-  Eigen::SparseLU<SpMat> solver;
-  //    Eigen::SparseQR<SpMat,Eigen::COLAMDOrdering<int> > solver;
-  //    Eigen::PardisoLU<SpMat> solver;
-
-  //        std::cout << "M: " << M << std::endl;
-  //        std::cout << "b: " << b << std::endl;
-  //    draw_matrix(M);
-  solver.compute(M);
-  //    std::cout << "Back end took " << tm.toc() << std::endl;
-
-  if (solver.info() != Eigen::Success) {
-    std::cout << "Back end failed" << std::endl;
-    //        std::cout << M << std::endl;
-    return false;
+  bool reduced = false;
+  VecD delta_x;
+  if (backend_ == KKT_LDLT) {
+    reduced = factorReduced(A, G, G_end, H);
+    if (reduced) {
+      delta_x = solveReduced(b, G, G_end);
+      reduced = delta_x.allFinite();
+    }
+    if (!reduced) stats_.fallbacks++;
   }
-  VecD delta_x = solver.solve(b);
-
-  //    VecD err = M*delta_x;
-  //    err-=b;
-  //    std::cout << "err: " << err.transpose() << std::endl;
+  if (!reduced) {
+    if (!factorLU(A, G, H)) {
+      std::cout << "Back end failed" << std::endl;
+      return false;
+    }
+    delta_x = lu_.solve(b);
+  }
+  stats_.factor_time += tm.toc();
 
   // Check error
 
@@ -294,10 +448,12 @@ bool NonlinearSolver::iterate() {
   // update b
   for (auto &ineq : ineq_con) {
     ET suv = ineq->sports_util(nu(ineq->id));
-    b.coeffRef(suv.row(), suv.col()) = suv.value();
+    b(suv.row()) = suv.value();
   }
   //     std::cout << "updated b: " << b << std::endl;
-  delta_x = solver.solve(b);
+  tm.tic();
+  delta_x = reduced ? solveReduced(b, G, G_end) : lu_.solve(b);
+  stats_.factor_time += tm.toc();
 
   // redo line search
   max_h = 1.0;
@@ -382,10 +538,30 @@ bool NonlinearSolver::solve(bool verbose, decimal_t epsilon) {
   VecD old_x = VecD::Zero(num_z);
   for (int i = 0; i < num_z; i++) old_x(i) = vars.at(i).val;
 
+  // ordering of the reduced system, in which u and s are eliminated
+  if (backend_ == KKT_LDLT) {
+    reduced_id_.assign(total_v, 0);
+    for (auto &con : ineq_con) {
+      reduced_id_[con->var_u->id] = -1;
+      reduced_id_[con->var_s->id] = -1;
+    }
+    int size = 0;
+    for (int i = 0; i < total_v; i++)
+      if (reduced_id_[i] >= 0) reduced_id_[i] = size++;
+    reduced_reg_ = kRegularization * VecD::Ones(size);
+    for (auto &con : eq_con) reduced_reg_(reduced_id_[con->var_v->id]) *= -1.0;
+  }
+  stats_ = SolverStats();
+
   // bool costreg=false;
   int its = 0;
   for (int i = 0; i < max_iterations; i++) {
     its = i;
+    if (std::chrono::steady_clock::now() > deadline_) {
+      stats_.timed_out = true;
+      break;
+    }
+    tm.tic();
     if (verbose) {
       //            std::cout << "Starting iteration " << i << std::endl;
       //            std::cout << "x: ";
@@ -407,7 +583,10 @@ bool NonlinearSolver::solve(bool verbose, decimal_t epsilon) {
       //            std::cout << "Cost: " << cost->evaluate() << std::endl;
       //            tm.tic();
     }
-    if (!iterate()) break;
+    bool more = iterate();
+    stats_.iterations++;
+    stats_.iteration_times.push_back(tm.toc());
+    if (!more) break;
 
     // check cost regression
     //        decimal_t new_cost = cost->evaluate();
@@ -456,8 +635,17 @@ bool NonlinearSolver::solve(bool verbose, decimal_t epsilon) {
     std::cout << "Gap: " << mu << std::endl;
     std::cout << "Iterations: " << its << std::endl;
   }
-  if (verbose)
-    std::cout << "Total time: " << tm_t.toc() * 1000.0 << " ms." << std::endl;
+  stats_.total_time = tm_t.toc();
+  if (verbose) {
+    std::cout << "Iteration times:";
+    for (auto &t : stats_.iteration_times) std::cout << " " << t * 1000.0;
+    std::cout << " ms." << std::endl;
+    std::cout << "Evaluation: " << stats_.evaluate_time * 1000.0
+              << " ms, factorization: " << stats_.factor_time * 1000.0
+              << " ms, symbolic analyses: " << stats_.analyses << std::endl;
+    std::cout << "Total time: " << stats_.total_time * 1000.0 << " ms."
+              << std::endl;
+  }
   return mu <= epsilon_;
 }
 bool NonlinearSolver::specialized_presolve() {
@@ -62,7 +62,7 @@ NonlinearTrajectory::NonlinearTrajectory(
     const std::vector<Waypoint> &waypoints,
     const std::vector<std::pair<MatD, VecD>> &cons, int deg, int min_dim,
     boost::shared_ptr<std::vector<decimal_t>> ds,
-    boost::shared_ptr<VecDVec> path)
+    boost::shared_ptr<VecDVec> path, const SolverOptions &options)
     : seg_(cons.size()), deg_(deg), basis(PolyType::ENDPOINT, deg_, min_dim) {
   dim_ = waypoints.front().pos.rows();
   assert(dim_ == cons.front().first.cols());
@@ -91,6 +91,10 @@ NonlinearTrajectory::NonlinearTrajectory(
   cost = boost::make_shared<PolyCost>(traj, times, basis, min_dim);
 
   solver.setCost(cost);
+  solver.setBackend(options.backend);
+  solver.setDeadline(options.deadline);
+  if (options.warm_start != NULL)
+    warm_started_ = solver.warmStart(*options.warm_start);
   // call solver
   // solved_ = solver.solve(true);
   solved_ = solver.solve(false);
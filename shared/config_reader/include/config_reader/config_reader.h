@@ -41,6 +41,7 @@ extern "C" {
 #include <vector>
 
 #include "common/init.h"
+#include "config_reader/config_snapshot.h"
 #include "config_reader/watch_files.h"
 
 namespace config_reader {
@@ -106,6 +107,9 @@ class ConfigReader {
   void Reset();
   bool IsOpen();
   void SetPath(const char* path);
+  // Directory of the compiled snapshots, none to always read from Lua. The
+  // default is $ASTROBEE_CONFIG_SNAPSHOT_DIR.
+  void SetSnapshotDir(const char* dir);
   void AddFile(const char *filename, unsigned flags = 0);
   bool ReadFiles();
   bool IsFileModified();
@@ -131,8 +135,9 @@ class ConfigReader {
    public:
     std::string filename_;      // name of file
     unsigned flags_;           // flags from FileFlags
+    bool imported_;            // found by AddImports, not added with AddFile
     WatchFiles::Watch watch_;  // file modification watch
-    FileHeader() {}
+    FileHeader() : flags_(0), imported_(false) {}
     FileHeader(const FileHeader &fh);
   };
 
@@ -145,11 +150,30 @@ class ConfigReader {
   void AddImports();
   void AddStandard();
   bool PutObjectOnLuaStack(const char *exp);
-  bool PutObjectOnLuaStack(const char *exp, int ref);
-  bool PutObjectOnLuaStack(int index, int ref);
+  bool PutObjectOnLuaStack(const char *exp, Table *table);
+  bool PutObjectOnLuaStack(int index, Table *table);
   bool IsTopValid();
   void OutputGetValueError(const char *exp, const char *type);
 
+  // The value put on the stack, either on the Lua stack or from the snapshot
+  bool TopIsNil();
+  bool TopIsTable();
+  bool TopIsString();
+  bool TopIsBoolean();
+  bool TopIsNumber();
+  std::string TopToString();
+  bool TopToBoolean();
+  double TopToNumber();
+  const char *TopTypeName();
+  void ClearTop();
+
+  // Snapshots of the values, named after the path and the added files
+  std::string SnapshotFile();
+  bool ReadSnapshot(const std::string &file);
+  bool WriteSnapshot(const std::string &file);
+  void AddSnapshotValue(ConfigSnapshot::Builder *builder, const std::string &exp,
+                        std::vector<const void*> *path);
+
   bool ReadTable(const char *exp, Table *table);
   bool ReadStr(const char *exp, std::string *str);
   bool ReadBool(const char *exp, bool *val);
@@ -170,6 +194,12 @@ class ConfigReader {
   WatchFiles watch_files_;  // class used to monitor files for changes
   bool modified_;  // true if config files need to be re-read
   std::string path_;
+
+  ConfigSnapshot snapshot_;  // values are read from it while it is open
+  std::string snapshot_dir_;
+  std::vector<std::string> lua_globals_;  // globals before the files ran
+  int top_;  // snapshot index of the value on the stack, -1 if none
+  std::string top_exp_;
 };
 
 bool FileExists(const char *filename);
@@ -0,0 +1,131 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CONFIG_READER_CONFIG_SNAPSHOT_H_
+#define CONFIG_READER_CONFIG_SNAPSHOT_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace config_reader {
+
+// A read only image of the values of an evaluated Lua config tree, in a file
+// that is memory mapped, so processes reading the same snapshot share its
+// pages. Every value is indexed by the expression that reaches it from the
+// global namespace, such as "a.b[2].c", in an open addressing hash table.
+//
+// A snapshot also records what the config depended on: the files it read,
+// including the ones that did not exist, and the environment variables it
+// looked up. IsCurrent checks them, so a stale snapshot is detected without
+// running Lua.
+class ConfigSnapshot {
+ public:
+  enum Type {
+    NIL = 0,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    TABLE,
+    OTHER,  // functions and the like, which only have a type name
+  };
+
+  struct Value {
+    Type type;
+    bool boolean;
+    double number;
+    const char *str;  // string, or type name of OTHER
+    int size;         // string length, or array size of a table
+  };
+
+  // Accumulates values and dependencies and writes them as a snapshot
+  class Builder {
+   public:
+    void AddBoolean(const std::string &exp, bool val);
+    void AddNumber(const std::string &exp, double val);
+    void AddString(const std::string &exp, const char *str, size_t len);
+    void AddTable(const std::string &exp, int size);
+    void AddOther(const std::string &exp, const char *type_name);
+    void AddFile(const std::string &filename);
+    void AddEnv(const std::string &name, const char *value);  // NULL if unset
+
+    // Writes to a unique temporary file, synced to disk and renamed into
+    // place, so readers only ever map complete snapshots, even with several
+    // writers of the same file
+    bool Write(const std::string &file) const;
+
+   private:
+    struct Node {
+      std::string exp;
+      Type type;
+      double number;
+      std::string str;
+      int size;
+    };
+    struct Dependency {
+      bool file;
+      std::string name;
+      bool set;            // file exists, or variable is set
+      std::string value;   // of a variable
+      int64_t mtime, size;  // of a file
+    };
+    std::vector<Node> nodes_;
+    std::vector<Dependency> deps_;
+  };
+
+  ConfigSnapshot();
+  ~ConfigSnapshot();
+  ConfigSnapshot(const ConfigSnapshot&) = delete;
+  ConfigSnapshot& operator=(const ConfigSnapshot&) = delete;
+
+  bool Load(const std::string &file);
+  void Close();
+  bool IsOpen() const;
+  // True if every file and environment variable is as when it was compiled
+  bool IsCurrent() const;
+
+  // Returns the index of the value of exp, or -1 if there is none
+  int Find(const char *exp, size_t len) const;
+  int Find(const std::string &exp) const;
+  void Get(int index, Value *value) const;
+  const char *Expression(int index) const;
+
+  // The files the config read, which existed when it was compiled
+  std::vector<std::string> Files() const;
+
+  // A 64 bit FNV-1a hash, to name snapshots
+  static uint64_t Hash(const std::string &str);
+
+ private:
+  struct Header;
+  struct Entry;
+  struct Dependency;
+
+  const Header *header_;
+  const Entry *entries_;
+  const uint32_t *slots_;
+  const Dependency *deps_;
+  const char *strings_;
+  void *data_;
+  size_t size_;
+};
+
+}  // namespace config_reader
+
+#endif  // CONFIG_READER_CONFIG_SNAPSHOT_H_
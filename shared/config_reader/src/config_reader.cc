@@ -21,6 +21,12 @@
 
 #include "config_reader/config_reader.h"
 
+#include <ctype.h>
+#include <errno.h>
+#include <string.h>
+
+#include <algorithm>
+
 
 /*
   [ References ]
@@ -37,6 +43,69 @@
 
 namespace config_reader {
 
+// Lua run before the config files when compiling snapshots. It wraps the
+// functions through which they read files and the environment, and returns
+// the list of what they read: {true, filename} or {false, name, value}.
+// The files required are the ones searched for until the module is found, so
+// creating one that comes earlier in the path is noticed as well
+static const char kDependencyHooks[] =
+  "local deps = {}\n"
+  "local function file(name)\n"
+  "  if type(name) == 'string' then deps[#deps + 1] = {true, name} end\n"
+  "end\n"
+  "local open, load, run, getenv = io.open, loadfile, dofile, os.getenv\n"
+  "io.open = function(name, ...) file(name) return open(name, ...) end\n"
+  "loadfile = function(name, ...) file(name) return load(name, ...) end\n"
+  "dofile = function(name, ...) file(name) return run(name, ...) end\n"
+  "local need = require\n"
+  "require = function(name)\n"
+  "  if type(name) == 'string' and package.loaded[name] == nil then\n"
+  "    local module = string.gsub(name, '%.', '/')\n"
+  "    for template in string.gmatch(package.path, '[^;]+') do\n"
+  "      local path = string.gsub(template, '%?', module)\n"
+  "      file(path)\n"
+  "      local f = open(path)\n"
+  "      if f then f:close() break end\n"
+  "    end\n"
+  "  end\n"
+  "  return need(name)\n"
+  "end\n"
+  "os.getenv = function(name)\n"
+  "  local value = getenv(name)\n"
+  "  deps[#deps + 1] = {false, name, value}\n"
+  "  return value\n"
+  "end\n"
+  "return deps\n";
+
+// Registry key of the list returned by kDependencyHooks
+static const char kDependencies[] = "config_reader_dependencies";
+
+// Tables nested deeper than this, or inside themselves, are in snapshots
+// without their contents
+static const size_t kMaxSnapshotDepth = 32;
+
+// Converts a string to a number as Lua does, false if it is not a number
+static bool StrToNumber(const char *str, double *val) {
+  char *end;
+  *val = strtod(str, &end);
+  if (end == str) {
+    return false;
+  }
+  if (*end == 'x' || *end == 'X') {
+    *val = static_cast<double>(strtoul(str, &end, 16));
+  }
+  while (isspace(static_cast<unsigned char>(*end))) {
+    end++;
+  }
+  return (*end == '\0');
+}
+
+// Snapshot values are named by their expression, so a key that holds the
+// separators of one would be mistaken for a nested value
+static bool IsSnapshotKey(const char *key) {
+  return (strpbrk(key, ".[") == NULL);
+}
+
 //====================================================================//
 bool FileExists(const char *filename) {
   struct stat st;
@@ -107,7 +176,7 @@ bool ConfigReader::Table::CheckValExists(const char *exp) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -125,7 +194,7 @@ bool ConfigReader::Table::GetTable(const char *exp, Table *table) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -137,7 +206,7 @@ bool ConfigReader::Table::GetTable(int index, Table *table) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -150,7 +219,7 @@ bool ConfigReader::Table::GetStr(const char *exp, std::string *str) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -162,7 +231,7 @@ bool ConfigReader::Table::GetStr(int index, std::string *str) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -175,7 +244,7 @@ bool ConfigReader::Table::GetBool(const char *exp, bool *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -187,7 +256,7 @@ bool ConfigReader::Table::GetBool(int index, bool *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -200,7 +269,7 @@ bool ConfigReader::Table::GetInt(const char *exp, int *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -212,7 +281,7 @@ bool ConfigReader::Table::GetInt(int index, int *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -225,7 +294,7 @@ bool ConfigReader::Table::GetLongLong(const char *exp, int64_t *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -237,7 +306,7 @@ bool ConfigReader::Table::GetLongLong(int index, int64_t *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -250,7 +319,7 @@ bool ConfigReader::Table::GetUInt(const char* exp, unsigned int *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -262,7 +331,7 @@ bool ConfigReader::Table::GetUInt(int index, unsigned int *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -275,7 +344,7 @@ bool ConfigReader::Table::GetReal(const char *exp, float *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -287,7 +356,7 @@ bool ConfigReader::Table::GetReal(int index, float *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -300,7 +369,7 @@ bool ConfigReader::Table::GetReal(const char *exp, double *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -312,7 +381,7 @@ bool ConfigReader::Table::GetReal(int index, double *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -325,7 +394,7 @@ bool ConfigReader::Table::GetPosReal(const char *exp, float *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -337,7 +406,7 @@ bool ConfigReader::Table::GetPosReal(int index, float *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -350,7 +419,7 @@ bool ConfigReader::Table::GetPosReal(const char *exp, double *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -362,7 +431,7 @@ bool ConfigReader::Table::GetPosReal(int index, double *val) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -375,7 +444,7 @@ bool ConfigReader::Table::GetInt(const char *exp, int *val, int min, int max) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -387,7 +456,7 @@ bool ConfigReader::Table::GetInt(int index, int *val, int min, int max) {
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -401,7 +470,7 @@ bool ConfigReader::Table::GetReal(const char *exp, float *val, float min,
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -414,7 +483,7 @@ bool ConfigReader::Table::GetReal(int index, float *val, float min,
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -428,7 +497,7 @@ bool ConfigReader::Table::GetReal(const char *exp, double *val, double min,
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(exp, ref_)) {
+  if (!config_->PutObjectOnLuaStack(exp, this)) {
     return false;
   }
 
@@ -441,7 +510,7 @@ bool ConfigReader::Table::GetReal(int index, double *val, double min,
     return false;
   }
 
-  if (!config_->PutObjectOnLuaStack(index, ref_)) {
+  if (!config_->PutObjectOnLuaStack(index, this)) {
     return false;
   }
 
@@ -453,6 +522,7 @@ bool ConfigReader::Table::GetReal(int index, double *val, double min,
 ConfigReader::FileHeader::FileHeader(const FileHeader &fh) {
   filename_ = fh.filename_;
   flags_ = fh.flags_;
+  imported_ = fh.imported_;
   watch_ = fh.watch_;
 }
 
@@ -462,8 +532,12 @@ ConfigReader::ConfigReader() {
   path_ = "";
   l_ = NULL;
   modified_ = false;
+  top_ = -1;
   const char* p = common::GetConfigDir();
   SetPath(p);
+  const char* dir = getenv("ASTROBEE_CONFIG_SNAPSHOT_DIR");
+  if (dir)
+    SetSnapshotDir(dir);
   AddStandard();
 }
 
@@ -471,7 +545,11 @@ ConfigReader::ConfigReader(const char* path) {
   path_ = "";
   l_ = NULL;
   modified_ = false;
+  top_ = -1;
   SetPath(path);
+  const char* dir = getenv("ASTROBEE_CONFIG_SNAPSHOT_DIR");
+  if (dir)
+    SetSnapshotDir(dir);
   AddStandard();
 }
 
@@ -481,17 +559,19 @@ ConfigReader::~ConfigReader() {
 
 void ConfigReader::Close() {
   CloseLua();
+  snapshot_.Close();
 }
 
 void ConfigReader::Reset() {
   CloseLua();
+  snapshot_.Close();
   ClearWatches();
   files_.clear();
   watch_files_.reset();
 }
 
 bool ConfigReader::IsOpen() {
-  return (l_ != NULL);
+  return (l_ != NULL || snapshot_.IsOpen());
 }
 
 void ConfigReader::SetPath(const char* path) {
@@ -502,6 +582,10 @@ void ConfigReader::SetPath(const char* path) {
   path_ += "/";
 }
 
+void ConfigReader::SetSnapshotDir(const char* dir) {
+  snapshot_dir_ = (dir != NULL) ? dir : "";
+}
+
 void ConfigReader::AddFile(const char *filename, unsigned flags) {
   FileHeader fh;
   if (filename[0] == '/')
@@ -516,6 +600,14 @@ void ConfigReader::AddFile(const char *filename, unsigned flags) {
 }
 
 bool ConfigReader::ReadFiles() {
+  // Serve the values from a snapshot, unless what it was compiled from changed
+  std::string snapshot_file = SnapshotFile();
+  if (!snapshot_file.empty() && ReadSnapshot(snapshot_file)) {
+    modified_ = false;
+    return true;
+  }
+  snapshot_.Close();
+
   if (!l_ && !InitLua()) {
     return false;
   }
@@ -537,6 +629,9 @@ bool ConfigReader::ReadFiles() {
 
   if (ok) {
     AddImports();
+    if (!snapshot_file.empty()) {
+      WriteSnapshot(snapshot_file);
+    }
   }
 
   return ok;
@@ -699,6 +794,27 @@ bool ConfigReader::InitLua() {
   // discard any results from initialization
   lua_settop(l_, 0);
 
+  // Record the files and environment variables the config files read, and
+  // which globals they did not define, to compile snapshots
+  if (!snapshot_dir_.empty()) {
+    if (luaL_loadstring(l_, kDependencyHooks) || lua_pcall(l_, 0, 1, 0)) {
+      LOG(ERROR) << "ConfigReader: Unable to install the dependency hooks!";
+      CloseLua();
+      return false;
+    }
+    lua_setfield(l_, LUA_REGISTRYINDEX, kDependencies);
+
+    lua_globals_.clear();
+    lua_pushnil(l_);
+    while (lua_next(l_, LUA_GLOBALSINDEX)) {
+      if (lua_type(l_, -2) == LUA_TSTRING) {
+        lua_globals_.push_back(lua_tostring(l_, -2));
+      }
+      lua_pop(l_, 1);
+    }
+    std::sort(lua_globals_.begin(), lua_globals_.end());
+  }
+
   return true;
 }
 
@@ -812,6 +928,7 @@ void ConfigReader::AddImports() {
       FileHeader fh;
       fh.filename_ = temp_filename;
       fh.flags_ = 0;
+      fh.imported_ = true;
       fh.watch_.watch(&watch_files_, fh.filename_.c_str());
       files_.push_back(fh);
     }
@@ -833,6 +950,11 @@ bool ConfigReader::PutObjectOnLuaStack(const char *exp) {
     return false;
   }
 
+  if (snapshot_.IsOpen()) {
+    top_ = IsSnapshotKey(exp) ? snapshot_.Find(exp, strlen(exp)) : -1;
+    return true;
+  }
+
   lua_getglobal(l_, exp);
 
   return true;
@@ -840,14 +962,23 @@ bool ConfigReader::PutObjectOnLuaStack(const char *exp) {
 
 // This function is used to get objects from table which has keys (much like a
 // c++ map)
-bool ConfigReader::PutObjectOnLuaStack(const char *exp, int ref) {
+bool ConfigReader::PutObjectOnLuaStack(const char *exp, Table *table) {
   if (!IsOpen()) {
     LOG(WARNING) << "ConfigReader: Lua is not open, open lua before getting "
       << " value";
     return false;
   }
 
-  lua_rawgeti(l_, LUA_REGISTRYINDEX, ref);
+  // Snapshot values are indexed by their full expression
+  if (snapshot_.IsOpen()) {
+    top_exp_ = table->full_exp_;
+    top_exp_ += '.';
+    top_exp_ += exp;
+    top_ = IsSnapshotKey(exp) ? snapshot_.Find(top_exp_) : -1;
+    return true;
+  }
+
+  lua_rawgeti(l_, LUA_REGISTRYINDEX, table->ref_);
 
   if (!lua_istable(l_, -1)) {
     LOG(ERROR) << "ConfigReader: Reference doesn't point to table! Make Katie "
@@ -864,14 +995,23 @@ bool ConfigReader::PutObjectOnLuaStack(const char *exp, int ref) {
 
 // This function is used to get objets from table which has numeric indices
 // (much like a c++ array)
-bool ConfigReader::PutObjectOnLuaStack(int index, int ref) {
+bool ConfigReader::PutObjectOnLuaStack(int index, Table *table) {
   if (!IsOpen()) {
     LOG(WARNING) << "ConfigReader: Lua is not open, open lua before getting "
       << "value";
     return false;
   }
 
-  lua_rawgeti(l_, LUA_REGISTRYINDEX, ref);
+  if (snapshot_.IsOpen()) {
+    top_exp_ = table->full_exp_;
+    top_exp_ += '[';
+    top_exp_ += std::to_string(index);
+    top_exp_ += ']';
+    top_ = snapshot_.Find(top_exp_);
+    return true;
+  }
+
+  lua_rawgeti(l_, LUA_REGISTRYINDEX, table->ref_);
 
   if (!lua_istable(l_, -1)) {
     LOG(ERROR) << "ConfigReader: Reference doesn't point to table! Make Katie "
@@ -886,31 +1026,150 @@ bool ConfigReader::PutObjectOnLuaStack(int index, int ref) {
 
 bool ConfigReader::IsTopValid() {
   // Lua puts null on the stack if the variable doesn't exist
-  if (lua_isnil(l_, -1)) {
+  if (TopIsNil()) {
     // Remove nil from stack
-    lua_settop(l_, 0);
+    ClearTop();
     return false;
   }
 
   // Only used to check if the value exists not actually reading it so remove
   // it from the stack
-  lua_settop(l_, 0);
+  ClearTop();
   return true;
 }
 
 void ConfigReader::OutputGetValueError(const char *exp, const char *type) {
-  if (lua_isnil(l_, -1)) {
+  if (TopIsNil()) {
     LOG(WARNING) << "ConfigReader: \"" << exp << "\" doesn't exist!";
   } else {
-    int luaType = lua_type(l_, -1);
     LOG(WARNING) << "ConfigReader: \"" << exp << "\" is a(n) " <<
-      lua_typename(l_, luaType) << " not a(n) " << type << "!";
+      TopTypeName() << " not a(n) " << type << "!";
+  }
+}
+
+bool ConfigReader::TopIsNil() {
+  if (snapshot_.IsOpen()) {
+    return (top_ < 0);
   }
+  return lua_isnil(l_, -1);
+}
+
+bool ConfigReader::TopIsTable() {
+  if (snapshot_.IsOpen()) {
+    ConfigSnapshot::Value value;
+    return (top_ >= 0 && (snapshot_.Get(top_, &value), value.type == ConfigSnapshot::TABLE));
+  }
+  return lua_istable(l_, -1);
+}
+
+// Like Lua, numbers are strings too
+bool ConfigReader::TopIsString() {
+  if (snapshot_.IsOpen()) {
+    if (top_ < 0) {
+      return false;
+    }
+    ConfigSnapshot::Value value;
+    snapshot_.Get(top_, &value);
+    return (value.type == ConfigSnapshot::STRING || value.type == ConfigSnapshot::NUMBER);
+  }
+  return lua_isstring(l_, -1);
+}
+
+bool ConfigReader::TopIsBoolean() {
+  if (snapshot_.IsOpen()) {
+    ConfigSnapshot::Value value;
+    return (top_ >= 0 && (snapshot_.Get(top_, &value), value.type == ConfigSnapshot::BOOLEAN));
+  }
+  return lua_isboolean(l_, -1);
+}
+
+// and strings that read as numbers are numbers
+bool ConfigReader::TopIsNumber() {
+  if (snapshot_.IsOpen()) {
+    if (top_ < 0) {
+      return false;
+    }
+    ConfigSnapshot::Value value;
+    snapshot_.Get(top_, &value);
+    double number;
+    return (value.type == ConfigSnapshot::NUMBER ||
+            (value.type == ConfigSnapshot::STRING && StrToNumber(value.str, &number)));
+  }
+  return lua_isnumber(l_, -1);
+}
+
+std::string ConfigReader::TopToString() {
+  if (snapshot_.IsOpen()) {
+    ConfigSnapshot::Value value;
+    snapshot_.Get(top_, &value);
+    if (value.type == ConfigSnapshot::NUMBER) {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%.14g", value.number);  // LUA_NUMBER_FMT
+      return buf;
+    }
+    return std::string(value.str, value.size);
+  }
+  size_t len;
+  const char *str = lua_tolstring(l_, -1, &len);
+  return std::string(str, len);
+}
+
+bool ConfigReader::TopToBoolean() {
+  if (snapshot_.IsOpen()) {
+    ConfigSnapshot::Value value;
+    snapshot_.Get(top_, &value);
+    return value.boolean;
+  }
+  return lua_toboolean(l_, -1);
+}
+
+double ConfigReader::TopToNumber() {
+  if (snapshot_.IsOpen()) {
+    ConfigSnapshot::Value value;
+    snapshot_.Get(top_, &value);
+    double number = value.number;
+    if (value.type == ConfigSnapshot::STRING) {
+      StrToNumber(value.str, &number);
+    }
+    return number;
+  }
+  return lua_tonumber(l_, -1);
+}
+
+const char *ConfigReader::TopTypeName() {
+  if (snapshot_.IsOpen()) {
+    if (top_ < 0) {
+      return "nil";
+    }
+    ConfigSnapshot::Value value;
+    snapshot_.Get(top_, &value);
+    switch (value.type) {
+      case ConfigSnapshot::BOOLEAN: return "boolean";
+      case ConfigSnapshot::NUMBER:  return "number";
+      case ConfigSnapshot::STRING:  return "string";
+      case ConfigSnapshot::TABLE:   return "table";
+      case ConfigSnapshot::OTHER:   return value.str;
+      default: return "nil";
+    }
+  }
+  return lua_typename(l_, lua_type(l_, -1));
+}
+
+void ConfigReader::ClearTop() {
+  if (snapshot_.IsOpen()) {
+    top_ = -1;
+    return;
+  }
+  lua_settop(l_, 0);
 }
 
 bool ConfigReader::ReadTable(const char *exp, Table *table) {
-  bool ok = lua_istable(l_, -1);
-  if (ok) {
+  bool ok = TopIsTable();
+  if (ok && snapshot_.IsOpen()) {
+    ConfigSnapshot::Value value;
+    snapshot_.Get(top_, &value);
+    table->Init(this, top_, exp, value.size);
+  } else if (ok) {
     int size = lua_objlen(l_, -1);
     int ref = luaL_ref(l_, LUA_REGISTRYINDEX);
     table->Init(this, ref, exp, size);
@@ -919,62 +1178,62 @@ bool ConfigReader::ReadTable(const char *exp, Table *table) {
   }
 
   // Clear stack so it doesn't over fill
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
 bool ConfigReader::ReadStr(const char *exp, std::string *str) {
-  bool ok = lua_isstring(l_, -1);
+  bool ok = TopIsString();
   if (ok) {
-    *str = lua_tostring(l_, -1);
+    *str = TopToString();
   } else {
     OutputGetValueError(exp, "string");
   }
 
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
 bool ConfigReader::ReadBool(const char *exp, bool *val) {
-  bool ok = lua_isboolean(l_, -1);
+  bool ok = TopIsBoolean();
   if (ok) {
-    *val = static_cast<bool>(lua_toboolean(l_, -1));
+    *val = static_cast<bool>(TopToBoolean());
   } else {
     OutputGetValueError(exp, "boolean");
   }
 
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
 bool ConfigReader::ReadInt(const char *exp, int *val) {
-  bool ok = lua_isnumber(l_, -1);
+  bool ok = TopIsNumber();
   if (ok) {
-    *val = static_cast<int>(rint(lua_tonumber(l_, -1)));
+    *val = static_cast<int>(rint(TopToNumber()));
   } else {
     OutputGetValueError(exp, "integer");
   }
 
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
 bool ConfigReader::ReadLongLong(const char *exp, int64_t *val) {
-  bool ok = lua_isnumber(l_, -1);
+  bool ok = TopIsNumber();
   if (ok) {
-    *val = static_cast<int64_t>(llrint(lua_tonumber(l_, -1)));
+    *val = static_cast<int64_t>(llrint(TopToNumber()));
   } else {
     OutputGetValueError(exp, "long long integer");
   }
 
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
 bool ConfigReader::ReadUInt(const char *exp, unsigned int *val) {
-  bool ok = lua_isnumber(l_, -1);
+  bool ok = TopIsNumber();
   if (ok) {
-    *val = static_cast<int>(rint(lua_tonumber(l_, -1)));
+    *val = static_cast<int>(rint(TopToNumber()));
     if (val < 0) {
       LOG(WARNING) << "ConfigReader: " << exp << " is not an unsigned integer";
       ok = false;
@@ -983,31 +1242,31 @@ bool ConfigReader::ReadUInt(const char *exp, unsigned int *val) {
     OutputGetValueError(exp, "unsigned integer");
   }
 
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
 bool ConfigReader::ReadReal(const char *exp, float *val) {
-  bool ok = lua_isnumber(l_, -1);
+  bool ok = TopIsNumber();
   if (ok) {
-    *val = static_cast<float>(lua_tonumber(l_, -1));
+    *val = static_cast<float>(TopToNumber());
   } else {
     OutputGetValueError(exp, "number");
   }
 
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
 bool ConfigReader::ReadReal(const char *exp, double *val) {
-  bool ok = lua_isnumber(l_, -1);
+  bool ok = TopIsNumber();
   if (ok) {
-    *val = static_cast<double>(lua_tonumber(l_, -1));
+    *val = static_cast<double>(TopToNumber());
   } else {
     OutputGetValueError(exp, "number");
   }
 
-  lua_settop(l_, 0);
+  ClearTop();
   return ok;
 }
 
@@ -1103,4 +1362,173 @@ bool ConfigReader::ReadReal(const char *exp, double *val, double min,
   return true;
 }
 
+//====================================================================//
+std::string ConfigReader::SnapshotFile() {
+  if (snapshot_dir_.empty()) {
+    return "";
+  }
+
+  // Create the directory and its parents if they are missing
+  for (size_t i = 1; i <= snapshot_dir_.size(); i++) {
+    if (i == snapshot_dir_.size() || snapshot_dir_[i] == '/') {
+      if (mkdir(snapshot_dir_.substr(0, i).c_str(), 0755) != 0 && errno != EEXIST) {
+        LOG(WARNING) << "ConfigReader: Unable to create snapshot directory "
+          << snapshot_dir_ << ", reading from Lua.";
+        snapshot_dir_.clear();
+        return "";
+      }
+    }
+  }
+
+  // The same files read from the same path give the same snapshot. What they
+  // import is in its dependencies.
+  std::string key = path_;
+  for (unsigned i = 0; i < files_.size(); i++) {
+    if (!files_[i].imported_) {
+      key += '\n' + files_[i].filename_ + ':' + std::to_string(files_[i].flags_);
+    }
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.snapshot",
+    static_cast<unsigned long long>(ConfigSnapshot::Hash(key)));  // NOLINT
+  return snapshot_dir_ + name;
+}
+
+bool ConfigReader::ReadSnapshot(const std::string &file) {
+  if (!snapshot_.Load(file) || !snapshot_.IsCurrent()) {
+    snapshot_.Close();
+    return false;
+  }
+  CloseLua();
+  top_ = -1;
+
+  // Watch the files the config read, as AddImports does
+  std::vector<std::string> files = snapshot_.Files();
+  for (unsigned i = 0; i < files.size(); i++) {
+    bool found = false;
+    for (unsigned j = 0; j < files_.size() && !found; j++) {
+      found = (files_[j].filename_ == files[i]);
+    }
+    if (!found) {
+      FileHeader fh;
+      fh.filename_ = files[i];
+      fh.flags_ = 0;
+      fh.imported_ = true;
+      fh.watch_.watch(&watch_files_, fh.filename_.c_str());
+      files_.push_back(fh);
+    }
+  }
+  for (unsigned i = 0; i < files_.size(); i++) {
+    if (files_[i].watch_.isFileModified()) {
+      files_[i].watch_.rewatch(files_[i].filename_.c_str());
+    }
+  }
+  return true;
+}
+
+bool ConfigReader::WriteSnapshot(const std::string &file) {
+  ConfigSnapshot::Builder builder;
+
+  // Every global the config files defined
+  std::vector<const void*> path;
+  lua_settop(l_, 0);
+  lua_pushnil(l_);
+  while (lua_next(l_, LUA_GLOBALSINDEX)) {
+    if (lua_type(l_, -2) == LUA_TSTRING) {
+      std::string name = lua_tostring(l_, -2);
+      if (IsSnapshotKey(name.c_str()) &&
+          !std::binary_search(lua_globals_.begin(), lua_globals_.end(), name)) {
+        AddSnapshotValue(&builder, name, &path);
+      }
+    }
+    lua_pop(l_, 1);
+  }
+
+  // and what they depend on
+  for (unsigned i = 0; i < files_.size(); i++) {
+    builder.AddFile(files_[i].filename_);
+  }
+  lua_getfield(l_, LUA_REGISTRYINDEX, kDependencies);
+  int num_deps = lua_istable(l_, -1) ? lua_objlen(l_, -1) : 0;
+  for (int i = 1; i <= num_deps; i++) {
+    lua_rawgeti(l_, -1, i);
+    lua_rawgeti(l_, -1, 1);
+    lua_rawgeti(l_, -2, 2);
+    lua_rawgeti(l_, -3, 3);
+    if (lua_type(l_, -2) == LUA_TSTRING) {
+      if (lua_toboolean(l_, -3)) {
+        builder.AddFile(lua_tostring(l_, -2));
+      } else {
+        builder.AddEnv(lua_tostring(l_, -2), lua_isstring(l_, -1) ? lua_tostring(l_, -1) : NULL);
+      }
+    }
+    lua_pop(l_, 4);
+  }
+  lua_settop(l_, 0);
+
+  // Serve the values from the snapshot from now on
+  if (!builder.Write(file)) {
+    LOG(WARNING) << "ConfigReader: Unable to write snapshot " << file
+      << ", reading from Lua.";
+    return false;
+  }
+  if (!snapshot_.Load(file)) {
+    return false;
+  }
+  CloseLua();
+  top_ = -1;
+  return true;
+}
+
+// Adds the value on top of the Lua stack, and what it contains
+void ConfigReader::AddSnapshotValue(ConfigSnapshot::Builder *builder, const std::string &exp,
+                                    std::vector<const void*> *path) {
+  switch (lua_type(l_, -1)) {
+    case LUA_TNIL:
+      break;
+    case LUA_TBOOLEAN:
+      builder->AddBoolean(exp, lua_toboolean(l_, -1));
+      break;
+    case LUA_TNUMBER:
+      builder->AddNumber(exp, lua_tonumber(l_, -1));
+      break;
+    case LUA_TSTRING: {
+      size_t len;
+      const char *str = lua_tolstring(l_, -1, &len);
+      builder->AddString(exp, str, len);
+      break;
+    }
+    case LUA_TTABLE: {
+      builder->AddTable(exp, lua_objlen(l_, -1));
+      const void *table = lua_topointer(l_, -1);
+      if (path->size() >= kMaxSnapshotDepth ||
+          std::find(path->begin(), path->end(), table) != path->end()) {
+        break;
+      }
+      // Only string keys and integer indices can be read back
+      path->push_back(table);
+      lua_pushnil(l_);
+      while (lua_next(l_, -2)) {
+        if (lua_type(l_, -2) == LUA_TSTRING) {
+          if (IsSnapshotKey(lua_tostring(l_, -2))) {
+            AddSnapshotValue(builder, exp + '.' + lua_tostring(l_, -2), path);
+          }
+        } else if (lua_type(l_, -2) == LUA_TNUMBER) {
+          double key = lua_tonumber(l_, -2);
+          int index = static_cast<int>(key);
+          if (index == key) {
+            AddSnapshotValue(builder, exp + '[' + std::to_string(index) + ']', path);
+          }
+        }
+        lua_pop(l_, 1);
+      }
+      path->pop_back();
+      break;
+    }
+    default:
+      builder->AddOther(exp, lua_typename(l_, lua_type(l_, -1)));
+      break;
+  }
+}
+
 }  // namespace config_reader
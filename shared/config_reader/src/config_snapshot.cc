@@ -0,0 +1,370 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "config_reader/config_snapshot.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace config_reader {
+
+// File layout: the header, the entries, the hash slots, the dependencies and
+// the string pool. Slots hold an entry index plus one, zero when empty.
+static const char kSnapshotMagic[8] = {'C', 'F', 'G', 'S', 'N', 'A', 'P', '\0'};
+static const uint32_t kSnapshotVersion = 1;
+
+struct ConfigSnapshot::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_entries;
+  uint32_t num_slots;
+  uint32_t num_deps;
+  uint32_t strings_size;
+  uint32_t reserved;
+  uint64_t size;
+};
+
+struct ConfigSnapshot::Entry {
+  double number;
+  uint32_t key, key_size, hash;
+  uint32_t str;
+  int32_t size;
+  uint8_t type, boolean;
+  uint8_t reserved[2];
+};
+
+struct ConfigSnapshot::Dependency {
+  int64_t mtime, size;
+  uint32_t name, value;
+  uint8_t file, set;
+  uint8_t reserved[6];
+};
+
+// Modification time in nanoseconds and size of a file, false if it is missing
+static bool FileStamp(const char *filename, int64_t *mtime, int64_t *size) {
+  struct stat st;
+  if (stat(filename, &st) != 0) {
+    *mtime = 0;
+    *size = -1;
+    return false;
+  }
+  *mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+  *size = st.st_size;
+  return true;
+}
+
+uint64_t ConfigSnapshot::Hash(const std::string &str) {
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < str.size(); i++) {
+    h ^= static_cast<unsigned char>(str[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+static uint32_t KeyHash(const char *exp, size_t len) {
+  uint32_t h = 2166136261U;
+  for (size_t i = 0; i < len; i++) {
+    h ^= static_cast<unsigned char>(exp[i]);
+    h *= 16777619U;
+  }
+  return h;
+}
+
+//====================================================================//
+void ConfigSnapshot::Builder::AddBoolean(const std::string &exp, bool val) {
+  Node n = {exp, BOOLEAN, val ? 1.0 : 0.0, "", 0};
+  nodes_.push_back(n);
+}
+
+void ConfigSnapshot::Builder::AddNumber(const std::string &exp, double val) {
+  Node n = {exp, NUMBER, val, "", 0};
+  nodes_.push_back(n);
+}
+
+void ConfigSnapshot::Builder::AddString(const std::string &exp, const char *str, size_t len) {
+  Node n = {exp, STRING, 0.0, std::string(str, len), static_cast<int>(len)};
+  nodes_.push_back(n);
+}
+
+void ConfigSnapshot::Builder::AddTable(const std::string &exp, int size) {
+  Node n = {exp, TABLE, 0.0, "", size};
+  nodes_.push_back(n);
+}
+
+void ConfigSnapshot::Builder::AddOther(const std::string &exp, const char *type_name) {
+  Node n = {exp, OTHER, 0.0, type_name, 0};
+  nodes_.push_back(n);
+}
+
+void ConfigSnapshot::Builder::AddFile(const std::string &filename) {
+  for (size_t i = 0; i < deps_.size(); i++)
+    if (deps_[i].file && deps_[i].name == filename) return;
+  Dependency d = {true, filename, false, "", 0, 0};
+  d.set = FileStamp(filename.c_str(), &d.mtime, &d.size);
+  deps_.push_back(d);
+}
+
+void ConfigSnapshot::Builder::AddEnv(const std::string &name, const char *value) {
+  for (size_t i = 0; i < deps_.size(); i++)
+    if (!deps_[i].file && deps_[i].name == name) return;
+  Dependency d = {false, name, value != NULL, value ? value : "", 0, 0};
+  deps_.push_back(d);
+}
+
+bool ConfigSnapshot::Builder::Write(const std::string &file) const {
+  // Lay out the string pool first, NUL terminating every string
+  std::string strings;
+  std::vector<Entry> entries(nodes_.size());
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    const Node &n = nodes_[i];
+    Entry &e = entries[i];
+    memset(&e, 0, sizeof(e));
+    e.key = strings.size();
+    e.key_size = n.exp.size();
+    e.hash = KeyHash(n.exp.data(), n.exp.size());
+    strings.append(n.exp).push_back('\0');
+    e.str = strings.size();
+    strings.append(n.str).push_back('\0');
+    e.number = n.number;
+    e.size = n.size;
+    e.type = n.type;
+    e.boolean = (n.type == BOOLEAN && n.number != 0.0);
+  }
+  std::vector<ConfigSnapshot::Dependency> deps(deps_.size());
+  for (size_t i = 0; i < deps_.size(); i++) {
+    ConfigSnapshot::Dependency &d = deps[i];
+    memset(&d, 0, sizeof(d));
+    d.mtime = deps_[i].mtime;
+    d.size = deps_[i].size;
+    d.file = deps_[i].file;
+    d.set = deps_[i].set;
+    d.name = strings.size();
+    strings.append(deps_[i].name).push_back('\0');
+    d.value = strings.size();
+    strings.append(deps_[i].value).push_back('\0');
+  }
+
+  // At most half full, so probe sequences stay short
+  uint32_t num_slots = 2;
+  while (num_slots < 2 * entries.size())
+    num_slots *= 2;
+  std::vector<uint32_t> slots(num_slots, 0);
+  for (size_t i = 0; i < entries.size(); i++) {
+    uint32_t s = entries[i].hash & (num_slots - 1);
+    while (slots[s] != 0)
+      s = (s + 1) & (num_slots - 1);
+    slots[s] = i + 1;
+  }
+
+  Header h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, kSnapshotMagic, sizeof(h.magic));
+  h.version = kSnapshotVersion;
+  h.num_entries = entries.size();
+  h.num_slots = num_slots;
+  h.num_deps = deps.size();
+  h.strings_size = strings.size();
+  h.size = sizeof(Header) + entries.size() * sizeof(Entry) + num_slots * sizeof(uint32_t)
+         + deps.size() * sizeof(ConfigSnapshot::Dependency) + strings.size();
+
+  // Every writer gets a temporary file of its own in the target directory, as
+  // nodes of the same process may write the same snapshot concurrently
+  std::string tmp = file + ".XXXXXX";
+  int fd = mkstemp(&tmp[0]);
+  if (fd < 0)
+    return false;
+  FILE *f = fdopen(fd, "wb");
+  if (f == NULL) {
+    close(fd);
+    unlink(tmp.c_str());
+    return false;
+  }
+  // mkstemp only lets the owner read the file, but other users run nodes too
+  bool ok = fchmod(fd, 0644) == 0 &&
+            fwrite(&h, sizeof(h), 1, f) == 1 &&
+            fwrite(entries.data(), sizeof(Entry), entries.size(), f) == entries.size() &&
+            fwrite(slots.data(), sizeof(uint32_t), slots.size(), f) == slots.size() &&
+            fwrite(deps.data(), sizeof(ConfigSnapshot::Dependency), deps.size(), f) == deps.size() &&
+            fwrite(strings.data(), 1, strings.size(), f) == strings.size();
+  // The data must reach the disk before the rename, or a crash could leave a
+  // complete name pointing at an incomplete file
+  ok = ok && fflush(f) == 0 && fsync(fd) == 0;
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp.c_str(), file.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return false;
+  }
+  // Make the rename itself durable
+  size_t slash = file.find_last_of('/');
+  std::string dir = (slash == std::string::npos) ? "." : file.substr(0, slash + 1);
+  int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    close(dir_fd);
+  }
+  return true;
+}
+
+//====================================================================//
+ConfigSnapshot::ConfigSnapshot() :
+  header_(NULL), entries_(NULL), slots_(NULL), deps_(NULL), strings_(NULL),
+  data_(NULL), size_(0) {
+}
+
+ConfigSnapshot::~ConfigSnapshot() {
+  Close();
+}
+
+bool ConfigSnapshot::Load(const std::string &file) {
+  Close();
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header)))
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+  data_ = data;
+  size_ = st.st_size;
+
+  // Check the header and that every offset is inside the file
+  const Header *h = reinterpret_cast<const Header*>(data_);
+  const char *base = reinterpret_cast<const char*>(data_);
+  size_t strings_offset = sizeof(Header) + static_cast<size_t>(h->num_entries) * sizeof(Entry)
+                        + static_cast<size_t>(h->num_slots) * sizeof(uint32_t)
+                        + static_cast<size_t>(h->num_deps) * sizeof(Dependency);
+  if (memcmp(h->magic, kSnapshotMagic, sizeof(h->magic)) != 0 || h->version != kSnapshotVersion ||
+      h->size != size_ || strings_offset + h->strings_size != size_ ||
+      h->num_slots < 2 || (h->num_slots & (h->num_slots - 1)) != 0 || h->num_entries >= h->num_slots ||
+      h->strings_size == 0 || base[size_ - 1] != '\0') {
+    Close();
+    return false;
+  }
+  header_ = h;
+  entries_ = reinterpret_cast<const Entry*>(base + sizeof(Header));
+  slots_ = reinterpret_cast<const uint32_t*>(entries_ + h->num_entries);
+  deps_ = reinterpret_cast<const Dependency*>(slots_ + h->num_slots);
+  strings_ = base + strings_offset;
+  for (uint32_t i = 0; i < h->num_entries; i++) {
+    const Entry &e = entries_[i];
+    if (e.key + static_cast<size_t>(e.key_size) >= h->strings_size || e.str >= h->strings_size ||
+        (e.type == STRING && e.str + static_cast<size_t>(e.size) >= h->strings_size)) {
+      Close();
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < h->num_slots; i++) {
+    if (slots_[i] > h->num_entries) {
+      Close();
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < h->num_deps; i++) {
+    if (deps_[i].name >= h->strings_size || deps_[i].value >= h->strings_size) {
+      Close();
+      return false;
+    }
+  }
+  return true;
+}
+
+void ConfigSnapshot::Close() {
+  if (data_ != NULL)
+    munmap(data_, size_);
+  header_ = NULL;
+  entries_ = NULL;
+  slots_ = NULL;
+  deps_ = NULL;
+  strings_ = NULL;
+  data_ = NULL;
+  size_ = 0;
+}
+
+bool ConfigSnapshot::IsOpen() const {
+  return header_ != NULL;
+}
+
+bool ConfigSnapshot::IsCurrent() const {
+  if (!IsOpen())
+    return false;
+  for (uint32_t i = 0; i < header_->num_deps; i++) {
+    const Dependency &d = deps_[i];
+    const char *name = strings_ + d.name;
+    if (d.file) {
+      int64_t mtime, size;
+      bool exists = FileStamp(name, &mtime, &size);
+      if (exists != static_cast<bool>(d.set) || (exists && (mtime != d.mtime || size != d.size)))
+        return false;
+    } else {
+      const char *value = getenv(name);
+      if ((value != NULL) != static_cast<bool>(d.set) || (value && strcmp(value, strings_ + d.value) != 0))
+        return false;
+    }
+  }
+  return true;
+}
+
+int ConfigSnapshot::Find(const char *exp, size_t len) const {
+  if (!IsOpen())
+    return -1;
+  uint32_t h = KeyHash(exp, len);
+  uint32_t mask = header_->num_slots - 1;
+  for (uint32_t s = h & mask; slots_[s] != 0; s = (s + 1) & mask) {
+    const Entry &e = entries_[slots_[s] - 1];
+    if (e.hash == h && e.key_size == len && memcmp(strings_ + e.key, exp, len) == 0)
+      return slots_[s] - 1;
+  }
+  return -1;
+}
+
+int ConfigSnapshot::Find(const std::string &exp) const {
+  return Find(exp.data(), exp.size());
+}
+
+void ConfigSnapshot::Get(int index, Value *value) const {
+  const Entry &e = entries_[index];
+  value->type = static_cast<Type>(e.type);
+  value->boolean = e.boolean;
+  value->number = e.number;
+  value->str = strings_ + e.str;
+  value->size = e.size;
+}
+
+const char *ConfigSnapshot::Expression(int index) const {
+  return strings_ + entries_[index].key;
+}
+
+std::vector<std::string> ConfigSnapshot::Files() const {
+  std::vector<std::string> files;
+  for (uint32_t i = 0; IsOpen() && i < header_->num_deps; i++)
+    if (deps_[i].file && deps_[i].set)
+      files.push_back(strings_ + deps_[i].name);
+  return files;
+}
+
+}  // namespace config_reader
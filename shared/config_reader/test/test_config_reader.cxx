@@ -0,0 +1,322 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <config_reader/config_reader.h>
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using config_reader::ConfigReader;
+
+// What get_imports needs from common_lua.config
+static const char kCommon[] =
+  "pi = math.pi\n"
+  "function get_imports()\n"
+  "  files = {}\n"
+  "  for k, v in pairs(package.loaded) do\n"
+  "    f = package.searchpath(k, package.path)\n"
+  "    if f ~= nil then\n"
+  "      table.insert(files, f)\n"
+  "    end\n"
+  "  end\n"
+  "  return files\n"
+  "end\n";
+
+// A value of every kind the getters convert between
+static const char kRobot[] =
+  "require \"geometry\"\n"
+  "robot_name = os.getenv(\"CONFIG_READER_TEST_ROBOT\") or \"none\"\n"
+  "robot = {\n"
+  "  name = robot_name,\n"
+  "  mass = geometry.mass * 2,\n"
+  "  enabled = true,\n"
+  "  disabled = false,\n"
+  "  count = 7,\n"
+  "  negative = -3.6,\n"
+  "  big = 2^40,\n"
+  "  numeric = \"12.5\",\n"
+  "  hex = \"0x1f\",\n"
+  "  padded = \" 42 \",\n"
+  "  word = \"bsharp\",\n"
+  "  empty = \"\",\n"
+  "  embedded = \"a\\0b\",\n"
+  "  cameras = {\"nav\", \"dock\", \"haz\"},\n"
+  "  poses = {{x = 1, y = 2}, {x = 3.5, y = -4}},\n"
+  "  limits = {low = -1, high = 1},\n"
+  "  inverse = function(x) return 1 / x end,\n"
+  "}\n";
+
+// Names looked up in every table, whether they are there or not
+static const char* kNames[] = {
+  "robot", "robot_name", "geometry", "pi", "get_imports", "name", "mass",
+  "enabled", "disabled", "count", "negative", "big", "numeric", "hex",
+  "padded", "word", "empty", "embedded", "cameras", "poses", "limits",
+  "inverse", "x", "y", "low", "high", "missing", "robot.name", "poses[1]"
+};
+
+// Only names can be checked for
+template <typename Source>
+static bool Exists(Source* source, const char* key) {
+  return source->CheckValExists(key);
+}
+
+template <typename Source>
+static bool Exists(Source* source, int key) {
+  return false;
+}
+
+class ConfigReaderTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    char dir[] = "/tmp/config_reader_XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != NULL);
+    dir_ = dir;
+    snapshots_ = dir_ + "/snapshots";
+    Write("common_lua.config", kCommon);
+    Write("robot.config", kRobot);
+    Write("geometry.config", "geometry = {mass = 9.5}\n");
+    setenv("CONFIG_READER_TEST_ROBOT", "bsharp", 1);
+  }
+
+  void TearDown() {
+    unsetenv("CONFIG_READER_TEST_ROBOT");
+    Remove(dir_);
+  }
+
+  void Write(std::string const& name, std::string const& text) {
+    std::ofstream((dir_ + "/" + name).c_str()) << text;
+  }
+
+  void Remove(std::string const& path) {
+    if (DIR* dir = opendir(path.c_str())) {
+      while (struct dirent* entry = readdir(dir))
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+          Remove(path + "/" + entry->d_name);
+      closedir(dir);
+      rmdir(path.c_str());
+    } else {
+      unlink(path.c_str());
+    }
+  }
+
+  // Inode of the only snapshot, 0 if there is none. Compiling a snapshot
+  // replaces the file, so a reader that kept it was served from it.
+  ino_t Snapshot() {
+    ino_t inode = 0;
+    if (DIR* dir = opendir(snapshots_.c_str())) {
+      while (struct dirent* entry = readdir(dir))
+        if (entry->d_name[0] != '.')
+          inode = entry->d_ino;
+      closedir(dir);
+    }
+    return inode;
+  }
+
+  // Reads the config as a node does, from Lua if snapshots is empty
+  std::unique_ptr<ConfigReader> Read(std::string const& snapshots) {
+    std::unique_ptr<ConfigReader> config(new ConfigReader(dir_.c_str()));
+    config->SetSnapshotDir(snapshots.c_str());
+    config->AddFile("robot.config");
+    EXPECT_TRUE(config->ReadFiles());
+    return config;
+  }
+
+  // Reads from the snapshot and tells whether it was compiled, not served
+  std::unique_ptr<ConfigReader> ReadSnapshot(bool* compiled) {
+    ino_t before = Snapshot();
+    std::unique_ptr<ConfigReader> config = Read(snapshots_);
+    *compiled = (Snapshot() != before);
+    return config;
+  }
+
+  // Everything every getter returns for a key of a table
+  template <typename Source, typename Key>
+  void Dump(Source* source, Key key, std::string const& exp, int depth,
+            std::ostream* out) {
+    std::string str = "?";
+    bool boolean = false;
+    int integer = -99;
+    int64_t long_long = -99;
+    unsigned int uint = 99;
+    double real = -99, pos_real = -99, ranged_real = -99;
+    float real_float = -99, pos_float = -99;
+    int ranged_int = -99;
+    ConfigReader::Table table;
+    *out << exp << ": " << Exists(source, key)
+      << " str " << source->GetStr(key, &str) << " '" << str << "'"
+      << " bool " << source->GetBool(key, &boolean) << " " << boolean
+      << " int " << source->GetInt(key, &integer) << " " << integer
+      << " long " << source->GetLongLong(key, &long_long) << " " << long_long
+      << " uint " << source->GetUInt(key, &uint) << " " << uint
+      << " real " << source->GetReal(key, &real) << " " << real
+      << " float " << source->GetReal(key, &real_float) << " " << real_float
+      << " pos " << source->GetPosReal(key, &pos_real) << " " << pos_real
+      << " pos_float " << source->GetPosReal(key, &pos_float) << " " << pos_float
+      << " int[0,10] " << source->GetInt(key, &ranged_int, 0, 10) << " " << ranged_int
+      << " real[-1,1] " << source->GetReal(key, &ranged_real, -1.0, 1.0) << " " << ranged_real
+      << " table " << source->GetTable(key, &table);
+    if (!table.IsInit()) {
+      *out << "\n";
+      return;
+    }
+    *out << " size " << table.GetSize() << "\n";
+    if (depth == 0)
+      return;
+    for (const char* name : kNames)
+      Dump(&table, name, exp + "." + name, depth - 1, out);
+    for (int i = 0; i <= table.GetSize() + 1; i++)
+      Dump(&table, i, exp + "[" + std::to_string(i) + "]", depth - 1, out);
+  }
+
+  std::string Dump(ConfigReader* config) {
+    std::ostringstream out;
+    for (const char* name : kNames)
+      Dump(config, name, name, 3, &out);
+    return out.str();
+  }
+
+  std::string dir_, snapshots_;
+};
+
+TEST_F(ConfigReaderTest, SnapshotMatchesLua) {
+  std::unique_ptr<ConfigReader> lua = Read("");
+  std::string expected = Dump(lua.get());
+  EXPECT_EQ(Snapshot(), 0u);
+  // The values come from the required file and the environment
+  std::string name;
+  double mass;
+  EXPECT_TRUE(lua->GetStr("robot_name", &name));
+  EXPECT_EQ(name, "bsharp");
+  ConfigReader::Table robot(lua.get(), "robot");
+  EXPECT_TRUE(robot.GetReal("mass", &mass));
+  EXPECT_EQ(mass, 19);
+
+  // by the reader that compiles the snapshot, and those it serves
+  bool compiled;
+  std::unique_ptr<ConfigReader> first = ReadSnapshot(&compiled);
+  EXPECT_TRUE(compiled);
+  EXPECT_EQ(Dump(first.get()), expected);
+  std::unique_ptr<ConfigReader> second = ReadSnapshot(&compiled);
+  EXPECT_FALSE(compiled);
+  EXPECT_EQ(Dump(second.get()), expected);
+}
+
+TEST_F(ConfigReaderTest, ChangedRequiredFileInvalidates) {
+  bool compiled;
+  ReadSnapshot(&compiled);
+  EXPECT_TRUE(compiled);
+  Write("geometry.config", "geometry = {mass = 10.25}\n");
+  std::unique_ptr<ConfigReader> config = ReadSnapshot(&compiled);
+  EXPECT_TRUE(compiled);
+  ConfigReader::Table robot(config.get(), "robot");
+  double mass;
+  EXPECT_TRUE(robot.GetReal("mass", &mass));
+  EXPECT_EQ(mass, 20.5);
+  EXPECT_EQ(Dump(config.get()), Dump(Read("").get()));
+  ReadSnapshot(&compiled);
+  EXPECT_FALSE(compiled);
+}
+
+// A required file found further down the path is shadowed by one created
+// earlier in it
+TEST_F(ConfigReaderTest, ShadowingRequiredFileInvalidates) {
+  Remove(dir_ + "/geometry.config");
+  Write("geometry.lua", "geometry = {mass = 1}\n");
+  bool compiled;
+  ReadSnapshot(&compiled);
+  EXPECT_TRUE(compiled);
+  ReadSnapshot(&compiled);
+  EXPECT_FALSE(compiled);
+  Write("geometry.config", "geometry = {mass = 2}\n");
+  std::unique_ptr<ConfigReader> config = ReadSnapshot(&compiled);
+  EXPECT_TRUE(compiled);
+  ConfigReader::Table robot(config.get(), "robot");
+  double mass;
+  EXPECT_TRUE(robot.GetReal("mass", &mass));
+  EXPECT_EQ(mass, 4);
+}
+
+TEST_F(ConfigReaderTest, ChangedEnvironmentInvalidates) {
+  bool compiled;
+  ReadSnapshot(&compiled);
+  EXPECT_TRUE(compiled);
+  const char* names[] = {"queen", NULL, "bsharp"};
+  for (const char* value : names) {
+    if (value)
+      setenv("CONFIG_READER_TEST_ROBOT", value, 1);
+    else
+      unsetenv("CONFIG_READER_TEST_ROBOT");
+    std::unique_ptr<ConfigReader> config = ReadSnapshot(&compiled);
+    EXPECT_TRUE(compiled);
+    std::string name;
+    EXPECT_TRUE(config->GetStr("robot_name", &name));
+    EXPECT_EQ(name, value ? value : "none");
+    EXPECT_EQ(Dump(config.get()), Dump(Read("").get()));
+    ReadSnapshot(&compiled);
+    EXPECT_FALSE(compiled);
+  }
+}
+
+// Resident memory of the process in kB
+static int64_t Resident() {
+  int64_t size = 0, resident = 0;
+  if (FILE* file = fopen("/proc/self/statm", "r")) {
+    if (fscanf(file, "%ld %ld", &size, &resident) != 2)  // NOLINT
+      resident = 0;
+    fclose(file);
+  }
+  return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+// Bring up time and the memory of the open readers, as a node holds them
+TEST_F(ConfigReaderTest, BringUp) {
+  const int kReaders = 50;
+  bool compiled;
+  ReadSnapshot(&compiled);
+  const char* sources[] = {"lua", "snapshot"};
+  for (const char* source : sources) {
+    std::string snapshots = (strcmp(source, "lua") == 0) ? "" : snapshots_;
+    std::vector<std::unique_ptr<ConfigReader>> configs;
+    int64_t resident = Resident();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kReaders; i++) {
+      configs.push_back(Read(snapshots));
+      double mass;
+      ConfigReader::Table robot(configs.back().get(), "robot");
+      EXPECT_TRUE(robot.GetReal("mass", &mass));
+    }
+    double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    printf("%s: %.3f ms and %.1f kB per reader\n", source,
+      1e3 * seconds / kReaders, (Resident() - resident) / static_cast<double>(kReaders));
+  }
+  EXPECT_FALSE(compiled && Snapshot() == 0);
+}
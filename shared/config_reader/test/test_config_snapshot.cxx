@@ -0,0 +1,204 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <config_reader/config_snapshot.h>
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+using config_reader::ConfigSnapshot;
+
+class ConfigSnapshotTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    char dir[] = "/tmp/config_snapshot_XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != NULL);
+    dir_ = dir;
+    config_ = dir_ + "/robot.config";
+    snapshot_ = dir_ + "/robot.snapshot";
+    WriteConfig("robot = {}\n");
+    unsetenv("CONFIG_SNAPSHOT_TEST");
+  }
+
+  void TearDown() {
+    unsetenv("CONFIG_SNAPSHOT_TEST");
+    for (std::string const& name : List())
+      unlink((dir_ + "/" + name).c_str());
+    rmdir(dir_.c_str());
+  }
+
+  void WriteConfig(std::string const& text) {
+    std::ofstream(config_.c_str()) << text;
+  }
+
+  // Files in the directory of the test
+  std::vector<std::string> List() {
+    std::vector<std::string> names;
+    DIR* dir = opendir(dir_.c_str());
+    if (dir == NULL)
+      return names;
+    while (struct dirent* entry = readdir(dir))
+      if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        names.push_back(entry->d_name);
+    closedir(dir);
+    return names;
+  }
+
+  // A snapshot of a small config, holding a marker to tell writers apart
+  ConfigSnapshot::Builder Build(double marker) {
+    ConfigSnapshot::Builder builder;
+    builder.AddTable("robot", 2);
+    builder.AddNumber("robot.marker", marker);
+    builder.AddBoolean("robot.enabled", true);
+    builder.AddString("robot.name", "bsharp", 6);
+    builder.AddTable("robot.cpus", 2);
+    builder.AddNumber("robot.cpus[1]", 2);
+    builder.AddNumber("robot.cpus[2]", 3);
+    builder.AddFile(config_);
+    builder.AddFile(dir_ + "/missing.config");
+    builder.AddEnv("CONFIG_SNAPSHOT_TEST", getenv("CONFIG_SNAPSHOT_TEST"));
+    return builder;
+  }
+
+  std::string dir_, config_, snapshot_;
+};
+
+TEST_F(ConfigSnapshotTest, RoundTrip) {
+  ASSERT_TRUE(Build(42).Write(snapshot_));
+  ConfigSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Load(snapshot_));
+  EXPECT_TRUE(snapshot.IsCurrent());
+  ConfigSnapshot::Value value;
+  int index = snapshot.Find("robot.marker");
+  ASSERT_GE(index, 0);
+  snapshot.Get(index, &value);
+  EXPECT_EQ(value.type, ConfigSnapshot::NUMBER);
+  EXPECT_EQ(value.number, 42);
+  EXPECT_STREQ(snapshot.Expression(index), "robot.marker");
+  index = snapshot.Find("robot.name");
+  ASSERT_GE(index, 0);
+  snapshot.Get(index, &value);
+  EXPECT_EQ(value.type, ConfigSnapshot::STRING);
+  EXPECT_STREQ(value.str, "bsharp");
+  EXPECT_EQ(value.size, 6);
+  index = snapshot.Find("robot.enabled");
+  ASSERT_GE(index, 0);
+  snapshot.Get(index, &value);
+  EXPECT_EQ(value.type, ConfigSnapshot::BOOLEAN);
+  EXPECT_TRUE(value.boolean);
+  index = snapshot.Find("robot.cpus");
+  ASSERT_GE(index, 0);
+  snapshot.Get(index, &value);
+  EXPECT_EQ(value.type, ConfigSnapshot::TABLE);
+  EXPECT_EQ(value.size, 2);
+  index = snapshot.Find("robot.cpus[2]");
+  ASSERT_GE(index, 0);
+  snapshot.Get(index, &value);
+  EXPECT_EQ(value.number, 3);
+  EXPECT_LT(snapshot.Find("robot.missing"), 0);
+  // Only files that existed are reported
+  EXPECT_EQ(snapshot.Files(), std::vector<std::string>({config_}));
+  // No temporary file is left behind
+  EXPECT_EQ(List().size(), 2u);
+}
+
+TEST_F(ConfigSnapshotTest, RejectsCorruptFiles) {
+  ASSERT_TRUE(Build(1).Write(snapshot_));
+  ASSERT_EQ(truncate(snapshot_.c_str(), 100), 0);
+  ConfigSnapshot snapshot;
+  EXPECT_FALSE(snapshot.Load(snapshot_));
+  EXPECT_FALSE(snapshot.IsOpen());
+  EXPECT_FALSE(snapshot.Load(dir_ + "/absent.snapshot"));
+}
+
+TEST_F(ConfigSnapshotTest, ChangedFileInvalidates) {
+  ASSERT_TRUE(Build(1).Write(snapshot_));
+  ConfigSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Load(snapshot_));
+  EXPECT_TRUE(snapshot.IsCurrent());
+  WriteConfig("robot = {marker = 2}\n");
+  EXPECT_FALSE(snapshot.IsCurrent());
+}
+
+TEST_F(ConfigSnapshotTest, CreatedFileInvalidates) {
+  ASSERT_TRUE(Build(1).Write(snapshot_));
+  ConfigSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Load(snapshot_));
+  std::ofstream((dir_ + "/missing.config").c_str()) << "robot = {}\n";
+  EXPECT_FALSE(snapshot.IsCurrent());
+}
+
+TEST_F(ConfigSnapshotTest, ChangedEnvironmentInvalidates) {
+  ASSERT_TRUE(Build(1).Write(snapshot_));
+  ConfigSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Load(snapshot_));
+  setenv("CONFIG_SNAPSHOT_TEST", "bumble", 1);
+  EXPECT_FALSE(snapshot.IsCurrent());
+  ASSERT_TRUE(Build(1).Write(snapshot_));
+  ASSERT_TRUE(snapshot.Load(snapshot_));
+  EXPECT_TRUE(snapshot.IsCurrent());
+  setenv("CONFIG_SNAPSHOT_TEST", "queen", 1);
+  EXPECT_FALSE(snapshot.IsCurrent());
+}
+
+// Nodes of one manager write the same snapshot at the same time. Readers must
+// only ever see one complete snapshot, and no temporary file may be left.
+TEST_F(ConfigSnapshotTest, ConcurrentWriters) {
+  ASSERT_TRUE(Build(0).Write(snapshot_));
+  std::atomic<bool> running(true);
+  std::atomic<int> failures(0);
+  std::vector<std::thread> writers;
+  for (int w = 1; w <= 4; w++) {
+    writers.emplace_back([this, w, &failures]() {
+      ConfigSnapshot::Builder builder = Build(w);
+      for (int i = 0; i < 200; i++)
+        if (!builder.Write(snapshot_))
+          failures++;
+    });
+  }
+  std::thread reader([this, &running, &failures]() {
+    while (running) {
+      ConfigSnapshot snapshot;
+      ConfigSnapshot::Value value;
+      int index = -1;
+      if (!snapshot.Load(snapshot_) || (index = snapshot.Find("robot.marker")) < 0) {
+        failures++;
+        continue;
+      }
+      snapshot.Get(index, &value);
+      if (value.number < 0 || value.number > 4)
+        failures++;
+    }
+  });
+  for (auto & writer : writers)
+    writer.join();
+  running = false;
+  reader.join();
+  EXPECT_EQ(failures, 0);
+  EXPECT_EQ(List().size(), 2u);
+}
@@ -31,8 +31,10 @@
 
 #include <diagnostic_msgs/KeyValue.h>
 
+#include <atomic>
 #include <climits>
 #include <cfloat>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -42,6 +44,53 @@ namespace ff_util {
 
 typedef boost::function<bool(dynamic_reconfigure::Config &request)> ConfigCallback;
 
+// The current value of a parameter. Reads are atomic loads and updates are
+// atomic stores, so the value can be read from any thread while the server
+// reconfigures it. Strings are replaced by swapping a pointer to a new copy.
+template<typename T> class ConfigSlot {
+ public:
+  ConfigSlot() : value_(T()) {}
+  T Load() const { return value_.load(std::memory_order_acquire); }
+  void Store(const T &value) { value_.store(value, std::memory_order_release); }
+
+ private:
+  std::atomic<T> value_;
+};
+
+template<> class ConfigSlot<std::string> {
+ public:
+  ConfigSlot() : value_(std::make_shared<const std::string>()) {}
+  std::string Load() const { return *std::atomic_load(&value_); }
+  void Store(const std::string &value) {
+    std::atomic_store(&value_, std::make_shared<const std::string>(value));
+  }
+
+ private:
+  std::shared_ptr<const std::string> value_;
+};
+
+// A parameter resolved once by ConfigServer::Resolve, so that reading it
+// needs no lookup by name. It stays valid for the lifetime of the server.
+template<typename T> class ConfigParam {
+ public:
+  ConfigParam() : slot_(nullptr) {}
+  // False if the parameter has not been resolved
+  bool Valid() const { return slot_ != nullptr; }
+  // Get error-aware, to fall back on a default like ConfigServer::Get
+  bool Get(T &value) const {
+    if (slot_ == nullptr)
+      return false;
+    value = slot_->Load();
+    return true;
+  }
+  T Get() const { return slot_ == nullptr ? T() : slot_->Load(); }
+
+ private:
+  friend class ConfigServer;
+  explicit ConfigParam(const ConfigSlot<T> *slot) : slot_(slot) {}
+  const ConfigSlot<T> *slot_;
+};
+
 class ConfigServer {
  public:
   // Constructor opens the ASTROBEE_CONFIG_DIR/subsystem/node.config file by default
@@ -64,6 +113,8 @@ class ConfigServer {
     }
     return tmp;
   }
+  // Resolve a parameter to a handle, for reads in hot paths and other threads
+  template<typename T> bool Resolve(const std::string &name, ConfigParam<T> &param);
   // Lim the values of a given type a runtime (helps prevent code from getting out of sync)
   template<typename T> bool Lim(const std::string &name, const std::map<T, std::string> &vals);
   // Dump all parameters into a KeyValue message
@@ -92,10 +143,12 @@ class ConfigServer {
   ros::ServiceServer srv_r_;
   config_reader::ConfigReader config_params_;
   ConfigCallback callback_;
-  std::map<std::string, bool> bools_;
-  std::map<std::string, int> ints_;
-  std::map<std::string, double> doubles_;
-  std::map<std::string, std::string> strs_;
+  // Parameters are not added or removed once listening, so the slots can be
+  // handed out to ConfigParam handles
+  std::map<std::string, ConfigSlot<bool>> bools_;
+  std::map<std::string, ConfigSlot<int>> ints_;
+  std::map<std::string, ConfigSlot<double>> doubles_;
+  std::map<std::string, ConfigSlot<std::string>> strs_;
   dynamic_reconfigure::ConfigDescription description_;
 };
 
@@ -104,6 +157,11 @@ template<> bool ConfigServer::Get<double>(const std::string &name, double &value
 template<> bool ConfigServer::Get<bool>(const std::string &name, bool &value);
 template<> bool ConfigServer::Get<std::string>(const std::string &name, std::string &value);
 
+template<> bool ConfigServer::Resolve<int>(const std::string &name, ConfigParam<int> &param);
+template<> bool ConfigServer::Resolve<double>(const std::string &name, ConfigParam<double> &param);
+template<> bool ConfigServer::Resolve<bool>(const std::string &name, ConfigParam<bool> &param);
+template<> bool ConfigServer::Resolve<std::string>(const std::string &name, ConfigParam<std::string> &param);
+
 template<> bool ConfigServer::Set<int>(const std::string &name, const int &value);
 template<> bool ConfigServer::Set<double>(const std::string &name, const double &value);
 template<> bool ConfigServer::Set<bool>(const std::string &name, const bool &value);
@@ -117,6 +117,23 @@ enum SegmentResult : int {
   ERROR_LIMITS_ALPHA              = -8
 };
 
+// A structure of arrays view of a segment, holding the time of every setpoint
+// and the magnitudes of its velocities and accelerations. It doubles as the
+// scratch space of the batch Check and Resample, so a caller that keeps one
+// between calls stops allocating once it has seen its longest segment.
+struct SegmentView {
+  // Fill the view from a segment, reusing the existing storage
+  void Assign(Segment const& segment);
+  // Number of setpoints in the view
+  size_t Size() const { return t.size(); }
+  std::vector<double> t;  // Time
+  std::vector<double> w;  // Omega magnitude
+  std::vector<double> v;  // Velocity magnitude
+  std::vector<double> b;  // Alpha magnitude
+  std::vector<double> a;  // Acceleration magnitude
+  std::vector<size_t> n;  // Resampled setpoints per interval
+};
+
 // Class to read flight mode information
 class FlightUtil {
  public:
@@ -150,6 +167,17 @@ class FlightUtil {
   static SegmentResult Resample(Segment const& in, Segment & out,
     double rate = -1.0);
 
+  // Batch versions of Check and Resample, which return the same results but
+  // do not build a State per setpoint. Check validates all limits in a single
+  // pass over a view of the segment. Resample sizes the output once and writes
+  // the propagated setpoints in place, so reusing the output segment reuses
+  // its messages.
+  static SegmentResult Check(SegmentCheckMask mask, Segment const& segment,
+    ff_msgs::FlightMode const& flight_mode, bool faceforward,
+    SegmentView & scratch);
+  static SegmentResult Resample(Segment const& in, Segment & out,
+    double rate, SegmentView & scratch);
+
   // Print a human-readable description of the error code
   static std::string GetDescription(SegmentResult result);
 
@@ -117,6 +117,7 @@
 #define TOPIC_GNC_CTL_SEGMENT                       "gnc/ctl/segment"
 #define TOPIC_GNC_CTL_PROGRESS                      "gnc/ctl/progress"
 #define TOPIC_GNC_CTL_COMMAND                       "gnc/ctl/command"
+#define TOPIC_GNC_FAM_LATENCY                       "gnc/fam/latency"
 
 #define SERVICE_GNC_EKF_RESET                       "gnc/ekf/reset"
 #define SERVICE_GNC_EKF_INIT_BIAS                   "gnc/ekf/init_bias"
@@ -159,6 +160,7 @@
 #define TOPIC_MANAGEMENT_EXEC_PLAN_STATUS           "mgt/executive/plan_status"
 #define TOPIC_MANAGEMENT_SYS_MONITOR_CONFIG         "mgt/sys_monitor/config"
 #define TOPIC_MANAGEMENT_SYS_MONITOR_STATE          "mgt/sys_monitor/state"
+#define TOPIC_MANAGEMENT_SYS_MONITOR_UPDATES        "mgt/sys_monitor/updates"
 #define TOPIC_MANAGEMENT_CAMERA_STATE               "mgt/camera_state"
 #define TOPIC_MANAGEMENT_IMG_SAMPLER_NAV_CAM_RECORD  "mgt/img_sampler/nav_cam/image_record"
 #define TOPIC_MANAGEMENT_IMG_SAMPLER_NAV_CAM_STREAM  "mgt/img_sampler/nav_cam/image_stream"
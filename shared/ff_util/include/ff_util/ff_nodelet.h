@@ -29,11 +29,14 @@
 
 #include <ff_msgs/Fault.h>
 #include <ff_msgs/Heartbeat.h>
+#include <ff_msgs/ThreadScheduling.h>
 #include <ff_msgs/Trigger.h>
 
 #include <ff_util/ff_names.h>
+#include <ff_util/ff_scheduling.h>
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -74,6 +77,26 @@ class FreeFlyerNodelet : public nodelet::Nodelet {
   void ClearFault(std::string const& key);
   void PrintFaults();
 
+  // Apply the scheduling policy of this node from scheduling.config to the
+  // calling thread, and report it in the heartbeat if the thread was
+  // registered with RegisterThread. Only call this at the start of threads
+  // owned by the node, never from callbacks, which run on worker threads
+  // that the nodelet manager shares with other nodes. Returns
+  // false if the policy could not be fully applied, usually because of
+  // missing privileges.
+  bool ApplyScheduling();
+
+  // Node handle whose callbacks run on a thread owned by this node, which has
+  // the scheduling policy of the node applied. Use it for the subscriptions
+  // of time critical callbacks. The thread is started on the first call.
+  ros::NodeHandle* GetRealtimeHandle();
+
+  // Name the calling thread after this node, and report it in the heartbeat,
+  // so that the cpu monitor attributes the cpu it uses to this node. Call this
+  // at the start of threads owned by the node. Thread names are limited to 15
+  // characters, so longer node names are truncated.
+  void RegisterThread();
+
  protected:
   // Virtual methods that *can* be implemented by FF nodes. We don't make
   // these mandatory, as there is already a load callback in Gazebo.
@@ -105,6 +128,9 @@ class FreeFlyerNodelet : public nodelet::Nodelet {
   // Called on a heartbeat event
   void HeartbeatCallback(ros::TimerEvent const& ev);
 
+  // Called periodically to report the publisher audit, when it is enabled
+  void AuditCallback(ros::WallTimerEvent const& ev);
+
   // Called when nodelet should be initialized
   void InitCallback(ros::TimerEvent const& ev);
 
@@ -120,6 +146,13 @@ class FreeFlyerNodelet : public nodelet::Nodelet {
   // Called in onInit to read in the faults associated with the node
   void ReadFaults();
 
+  // Called in onInit to read in the scheduling policy of the node
+  void ReadScheduling();
+
+  // Report the scheduling of the calling thread in the heartbeat, adding the
+  // thread if it is not reported yet and add is set
+  void ReportThread(bool add);
+
   // Heartbeat autostart
   bool autostart_hb_timer_;
   bool initialized_;
@@ -135,10 +168,12 @@ class FreeFlyerNodelet : public nodelet::Nodelet {
   ros::NodeHandle nh_mt_;
   ros::NodeHandle nh_private_;
   ros::NodeHandle nh_private_mt_;
+  ros::NodeHandle nh_rt_;
 
   // Timers
   ros::Timer timer_heartbeat_;
   ros::Timer timer_deferred_init_;
+  ros::WallTimer timer_audit_;
 
   // Publishers
   ros::Publisher pub_heartbeat_;
@@ -149,6 +184,15 @@ class FreeFlyerNodelet : public nodelet::Nodelet {
 
   std::map<std::string, int> faults_;
 
+  // Scheduling policy, the thread serving the realtime handle, and the
+  // scheduling achieved by each thread
+  bool sched_enabled_;
+  SchedulingPolicy sched_policy_;
+  DedicatedQueue rt_queue_;
+  std::once_flag rt_once_;
+  std::mutex mutex_threads_;
+  std::vector<ff_msgs::ThreadScheduling> threads_;
+
   // Name and subsystem
   std::string platform_;
   std::string node_;
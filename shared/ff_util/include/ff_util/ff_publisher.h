@@ -0,0 +1,136 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FF_UTIL_FF_PUBLISHER_H_
+#define FF_UTIL_FF_PUBLISHER_H_
+
+// ROS includes
+#include <ros/ros.h>
+
+// Boost includes
+#include <boost/make_shared.hpp>
+
+// C++11 includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ff_util {
+
+// Counts, per topic, the bytes published by shared pointer and the bytes published by value. Enabled
+// by setting FF_PUBLISHER_AUDIT in the environment of the nodelet manager, in which case a summary is
+// logged every ten seconds and the first copy on each topic is warned about. Topics advertised in the
+// process with a raw ros::Publisher rather than a FreeFlyerPublisher cannot be counted, so they are
+// listed in the summary instead, and warned about once.
+class PublisherAudit {
+ public:
+  // Messages and bytes published on a topic, by shared pointer and by value
+  struct Counts {
+    Counts() : shared_msgs(0), shared_bytes(0), copied_msgs(0), copied_bytes(0) {}
+    uint64_t shared_msgs, shared_bytes, copied_msgs, copied_bytes;
+  };
+
+  // Whether the audit is enabled, read from the environment once
+  static bool Enabled();
+
+  // Record a topic advertised by a FreeFlyerPublisher, so that it is not reported as raw
+  static void Advertise(std::string const& topic);
+
+  // Account for a message of a given serialized size published on a topic
+  static void Add(std::string const& topic, bool shared, uint64_t bytes);
+
+  // Get the counts of a topic, which are zero if nothing was published on it
+  static Counts Get(std::string const& topic);
+
+  // Get the topics advertised in this process that are not published by a FreeFlyerPublisher
+  static std::vector<std::string> RawTopics();
+
+  // Log the summary if it was not logged in the last ten seconds. Called periodically by every
+  // FreeFlyerNodelet, so that raw publishers are reported even when nothing is counted.
+  static void Report();
+};
+
+// This is a simple wrapper around a ROS publisher, which publishes messages by shared pointer. A
+// subscriber in the same nodelet manager then receives the very message that was published, rather
+// than a copy that was serialized and deserialized. Only subscribers in other processes pay for the
+// serialization. Since the subscribers share the message, it must not be modified once published,
+// so each message is allocated with Allocate() and filled before it is handed to Publish().
+
+template < class MessageType >
+class FreeFlyerPublisher {
+ public:
+  typedef boost::shared_ptr < MessageType > Ptr;
+
+  // Constructor
+  FreeFlyerPublisher() {}
+
+  // Destructor
+  ~FreeFlyerPublisher() {}
+
+  // Advertise the topic, with optional callbacks for subscribers connecting and disconnecting
+  void Create(ros::NodeHandle *nh, std::string const& topic, uint32_t queue_size, bool latch = false,
+    ros::SubscriberStatusCallback const& cb_connect = ros::SubscriberStatusCallback(),
+    ros::SubscriberStatusCallback const& cb_disconnect = ros::SubscriberStatusCallback()) {
+    pub_ = nh->advertise < MessageType > (topic, queue_size, cb_connect, cb_disconnect,
+      ros::VoidConstPtr(), latch);
+    if (PublisherAudit::Enabled())
+      PublisherAudit::Advertise(pub_.getTopic());
+  }
+
+  // Allocate a new message to fill and publish
+  Ptr Allocate() const {
+    return boost::make_shared < MessageType > ();
+  }
+
+  // Allocate a new message as a copy of a template, for example one holding the fields of a cloud
+  Ptr Allocate(MessageType const& msg) const {
+    return boost::make_shared < MessageType > (msg);
+  }
+
+  // Publish a message without copying it. It must not be modified afterwards.
+  void Publish(boost::shared_ptr < MessageType const > const& msg) {
+    if (PublisherAudit::Enabled())
+      PublisherAudit::Add(pub_.getTopic(), true, ros::serialization::serializationLength(*msg));
+    pub_.publish(msg);
+  }
+
+  // Publish a message by value, which serializes it for every subscriber, including those that
+  // share the process. Only use this for messages that are not worth allocating.
+  void Publish(MessageType const& msg) {
+    if (PublisherAudit::Enabled())
+      PublisherAudit::Add(pub_.getTopic(), false, ros::serialization::serializationLength(msg));
+    pub_.publish(msg);
+  }
+
+  // Get the number of subscribers, so that work can be skipped when there are none
+  uint32_t GetNumSubscribers() const {
+    return pub_.getNumSubscribers();
+  }
+
+  // Get the topic that was advertised
+  std::string GetTopic() const {
+    return pub_.getTopic();
+  }
+
+ private:
+  ros::Publisher pub_;
+};
+
+}  // namespace ff_util
+
+#endif  // FF_UTIL_FF_PUBLISHER_H_
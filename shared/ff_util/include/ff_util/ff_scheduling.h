@@ -0,0 +1,78 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FF_UTIL_FF_SCHEDULING_H_
+#define FF_UTIL_FF_SCHEDULING_H_
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace ff_util {
+
+// Scheduling policy of a thread, as read from scheduling.config
+struct SchedulingPolicy {
+  int priority = 0;           // SCHED_FIFO priority, or SCHED_OTHER if zero
+  bool lock_memory = false;   // Lock the memory of the whole process
+  std::vector<int> cpus;      // Cores the thread may run on, all if empty
+};
+
+// Apply the priority and cores of a policy to the calling thread. Returns an
+// empty string on success, or a description of what could not be applied.
+std::string ApplyThreadPolicy(SchedulingPolicy const& policy);
+
+// Lock all current and future memory of the process. Only the first call does
+// any work, so it is safe to call from every node that asks for it. Returns an
+// empty string on success, or the reason of the failure.
+std::string LockProcessMemory();
+
+// Whether the memory of the process has been locked
+bool ProcessMemoryLocked();
+
+// A callback queue served by a thread of its own. Subscriptions and timers
+// created through Handle() only ever run on this thread, so a scheduling
+// policy applied to it does not leak to the worker threads that the nodelet
+// manager shares between all of its nodes.
+class DedicatedQueue {
+ public:
+  DedicatedQueue();
+  ~DedicatedQueue();
+
+  // Start serving the queue. The init function runs first on the new thread.
+  void Start(std::function<void()> init);
+
+  // Stop serving the queue, waiting for the callback in progress
+  void Stop();
+
+  // Copy of a node handle whose callbacks are served by this queue
+  ros::NodeHandle Handle(ros::NodeHandle const& nh);
+
+ private:
+  ros::CallbackQueue queue_;
+  std::atomic<bool> running_;
+  std::thread thread_;
+};
+
+}  // namespace ff_util
+
+#endif  // FF_UTIL_FF_SCHEDULING_H_
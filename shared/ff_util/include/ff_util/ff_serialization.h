@@ -23,43 +23,64 @@
 #include <ros/ros.h>
 
 // STL includes
-#include <fstream>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace ff_util {
 
+// A file mapped read only into memory, so that a message can be deserialized
+// from it without first copying the whole file into a buffer.
+class MappedFile {
+ public:
+  explicit MappedFile(std::string const& file_name);
+  ~MappedFile();
+
+  bool IsOpen() const { return data_ != nullptr; }
+  uint8_t const* Data() const { return data_; }
+  size_t Size() const { return size_; }
+
+ private:
+  MappedFile(MappedFile const&) = delete;
+  MappedFile & operator=(MappedFile const&) = delete;
+
+  uint8_t* data_;
+  size_t size_;
+};
+
 class Serialization {
  public:
+  // Serialize a ROS message into a buffer
+  template < class RosMessage >
+  static void Serialize(RosMessage const& msg, std::vector < uint8_t > & buffer) {
+    buffer.resize(ros::serialization::serializationLength(msg));
+    ros::serialization::OStream ostream(buffer.data(), buffer.size());
+    ros::serialization::serialize(ostream, msg);
+  }
+  // Write a buffer to a file, through a temporary file that is synced and then
+  // renamed over the file, so that a crash leaves either the old or the new
+  // contents and never a partial file.
+  static bool WriteBuffer(std::string const& file_name, uint8_t const* data, size_t size);
   // Write a ROS message to a file
   template < class RosMessage >
   static bool WriteFile(std::string const& file_name, RosMessage const& msg) {
-    std::ofstream ofs(file_name, std::ios::out | std::ios::binary);
-    if (!ofs.is_open())
-      return false;
-    uint32_t serial_size = ros::serialization::serializationLength(msg);
-    boost::shared_array < uint8_t > obuffer(new uint8_t[serial_size]);
-    ros::serialization::OStream ostream(obuffer.get(), serial_size);
-    ros::serialization::serialize(ostream, msg);
-    ofs.write(reinterpret_cast < char* > (obuffer.get()), serial_size);
-    ofs.close();
-    return true;
+    std::vector < uint8_t > buffer;
+    Serialize(msg, buffer);
+    return WriteBuffer(file_name, buffer.data(), buffer.size());
   }
-  // Read a ROS message from a file
+  // Read a ROS message from a file, returning false if the file is missing or
+  // too short for the message
   template < class RosMessage >
   static bool ReadFile(std::string const& file_name, RosMessage & msg) {
-    std::ifstream ifs(file_name, std::ios::in | std::ios::binary);
-    if (!ifs.is_open())
+    MappedFile file(file_name);
+    if (!file.IsOpen())
+      return false;
+    try {
+      ros::serialization::IStream istream(const_cast < uint8_t* > (file.Data()), file.Size());
+      ros::serialization::deserialize(istream, msg);
+    } catch (ros::Exception const& e) {
       return false;
-    ifs.seekg(0, std::ios::end);
-    std::streampos end = ifs.tellg();
-    ifs.seekg(0, std::ios::beg);
-    std::streampos begin = ifs.tellg();
-    uint32_t file_size = end - begin;
-    boost::shared_array<uint8_t> ibuffer(new uint8_t[file_size]);
-    ifs.read(reinterpret_cast<char*> (ibuffer.get()), file_size);
-    ros::serialization::IStream istream(ibuffer.get(), file_size);
-    ros::serialization::deserialize(istream, msg);
-    ifs.close();
+    }
     return true;
   }
 };
@@ -0,0 +1,67 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FF_UTIL_LATENCY_MONITOR_H_
+#define FF_UTIL_LATENCY_MONITOR_H_
+
+#include <ros/ros.h>
+
+#include <ff_msgs/LatencyStats.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ff_util {
+
+// Accumulates per stage and end to end latency histograms of a pipeline, such
+// as the GNC loop from IMU sample to PMC command, and checks the end to end
+// latency against a deadline. Each sample is the list of times at which the
+// data entered the pipeline and left each stage.
+class LatencyMonitor {
+ public:
+  LatencyMonitor();
+
+  // Advertise the statistics on a topic. The bin edges are in seconds.
+  void Initialize(ros::NodeHandle* nh, std::string const& topic,
+                  std::vector<std::string> const& stages,
+                  std::vector<float> const& bin_edges);
+
+  // Maximum acceptable end to end latency in seconds, zero disables the check
+  void SetDeadline(double deadline);
+
+  // Add a sample with one more time than there are stages. Returns false if
+  // the end to end latency exceeded the deadline.
+  bool Add(std::vector<ros::Time> const& times);
+
+  // Publish the statistics accumulated since the last call, and clear them
+  void Send();
+
+ private:
+  void AddStage(ff_msgs::LatencyStage & stage, double latency);
+  void Clear();
+
+  std::mutex mutex_;
+  ff_msgs::LatencyStats msg_;
+  ros::Publisher pub_;
+  bool init_;
+};
+
+}  // namespace ff_util
+
+#endif  // FF_UTIL_LATENCY_MONITOR_H_
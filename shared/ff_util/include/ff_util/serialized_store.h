@@ -0,0 +1,151 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FF_UTIL_SERIALIZED_STORE_H_
+#define FF_UTIL_SERIALIZED_STORE_H_
+
+// ROS includes
+#include <ros/ros.h>
+
+// FSW includes
+#include <ff_util/ff_serialization.h>
+
+// STL includes
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace ff_util {
+
+// Keeps the versions of some state, such as the keep-out zones, in a directory
+// with one file per version, named after the seconds of its timestamp. Saving
+// a version only serializes it, and a thread of the store writes the file in
+// the background with Serialization::WriteBuffer, so a crash leaves either the
+// old or the new file. Versions saved while the thread is busy are written
+// together, and only the last version saved with a given name is written. The
+// directory also holds an index of the timestamp, size and modification time
+// of each file, so the newest version is found without reading the others. A
+// file that does not match its entry was replaced behind the back of the store
+// and is read again. The index is only written with the saved versions, so a
+// directory that is never saved to, such as an installed one, stays read-only.
+class SerializedStoreBase {
+ public:
+  // Wait until every version saved so far has been written
+  void Flush();
+
+ protected:
+  SerializedStoreBase();
+  ~SerializedStoreBase();
+
+  // Read the index of the directory and start the writer. The files with the
+  // extension that the index does not list, or whose size or modification time
+  // differ from their entry, are returned. They were written before the index,
+  // by a write interrupted before the index was updated, or by something else.
+  bool OpenDirectory(std::string const& directory, std::string const& extension,
+    std::vector < std::string > & unindexed);
+
+  // Add a file found in the directory to the index
+  void AddToIndex(std::string const& name, ros::Time const& stamp);
+
+  // Queue a serialized version to be written
+  void Enqueue(ros::Time const& stamp, std::vector < uint8_t > && data);
+
+  // The paths of the indexed files, newest first
+  std::vector < std::string > IndexedFiles();
+
+  // The path of a file in the directory
+  std::string Path(std::string const& name) const;
+
+ private:
+  // What the index knows about a file
+  struct Entry {
+    ros::Time stamp;
+    uintmax_t size;
+    std::time_t mtime;
+  };
+
+  void WriterThread();
+  bool ReadIndex();
+  bool Stat(std::string const& name, Entry & entry) const;
+  std::string FormatIndex() const;
+
+  std::string directory_, extension_;
+  std::map < std::string, Entry > index_;                   // Written files
+  std::map < std::string, std::pair < ros::Time, std::vector < uint8_t > > > pending_;
+  bool busy_, stop_;
+  std::mutex mutex_;
+  std::condition_variable cv_work_, cv_idle_;
+  std::thread thread_;
+};
+
+template < class RosMessage >
+class SerializedStore : public SerializedStoreBase {
+ public:
+  typedef std::function < ros::Time (RosMessage const&) > StampFunction;
+
+  // Open the directory, reading the files missing from the index to find their
+  // timestamps. Once a version was saved, this only reads the index.
+  bool Open(std::string const& directory, std::string const& extension, StampFunction stamp) {
+    stamp_ = stamp;
+    std::vector < std::string > unindexed;
+    if (!OpenDirectory(directory, extension, unindexed))
+      return false;
+    for (auto const& name : unindexed) {
+      RosMessage msg;
+      if (Serialization::ReadFile(Path(name), msg))
+        AddToIndex(name, stamp_(msg));
+      else
+        ROS_WARN_STREAM("Cannot read " << Path(name));
+    }
+    return true;
+  }
+
+  // Save a version of the state, without waiting for it to be written
+  void Save(RosMessage const& msg) {
+    std::vector < uint8_t > data;
+    Serialization::Serialize(msg, data);
+    Enqueue(stamp_(msg), std::move(data));
+  }
+
+  // Load the newest version that can be read
+  bool LoadNewest(RosMessage & msg) {
+    for (auto const& file : IndexedFiles()) {
+      RosMessage newest;
+      if (Serialization::ReadFile(file, newest)) {
+        msg = newest;
+        return true;
+      }
+      ROS_WARN_STREAM("Cannot read " << file);
+    }
+    return false;
+  }
+
+ private:
+  StampFunction stamp_;
+};
+
+}  // namespace ff_util
+
+#endif  // FF_UTIL_SERIALIZED_STORE_H_
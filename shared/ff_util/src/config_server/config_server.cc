@@ -134,7 +134,8 @@ bool ConfigServer::Listen() {
         ROS_ERROR_STREAM("String variable " << id << " already declared. Ignoring.");
         continue;
       }
-      if (!group.GetStr("default", &strs_[id])) {
+      std::string value;
+      if (!group.GetStr("default", &value)) {
         ROS_ERROR_STREAM("Could not get the default value for parameter " << id);
         continue;
       }
@@ -142,7 +143,7 @@ bool ConfigServer::Listen() {
         pd.type = "str";
         dynamic_reconfigure::StrParameter tmp;
         tmp.name = id;
-        tmp.value = strs_[id];
+        tmp.value = value;
         description_.min.strs.push_back(tmp);
         description_.max.strs.push_back(tmp);
         description_.dflt.strs.push_back(tmp);
@@ -166,15 +167,17 @@ bool ConfigServer::Listen() {
           }
         }
       }
-      nh_.getParam(id, strs_[id]);
-      nh_.setParam(id, strs_[id]);
+      nh_.getParam(id, value);
+      nh_.setParam(id, value);
+      strs_[id].Store(value);
       // *** INTEGERS *** //
     } else if (!type.compare("integer")) {
       if (ints_.find(id) != ints_.end()) {
         ROS_ERROR_STREAM("String variable " << id << " already declared. Ignoring.");
         continue;
       }
-      if (!group.GetInt("default", &ints_[id])) {
+      int value;
+      if (!group.GetInt("default", &value)) {
         ROS_ERROR_STREAM("Could not get the default value for parameter " << id);
         continue;
       }
@@ -190,7 +193,7 @@ bool ConfigServer::Listen() {
           ROS_WARN_STREAM("Could not get the max value for parameter " << id);
         description_.max.ints.push_back(tmp);
         tmp.name = id;
-        tmp.value = ints_[id];
+        tmp.value = value;
         description_.dflt.ints.push_back(tmp);
         description_.groups[0].parameters.push_back(pd);
         if (!unit.compare("enumeration")) {
@@ -212,15 +215,17 @@ bool ConfigServer::Listen() {
           }
         }
       }
-      nh_.getParam(id, ints_[id]);
-      nh_.setParam(id, ints_[id]);
+      nh_.getParam(id, value);
+      nh_.setParam(id, value);
+      ints_[id].Store(value);
       // *** BOOLEANS *** //
     } else if (!type.compare("boolean")) {
       if (bools_.find(id) != bools_.end()) {
         ROS_ERROR_STREAM("Boolean variable " << id << " already declared. Ignoring.");
         continue;
       }
-      if (!group.GetBool("default", &bools_[id])) {
+      bool value;
+      if (!group.GetBool("default", &value)) {
         ROS_ERROR_STREAM("Could not get the default value for parameter " << id);
         continue;
       }
@@ -228,7 +233,7 @@ bool ConfigServer::Listen() {
         pd.type = "bool";
         dynamic_reconfigure::BoolParameter tmp;
         tmp.name = id;
-        tmp.value = bools_[id];
+        tmp.value = value;
         description_.min.bools.push_back(tmp);
         description_.max.bools.push_back(tmp);
         description_.dflt.bools.push_back(tmp);
@@ -253,15 +258,17 @@ bool ConfigServer::Listen() {
         }
       }
       // Grab the persistent value from the parameter server
-      nh_.getParam(id, bools_[id]);
-      nh_.setParam(id, bools_[id]);
+      nh_.getParam(id, value);
+      nh_.setParam(id, value);
+      bools_[id].Store(value);
       // *** DOUBLES *** //
     } else if (!type.compare("double")) {
       if (doubles_.find(id) != doubles_.end()) {
         ROS_ERROR_STREAM("Double variable " << id << " already declared. Ignoring.");
         continue;
       }
-      if (!group.GetReal("default", &doubles_[id])) {
+      double value;
+      if (!group.GetReal("default", &value)) {
         ROS_ERROR_STREAM("Could not get the default value for parameter " << id);
         continue;
       }
@@ -277,7 +284,7 @@ bool ConfigServer::Listen() {
           ROS_WARN_STREAM("Could not get the max value for parameter " << id);
         description_.max.doubles.push_back(tmp);
         tmp.name = id;
-        tmp.value = doubles_[id];
+        tmp.value = value;
         description_.dflt.doubles.push_back(tmp);
         description_.groups[0].parameters.push_back(pd);
         config_reader::ConfigReader::Table values;
@@ -299,8 +306,9 @@ bool ConfigServer::Listen() {
           }
         }
       }
-      nh_.getParam(id, doubles_[id]);
-      nh_.setParam(id, doubles_[id]);
+      nh_.getParam(id, value);
+      nh_.setParam(id, value);
+      doubles_[id].Store(value);
     } else {
       ROS_ERROR_STREAM("Could not understand type " << type << " of parameter " << id);
       continue;
@@ -378,25 +386,25 @@ dynamic_reconfigure::Config ConfigServer::UpdateValues() {
     if (it->type == "bool") {
       dynamic_reconfigure::BoolParameter dp;
       dp.name = it->name;
-      dp.value = bools_[it->name];
+      dp.value = bools_[it->name].Load();
       config.bools.push_back(dp);
     }
     if (it->type == "int") {
       dynamic_reconfigure::IntParameter dp;
       dp.name = it->name;
-      dp.value = ints_[it->name];
+      dp.value = ints_[it->name].Load();
       config.ints.push_back(dp);;
     }
     if (it->type == "str") {
       dynamic_reconfigure::StrParameter dp;
       dp.name = it->name;
-      dp.value = strs_[it->name];
+      dp.value = strs_[it->name].Load();
       config.strs.push_back(dp);
     }
     if (it->type == "double") {
       dynamic_reconfigure::DoubleParameter dp;
       dp.name = it->name;
-      dp.value = doubles_[it->name];
+      dp.value = doubles_[it->name].Load();
       config.doubles.push_back(dp);
     }
   }
@@ -412,6 +420,12 @@ bool ConfigServer::Get(const std::string &name, T &value) {
   return false;
 }
 
+template<typename T>
+bool ConfigServer::Resolve(const std::string &name, ConfigParam<T> &param) {
+  ROS_WARN_STREAM("Invalid parameter type");
+  return false;
+}
+
 template<typename T>
 bool ConfigServer::Set(const std::string &name, const T &value) {
   ROS_WARN_STREAM("Invalid parameter type");
@@ -428,22 +442,35 @@ bool ConfigServer::Lim(const std::string &name, const std::map<T, std::string> &
 
 template<>
 bool ConfigServer::Get<bool>(const std::string &name, bool &value) {
-  if (bools_.find(name) == bools_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<bool>>::const_iterator it = bools_.find(name);
+  if (it == bools_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  value = bools_[name];
+  value = it->second.Load();
+  return true;
+}
+
+template<>
+bool ConfigServer::Resolve<bool>(const std::string &name, ConfigParam<bool> &param) {
+  std::map<std::string, ConfigSlot<bool>>::const_iterator it = bools_.find(name);
+  if (it == bools_.end() || !listening_) {
+    ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
+    return false;
+  }
+  param = ConfigParam<bool>(&it->second);
   return true;
 }
 
 template<>
 bool ConfigServer::Set<bool>(const std::string &name, const bool &value) {
-  if (bools_.find(name) == bools_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<bool>>::iterator it = bools_.find(name);
+  if (it == bools_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  bools_[name] = value;
-  nh_.setParam(name, bools_[name]);
+  it->second.Store(value);
+  nh_.setParam(name, value);
   UpdateValues();
   return true;
 }
@@ -469,22 +496,35 @@ bool ConfigServer::Lim<bool>(const std::string &name, const std::map<bool, std::
 
 template<>
 bool ConfigServer::Get<int>(const std::string &name, int &value) {
-  if (ints_.find(name) == ints_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<int>>::const_iterator it = ints_.find(name);
+  if (it == ints_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  value = ints_[name];
+  value = it->second.Load();
+  return true;
+}
+
+template<>
+bool ConfigServer::Resolve<int>(const std::string &name, ConfigParam<int> &param) {
+  std::map<std::string, ConfigSlot<int>>::const_iterator it = ints_.find(name);
+  if (it == ints_.end() || !listening_) {
+    ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
+    return false;
+  }
+  param = ConfigParam<int>(&it->second);
   return true;
 }
 
 template<>
 bool ConfigServer::Set<int>(const std::string &name, const int &value) {
-  if (ints_.find(name) == ints_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<int>>::iterator it = ints_.find(name);
+  if (it == ints_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  ints_[name] = value;
-  nh_.setParam(name, ints_[name]);
+  it->second.Store(value);
+  nh_.setParam(name, value);
   UpdateValues();
   return true;
 }
@@ -510,22 +550,35 @@ bool ConfigServer::Lim<int>(const std::string &name, const std::map<int, std::st
 
 template<>
 bool ConfigServer::Get<double>(const std::string &name, double &value) {
-  if (doubles_.find(name) == doubles_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<double>>::const_iterator it = doubles_.find(name);
+  if (it == doubles_.end() || !listening_) {
+    ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
+    return false;
+  }
+  value = it->second.Load();
+  return true;
+}
+
+template<>
+bool ConfigServer::Resolve<double>(const std::string &name, ConfigParam<double> &param) {
+  std::map<std::string, ConfigSlot<double>>::const_iterator it = doubles_.find(name);
+  if (it == doubles_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  value = doubles_[name];
+  param = ConfigParam<double>(&it->second);
   return true;
 }
 
 template<>
 bool ConfigServer::Set<double>(const std::string &name, const double &value) {
-  if (doubles_.find(name) == doubles_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<double>>::iterator it = doubles_.find(name);
+  if (it == doubles_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  doubles_[name] = value;
-  nh_.setParam(name, doubles_[name]);
+  it->second.Store(value);
+  nh_.setParam(name, value);
   UpdateValues();
   return true;
 }
@@ -551,22 +604,35 @@ bool ConfigServer::Lim<double>(const std::string &name, const std::map<double, s
 
 template<>
 bool ConfigServer::Get<std::string>(const std::string &name, std::string &value) {
-  if (strs_.find(name) == strs_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<std::string>>::const_iterator it = strs_.find(name);
+  if (it == strs_.end() || !listening_) {
+    ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
+    return false;
+  }
+  value = it->second.Load();
+  return true;
+}
+
+template<>
+bool ConfigServer::Resolve<std::string>(const std::string &name, ConfigParam<std::string> &param) {
+  std::map<std::string, ConfigSlot<std::string>>::const_iterator it = strs_.find(name);
+  if (it == strs_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  value = strs_[name];
+  param = ConfigParam<std::string>(&it->second);
   return true;
 }
 
 template<>
 bool ConfigServer::Set<std::string>(const std::string &name, const std::string &value) {
-  if (strs_.find(name) == strs_.end() || !listening_) {
+  std::map<std::string, ConfigSlot<std::string>>::iterator it = strs_.find(name);
+  if (it == strs_.end() || !listening_) {
     ROS_WARN_STREAM("ConfigServer is not listening or parameter " << name << " does not exist");
     return false;
   }
-  strs_[name] = value;
-  nh_.setParam(name, strs_[name]);
+  it->second.Store(value);
+  nh_.setParam(name, value);
   UpdateValues();
   return true;
 }
@@ -592,24 +658,24 @@ bool ConfigServer::Lim<std::string>(const std::string &name, const std::map<std:
 std::vector<diagnostic_msgs::KeyValue> ConfigServer::Dump() {
   std::vector<diagnostic_msgs::KeyValue> keyval;
   diagnostic_msgs::KeyValue kv;
-  for (std::map<std::string, int>::iterator it = ints_.begin(); it != ints_.end(); it++) {
+  for (std::map<std::string, ConfigSlot<int>>::const_iterator it = ints_.begin(); it != ints_.end(); it++) {
     kv.key = it->first;
-    kv.value = std::to_string(it->second);
+    kv.value = std::to_string(it->second.Load());
     keyval.push_back(kv);
   }
-  for (std::map<std::string, double>::iterator it = doubles_.begin(); it != doubles_.end(); it++) {
+  for (std::map<std::string, ConfigSlot<double>>::const_iterator it = doubles_.begin(); it != doubles_.end(); it++) {
     kv.key = it->first;
-    kv.value = std::to_string(it->second);
+    kv.value = std::to_string(it->second.Load());
     keyval.push_back(kv);
   }
-  for (std::map<std::string, bool>::iterator it = bools_.begin(); it != bools_.end(); it++) {
+  for (std::map<std::string, ConfigSlot<bool>>::const_iterator it = bools_.begin(); it != bools_.end(); it++) {
     kv.key = it->first;
-    kv.value = (it->second ? "TRUE" : "FALSE");
+    kv.value = (it->second.Load() ? "TRUE" : "FALSE");
     keyval.push_back(kv);
   }
-  for (std::map<std::string, std::string>::iterator it = strs_.begin(); it != strs_.end(); it++) {
+  for (std::map<std::string, ConfigSlot<std::string>>::const_iterator it = strs_.begin(); it != strs_.end(); it++) {
     kv.key = it->first;
-    kv.value = it->second;
+    kv.value = it->second.Load();
     keyval.push_back(kv);
   }
   return keyval;
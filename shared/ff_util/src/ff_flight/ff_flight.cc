@@ -23,6 +23,7 @@
 #include <msg_conversions/msg_conversions.h>
 
 // STL includes
+#include <cmath>
 #include <fstream>
 #include <string>
 
@@ -38,6 +39,20 @@ namespace ff_util {
   // MODELLING AND SECOND ORDER KINEMATIC MODEL FOR A 6DoF RIGID BODY //
   //////////////////////////////////////////////////////////////////////
 
+  // Magnitude of a vector message, as State::VectorMagnitude
+  static inline double Magnitude(geometry_msgs::Vector3 const& vec) {
+    return sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z);
+  }
+
+  // Multiply a quaternion [x y z w] by the strapdown matrix State::Omega(vec)
+  static inline void OmegaProduct(const double vec[3], const double q[4],
+    double out[4]) {
+    out[0] =  vec[2] * q[1] - vec[1] * q[2] + vec[0] * q[3];
+    out[1] = -vec[2] * q[0] + vec[0] * q[2] + vec[1] * q[3];
+    out[2] =  vec[1] * q[0] - vec[0] * q[1] + vec[2] * q[3];
+    out[3] = -vec[0] * q[0] - vec[1] * q[1] - vec[2] * q[2];
+  }
+
   State::State() {}
 
   State::State(Setpoint const& msg) {
@@ -169,6 +184,24 @@ namespace ff_util {
     return iv.norm();
   }
 
+  // Fill the view from a segment, reusing the existing storage
+  void SegmentView::Assign(Segment const& segment) {
+    size_t size = segment.size();
+    t.resize(size);
+    w.resize(size);
+    v.resize(size);
+    b.resize(size);
+    a.resize(size);
+    for (size_t i = 0; i < size; i++) {
+      Setpoint const& sp = segment[i];
+      t[i] = sp.when.toSec();
+      w[i] = Magnitude(sp.twist.angular);
+      v[i] = Magnitude(sp.twist.linear);
+      b[i] = Magnitude(sp.accel.angular);
+      a[i] = Magnitude(sp.accel.linear);
+    }
+  }
+
   /////////////////////////////////////////////////////////////////////
   // FLIGHT UTILITIES SHARED BETWEEN THE PLANNING AND GNC SUBSYSTEMS //
   /////////////////////////////////////////////////////////////////////
@@ -400,6 +433,147 @@ namespace ff_util {
     return SUCCESS;
   }
 
+  // Batch check, making the same checks in the same order as Check
+  SegmentResult FlightUtil::Check(SegmentCheckMask mask,
+    Segment const& segment, ff_msgs::FlightMode const& flight_mode,
+    bool faceforward, SegmentView & scratch) {
+    if (segment.size() < 2)
+      return ERROR_MINIMUM_NUM_SETPOINTS;
+    scratch.Assign(segment);
+    // The limits do not change along the segment
+    double divider = 0;
+    if (!faceforward && flight_mode.hard_divider > 0)
+      divider = flight_mode.hard_divider;
+    const double limit_omega = flight_mode.hard_limit_omega;
+    const double limit_vel = flight_mode.hard_limit_vel;
+    const double limit_alpha = flight_mode.hard_limit_alpha / divider;
+    const double limit_accel = flight_mode.hard_limit_accel / divider;
+    const size_t last = scratch.Size() - 1;
+    for (size_t i = 0; i < last; i++) {
+      if ((mask & CHECK_LIMITS_OMEGA)
+        && ValidateUpperLimit(limit_omega, scratch.w[i]) < 0)
+        return ERROR_LIMITS_OMEGA;
+      if ((mask & CHECK_LIMITS_VEL)
+        && ValidateUpperLimit(limit_vel, scratch.v[i]) < 0)
+        return ERROR_LIMITS_VEL;
+      if ((mask & CHECK_LIMITS_ALPHA)
+        && ValidateUpperLimit(limit_alpha, scratch.b[i]) < 0)
+        return ERROR_LIMITS_ALPHA;
+      if ((mask & CHECK_LIMITS_ACCEL)
+        && ValidateUpperLimit(limit_accel, scratch.a[i]) < 0)
+        return ERROR_LIMITS_ACCEL;
+      double dt = scratch.t[i + 1] - scratch.t[i];
+      if (dt < -EPSILON)
+        return ERROR_TIME_RUNS_BACKWARDS;
+      if (dt - MIN_CONTROL_RATE > EPSILON)
+        return ERROR_MINIMUM_FREQUENCY;
+    }
+    if (mask & CHECK_STATIONARY_ENDPOINT) {
+      if (scratch.w[last] == 0 || scratch.v[last] == 0
+       || scratch.a[last] == 0 || scratch.b[last] == 0)
+        return ERROR_STATIONARY_ENDPOINT;
+    }
+    return SUCCESS;
+  }
+
+  // Batch resample. The number of setpoints in each interval is found first by
+  // stepping the time exactly as State::Propagate does, so that the output is
+  // sized once. The quaternion is then propagated with the closed form of the
+  // matrix exponential, as Omega(x)^2 = -|x|^2 I.
+  SegmentResult FlightUtil::Resample(Segment const& in, Segment & out,
+    double rate, SegmentView & scratch) {
+    if (in.size() < 2)
+      return ERROR_MINIMUM_NUM_SETPOINTS;
+    if (rate < MIN_CONTROL_RATE) rate = MIN_CONTROL_RATE;
+    // Count the setpoints
+    const size_t intervals = in.size() - 1;
+    scratch.n.resize(intervals);
+    size_t total = 1;
+    for (size_t i = 0; i < intervals; i++) {
+      double t = in[i].when.toSec();
+      double next = in[i + 1].when.toSec();
+      size_t n = 0;
+      do {
+        n++;
+        t = t + rate;
+      } while (t < next);
+      scratch.n[i] = n;
+      total += n;
+    }
+    out.resize(total);
+    // Propagate each interval in place
+    const double dt = rate;
+    const double dt3 = dt * dt * dt / 48.0;
+    size_t k = 0;
+    for (size_t i = 0; i < intervals; i++) {
+      Setpoint const& sp = in[i];
+      double t = sp.when.toSec();
+      double q[4] = {sp.pose.orientation.x, sp.pose.orientation.y,
+        sp.pose.orientation.z, sp.pose.orientation.w};
+      double p[3] = {sp.pose.position.x, sp.pose.position.y,
+        sp.pose.position.z};
+      double w[3] = {sp.twist.angular.x, sp.twist.angular.y,
+        sp.twist.angular.z};
+      double v[3] = {sp.twist.linear.x, sp.twist.linear.y, sp.twist.linear.z};
+      const double b[3] = {sp.accel.angular.x, sp.accel.angular.y,
+        sp.accel.angular.z};
+      const double a[3] = {sp.accel.linear.x, sp.accel.linear.y,
+        sp.accel.linear.z};
+      const bool alpha = (b[0] != 0 || b[1] != 0 || b[2] != 0);
+      for (size_t j = 0; j < scratch.n[i]; j++, k++) {
+        Setpoint & o = out[k];
+        o.when = ros::Time(t);
+        o.pose.orientation.x = q[0];
+        o.pose.orientation.y = q[1];
+        o.pose.orientation.z = q[2];
+        o.pose.orientation.w = q[3];
+        o.pose.position.x = p[0];
+        o.pose.position.y = p[1];
+        o.pose.position.z = p[2];
+        o.twist.angular.x = w[0];
+        o.twist.angular.y = w[1];
+        o.twist.angular.z = w[2];
+        o.twist.linear.x = v[0];
+        o.twist.linear.y = v[1];
+        o.twist.linear.z = v[2];
+        o.accel.angular = sp.accel.angular;
+        o.accel.linear = sp.accel.linear;
+        // exp(0.5 dt Omega(x)) q = cos(h) q + sin(h) / h * 0.5 dt Omega(x) q,
+        // where x = w + 0.5 b dt and h = 0.5 dt |x|
+        double x[3], r[4];
+        for (int d = 0; d < 3; d++)
+          x[d] = w[d] + 0.5 * b[d] * dt;
+        double h = 0.5 * dt * sqrt(x[0] * x[0] + x[1] * x[1] + x[2] * x[2]);
+        double gain = (h > 0 ? sin(h) / h : 1.0) * 0.5 * dt;
+        double cos_h = cos(h);
+        OmegaProduct(x, q, r);
+        for (int d = 0; d < 4; d++)
+          r[d] = cos_h * q[d] + gain * r[d];
+        // Add the commutator term dt^3 / 48 (Omega(b) Omega(w) - Omega(w) Omega(b)) q
+        if (alpha) {
+          double wq[4], bwq[4], bq[4], wbq[4];
+          OmegaProduct(w, q, wq);
+          OmegaProduct(b, wq, bwq);
+          OmegaProduct(b, q, bq);
+          OmegaProduct(w, bq, wbq);
+          for (int d = 0; d < 4; d++)
+            r[d] += dt3 * (bwq[d] - wbq[d]);
+        }
+        for (int d = 0; d < 4; d++)
+          q[d] = r[d];
+        for (int d = 0; d < 3; d++) {
+          p[d] = p[d] + (v[d] + 0.5 * a[d] * dt) * dt;
+          w[d] = w[d] + b[d] * dt;
+          v[d] = v[d] + a[d] * dt;
+        }
+        t = t + dt;
+      }
+    }
+    // The final setpoint is copied through State, as in Resample
+    out[k] = State(in.back()).ToSetpoint();
+    return SUCCESS;
+  }
+
   // Print a human-readable description of the error code
   std::string FlightUtil::GetDescription(SegmentResult result) {
     switch (result) {
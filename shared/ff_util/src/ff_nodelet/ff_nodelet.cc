@@ -18,6 +18,7 @@
 
 
 #include <ff_util/ff_nodelet.h>
+#include <ff_util/ff_publisher.h>
 
 #include <boost/filesystem.hpp>
 
@@ -26,6 +27,11 @@
 #include <diagnostic_msgs/DiagnosticStatus.h>
 #include <diagnostic_msgs/DiagnosticArray.h>
 
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 #include <cstdint>
 #include <string>
 
@@ -38,6 +44,7 @@ FreeFlyerNodelet::FreeFlyerNodelet(std::string const& node, bool autostart_hb_ti
   autostart_hb_timer_(autostart_hb_timer),
   initialized_(false),
   sleeping_(false),
+  sched_enabled_(false),
   node_(node) {
 }
 
@@ -45,10 +52,13 @@ FreeFlyerNodelet::FreeFlyerNodelet(bool autostart_hb_timer) :
   nodelet::Nodelet(),
   autostart_hb_timer_(autostart_hb_timer),
   initialized_(false),
+  sleeping_(false),
+  sched_enabled_(false),
   node_("") {
 }
 
 FreeFlyerNodelet::~FreeFlyerNodelet() {
+  rt_queue_.Stop();
 }
 
 void FreeFlyerNodelet::Setup(ros::NodeHandle nh) {
@@ -69,9 +79,19 @@ void FreeFlyerNodelet::Setup(ros::NodeHandle nh) {
       &FreeFlyerNodelet::HeartbeatCallback, this, false, false);
   }
 
+  // Report the publisher audit even when nothing is published through a FreeFlyerPublisher, so
+  // that the topics advertised with a raw ros::Publisher are listed. The report is rate limited,
+  // so it does not matter that every nodelet in the manager has this timer.
+  if (PublisherAudit::Enabled())
+    timer_audit_ = nh_.createWallTimer(ros::WallDuration(1.0),
+      &FreeFlyerNodelet::AuditCallback, this);
+
   // Read in faults for this node
   fault_config_.AddFile("faults.config");
   ReadFaults();
+
+  // Read in the scheduling policy for this node
+  ReadScheduling();
 }
 
 void FreeFlyerNodelet::onInit() {
@@ -152,6 +172,105 @@ void FreeFlyerNodelet::ReadFaults() {
   return;
 }
 
+void FreeFlyerNodelet::ReadScheduling() {
+  // The config is only needed once, so don't keep the interpreter around
+  config_reader::ConfigReader config;
+  config.AddFile("scheduling.config");
+  if (!config.ReadFiles()) {
+    FF_ERROR(node_ << ": Couldn't open scheduling.config!");
+    return;
+  }
+  config_reader::ConfigReader::Table scheduling;
+  if (!config.GetTable("scheduling", &scheduling))
+    return;
+  // Nodes without an entry keep the default scheduling
+  if (!scheduling.CheckValExists(node_.c_str()))
+    return;
+  config_reader::ConfigReader::Table policy(&scheduling, node_.c_str());
+  if (policy.CheckValExists("priority") &&
+      !policy.GetInt("priority", &sched_policy_.priority, 0, 99))
+    FF_ERROR(node_ << ": Scheduling priority must be between 0 and 99.");
+  if (policy.CheckValExists("lock_memory"))
+    policy.GetBool("lock_memory", &sched_policy_.lock_memory);
+  if (policy.CheckValExists("cpus")) {
+    config_reader::ConfigReader::Table cpus(&policy, "cpus");
+    for (int i = 1; i < (cpus.GetSize() + 1); i++) {
+      int cpu;
+      if (cpus.GetInt(i, &cpu, 0, CPU_SETSIZE - 1))
+        sched_policy_.cpus.push_back(cpu);
+    }
+  }
+  sched_enabled_ = true;
+  // Memory is locked for the whole process, so do it once while the node is
+  // loaded rather than from the threads that run its work
+  if (sched_policy_.lock_memory) {
+    std::string error = LockProcessMemory();
+    if (!error.empty())
+      FF_WARN(node_ << ": Scheduling " << error);
+  }
+}
+
+bool FreeFlyerNodelet::ApplyScheduling() {
+  if (!sched_enabled_)
+    return true;
+  std::string error = ApplyThreadPolicy(sched_policy_);
+  if (!error.empty())
+    FF_WARN(node_ << ": Scheduling " << error);
+  // Report what was achieved, rather than what was asked for. Only threads
+  // registered by the node are reported, so that the cpu monitor never
+  // charges a shared worker thread to this node.
+  ReportThread(false);
+  return error.empty();
+}
+
+ros::NodeHandle* FreeFlyerNodelet::GetRealtimeHandle() {
+  std::call_once(rt_once_, [this]() {
+    nh_rt_ = rt_queue_.Handle(nh_);
+    rt_queue_.Start([this]() {
+      RegisterThread();
+      ApplyScheduling();
+    });
+  });
+  return &nh_rt_;
+}
+
+void FreeFlyerNodelet::RegisterThread() {
+  // The kernel rejects names longer than 15 characters
+  pthread_setname_np(pthread_self(), node_.substr(0, 15).c_str());
+  ReportThread(true);
+}
+
+void FreeFlyerNodelet::ReportThread(bool add) {
+  ff_msgs::ThreadScheduling ts;
+  sched_param param;
+  ts.tid = syscall(SYS_gettid);
+  int policy;
+  if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+    switch (policy) {
+    case SCHED_FIFO: ts.policy = "SCHED_FIFO"; break;
+    case SCHED_RR:   ts.policy = "SCHED_RR";   break;
+    default:         ts.policy = "SCHED_OTHER"; break;
+    }
+    ts.priority = param.sched_priority;
+  }
+  cpu_set_t set;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+      if (CPU_ISSET(cpu, &set))
+        ts.cpus.push_back(cpu);
+  }
+  ts.memory_locked = ProcessMemoryLocked();
+  std::lock_guard<std::mutex> lock(mutex_threads_);
+  for (auto & thread : threads_) {
+    if (thread.tid == ts.tid) {
+      thread = ts;
+      return;
+    }
+  }
+  if (add)
+    threads_.push_back(ts);
+}
+
 void FreeFlyerNodelet::AssertFault(std::string const& key,
                                    std::string const& message,
                                    ros::Time time_fault_occurred) {
@@ -234,6 +353,10 @@ void FreeFlyerNodelet::HeartbeatCallback(ros::TimerEvent const& ev) {
   PublishHeartbeat();
 }
 
+void FreeFlyerNodelet::AuditCallback(ros::WallTimerEvent const& ev) {
+  PublisherAudit::Report();
+}
+
 void FreeFlyerNodelet::InitCallback(ros::TimerEvent const& ev) {
   // Return a single threaded nodehandle by default
   initialized_ = false;
@@ -297,6 +420,10 @@ bool FreeFlyerNodelet::TriggerCallback(ff_msgs::Trigger::Request &req, ff_msgs::
 void FreeFlyerNodelet::PublishHeartbeat() {
   if (initialized_) {
     heartbeat_.header.stamp = ros::Time::now();
+    {
+      std::lock_guard<std::mutex> lock(mutex_threads_);
+      heartbeat_.threads = threads_;
+    }
     pub_heartbeat_.publish(heartbeat_);
   }
 }
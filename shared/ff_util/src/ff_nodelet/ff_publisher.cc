@@ -0,0 +1,122 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ff_util/ff_publisher.h>
+
+#include <cstdlib>
+#include <map>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ff_util {
+
+namespace {
+
+// The audit is only a diagnostic, so a lock per publish is acceptable
+std::mutex audit_mutex_;
+std::map<std::string, PublisherAudit::Counts> audit_counts_;
+std::set<std::string> audit_advertised_;
+std::set<std::string> audit_raw_warned_;
+ros::WallTime audit_reported_;
+
+constexpr double kAuditPeriod = 10.0;
+
+// Topics advertised in this process without a FreeFlyerPublisher, with the audit mutex held
+std::vector<std::string> RawTopicsLocked() {
+  ros::V_string advertised;
+  ros::this_node::getAdvertisedTopics(advertised);
+  std::vector<std::string> raw;
+  for (auto const& topic : advertised)
+    if (audit_advertised_.find(topic) == audit_advertised_.end())
+      raw.push_back(topic);
+  return raw;
+}
+
+// Log the summary if the period elapsed, with the audit mutex held
+void ReportLocked() {
+  ros::WallTime now = ros::WallTime::now();
+  if (audit_reported_.isZero())
+    audit_reported_ = now;
+  if ((now - audit_reported_).toSec() < kAuditPeriod)
+    return;
+  audit_reported_ = now;
+  for (auto const& it : audit_counts_)
+    ROS_INFO_STREAM("Publisher audit: " << it.first
+      << " shared " << it.second.shared_msgs << " msgs (" << it.second.shared_bytes << " bytes),"
+      << " copied " << it.second.copied_msgs << " msgs (" << it.second.copied_bytes << " bytes)");
+  std::string raw;
+  for (auto const& topic : RawTopicsLocked()) {
+    if (audit_raw_warned_.insert(topic).second)
+      ROS_WARN_STREAM("Publisher audit: " << topic << " is advertised with a raw ros::Publisher, "
+        << "so it is not audited, and any message it publishes by value is copied");
+    raw += (raw.empty() ? "" : ", ") + topic;
+  }
+  if (!raw.empty())
+    ROS_INFO_STREAM("Publisher audit: raw publishers " << raw);
+}
+
+}  // namespace
+
+bool PublisherAudit::Enabled() {
+  static const bool enabled = (std::getenv("FF_PUBLISHER_AUDIT") != nullptr);
+  return enabled;
+}
+
+void PublisherAudit::Advertise(std::string const& topic) {
+  std::lock_guard<std::mutex> lock(audit_mutex_);
+  audit_advertised_.insert(topic);
+}
+
+void PublisherAudit::Add(std::string const& topic, bool shared, uint64_t bytes) {
+  std::lock_guard<std::mutex> lock(audit_mutex_);
+  Counts & counts = audit_counts_[topic];
+  if (shared) {
+    counts.shared_msgs++;
+    counts.shared_bytes += bytes;
+  } else {
+    if (counts.copied_msgs == 0)
+      ROS_WARN_STREAM("Publisher audit: " << topic << " is published by value, which copies "
+        << bytes << " bytes for each subscriber");
+    counts.copied_msgs++;
+    counts.copied_bytes += bytes;
+  }
+  // Report the totals periodically, from whichever thread happens to publish
+  ReportLocked();
+}
+
+PublisherAudit::Counts PublisherAudit::Get(std::string const& topic) {
+  std::lock_guard<std::mutex> lock(audit_mutex_);
+  auto it = audit_counts_.find(topic);
+  if (it == audit_counts_.end())
+    return Counts();
+  return it->second;
+}
+
+std::vector<std::string> PublisherAudit::RawTopics() {
+  std::lock_guard<std::mutex> lock(audit_mutex_);
+  return RawTopicsLocked();
+}
+
+void PublisherAudit::Report() {
+  std::lock_guard<std::mutex> lock(audit_mutex_);
+  ReportLocked();
+}
+
+}  // namespace ff_util
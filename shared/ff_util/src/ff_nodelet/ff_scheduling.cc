@@ -0,0 +1,102 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ff_util/ff_scheduling.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <string>
+
+namespace ff_util {
+
+// Memory locking applies to the whole process, so it is shared by all nodes
+static std::once_flag memory_lock_once_;
+static std::atomic<bool> memory_locked_(false);
+static std::string memory_lock_error_;
+
+std::string ApplyThreadPolicy(SchedulingPolicy const& policy) {
+  std::string error;
+  if (!policy.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : policy.cpus)
+      CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0)
+      error = std::string("could not set affinity: ") + strerror(err);
+  }
+  sched_param param;
+  param.sched_priority = policy.priority;
+  int err = pthread_setschedparam(pthread_self(),
+    (policy.priority > 0 ? SCHED_FIFO : SCHED_OTHER), &param);
+  if (err != 0)
+    error += (error.empty() ? "" : ", ") + std::string("could not set priority ")
+      + std::to_string(policy.priority) + ": " + strerror(err);
+  return error;
+}
+
+std::string LockProcessMemory() {
+  std::call_once(memory_lock_once_, []() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+      memory_locked_ = true;
+    else
+      memory_lock_error_ = std::string("could not lock memory: ") + strerror(errno);
+  });
+  return memory_lock_error_;
+}
+
+bool ProcessMemoryLocked() {
+  return memory_locked_;
+}
+
+DedicatedQueue::DedicatedQueue() : running_(false) {}
+
+DedicatedQueue::~DedicatedQueue() {
+  Stop();
+}
+
+void DedicatedQueue::Start(std::function<void()> init) {
+  if (thread_.joinable())
+    return;
+  running_ = true;
+  thread_ = std::thread([this, init]() {
+    if (init)
+      init();
+    while (running_)
+      queue_.callAvailable(ros::WallDuration(0.1));
+  });
+}
+
+void DedicatedQueue::Stop() {
+  running_ = false;
+  if (thread_.joinable())
+    thread_.join();
+}
+
+ros::NodeHandle DedicatedQueue::Handle(ros::NodeHandle const& nh) {
+  ros::NodeHandle handle(nh);
+  handle.setCallbackQueue(&queue_);
+  return handle;
+}
+
+}  // namespace ff_util
@@ -0,0 +1,84 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ff_util/ff_serialization.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+
+namespace ff_util {
+
+MappedFile::MappedFile(std::string const& file_name) : data_(nullptr), size_(0) {
+  int fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      data_ = static_cast<uint8_t*>(data);
+      size_ = st.st_size;
+    }
+  }
+  // The mapping stays valid once the descriptor is closed
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr)
+    munmap(data_, size_);
+}
+
+bool Serialization::WriteBuffer(std::string const& file_name, uint8_t const* data, size_t size) {
+  std::string tmp_name = file_name + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    return false;
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = write(fd, data + written, size - written);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      break;
+    written += n;
+  }
+  // The contents must be on disk before the rename makes them visible
+  bool ok = (written == size && fsync(fd) == 0);
+  ok = (close(fd) == 0) && ok;
+  if (!ok || rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    unlink(tmp_name.c_str());
+    return false;
+  }
+  // Sync the directory as well, so the rename itself survives a power loss
+  size_t slash = file_name.rfind('/');
+  std::string dir_name = (slash == std::string::npos) ? "." : file_name.substr(0, slash + 1);
+  int dir_fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd >= 0) {
+    fsync(dir_fd);
+    close(dir_fd);
+  }
+  return true;
+}
+
+}  // namespace ff_util
@@ -0,0 +1,197 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ff_util/serialized_store.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ff_util {
+
+namespace fs = boost::filesystem;
+
+// The index lists a file per line, as "sec nsec size mtime name"
+static const char kIndexName[] = ".index";
+
+SerializedStoreBase::SerializedStoreBase() :
+  busy_(false), stop_(false) {}
+
+SerializedStoreBase::~SerializedStoreBase() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_work_.notify_one();
+  // The writer finishes the pending writes before it stops
+  if (thread_.joinable())
+    thread_.join();
+}
+
+bool SerializedStoreBase::OpenDirectory(std::string const& directory, std::string const& extension,
+  std::vector<std::string> & unindexed) {
+  boost::system::error_code ec;
+  if (!fs::is_directory(directory, ec))
+    return false;
+  directory_ = directory;
+  extension_ = extension;
+  if (!ReadIndex())
+    index_.clear();
+  // Compare the index to the directory, which only needs its listing and the
+  // size and time of each file. The index is not rewritten here, in case the
+  // directory is read-only, but with the next versions saved.
+  std::map<std::string, Entry> listed;
+  listed.swap(index_);
+  for (fs::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->path().extension() != extension_)
+      continue;
+    std::string name = it->path().filename().string();
+    auto found = listed.find(name);
+    Entry entry;
+    if (found != listed.end() && Stat(name, entry)
+      && entry.size == found->second.size && entry.mtime == found->second.mtime)
+      index_.insert(*found);
+    else
+      unindexed.push_back(name);
+  }
+  if (!thread_.joinable())
+    thread_ = std::thread(&SerializedStoreBase::WriterThread, this);
+  return true;
+}
+
+void SerializedStoreBase::AddToIndex(std::string const& name, ros::Time const& stamp) {
+  Entry entry;
+  if (!Stat(name, entry))
+    return;
+  entry.stamp = stamp;
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_[name] = entry;
+}
+
+void SerializedStoreBase::Enqueue(ros::Time const& stamp, std::vector<uint8_t> && data) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto & pending = pending_[std::to_string(stamp.sec) + extension_];
+    pending.first = stamp;
+    pending.second = std::move(data);
+  }
+  cv_work_.notify_one();
+}
+
+void SerializedStoreBase::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_idle_.wait(lock, [this]() {
+    return !thread_.joinable() || (pending_.empty() && !busy_); });
+}
+
+std::vector<std::string> SerializedStoreBase::IndexedFiles() {
+  std::vector<std::pair<ros::Time, std::string>> files;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto const& it : index_)
+      files.emplace_back(it.second.stamp, it.first);
+  }
+  std::sort(files.rbegin(), files.rend());
+  std::vector<std::string> paths;
+  for (auto const& file : files)
+    paths.push_back(Path(file.second));
+  return paths;
+}
+
+std::string SerializedStoreBase::Path(std::string const& name) const {
+  return (fs::path(directory_) / name).string();
+}
+
+bool SerializedStoreBase::ReadIndex() {
+  std::ifstream ifs(Path(kIndexName));
+  if (!ifs.is_open())
+    return false;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    std::istringstream iss(line);
+    uint32_t sec, nsec;
+    Entry entry;
+    std::string name;
+    if (!(iss >> sec >> nsec >> entry.size >> entry.mtime >> name))
+      return false;
+    entry.stamp = ros::Time(sec, nsec);
+    index_[name] = entry;
+  }
+  return true;
+}
+
+bool SerializedStoreBase::Stat(std::string const& name, Entry & entry) const {
+  boost::system::error_code ec;
+  entry.size = fs::file_size(Path(name), ec);
+  if (ec)
+    return false;
+  entry.mtime = fs::last_write_time(Path(name), ec);
+  return !ec;
+}
+
+std::string SerializedStoreBase::FormatIndex() const {
+  std::ostringstream oss;
+  for (auto const& it : index_)
+    oss << it.second.stamp.sec << " " << it.second.stamp.nsec << " " << it.second.size
+        << " " << it.second.mtime << " " << it.first << "\n";
+  return oss.str();
+}
+
+void SerializedStoreBase::WriterThread() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_work_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+    if (pending_.empty())
+      return;
+    // Write everything saved since the last batch
+    std::map<std::string, std::pair<ros::Time, std::vector<uint8_t>>> batch;
+    batch.swap(pending_);
+    busy_ = true;
+    lock.unlock();
+    std::vector<std::pair<std::string, Entry>> written;
+    for (auto const& it : batch) {
+      Entry entry;
+      if (Serialization::WriteBuffer(Path(it.first), it.second.second.data(), it.second.second.size())
+        && Stat(it.first, entry)) {
+        entry.stamp = it.second.first;
+        written.emplace_back(it.first, entry);
+      } else {
+        ROS_ERROR_STREAM("Cannot write " << Path(it.first));
+      }
+    }
+    // The index is only updated once the files it lists are on disk
+    lock.lock();
+    for (auto const& it : written)
+      index_[it.first] = it.second;
+    std::string index = FormatIndex();
+    lock.unlock();
+    if (!Serialization::WriteBuffer(Path(kIndexName),
+      reinterpret_cast<uint8_t const*>(index.data()), index.size()))
+      ROS_ERROR_STREAM("Cannot write " << Path(kIndexName));
+    lock.lock();
+    busy_ = false;
+    cv_idle_.notify_all();
+  }
+}
+
+}  // namespace ff_util
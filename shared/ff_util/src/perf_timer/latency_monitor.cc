@@ -0,0 +1,91 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ff_util/latency_monitor.h>
+
+#include <algorithm>
+
+namespace ff_util {
+
+LatencyMonitor::LatencyMonitor() : init_(false) {}
+
+void LatencyMonitor::Initialize(ros::NodeHandle* nh, std::string const& topic,
+  std::vector<std::string> const& stages, std::vector<float> const& bin_edges) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pub_ = nh->advertise<ff_msgs::LatencyStats>(topic, 5);
+  msg_.bin_edges = bin_edges;
+  std::sort(msg_.bin_edges.begin(), msg_.bin_edges.end());
+  msg_.stages.resize(stages.size() + 1);
+  for (size_t i = 0; i < stages.size(); i++)
+    msg_.stages[i].name = stages[i];
+  msg_.stages.back().name = "total";
+  msg_.deadline = 0.0;
+  Clear();
+  init_ = true;
+}
+
+void LatencyMonitor::SetDeadline(double deadline) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  msg_.deadline = deadline;
+}
+
+void LatencyMonitor::Clear() {
+  for (auto & stage : msg_.stages) {
+    stage.count = 0;
+    stage.last = stage.min = stage.max = stage.mean = 0.0;
+    stage.histogram.assign(msg_.bin_edges.size() + 1, 0);
+  }
+  msg_.deadline_misses = 0;
+}
+
+void LatencyMonitor::AddStage(ff_msgs::LatencyStage & stage, double latency) {
+  stage.last = latency;
+  if (stage.count == 0 || latency < stage.min) stage.min = latency;
+  if (stage.count == 0 || latency > stage.max) stage.max = latency;
+  stage.count++;
+  stage.mean += (latency - stage.mean) / stage.count;
+  // The bin is the index of the first edge not below the latency
+  size_t bin = std::lower_bound(msg_.bin_edges.begin(), msg_.bin_edges.end(),
+    static_cast<float>(latency)) - msg_.bin_edges.begin();
+  stage.histogram[bin]++;
+}
+
+bool LatencyMonitor::Add(std::vector<ros::Time> const& times) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!init_ || times.size() != msg_.stages.size())
+    return true;
+  for (size_t i = 0; i + 1 < times.size(); i++)
+    AddStage(msg_.stages[i], (times[i + 1] - times[i]).toSec());
+  double total = (times.back() - times.front()).toSec();
+  AddStage(msg_.stages.back(), total);
+  if (msg_.deadline > 0.0 && total > msg_.deadline) {
+    msg_.deadline_misses++;
+    return false;
+  }
+  return true;
+}
+
+void LatencyMonitor::Send() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!init_) return;
+  msg_.header.stamp = ros::Time::now();
+  pub_.publish(msg_);
+  Clear();
+}
+
+}  // namespace ff_util
@@ -0,0 +1,153 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Required for the test cases
+#include <ros/ros.h>
+
+// Publisher interface
+#include <ff_util/ff_publisher.h>
+
+// Estimates, as published by the EKF
+#include <ff_msgs/EkfState.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Receives the messages published on a topic in this process
+class Receiver {
+ public:
+  Receiver(ros::NodeHandle *nh, std::string const& topic) {
+    sub_ = nh->subscribe(topic, 10, &Receiver::Callback, this);
+  }
+
+  // Spin until a message arrives, or the timeout expires
+  ff_msgs::EkfState::ConstPtr Wait(double timeout) {
+    ros::WallTime end = ros::WallTime::now() + ros::WallDuration(timeout);
+    while (!msg_ && ros::WallTime::now() < end) {
+      ros::spinOnce();
+      ros::WallDuration(0.01).sleep();
+    }
+    return msg_;
+  }
+
+ private:
+  void Callback(ff_msgs::EkfState::ConstPtr const& msg) {
+    msg_ = msg;
+  }
+
+  ros::Subscriber sub_;
+  ff_msgs::EkfState::ConstPtr msg_;
+};
+
+// Wait for a publisher to be connected to its subscriber
+template < class MessageType >
+bool Connect(ff_util::FreeFlyerPublisher < MessageType > const& pub, double timeout) {
+  ros::WallTime end = ros::WallTime::now() + ros::WallDuration(timeout);
+  while (pub.GetNumSubscribers() == 0 && ros::WallTime::now() < end) {
+    ros::spinOnce();
+    ros::WallDuration(0.01).sleep();
+  }
+  return pub.GetNumSubscribers() > 0;
+}
+
+// Fill an estimate with values that are checked on receipt
+void Fill(ff_msgs::EkfState & msg) {
+  msg.header.frame_id = "world";
+  msg.child_frame_id = "body";
+  msg.pose.position.x = 1.5;
+  msg.velocity.y = -0.25;
+  for (size_t i = 0; i < msg.cov_diag.size(); i++)
+    msg.cov_diag[i] = 0.01 * i;
+  msg.of_count = 12;
+}
+
+// A message published by shared pointer reaches a subscriber in the same process uncopied, and is
+// counted as shared
+TEST(ff_publisher, PublishSharedPointer) {
+  ros::NodeHandle nh;
+  ff_util::FreeFlyerPublisher < ff_msgs::EkfState > pub;
+  pub.Create(&nh, "/ff_publisher/shared", 10);
+  Receiver receiver(&nh, "/ff_publisher/shared");
+  ASSERT_TRUE(Connect(pub, 5.0));
+  ff_msgs::EkfState::Ptr msg = pub.Allocate();
+  Fill(*msg);
+  uint64_t bytes = ros::serialization::serializationLength(*msg);
+  pub.Publish(msg);
+  ff_msgs::EkfState::ConstPtr got = receiver.Wait(5.0);
+  ASSERT_TRUE(got != nullptr);
+  EXPECT_EQ(got.get(), msg.get());
+  ff_util::PublisherAudit::Counts counts = ff_util::PublisherAudit::Get(pub.GetTopic());
+  EXPECT_EQ(counts.shared_msgs, 1u);
+  EXPECT_EQ(counts.shared_bytes, bytes);
+  EXPECT_EQ(counts.copied_msgs, 0u);
+  EXPECT_EQ(counts.copied_bytes, 0u);
+}
+
+// A message published by value reaches the subscriber as a copy, and is counted as copied
+TEST(ff_publisher, PublishByValue) {
+  ros::NodeHandle nh;
+  ff_util::FreeFlyerPublisher < ff_msgs::EkfState > pub;
+  pub.Create(&nh, "/ff_publisher/copied", 10);
+  Receiver receiver(&nh, "/ff_publisher/copied");
+  ASSERT_TRUE(Connect(pub, 5.0));
+  ff_msgs::EkfState msg;
+  Fill(msg);
+  uint64_t bytes = ros::serialization::serializationLength(msg);
+  pub.Publish(msg);
+  pub.Publish(msg);
+  ff_msgs::EkfState::ConstPtr got = receiver.Wait(5.0);
+  ASSERT_TRUE(got != nullptr);
+  EXPECT_NE(got.get(), &msg);
+  EXPECT_EQ(got->child_frame_id, msg.child_frame_id);
+  EXPECT_EQ(got->pose.position.x, msg.pose.position.x);
+  EXPECT_EQ(got->velocity.y, msg.velocity.y);
+  EXPECT_EQ(got->cov_diag, msg.cov_diag);
+  EXPECT_EQ(got->of_count, msg.of_count);
+  ff_util::PublisherAudit::Counts counts = ff_util::PublisherAudit::Get(pub.GetTopic());
+  EXPECT_EQ(counts.shared_msgs, 0u);
+  EXPECT_EQ(counts.shared_bytes, 0u);
+  EXPECT_EQ(counts.copied_msgs, 2u);
+  EXPECT_EQ(counts.copied_bytes, 2 * bytes);
+}
+
+// A topic advertised with a raw ros::Publisher is reported, and those of FreeFlyerPublishers are not
+TEST(ff_publisher, RawPublisherReported) {
+  ros::NodeHandle nh;
+  ff_util::FreeFlyerPublisher < ff_msgs::EkfState > pub;
+  pub.Create(&nh, "/ff_publisher/audited", 1);
+  ros::Publisher raw = nh.advertise < ff_msgs::EkfState > ("/ff_publisher/raw", 1);
+  std::vector<std::string> topics = ff_util::PublisherAudit::RawTopics();
+  EXPECT_NE(std::find(topics.begin(), topics.end(), raw.getTopic()), topics.end());
+  EXPECT_EQ(std::find(topics.begin(), topics.end(), pub.GetTopic()), topics.end());
+  EXPECT_EQ(ff_util::PublisherAudit::Get(raw.getTopic()).copied_msgs, 0u);
+  ff_util::PublisherAudit::Report();
+}
+
+// Required for the test framework
+int main(int argc, char **argv) {
+  // The audit reads the environment once, so enable it before anything is published
+  setenv("FF_PUBLISHER_AUDIT", "1", 1);
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "ff_publisher");
+  return RUN_ALL_TESTS();
+}
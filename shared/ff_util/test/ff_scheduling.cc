@@ -0,0 +1,225 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Required for the test cases
+#include <ros/ros.h>
+
+// Scheduling interface
+#include <ff_util/ff_scheduling.h>
+
+// Estimates, as received by control
+#include <ff_msgs/EkfState.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+using ff_util::SchedulingPolicy;
+using ff_util::DedicatedQueue;
+
+// Period of the estimates, and how many are recorded
+static constexpr double kPeriod = 0.002;
+static constexpr size_t kSamples = 1000;
+
+// Priorities of the producer and of the dedicated thread, like the EKF and
+// the control nodes
+static constexpr int kProducerPriority = 80;
+static constexpr int kPriority = 79;
+
+// SCHED_FIFO needs privileges, or an rtprio limit, that a build machine may
+// not have. Try it on a scratch thread.
+static bool CanUseRealtime() {
+  bool ok = false;
+  std::thread thread([&ok]() {
+    SchedulingPolicy policy;
+    policy.priority = kPriority;
+    ok = ff_util::ApplyThreadPolicy(policy).empty();
+  });
+  thread.join();
+  return ok;
+}
+
+// Keeps every core busy with threads at the default scheduling
+class CpuLoad {
+ public:
+  CpuLoad() : running_(true) {
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 0; i < 2 * cores; i++) {
+      threads_.emplace_back([this]() {
+        volatile uint64_t count = 0;
+        while (running_)
+          count = count + 1;
+      });
+    }
+  }
+  ~CpuLoad() {
+    running_ = false;
+    for (auto & thread : threads_)
+      thread.join();
+  }
+
+ private:
+  std::atomic<bool> running_;
+  std::vector<std::thread> threads_;
+};
+
+// Records how long each estimate waits before its callback runs, and the
+// scheduling policy of the threads that ran it. The queue of the node handle
+// decides the threads.
+class Recorder {
+ public:
+  Recorder(ros::NodeHandle nh, std::string const& topic) {
+    sub_ = nh.subscribe(topic, kSamples, &Recorder::EkfCallback, this);
+  }
+
+  // Wait until all estimates are recorded
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return lateness_.size() >= kSamples; });
+  }
+
+  // Wait that 99% of the estimates stay under, in seconds
+  double Jitter() {
+    std::vector<double> sorted = lateness_;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() * 99 / 100];
+  }
+
+  std::set<int> const& Policies() {
+    return policies_;
+  }
+
+ private:
+  void EkfCallback(ff_msgs::EkfState::ConstPtr const& state) {
+    double lateness = (ros::Time::now() - state->header.stamp).toSec();
+    int policy;
+    sched_param param;
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    std::lock_guard<std::mutex> lock(mutex_);
+    lateness_.push_back(lateness);
+    policies_.insert(policy);
+    cv_.notify_all();
+  }
+
+  ros::Subscriber sub_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<double> lateness_;
+  std::set<int> policies_;
+};
+
+// Publishes estimates on two topics from a thread with the priority of the
+// EKF. Publishing within the process hands the message straight to the queue
+// of each subscriber, as between the EKF and control nodelets.
+static void Produce(ros::NodeHandle nh, bool realtime) {
+  ros::Publisher pub_dedicated = nh.advertise<ff_msgs::EkfState>("dedicated", kSamples);
+  ros::Publisher pub_workers = nh.advertise<ff_msgs::EkfState>("workers", kSamples);
+  while (ros::ok() && (pub_dedicated.getNumSubscribers() == 0
+    || pub_workers.getNumSubscribers() == 0))
+    ros::WallDuration(0.01).sleep();
+  std::thread thread([&pub_dedicated, &pub_workers, realtime]() {
+    SchedulingPolicy policy;
+    policy.priority = (realtime ? kProducerPriority : 0);
+    ff_util::ApplyThreadPolicy(policy);
+    for (size_t i = 0; i < kSamples && ros::ok(); i++) {
+      ff_msgs::EkfState::Ptr state(new ff_msgs::EkfState);
+      state->header.stamp = ros::Time::now();
+      pub_dedicated.publish(state);
+      pub_workers.publish(state);
+      ros::WallDuration(kPeriod).sleep();
+    }
+  });
+  thread.join();
+}
+
+// The worker threads of the spinner stand in for those of the nodelet manager.
+// A node with a policy must only change its own thread, never the workers.
+TEST(ff_scheduling, WorkersKeepDefaultScheduling) {
+  bool realtime = CanUseRealtime();
+  ros::NodeHandle nh;
+  ros::AsyncSpinner spinner(2);
+  spinner.start();
+  SchedulingPolicy policy;
+  policy.priority = (realtime ? kPriority : 0);
+  DedicatedQueue queue;
+  queue.Start([&policy]() {
+    ff_util::ApplyThreadPolicy(policy);
+  });
+  Recorder dedicated(queue.Handle(nh), "dedicated");
+  Recorder workers(nh, "workers");
+  Produce(nh, realtime);
+  dedicated.Wait();
+  workers.Wait();
+  EXPECT_EQ(workers.Policies(), std::set<int>({SCHED_OTHER}));
+  if (realtime) {
+    EXPECT_EQ(dedicated.Policies(), std::set<int>({SCHED_FIFO}));
+  }
+  queue.Stop();
+  spinner.stop();
+}
+
+// Under a CPU load, estimates served by the real-time thread must wait less
+// than those served by the workers
+TEST(ff_scheduling, DedicatedThreadReducesJitter) {
+  if (!CanUseRealtime()) {
+    std::cout << "SCHED_FIFO is not permitted, skipping the jitter test" << std::endl;
+    return;
+  }
+  ros::NodeHandle nh;
+  ros::AsyncSpinner spinner(2);
+  spinner.start();
+  SchedulingPolicy policy;
+  policy.priority = kPriority;
+  DedicatedQueue queue;
+  queue.Start([&policy]() {
+    ff_util::ApplyThreadPolicy(policy);
+  });
+  Recorder dedicated(queue.Handle(nh), "dedicated");
+  Recorder workers(nh, "workers");
+  {
+    CpuLoad load;
+    Produce(nh, true);
+    dedicated.Wait();
+    workers.Wait();
+  }
+  std::cout << "99th percentile wait: dedicated " << dedicated.Jitter()
+            << " s, workers " << workers.Jitter() << " s" << std::endl;
+  EXPECT_LT(dedicated.Jitter(), workers.Jitter());
+  queue.Stop();
+  spinner.stop();
+}
+
+// Required for the test framework
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "ff_scheduling");
+  return RUN_ALL_TESTS();
+}
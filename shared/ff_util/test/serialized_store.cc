@@ -0,0 +1,180 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Required for the test framework
+#include <gtest/gtest.h>
+
+// Required for the test cases
+#include <ros/ros.h>
+
+// Store interface
+#include <ff_util/serialized_store.h>
+
+// Any message with a timestamp will do
+#include <ff_msgs/SetZones.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace fs = boost::filesystem;
+
+typedef ff_util::SerializedStore<ff_msgs::SetZones::Request> Store;
+
+static ros::Time Stamp(ff_msgs::SetZones::Request const& msg) {
+  return msg.timestamp;
+}
+
+static ff_msgs::SetZones::Request Zones(uint32_t sec, size_t count) {
+  ff_msgs::SetZones::Request msg;
+  msg.timestamp = ros::Time(sec, 500);
+  msg.zones.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    msg.zones[i].name = "zone" + std::to_string(i);
+    msg.zones[i].type = ff_msgs::Zone::KEEPOUT;
+  }
+  return msg;
+}
+
+class SerializedStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() {
+    char dir[] = "/tmp/serialized_store_XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != nullptr);
+    dir_ = dir;
+  }
+
+  void TearDown() {
+    fs::remove_all(dir_);
+  }
+
+  std::string dir_;
+};
+
+TEST_F(SerializedStoreTest, LoadsNewestAfterRestart) {
+  {
+    Store store;
+    ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+    store.Save(Zones(20, 2));
+    store.Save(Zones(30, 3));
+    store.Save(Zones(10, 1));
+  }
+  EXPECT_TRUE(fs::exists(fs::path(dir_) / "30.bin"));
+  EXPECT_TRUE(fs::exists(fs::path(dir_) / ".index"));
+  Store store;
+  ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+  ff_msgs::SetZones::Request msg;
+  ASSERT_TRUE(store.LoadNewest(msg));
+  EXPECT_EQ(msg.timestamp, ros::Time(30, 500));
+  EXPECT_EQ(msg.zones.size(), 3u);
+}
+
+TEST_F(SerializedStoreTest, LastSaveOfAFileWins) {
+  Store store;
+  ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+  for (size_t i = 1; i <= 50; i++)
+    store.Save(Zones(40, i));
+  store.Flush();
+  ff_msgs::SetZones::Request msg;
+  ASSERT_TRUE(ff_util::Serialization::ReadFile((fs::path(dir_) / "40.bin").string(), msg));
+  EXPECT_EQ(msg.zones.size(), 50u);
+}
+
+TEST_F(SerializedStoreTest, RebuildsMissingOrStaleIndex) {
+  // Files written without the store, as the zone files shipped with a world
+  ASSERT_TRUE(ff_util::Serialization::WriteFile((fs::path(dir_) / "granite.bin").string(), Zones(50, 5)));
+  ASSERT_TRUE(ff_util::Serialization::WriteFile((fs::path(dir_) / "iss.bin").string(), Zones(5, 1)));
+  {
+    Store store;
+    ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+    ff_msgs::SetZones::Request msg;
+    ASSERT_TRUE(store.LoadNewest(msg));
+    EXPECT_EQ(msg.zones.size(), 5u);
+    // Opening alone leaves the directory as it was
+    store.Flush();
+    EXPECT_FALSE(fs::exists(fs::path(dir_) / ".index"));
+    store.Save(Zones(40, 4));
+  }
+  EXPECT_TRUE(fs::exists(fs::path(dir_) / ".index"));
+  // A file written after the index, as when a crash interrupts the writer
+  ASSERT_TRUE(ff_util::Serialization::WriteFile((fs::path(dir_) / "60.bin").string(), Zones(60, 6)));
+  fs::remove(fs::path(dir_) / "granite.bin");
+  {
+    Store store;
+    ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+    ff_msgs::SetZones::Request msg;
+    ASSERT_TRUE(store.LoadNewest(msg));
+    EXPECT_EQ(msg.zones.size(), 6u);
+  }
+  // Indexed files replaced behind the back of the store, one with a new size,
+  // and one with the same size, only told apart by its modification time
+  ASSERT_TRUE(ff_util::Serialization::WriteFile((fs::path(dir_) / "40.bin").string(), Zones(80, 8)));
+  {
+    Store store;
+    ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+    ff_msgs::SetZones::Request msg;
+    ASSERT_TRUE(store.LoadNewest(msg));
+    EXPECT_EQ(msg.timestamp, ros::Time(80, 500));
+    EXPECT_EQ(msg.zones.size(), 8u);
+  }
+  fs::path iss = fs::path(dir_) / "iss.bin";
+  std::time_t mtime = fs::last_write_time(iss);
+  uintmax_t size = fs::file_size(iss);
+  ASSERT_TRUE(ff_util::Serialization::WriteFile(iss.string(), Zones(90, 1)));
+  fs::last_write_time(iss, mtime + 10);
+  ASSERT_EQ(fs::file_size(iss), size);
+  Store store;
+  ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+  ff_msgs::SetZones::Request msg;
+  ASSERT_TRUE(store.LoadNewest(msg));
+  EXPECT_EQ(msg.timestamp, ros::Time(90, 500));
+}
+
+TEST_F(SerializedStoreTest, SkipsTruncatedFile) {
+  {
+    Store store;
+    ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+    store.Save(Zones(70, 7));
+    store.Save(Zones(80, 8));
+  }
+  // Corrupt the newest file behind the back of the store
+  fs::resize_file(fs::path(dir_) / "80.bin", 10);
+  Store store;
+  ASSERT_TRUE(store.Open(dir_, ".bin", &Stamp));
+  ff_msgs::SetZones::Request msg;
+  ASSERT_TRUE(store.LoadNewest(msg));
+  EXPECT_EQ(msg.zones.size(), 7u);
+}
+
+TEST_F(SerializedStoreTest, RejectsMissingDirectory) {
+  Store store;
+  EXPECT_FALSE(store.Open(dir_ + "/missing", ".bin", &Stamp));
+}
+
+// Required for the test framework
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  ros::Time::init();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ff_util/ff_flight.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <random>
+
+// Compares the batch FlightUtil::Resample and FlightUtil::Check against the
+// per setpoint versions, on random segments, and reports the time taken by each.
+// Each segment is resampled, and the resampled segment is then checked.
+//   ff_flight_benchmark [setpoints] [repetitions]
+
+typedef std::chrono::steady_clock Clock;
+
+std::mt19937 generator(0);
+
+double Random(double lo, double hi) {
+  return std::uniform_real_distribution<double>(lo, hi)(generator);
+}
+
+geometry_msgs::Vector3 RandomVector(double magnitude) {
+  geometry_msgs::Vector3 v;
+  v.x = Random(-magnitude, magnitude);
+  v.y = Random(-magnitude, magnitude);
+  v.z = Random(-magnitude, magnitude);
+  return v;
+}
+
+// A segment with setpoints spaced by up to three times the resampling period
+void GenerateSegment(size_t size, ff_util::Segment & segment) {
+  segment.resize(size);
+  double t = 1000.0;
+  for (size_t i = 0; i < size; i++) {
+    ff_util::Setpoint & sp = segment[i];
+    sp.when = ros::Time(t);
+    sp.pose.position.x = Random(-1.0, 1.0);
+    sp.pose.position.y = Random(-1.0, 1.0);
+    sp.pose.position.z = Random(-1.0, 1.0);
+    Eigen::Quaterniond q(Random(-1.0, 1.0), Random(-1.0, 1.0),
+      Random(-1.0, 1.0), Random(-1.0, 1.0));
+    q.normalize();
+    sp.pose.orientation.x = q.x();
+    sp.pose.orientation.y = q.y();
+    sp.pose.orientation.z = q.z();
+    sp.pose.orientation.w = q.w();
+    sp.twist.linear = RandomVector(0.05);
+    sp.twist.angular = RandomVector(0.1);
+    sp.accel.linear = RandomVector(0.005);
+    sp.accel.angular = RandomVector(0.01);
+    t += Random(0.1, 3.0);
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t size = (argc > 1) ? atoi(argv[1]) : 1000;
+  int repetitions = (argc > 2) ? atoi(argv[2]) : 100;
+  const double rate = 1.0;
+
+  ff_msgs::FlightMode fm;
+  fm.hard_limit_vel = 0.2;
+  fm.hard_limit_accel = 0.02;
+  fm.hard_limit_omega = 0.2;
+  fm.hard_limit_alpha = 0.02;
+  fm.hard_divider = 1.0;
+  ff_util::SegmentCheckMask mask = static_cast<ff_util::SegmentCheckMask>(
+    ff_util::CHECK_LIMITS_VEL | ff_util::CHECK_LIMITS_ACCEL
+    | ff_util::CHECK_LIMITS_OMEGA | ff_util::CHECK_LIMITS_ALPHA
+    | ff_util::CHECK_STATIONARY_ENDPOINT);
+
+  ff_util::Segment in, reference, batch;
+  ff_util::SegmentView scratch;
+  double check_time[2] = {0.0, 0.0}, resample_time[2] = {0.0, 0.0};
+  size_t resampled = 0;
+  for (int r = 0; r < repetitions; r++) {
+    GenerateSegment(size, in);
+    // Resample, reusing the output segment of the batch version
+    Clock::time_point t0 = Clock::now();
+    ff_util::FlightUtil::Resample(in, reference, rate);
+    Clock::time_point t1 = Clock::now();
+    ff_util::FlightUtil::Resample(in, batch, rate, scratch);
+    Clock::time_point t2 = Clock::now();
+    resample_time[0] += std::chrono::duration<double>(t1 - t0).count();
+    resample_time[1] += std::chrono::duration<double>(t2 - t1).count();
+    if (reference.size() != batch.size()) {
+      fprintf(stderr, "Resample produced %zu setpoints, batch resample %zu.\n",
+        reference.size(), batch.size());
+      return 1;
+    }
+    for (size_t i = 0; i < reference.size(); i++) {
+      if (reference[i].when != batch[i].when
+        || !ff_util::FlightUtil::Equal(reference[i], batch[i])) {
+        fprintf(stderr, "Resampled setpoint %zu differs.\n", i);
+        return 1;
+      }
+    }
+    // Check the resampled segment, then again with a limit broken half way
+    for (int c = 0; c < 2; c++) {
+      if (c == 1)
+        reference[reference.size() / 2].twist.linear.x = 1.0;
+      Clock::time_point t0 = Clock::now();
+      ff_util::SegmentResult a = ff_util::FlightUtil::Check(mask, reference, fm, false);
+      Clock::time_point t1 = Clock::now();
+      ff_util::SegmentResult b = ff_util::FlightUtil::Check(mask, reference, fm, false, scratch);
+      Clock::time_point t2 = Clock::now();
+      check_time[0] += std::chrono::duration<double>(t1 - t0).count();
+      check_time[1] += std::chrono::duration<double>(t2 - t1).count();
+      if (a != b) {
+        fprintf(stderr, "Check returned %s, batch check returned %s.\n",
+          ff_util::FlightUtil::GetDescription(a).c_str(),
+          ff_util::FlightUtil::GetDescription(b).c_str());
+        return 1;
+      }
+    }
+    resampled += reference.size();
+  }
+
+  printf("Resampled %d segments from %zu to %zu setpoints. Resample: %.3f us, batch: %.3f us.\n",
+    repetitions, size, resampled / repetitions, 1e6 * resample_time[0] / repetitions,
+    1e6 * resample_time[1] / repetitions);
+  printf("Checked %d segments. Check: %.3f us, batch: %.3f us.\n", 2 * repetitions,
+    1e6 * check_time[0] / (2 * repetitions), 1e6 * check_time[1] / (2 * repetitions));
+  return 0;
+}
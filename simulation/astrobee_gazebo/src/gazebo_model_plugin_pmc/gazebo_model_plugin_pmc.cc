@@ -33,11 +33,13 @@
 
 // Autocode inclide
 #include <gnc_autocode/blowers.h>
+#include <gnc_autocode/blowers_kernel.h>
 
 // Gazebo includes
 #include <astrobee_gazebo/astrobee_gazebo.h>
 
 // STL includes
+#include <memory>
 #include <string>
 
 namespace gazebo {
@@ -66,6 +68,12 @@ class GazeboModelPluginPmc : public FreeFlyerModelPlugin {
       AssertFault("INITIALIZATION_FAULT", "Could not get PMC parameters");
     }
 
+    // Either step the hand optimized blower kernel, or the autocode directly
+    if (sdf->HasElement("blower_kernel") && sdf->Get<bool>("blower_kernel"))
+      blowers_.reset(new gnc_autocode::GncBlowersKernel());
+    else
+      blowers_.reset(new gnc_autocode::GncBlowersAutocode());
+
     // Create a null command to be used later
     ff_hw_msgs::PmcGoal null_goal;
     null_goal.motor_speed = 0;
@@ -180,9 +188,9 @@ class GazeboModelPluginPmc : public FreeFlyerModelPlugin {
       return;
     // Set the impeller and nozzle values to those given in the message
     for (size_t i = 0; i < NUMBER_OF_PMCS; i++) {
-      blowers_.states_[i].impeller_cmd = msg.goals[i].motor_speed;
+      blowers_->states_[i].impeller_cmd = msg.goals[i].motor_speed;
       for (size_t j = 0; j < NUMBER_OF_NOZZLES; j++)
-        blowers_.states_[i].servo_cmd[j]
+        blowers_->states_[i].servo_cmd[j]
           = static_cast <float> (msg.goals[i].nozzle_positions[j]);
     }
     // Publish telemetry
@@ -201,15 +209,15 @@ class GazeboModelPluginPmc : public FreeFlyerModelPlugin {
     for (size_t i = 0; i < NUMBER_OF_PMCS; i++) {
       // Populate as much telemetry as possible from the blower model
       static ff_hw_msgs::PmcStatus t;
-      t.motor_speed = static_cast<uint8_t>((blowers_.states_[i].motor_speed
+      t.motor_speed = static_cast<uint8_t>((blowers_->states_[i].motor_speed
         * RADS_PER_SEC_TO_RPM) / state_telemetry_scale_);
       // Send the telemetry
       telemetry_vector_.statuses.push_back(t);
       // Determine the current state based on the different between the
       // commanded and telemetry motor speeds, scaled appropriately
       static double crps, trps;
-      crps = state_command_scale_ * blowers_.states_[i].impeller_cmd;
-      trps = blowers_.states_[i].motor_speed;   // Comes in rads/sec!
+      crps = state_command_scale_ * blowers_->states_[i].impeller_cmd;
+      trps = blowers_->states_[i].motor_speed;   // Comes in rads/sec!
       // ROS_INFO_STREAM("PMC delta C " << crps << ":: T " << trps);
       if (fabs(crps - trps) < state_tol_rads_per_sec_) {
         msg.states[i] = ff_hw_msgs::PmcState::READY;
@@ -251,20 +259,20 @@ class GazeboModelPluginPmc : public FreeFlyerModelPlugin {
     if (GetWorld()->GetSimTime() >= next_tick_) {
       next_tick_ += 1.0 / control_rate_hz_;
       // Set the angular velocity
-      blowers_.SetAngularVelocity(GetLink()->GetRelativeAngularVel().x,
+      blowers_->SetAngularVelocity(GetLink()->GetRelativeAngularVel().x,
         GetLink()->GetRelativeAngularVel().y, GetLink()->GetRelativeAngularVel().z);
       // Set the battery voltage
-      blowers_.SetBatteryVoltage(14.0);
+      blowers_->SetBatteryVoltage(14.0);
       // Step the system
-      blowers_.Step();
+      blowers_->Step();
       // Extract and apply the force and torque for the blowers
       force_ = math::Vector3(0, 0, 0);
       torque_ = math::Vector3(0, 0, 0);
       for (size_t i = 0; i < NUMBER_OF_PMCS; i++) {
-        force_ += math::Vector3(blowers_.states_[i].force_B[0],
-          blowers_.states_[i].force_B[1], blowers_.states_[i].force_B[2]);
-        torque_ += math::Vector3(blowers_.states_[i].torque_B[0],
-          blowers_.states_[i].torque_B[1], blowers_.states_[i].torque_B[2]);
+        force_ += math::Vector3(blowers_->states_[i].force_B[0],
+          blowers_->states_[i].force_B[1], blowers_->states_[i].force_B[2]);
+        torque_ += math::Vector3(blowers_->states_[i].torque_B[0],
+          blowers_->states_[i].torque_B[1], blowers_->states_[i].torque_B[2]);
       }
     }
     // Apply the force and torque to the model
@@ -280,7 +288,7 @@ class GazeboModelPluginPmc : public FreeFlyerModelPlugin {
   ros::Timer timer_;                                // Watchdog timer
   math::Vector3 force_;                             // Current body-frame force
   math::Vector3 torque_;                            // Current body-frame torque
-  gnc_autocode::GncBlowersAutocode blowers_;        // Autocode blower iface
+  std::unique_ptr<gnc_autocode::GncBlowersAutocode> blowers_;  // Blower iface
   ff_hw_msgs::PmcCommand null_command_;             // PMC null command
   event::ConnectionPtr update_;                     // Update event from gazeo
   ff_hw_msgs::PmcTelemetry telemetry_vector_;       // Telemetry
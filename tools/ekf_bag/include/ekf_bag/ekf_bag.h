@@ -21,6 +21,7 @@
 
 #include <config_reader/config_reader.h>
 #include <ekf/ekf.h>
+#include <ekf_bag/feature_cache.h>
 #include <sparse_mapping/sparse_map.h>
 #include <localization_node/localization.h>
 #include <lk_optical_flow/lk_optical_flow.h>
@@ -28,6 +29,8 @@
 #include <rosbag/bag.h>
 #include <sensor_msgs/Imu.h>
 
+#include <string>
+
 namespace ekf_bag {
 
 class EkfBag {
@@ -37,6 +40,14 @@ class EkfBag {
 
   void Run(void);
 
+  // Time spanned by the messages of the bag, in seconds
+  double Duration(void);
+
+  // If set, vision features are read from this file instead of being computed
+  // from the images. If the file does not exist or is stale, the features are
+  // computed as usual and saved to it at the end of the run.
+  void SetFeatureCache(const std::string & cache_file) {cache_file_ = cache_file;}
+
  protected:
   virtual void ReadParams(config_reader::ConfigReader* config);
 
@@ -60,8 +71,14 @@ class EkfBag {
   // most recent ground truth pose
   geometry_msgs::Pose ground_truth_;
 
+  // optional config file read after all others, to override parameters
+  std::string param_file_;
+
  private:
   void EstimateBias(void);
+  void StartOpticalFlow(const ros::Time & time);
+  void StartSparseMap(const ros::Time & time);
+  void ReplayFeatures(const CachedFeatures & f);
 
   // configuration parameters
   float sparse_map_delay_, of_delay_;
@@ -72,6 +89,12 @@ class EkfBag {
   ros::Time of_send_time_, vl_send_time_;  // time to send features
   ff_msgs::Feature2dArray of_features_;  // save to send later
   ff_msgs::VisualLandmarks vl_features_;
+
+  // features saved from or loaded for the current bag, and the parameters
+  // they depend on
+  std::string map_file_, cache_file_, vision_params_;
+  FeatureCache cache_;
+  bool recording_features_;
 };
 
 }  // end namespace ekf_bag
@@ -0,0 +1,65 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef EKF_BAG_EKF_BAG_SUMMARY_H_
+#define EKF_BAG_EKF_BAG_SUMMARY_H_
+
+#include <ekf_bag/ekf_bag.h>
+
+#include <stdio.h>
+
+namespace ekf_bag {
+
+// error metrics of a whole EKF run against ground truth
+struct EkfErrorSummary {
+  int ekf_count;       // number of EKF states
+  int compared_count;  // number of EKF states with ground truth close in time
+  int lost_count;      // number of EKF states with lost confidence
+  double position_rmse, position_max;  // meters
+  double angle_rmse, angle_max;        // radians
+};
+
+// Replays a bag and accumulates the EKF error against ground truth, without
+// writing any per state output.
+class EkfBagSummary : public EkfBag {
+ public:
+  EkfBagSummary(const char* bagfile, const char* mapfile, const char* param_file = NULL);
+  virtual ~EkfBagSummary(void) {}
+
+  EkfErrorSummary GetSummary(void) const;
+
+  // write the summary as one row of a space separated table
+  static void PrintHeader(FILE* f);
+  static void Print(FILE* f, const EkfErrorSummary & s);
+
+ protected:
+  virtual void UpdateGroundTruth(const geometry_msgs::PoseStamped & pose);
+  virtual void UpdateEKF(const ff_msgs::EkfState & state);
+
+ private:
+  bool ground_truth_set_;
+  ros::Time ground_truth_time_;
+
+  int ekf_count_, compared_count_, lost_count_;
+  double position_sq_sum_, position_max_;
+  double angle_sq_sum_, angle_max_;
+};
+
+}  // end namespace ekf_bag
+
+#endif  // EKF_BAG_EKF_BAG_SUMMARY_H_
@@ -0,0 +1,72 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef EKF_BAG_FEATURE_CACHE_H_
+#define EKF_BAG_FEATURE_CACHE_H_
+
+#include <ff_msgs/Feature2dArray.h>
+#include <ff_msgs/VisualLandmarks.h>
+#include <ros/time.h>
+
+#include <string>
+#include <vector>
+
+namespace ekf_bag {
+
+// The vision output computed from one nav cam image, and the bag time it was
+// computed at. Only one of of / vl is used, depending on the type.
+struct CachedFeatures {
+  enum Type { OPTICAL_FLOW = 0, SPARSE_MAP = 1 };
+  Type type;
+  ros::Time time;
+  ff_msgs::Feature2dArray of;
+  ff_msgs::VisualLandmarks vl;
+};
+
+// Stores the optical flow features and sparse map landmarks found while
+// replaying a bag in a binary sidecar file, so that later runs of the EKF on the
+// same bag can skip image processing entirely.
+class FeatureCache {
+ public:
+  FeatureCache(void) {}
+  ~FeatureCache(void) {}
+
+  // Describes everything other than the bag that the features depend on: the
+  // map file, and the effective values of the parameters of the vision and of
+  // the delays, as text. A cache file written with a different signature is
+  // rejected on load.
+  void SetSignature(const std::string & map_file, const std::string & params);
+
+  bool Load(const std::string & file);
+  bool Save(const std::string & file) const;
+
+  void Clear(void) {entries_.clear();}
+  void AddOpticalFlow(const ros::Time & time, const ff_msgs::Feature2dArray & of);
+  void AddSparseMap(const ros::Time & time, const ff_msgs::VisualLandmarks & vl);
+
+  size_t Size(void) const {return entries_.size();}
+  const CachedFeatures & Get(size_t index) const {return entries_[index];}
+
+ private:
+  std::string signature_;
+  std::vector<CachedFeatures> entries_;
+};
+
+}  // end namespace ekf_bag
+
+#endif  // EKF_BAG_FEATURE_CACHE_H_
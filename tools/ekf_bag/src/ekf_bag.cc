@@ -17,6 +17,7 @@
  */
 
 #include <ekf_bag/ekf_bag.h>
+#include <ekf_bag/bounded_queue.h>
 
 #include <image_transport/image_transport.h>
 #include <ff_util/ff_names.h>
@@ -26,10 +27,44 @@
 #include <Eigen/Core>
 #include <rosbag/view.h>
 
+#include <exception>
+#include <sstream>
+#include <thread>  // NOLINT
+#include <utility>
+
 namespace ekf_bag {
 
+// messages read ahead of the replay, a few seconds of imu and some images
+static const size_t kReadAhead = 256;
+
+// a message read and deserialized from the bag, waiting to be replayed
+struct BagMessage {
+  ros::Time time;
+  int progress;
+  sensor_msgs::ImageConstPtr image;
+  sensor_msgs::ImuConstPtr imu;
+  geometry_msgs::PoseStampedConstPtr truth;
+};
+
+// Stops and joins a thread filling a queue when it goes out of scope, also
+// when the consumer throws, so the thread never outlives what it reads from
+class ProducerGuard {
+ public:
+  ProducerGuard(BoundedQueue<BagMessage>* queue, std::thread* thread) :
+    queue_(queue), thread_(thread) {}
+  ~ProducerGuard(void) {
+    queue_->Close();
+    if (thread_->joinable())
+      thread_->join();
+  }
+
+ private:
+  BoundedQueue<BagMessage>* queue_;
+  std::thread* thread_;
+};
+
 EkfBag::EkfBag(const char* bagfile, const char* mapfile) :
-          map_(mapfile, true), loc_(&map_) {
+          map_(mapfile, true), loc_(&map_), map_file_(mapfile), recording_features_(false) {
   bag_.open(bagfile, rosbag::bagmode::Read);
 }
 
@@ -44,6 +79,8 @@ void EkfBag::ReadParams(config_reader::ConfigReader* config) {
   config->AddFile("geometry.config");
   config->AddFile("localization.config");
   config->AddFile("optical_flow.config");
+  if (!param_file_.empty())
+    config->AddFile(param_file_.c_str());
 
   if (!config->ReadFiles()) {
     ROS_FATAL("Failed to read config files.");
@@ -58,6 +95,30 @@ void EkfBag::ReadParams(config_reader::ConfigReader* config) {
   ekf_.ReadParams(config);
   of_.ReadParams(config);
   loc_.ReadParams(config);
+
+  // the cached features depend on the values the vision actually uses, which
+  // any config file, including param_file_, may override
+  static const char* kVisionParams[] = {
+    // read by LKOpticalFlow
+    "max_flow_magnitude", "max_lk_pyr_level", "max_lk_itr", "max_gap",
+    "win_size_width", "win_size_height", "max_feature", "detect_grid_cols",
+    "detect_grid_rows",
+    // read by Localizer
+    "num_similar", "ransac_inlier_tolerance", "ransac_iterations",
+    "min_features", "max_features", "brisk_threshold", "detection_retries"};
+  std::ostringstream params;
+  params.precision(17);
+  params << "of_delay " << of_delay_ << " sparse_map_delay " << sparse_map_delay_;
+  for (const char* name : kVisionParams) {
+    double value = 0;
+    config->GetReal(name, &value);
+    params << " " << name << " " << value;
+  }
+  camera::CameraParameters cam(config, "nav_cam");
+  params << " nav_cam " << cam.GetDistortedSize().transpose() << " "
+         << cam.GetUndistortedSize().transpose() << " " << cam.GetFocalVector().transpose()
+         << " " << cam.GetOpticalOffset().transpose() << " " << cam.GetDistortion().transpose();
+  vision_params_ = params.str();
 }
 
 void EkfBag::EstimateBias(void) {
@@ -110,32 +171,46 @@ void EkfBag::UpdateImu(const ros::Time & time, const sensor_msgs::Imu & imu) {
     UpdateEKF(state);
 }
 
+void EkfBag::StartOpticalFlow(const ros::Time & time) {
+  // send of registration
+  ff_msgs::CameraRegistration r;
+  r.header = std_msgs::Header();
+  r.header.stamp = time;
+  r.camera_id = ++of_id_;
+  ekf_.OpticalFlowRegister(r);
+  // the features were computed now, but send them later
+  of_features_.camera_id = of_id_;
+  processing_of_ = true;
+  of_send_time_ = time + ros::Duration(of_delay_);
+
+  UpdateOpticalFlow(of_features_);
+}
+
+void EkfBag::StartSparseMap(const ros::Time & time) {
+  // send registration
+  ff_msgs::CameraRegistration r;
+  r.header = std_msgs::Header();
+  r.header.stamp = time;
+  r.camera_id = ++vl_id_;
+  ekf_.SparseMapRegister(r);
+  // the landmarks were computed now, but send them later
+  vl_features_.camera_id = vl_id_;
+  processing_sparse_map_ = true;
+  vl_send_time_ = time + ros::Duration(sparse_map_delay_);
+
+  UpdateSparseMap(vl_features_);
+}
+
 void EkfBag::UpdateImage(const ros::Time & time, const sensor_msgs::ImageConstPtr & image_msg) {
   if (!processing_of_) {
-    // send of registration
-    ff_msgs::CameraRegistration r;
-    r.header = std_msgs::Header();
-    r.header.stamp = time;
-    r.camera_id = ++of_id_;
-    ekf_.OpticalFlowRegister(r);
-    // do the processing now, but send it later
     of_features_.feature_array.clear();
     of_.OpticalFlow(image_msg, &of_features_);
-    of_features_.camera_id = of_id_;
-    processing_of_ = true;
-    of_send_time_ = time + ros::Duration(of_delay_);
-
-    UpdateOpticalFlow(of_features_);
+    if (recording_features_)
+      cache_.AddOpticalFlow(time, of_features_);
+    StartOpticalFlow(time);
   }
   // now do sparse map
   if (!processing_sparse_map_) {
-    // send registration
-    ff_msgs::CameraRegistration r;
-    r.header = std_msgs::Header();
-    r.header.stamp = time;
-    r.camera_id = ++vl_id_;
-    ekf_.SparseMapRegister(r);
-    // do processing now, but send it later
     cv_bridge::CvImageConstPtr image;
     try {
       image = cv_bridge::toCvShare(image_msg, sensor_msgs::image_encodings::MONO8);
@@ -145,11 +220,21 @@ void EkfBag::UpdateImage(const ros::Time & time, const sensor_msgs::ImageConstPt
     }
     vl_features_.landmarks.clear();
     loc_.Localize(image, &vl_features_);
-    vl_features_.camera_id = vl_id_;
-    processing_sparse_map_ = true;
-    vl_send_time_ = time + ros::Duration(sparse_map_delay_);
+    if (recording_features_)
+      cache_.AddSparseMap(time, vl_features_);
+    StartSparseMap(time);
+  }
+}
 
-    UpdateSparseMap(vl_features_);
+void EkfBag::ReplayFeatures(const CachedFeatures & f) {
+  // the cache only holds images that were processed, so the ekf is idle here
+  // exactly as it was when the features were recorded
+  if (f.type == CachedFeatures::OPTICAL_FLOW && !processing_of_) {
+    of_features_ = f.of;
+    StartOpticalFlow(f.time);
+  } else if (f.type == CachedFeatures::SPARSE_MAP && !processing_sparse_map_) {
+    vl_features_ = f.vl;
+    StartSparseMap(f.time);
   }
 }
 
@@ -157,35 +242,92 @@ void EkfBag::UpdateGroundTruth(const geometry_msgs::PoseStamped & pose) {
   ground_truth_ = pose.pose;  // Cache the pose for MGTF gravity correction
 }
 
+double EkfBag::Duration(void) {
+  rosbag::View view(bag_);
+  if (view.size() == 0)
+    return 0.0;
+  return (view.getEndTime() - view.getBeginTime()).toSec();
+}
+
 void EkfBag::Run(void) {
   EstimateBias();
 
+  // replay the vision features from the cache if we have a valid one
+  bool replay = false;
+  if (!cache_file_.empty()) {
+    cache_.SetSignature(map_file_, vision_params_);
+    replay = cache_.Load(cache_file_);
+  }
+  recording_features_ = !cache_file_.empty() && !replay;
+
   std::vector<std::string> topics;
   topics.push_back(std::string("/") + TOPIC_HARDWARE_IMU);
-  topics.push_back(std::string("/") + TOPIC_HARDWARE_NAV_CAM);
+  if (!replay)
+    topics.push_back(std::string("/") + TOPIC_HARDWARE_NAV_CAM);
   topics.push_back(std::string("/") + TOPIC_LOCALIZATION_TRUTH);
   rosbag::View view(bag_, rosbag::TopicQuery(topics));
 
   processing_of_ = processing_sparse_map_ = false;
   of_id_ = vl_id_ = 0;
 
-  int progress = 0;
-  for (rosbag::MessageInstance const m : view) {
-    progress++;
-
-    if (m.isType<sensor_msgs::Image>()) {
-      sensor_msgs::ImageConstPtr image_msg = m.instantiate<sensor_msgs::Image>();
-      UpdateImage(m.getTime(), image_msg);
-      common::PrintProgressBar(stdout, static_cast<float>(progress) / view.size());
-    } else if (m.isType<sensor_msgs::Imu>()) {
-      sensor_msgs::ImuConstPtr imu_msg = m.instantiate<sensor_msgs::Imu>();
-      UpdateImu(m.getTime(), *imu_msg.get());
-    } else if (m.isType<geometry_msgs::PoseStamped>()) {
-      geometry_msgs::PoseStampedConstPtr gt_msg = m.instantiate<geometry_msgs::PoseStamped>();
-      UpdateGroundTruth(*gt_msg.get());
+  // read and deserialize the bag on a thread of its own, ahead of the replay
+  const float total = view.size();
+  BoundedQueue<BagMessage> messages(kReadAhead);
+  // an error reading the bag is thrown again here once the queue is drained
+  std::exception_ptr reader_error;
+  std::thread reader([&view, &messages, &reader_error]() {
+    try {
+      int progress = 0;
+      for (rosbag::MessageInstance const m : view) {
+        BagMessage msg;
+        msg.time = m.getTime();
+        msg.progress = ++progress;
+        if (m.isType<sensor_msgs::Image>())
+          msg.image = m.instantiate<sensor_msgs::Image>();
+        else if (m.isType<sensor_msgs::Imu>())
+          msg.imu = m.instantiate<sensor_msgs::Imu>();
+        else if (m.isType<geometry_msgs::PoseStamped>())
+          msg.truth = m.instantiate<geometry_msgs::PoseStamped>();
+        else
+          continue;
+        if (!messages.Push(std::move(msg)))
+          break;
+      }
+    } catch (...) {
+      reader_error = std::current_exception();
+    }
+    messages.Close();
+  });
+
+  size_t next_features = 0;
+  {
+    // the reader is joined when the replay ends, even by an exception
+    ProducerGuard guard(&messages, &reader);
+    BagMessage msg;
+    while (messages.Pop(&msg)) {
+      while (replay && next_features < cache_.Size() && cache_.Get(next_features).time <= msg.time)
+        ReplayFeatures(cache_.Get(next_features++));
+
+      if (msg.image) {
+        UpdateImage(msg.time, msg.image);
+        common::PrintProgressBar(stdout, msg.progress / total);
+      } else if (msg.imu) {
+        UpdateImu(msg.time, *msg.imu.get());
+      } else if (msg.truth) {
+        UpdateGroundTruth(*msg.truth.get());
+      }
     }
   }
-  printf("\n");
+  if (reader_error)
+    std::rethrow_exception(reader_error);
+  if (!replay)
+    printf("\n");
+
+  if (recording_features_) {
+    cache_.Save(cache_file_);
+    recording_features_ = false;
+  }
+  cache_.Clear();
 }
 
 }  // namespace ekf_bag
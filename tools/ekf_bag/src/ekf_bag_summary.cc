@@ -0,0 +1,94 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ekf_bag/ekf_bag_summary.h>
+
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ekf_bag {
+
+// ekf states further than this from the last ground truth are not compared
+static const double kMaxGroundTruthAge = 0.1;
+
+EkfBagSummary::EkfBagSummary(const char* bagfile, const char* mapfile, const char* param_file) :
+          EkfBag(bagfile, mapfile), ground_truth_set_(false),
+          ekf_count_(0), compared_count_(0), lost_count_(0),
+          position_sq_sum_(0.0), position_max_(0.0),
+          angle_sq_sum_(0.0), angle_max_(0.0) {
+  if (param_file != NULL)
+    param_file_ = param_file;
+  // virtual function has to be called in subclass since not initialized in superclass
+  config_reader::ConfigReader config;
+  ReadParams(&config);
+}
+
+void EkfBagSummary::UpdateGroundTruth(const geometry_msgs::PoseStamped & pose) {
+  EkfBag::UpdateGroundTruth(pose);
+  ground_truth_time_ = pose.header.stamp;
+  ground_truth_set_ = true;
+}
+
+void EkfBagSummary::UpdateEKF(const ff_msgs::EkfState & s) {
+  EkfBag::UpdateEKF(s);
+
+  ekf_count_++;
+  if (s.confidence == ff_msgs::EkfState::CONFIDENCE_LOST)
+    lost_count_++;
+  if (!ground_truth_set_ || std::abs((s.header.stamp - ground_truth_time_).toSec()) > kMaxGroundTruthAge)
+    return;
+
+  const geometry_msgs::Pose & gt = ground_truth_;
+  Eigen::Vector3d dp(s.pose.position.x - gt.position.x, s.pose.position.y - gt.position.y,
+                     s.pose.position.z - gt.position.z);
+  Eigen::Quaterniond q_ekf(s.pose.orientation.w, s.pose.orientation.x, s.pose.orientation.y, s.pose.orientation.z);
+  Eigen::Quaterniond q_gt(gt.orientation.w, gt.orientation.x, gt.orientation.y, gt.orientation.z);
+  double angle = q_ekf.normalized().angularDistance(q_gt.normalized());
+
+  double position = dp.norm();
+  position_sq_sum_ += position * position;
+  position_max_ = std::max(position_max_, position);
+  angle_sq_sum_ += angle * angle;
+  angle_max_ = std::max(angle_max_, angle);
+  compared_count_++;
+}
+
+EkfErrorSummary EkfBagSummary::GetSummary(void) const {
+  EkfErrorSummary s;
+  s.ekf_count = ekf_count_;
+  s.compared_count = compared_count_;
+  s.lost_count = lost_count_;
+  s.position_rmse = (compared_count_ > 0 ? sqrt(position_sq_sum_ / compared_count_) : 0.0);
+  s.position_max = position_max_;
+  s.angle_rmse = (compared_count_ > 0 ? sqrt(angle_sq_sum_ / compared_count_) : 0.0);
+  s.angle_max = angle_max_;
+  return s;
+}
+
+void EkfBagSummary::PrintHeader(FILE* f) {
+  fprintf(f, "ekf_count compared_count lost_count position_rmse position_max angle_rmse angle_max");
+}
+
+void EkfBagSummary::Print(FILE* f, const EkfErrorSummary & s) {
+  fprintf(f, "%d %d %d %g %g %g %g", s.ekf_count, s.compared_count, s.lost_count,
+          s.position_rmse, s.position_max, s.angle_rmse, s.angle_max);
+}
+
+}  // namespace ekf_bag
@@ -0,0 +1,193 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ekf_bag/feature_cache.h>
+
+#include <ros/serialization.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace ekf_bag {
+
+// file layout: magic, version, signature, entry count, then for each entry the
+// type, the bag time and the length prefixed ROS serialized message
+static const char kCacheMagic[8] = {'E', 'K', 'F', 'C', 'A', 'C', 'H', 'E'};
+static const uint32_t kCacheVersion = 1;
+
+static bool WriteU32(FILE* f, uint32_t v) {
+  return fwrite(&v, sizeof(v), 1, f) == 1;
+}
+
+static bool ReadU32(FILE* f, uint32_t* v) {
+  return fread(v, sizeof(*v), 1, f) == 1;
+}
+
+template <class RosMessage>
+static bool WriteMessage(FILE* f, const RosMessage & msg, std::vector<uint8_t>* buffer) {
+  uint32_t size = ros::serialization::serializationLength(msg);
+  buffer->resize(size);
+  ros::serialization::OStream stream(buffer->data(), size);
+  ros::serialization::serialize(stream, msg);
+  return WriteU32(f, size) && fwrite(buffer->data(), 1, size, f) == size;
+}
+
+template <class RosMessage>
+static bool ReadMessage(FILE* f, RosMessage* msg, std::vector<uint8_t>* buffer) {
+  uint32_t size;
+  if (!ReadU32(f, &size))
+    return false;
+  buffer->resize(size);
+  if (fread(buffer->data(), 1, size, f) != size)
+    return false;
+  ros::serialization::IStream stream(buffer->data(), size);
+  ros::serialization::deserialize(stream, *msg);
+  return true;
+}
+
+void FeatureCache::SetSignature(const std::string & map_file, const std::string & params) {
+  // a map rebuilt in place changes size or modification time
+  struct stat st;
+  int64_t map_size = -1, map_mtime = 0;
+  if (stat(map_file.c_str(), &st) == 0) {
+    map_size = st.st_size;
+    map_mtime = st.st_mtime;
+  }
+  // FNV-1a of the parameters, which keeps the header short
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < params.size(); i++) {
+    hash ^= static_cast<unsigned char>(params[i]);
+    hash *= 1099511628211ULL;
+  }
+  char buf[96];
+  snprintf(buf, sizeof(buf), " %lld %lld %016llx", static_cast<long long>(map_size),  // NOLINT
+           static_cast<long long>(map_mtime), static_cast<unsigned long long>(hash));  // NOLINT
+  signature_ = map_file + buf;
+}
+
+void FeatureCache::AddOpticalFlow(const ros::Time & time, const ff_msgs::Feature2dArray & of) {
+  CachedFeatures f;
+  f.type = CachedFeatures::OPTICAL_FLOW;
+  f.time = time;
+  f.of = of;
+  entries_.push_back(f);
+}
+
+void FeatureCache::AddSparseMap(const ros::Time & time, const ff_msgs::VisualLandmarks & vl) {
+  CachedFeatures f;
+  f.type = CachedFeatures::SPARSE_MAP;
+  f.time = time;
+  f.vl = vl;
+  entries_.push_back(f);
+}
+
+bool FeatureCache::Save(const std::string & file) const {
+  // write to a temporary file first so an interrupted run never leaves a partial
+  // cache, unique because parallel workers may save the cache of the same bag
+  std::string tmp = file + ".XXXXXX";
+  int fd = mkstemp(&tmp[0]);
+  FILE* f = (fd < 0) ? NULL : fdopen(fd, "wb");
+  if (f == NULL) {
+    fprintf(stderr, "Failed to open feature cache %s for writing.\n", tmp.c_str());
+    if (fd >= 0) {
+      close(fd);
+      unlink(tmp.c_str());
+    }
+    return false;
+  }
+  bool ok = fchmod(fd, 0644) == 0 &&
+            fwrite(kCacheMagic, sizeof(kCacheMagic), 1, f) == 1 &&
+            WriteU32(f, kCacheVersion) &&
+            WriteU32(f, signature_.size()) &&
+            fwrite(signature_.data(), 1, signature_.size(), f) == signature_.size() &&
+            WriteU32(f, entries_.size());
+  std::vector<uint8_t> buffer;
+  for (size_t i = 0; ok && i < entries_.size(); i++) {
+    const CachedFeatures & e = entries_[i];
+    ok = WriteU32(f, e.type) && WriteU32(f, e.time.sec) && WriteU32(f, e.time.nsec);
+    if (!ok)
+      break;
+    if (e.type == CachedFeatures::OPTICAL_FLOW)
+      ok = WriteMessage(f, e.of, &buffer);
+    else
+      ok = WriteMessage(f, e.vl, &buffer);
+  }
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp.c_str(), file.c_str()) != 0) {
+    fprintf(stderr, "Failed to write feature cache %s.\n", file.c_str());
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool FeatureCache::Load(const std::string & file) {
+  entries_.clear();
+  FILE* f = fopen(file.c_str(), "rb");
+  if (f == NULL)
+    return false;
+
+  char magic[sizeof(kCacheMagic)];
+  uint32_t version, length, count;
+  if (fread(magic, sizeof(magic), 1, f) != 1 || memcmp(magic, kCacheMagic, sizeof(magic)) != 0 ||
+      !ReadU32(f, &version) || version != kCacheVersion || !ReadU32(f, &length)) {
+    fprintf(stderr, "Feature cache %s has an unknown format, ignoring.\n", file.c_str());
+    fclose(f);
+    return false;
+  }
+  std::string signature(length, '\0');
+  if (fread(&signature[0], 1, length, f) != length || signature != signature_) {
+    fprintf(stderr, "Feature cache %s was generated with a different map or parameters, ignoring.\n", file.c_str());
+    fclose(f);
+    return false;
+  }
+
+  bool ok = ReadU32(f, &count);
+  std::vector<uint8_t> buffer;
+  if (ok)
+    entries_.resize(count);
+  for (uint32_t i = 0; ok && i < count; i++) {
+    CachedFeatures & e = entries_[i];
+    uint32_t type;
+    ok = ReadU32(f, &type) && ReadU32(f, &e.time.sec) && ReadU32(f, &e.time.nsec);
+    if (!ok)
+      break;
+    e.type = static_cast<CachedFeatures::Type>(type);
+    if (e.type == CachedFeatures::OPTICAL_FLOW)
+      ok = ReadMessage(f, &e.of, &buffer);
+    else if (e.type == CachedFeatures::SPARSE_MAP)
+      ok = ReadMessage(f, &e.vl, &buffer);
+    else
+      ok = false;
+  }
+  fclose(f);
+  if (!ok) {
+    fprintf(stderr, "Feature cache %s is truncated or corrupt, ignoring.\n", file.c_str());
+    entries_.clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace ekf_bag
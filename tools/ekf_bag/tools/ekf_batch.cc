@@ -0,0 +1,150 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <common/init.h>
+#include <ekf_bag/ekf_bag_summary.h>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+DEFINE_string(map, "", "Sparse map used for localization.");
+DEFINE_string(params, "", "Comma separated list of config files overriding the EKF parameters. "
+              "Each one is run on every bag. If empty, the default parameters are used.");
+DEFINE_string(output, "ekf_batch.txt", "File to write the summary error metrics to.");
+DEFINE_string(cache_suffix, ".features", "Suffix appended to each bag name to form its feature cache.");
+DEFINE_int32(jobs, 0, "Number of worker processes. If zero, use one per core.");
+
+// One EKF replay of a bag with one parameter set. Each job runs in its own
+// process, since the EKF autocode and the lua interpreter are not thread safe,
+// so the results do not depend on scheduling.
+struct Job {
+  std::string bag;
+  std::string params;
+  ekf_bag::EkfErrorSummary summary;
+  bool ok;
+};
+
+static void RunJob(const Job & job, int fd) {
+  // the progress bars of the workers would interleave
+  if (freopen("/dev/null", "w", stdout) == NULL)
+    _exit(1);
+  ekf_bag::EkfBagSummary bag(job.bag.c_str(), FLAGS_map.c_str(),
+                             job.params.empty() ? NULL : job.params.c_str());
+  bag.SetFeatureCache(job.bag + FLAGS_cache_suffix);
+  bag.Run();
+  ekf_bag::EkfErrorSummary s = bag.GetSummary();
+  ssize_t written = write(fd, &s, sizeof(s));
+  _exit(written == sizeof(s) ? 0 : 1);
+}
+
+// run the jobs with indices in [begin, end) on at most FLAGS_jobs processes
+static void RunJobs(std::vector<Job>* jobs, size_t begin, size_t end) {
+  std::map<pid_t, std::pair<size_t, int> > running;  // pid -> job index, pipe
+  size_t next = begin;
+  while (next < end || !running.empty()) {
+    if (next < end && static_cast<int>(running.size()) < FLAGS_jobs) {
+      int fds[2];
+      if (pipe(fds) != 0)
+        LOG(FATAL) << "Failed to create pipe.";
+      pid_t pid = fork();
+      if (pid < 0)
+        LOG(FATAL) << "Failed to fork.";
+      if (pid == 0) {
+        close(fds[0]);
+        RunJob((*jobs)[next], fds[1]);
+      }
+      close(fds[1]);
+      running[pid] = std::make_pair(next, fds[0]);
+      next++;
+      continue;
+    }
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0)
+      LOG(FATAL) << "Failed to wait for workers.";
+    auto it = running.find(pid);
+    if (it == running.end())
+      continue;
+    Job & job = (*jobs)[it->second.first];
+    job.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+             read(it->second.second, &job.summary, sizeof(job.summary)) == sizeof(job.summary);
+    if (!job.ok)
+      LOG(ERROR) << "Failed to run " << job.bag << " with parameters '" << job.params << "'.";
+    close(it->second.second);
+    running.erase(it);
+  }
+}
+
+int main(int argc, char ** argv) {
+  common::InitFreeFlyerApplication(&argc, &argv);
+
+  if (argc < 2 || FLAGS_map.empty()) {
+    LOG(INFO) << "Usage: " << argv[0] << " -map map.map [-params a.config,b.config] [-jobs n] bag1.bag bag2.bag ...";
+    exit(0);
+  }
+  if (FLAGS_jobs <= 0)
+    FLAGS_jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<std::string> params;
+  std::stringstream ss(FLAGS_params);
+  std::string p;
+  while (std::getline(ss, p, ','))
+    if (!p.empty())
+      params.push_back(p);
+  if (params.empty())
+    params.push_back("");
+
+  // the first parameter set of every bag goes first, and creates the feature
+  // caches if needed, so that no two workers compute the features of one bag
+  std::vector<Job> jobs;
+  for (int i = 1; i < argc; i++)
+    jobs.push_back({argv[i], params[0], ekf_bag::EkfErrorSummary(), false});
+  for (size_t j = 1; j < params.size(); j++)
+    for (int i = 1; i < argc; i++)
+      jobs.push_back({argv[i], params[j], ekf_bag::EkfErrorSummary(), false});
+  RunJobs(&jobs, 0, argc - 1);
+  RunJobs(&jobs, argc - 1, jobs.size());
+
+  FILE* f = fopen(FLAGS_output.c_str(), "w");
+  if (f == NULL) {
+    LOG(ERROR) << "Failed to open " << FLAGS_output;
+    return 1;
+  }
+  fprintf(f, "bag params ");
+  ekf_bag::EkfBagSummary::PrintHeader(f);
+  fprintf(f, "\n");
+  for (size_t i = 0; i < jobs.size(); i++) {
+    if (!jobs[i].ok)
+      continue;
+    fprintf(f, "%s %s ", jobs[i].bag.c_str(), jobs[i].params.empty() ? "default" : jobs[i].params.c_str());
+    ekf_bag::EkfBagSummary::Print(f, jobs[i].summary);
+    fprintf(f, "\n");
+  }
+  fclose(f);
+  return 0;
+}
@@ -21,11 +21,15 @@
 
 #include <ekf_bag/ekf_bag.h>
 #include <ekf_bag/tracked_features.h>
+#include <ekf_video/render_pipeline.h>
 #include <ekf_video/video_writer.h>
 
 #include <ff_msgs/EkfState.h>
 #include <geometry_msgs/Pose.h>
+#include <Eigen/Core>
+#include <QtGui/QImage>
 #include <list>
+#include <vector>
 
 #define MAHAL_NUM_BINS 20
 #define MAHAL_BIN_SIZE 0.5
@@ -36,9 +40,21 @@ class QRect;
 
 namespace ekf_video {
 
+// everything drawn in a frame, copied from the replay when the image arrives
+struct VideoFrame {
+  sensor_msgs::ImageConstPtr image;
+  std::vector<Eigen::Vector2f> of_features;  // pixels relative to the image center
+  std::vector<Eigen::Vector2f> sm_features;
+  std::vector<geometry_msgs::Pose> pose_history;
+  int mahal_bins[MAHAL_NUM_BINS];
+};
+
 class EkfBagVideo : public ekf_bag::EkfBag {
  public:
-  EkfBagVideo(const char* bagfile, const char* mapfile, const char* videofile);
+  // frames are composed on render_threads threads, one per core if zero, and
+  // encoded with the given x264 preset
+  EkfBagVideo(const char* bagfile, const char* mapfile, const char* videofile,
+              unsigned int render_threads = 0, const char* preset = "faster");
   virtual ~EkfBagVideo(void);
 
  protected:
@@ -51,11 +67,15 @@ class EkfBagVideo : public ekf_bag::EkfBag {
   virtual void ReadParams(config_reader::ConfigReader* config);
 
  private:
-  void DrawImage(QPainter & p, const sensor_msgs::ImageConstPtr & ros_image, const QRect & rect);
-  void DrawTable(QPainter & p, const QRect & rect);
-  void DrawMahalanobis(QPainter & p, const QRect & rect);
+  // these run on the render threads, and only draw from the frame
+  static void ComposeFrame(const VideoFrame & frame, QImage* image);
+  static void DrawImage(QPainter & p, const VideoFrame & frame, const QRect & rect);
+  static void DrawTable(QPainter & p, const VideoFrame & frame, const QRect & rect);
+  static void DrawMahalanobis(QPainter & p, const VideoFrame & frame, const QRect & rect);
 
   VideoWriter video_;
+  // declared after the writer, so frames still in the pipeline are encoded first
+  RenderPipeline<VideoFrame, QImage> pipeline_;
 
   ekf_bag::TrackedOFFeatures tracked_of_;
   ekf_bag::TrackedSMFeatures tracked_sm_;
@@ -0,0 +1,142 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef EKF_VIDEO_RENDER_PIPELINE_H_
+#define EKF_VIDEO_RENDER_PIPELINE_H_
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace ekf_video {
+
+// Composes video frames on a pool of worker threads and encodes them in order
+// on a thread of its own. Each frame pushed holds everything needed to draw
+// it, so the replay can move on to the next one. Frames are kept in a ring of
+// slots, each with the image it is composed into, and Push blocks while the
+// ring is full, so the memory used is bounded and the replay runs at most
+// depth frames ahead of the encoder. Frames are encoded in the order pushed,
+// however long each one takes to compose.
+template <typename Frame, typename Image>
+class RenderPipeline {
+ public:
+  typedef std::function<void(const Frame &, Image*)> ComposeFunction;
+  typedef std::function<void(const Image &)> EncodeFunction;
+
+  RenderPipeline(ComposeFunction compose, EncodeFunction encode, unsigned int workers, size_t depth) :
+      compose_(compose), encode_(encode), slots_(std::max(depth, static_cast<size_t>(1))),
+      pushed_(0), encoded_(0), stop_(false) {
+    for (unsigned int i = 0; i < std::max(workers, 1u); i++)
+      workers_.emplace_back(&RenderPipeline::Compose, this);
+    encoder_ = std::thread(&RenderPipeline::Encode, this);
+  }
+
+  ~RenderPipeline(void) {
+    Finish();
+  }
+
+  void Push(Frame && frame) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Slot & slot = slots_[pushed_ % slots_.size()];
+    slot_changed_.wait(lock, [&slot]() { return slot.state == FREE; });
+    slot.frame = std::move(frame);
+    slot.state = QUEUED;
+    jobs_.push_back(pushed_++);
+    job_added_.notify_one();
+  }
+
+  // waits for all the frames pushed to be encoded
+  void Finish(void) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    job_added_.notify_all();
+    slot_changed_.notify_all();
+    for (auto & worker : workers_)
+      if (worker.joinable())
+        worker.join();
+    if (encoder_.joinable())
+      encoder_.join();
+  }
+
+ private:
+  enum State { FREE, QUEUED, COMPOSED };
+
+  struct Slot {
+    Slot(void) : state(FREE) {}
+    State state;
+    Frame frame;
+    Image image;
+  };
+
+  void Compose(void) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      job_added_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+      if (jobs_.empty())
+        return;
+      Slot & slot = slots_[jobs_.front() % slots_.size()];
+      jobs_.pop_front();
+      // the slot belongs to this worker until it is marked composed
+      lock.unlock();
+      compose_(slot.frame, &slot.image);
+      lock.lock();
+      slot.state = COMPOSED;
+      slot_changed_.notify_all();
+    }
+  }
+
+  void Encode(void) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      Slot & slot = slots_[encoded_ % slots_.size()];
+      slot_changed_.wait(lock, [this, &slot]() {
+        return slot.state == COMPOSED || (stop_ && encoded_ == pushed_); });
+      if (slot.state != COMPOSED)
+        return;
+      lock.unlock();
+      encode_(slot.image);
+      slot.frame = Frame();
+      lock.lock();
+      slot.state = FREE;
+      encoded_++;
+      slot_changed_.notify_all();
+    }
+  }
+
+  ComposeFunction compose_;
+  EncodeFunction encode_;
+  std::vector<Slot> slots_;
+  std::deque<size_t> jobs_;
+  size_t pushed_, encoded_;
+  bool stop_;
+  std::mutex mutex_;
+  std::condition_variable job_added_, slot_changed_;
+  std::vector<std::thread> workers_;
+  std::thread encoder_;
+};
+
+}  // end namespace ekf_video
+
+#endif  // EKF_VIDEO_RENDER_PIPELINE_H_
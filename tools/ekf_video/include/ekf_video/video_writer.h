@@ -24,6 +24,7 @@
 struct AVCodecContext;
 struct AVFormatContext;
 struct AVFrame;
+struct SwsContext;
 
 class QImage;
 
@@ -31,13 +32,15 @@ namespace ekf_video {
 
 class VideoWriter {
  public:
-  VideoWriter(const char* videofile, int width, int height);
+  // encodes h264 with the given x264 preset, on as many threads as the
+  // encoder finds useful
+  VideoWriter(const char* videofile, int width, int height, const char* preset = "faster");
   virtual ~VideoWriter(void);
 
   virtual void AddFrame(const QImage & image);
 
  private:
-  void OpenVideo(const char* videofile);
+  void OpenVideo(const char* videofile, const char* preset);
   void CloseVideo();
 
   int EncodeFrame(AVFrame* frame, int* output_received);
@@ -47,6 +50,7 @@ class VideoWriter {
   struct AVFormatContext* format_context_;
   struct AVCodecContext* codec_context_;
   struct AVFrame* frame_;
+  struct SwsContext* sws_context_;
 };
 
 }  // end namespace ekf_video
@@ -25,16 +25,30 @@
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
 
+#include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
+#include <utility>
+
 namespace ekf_video {
 
-EkfBagVideo::EkfBagVideo(const char* bagfile, const char* mapfile, const char* videofile) :
-          EkfBag(bagfile, mapfile), video_(videofile, 1920, 1080) {
+// one render thread per core unless given, each with two frames in flight
+static unsigned int RenderThreads(unsigned int threads) {
+  return threads ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+EkfBagVideo::EkfBagVideo(const char* bagfile, const char* mapfile, const char* videofile,
+                         unsigned int render_threads, const char* preset) :
+          EkfBag(bagfile, mapfile), video_(videofile, 1920, 1080, preset),
+          pipeline_(&EkfBagVideo::ComposeFrame, std::bind(&VideoWriter::AddFrame, &video_, std::placeholders::_1),
+                    RenderThreads(render_threads), 2 * RenderThreads(render_threads)) {
   // virtual function has to be called in subclass since not initialized in superclass
   config_reader::ConfigReader config;
   ReadParams(&config);
 
   start_time_set_ = false;
   pose_count_ = 0;
+  memset(mahal_bins_, 0, sizeof(int) * MAHAL_NUM_BINS);
 }
 
 EkfBagVideo::~EkfBagVideo(void) {
@@ -56,7 +70,8 @@ void EkfBagVideo::ReadParams(config_reader::ConfigReader* config) {
   tracked_sm_.SetCameraToBody(nav_cam_to_body);
 }
 
-void EkfBagVideo::DrawImage(QPainter & p, const sensor_msgs::ImageConstPtr & ros_image, const QRect & rect) {
+void EkfBagVideo::DrawImage(QPainter & p, const VideoFrame & frame, const QRect & rect) {
+  const sensor_msgs::ImageConstPtr & ros_image = frame.image;
   const QImage gray(ros_image->data.data(), ros_image->width, ros_image->height,
                     ros_image->step, QImage::Format_Grayscale8);
   // draw on image
@@ -68,30 +83,27 @@ void EkfBagVideo::DrawImage(QPainter & p, const sensor_msgs::ImageConstPtr & ros
 
   // draw optical flow
   p.setBrush(QColor::fromRgb(0x99, 0x99, 0xFF, 0xA0));
-  for (auto it = tracked_of_.begin(); it != tracked_of_.end(); it++) {
-    const auto & a = (*it).second;
-    p.drawEllipse(QPointF(a.x, a.y), 4, 4);
-  }
+  for (const auto & a : frame.of_features)
+    p.drawEllipse(QPointF(a.x(), a.y()), 4, 4);
 
   // draw sparse mapping
   p.setBrush(QColor::fromRgb(0xFF, 0x00, 0x66, 0xA0));
-  for (auto it = tracked_sm_.begin(); it != tracked_sm_.end(); it++) {
-    Eigen::Vector2d pixel = tracked_sm_.FeatureToCurrentPixel(*it);
+  for (const auto & pixel : frame.sm_features)
     if (pixel.x() < rect.width() / 2 && pixel.y() < rect.height() / 2)
       p.drawEllipse(QPointF(pixel.x(), pixel.y()), 4, 4);
-  }
 
   p.resetTransform();
 }
 
-void EkfBagVideo::DrawTable(QPainter & p, const QRect & rect) {
+void EkfBagVideo::DrawTable(QPainter & p, const VideoFrame & frame, const QRect & rect) {
+  const std::vector<geometry_msgs::Pose> & pose_history = frame.pose_history;
   // draw robot pose
   p.translate(rect.center().x(), rect.center().y());
   p.scale(rect.width() / 2.13333, rect.height() / 2.13333);
 
-  if (pose_history_.size() > 0) {
+  if (pose_history.size() > 0) {
     p.fillRect(QRectF(-1.0, -1.0, 2.0, 2.0), QBrush(QColor::fromRgb(0xDD, 0xDD, 0xDD)));
-    auto & pose = pose_history_.back();
+    auto & pose = pose_history.back();
     Eigen::Quaternionf o(pose.orientation.w, pose.orientation.x, pose.orientation.y, pose.orientation.z);
     auto euler = o.toRotationMatrix().eulerAngles(0, 1, 2);
     float zrot = (euler[2] + M_PI) * 180.0 / M_PI;
@@ -106,11 +118,11 @@ void EkfBagVideo::DrawTable(QPainter & p, const QRect & rect) {
     p.translate(-pose.position.x, -pose.position.y);
 
     int i = 0;
-    for (auto it = pose_history_.begin(); it != pose_history_.end(); it++) {
+    for (auto it = pose_history.begin(); it != pose_history.end(); it++) {
       pen.setColor(QColor::fromRgb(0x10, 0xDD, 0x10, (unsigned char)(255 * (i / 200.0))));
       p.setPen(pen);
       auto second = std::next(it);
-      if (second == pose_history_.end())
+      if (second == pose_history.end())
         break;
       p.drawLine(QLineF(it->position.x, it->position.y, second->position.x, second->position.y));
       i++;
@@ -120,12 +132,13 @@ void EkfBagVideo::DrawTable(QPainter & p, const QRect & rect) {
   p.resetTransform();
 }
 
-void EkfBagVideo::DrawMahalanobis(QPainter & p, const QRect & rect) {
+void EkfBagVideo::DrawMahalanobis(QPainter & p, const VideoFrame & frame, const QRect & rect) {
+  const int* mahal_bins = frame.mahal_bins;
   p.translate(rect.x(), rect.y());
 
   for (int i = 0; i < MAHAL_NUM_BINS; i++)
-    if (mahal_bins_[i] > 0) {
-      float height = std::min(mahal_bins_[i], MAHAL_BIN_MAX) / static_cast<float>(MAHAL_BIN_MAX) * rect.height();
+    if (mahal_bins[i] > 0) {
+      float height = std::min(mahal_bins[i], MAHAL_BIN_MAX) / static_cast<float>(MAHAL_BIN_MAX) * rect.height();
       p.fillRect(QRectF(i * rect.width() / MAHAL_NUM_BINS, rect.height() - height,
             rect.width() / static_cast<float>(MAHAL_NUM_BINS), height),
             QBrush(QColor::fromRgb(0x00, 0xFF, 0x00)));
@@ -147,19 +160,33 @@ void EkfBagVideo::UpdateImage(const ros::Time & time, const sensor_msgs::ImageCo
     start_time_set_ = true;
   }
 
-  QImage image(1920, 1080, QImage::Format_ARGB32);
-  image.fill(QColor::fromRgb(0, 0, 0));
-  QPainter p(&image);
+  // copy what is drawn, so the frame can be composed while the replay goes on
+  VideoFrame frame;
+  frame.image = ros_image;
+  for (auto it = tracked_of_.begin(); it != tracked_of_.end(); it++)
+    frame.of_features.push_back(Eigen::Vector2f(it->second.x, it->second.y));
+  for (auto it = tracked_sm_.begin(); it != tracked_sm_.end(); it++)
+    frame.sm_features.push_back(tracked_sm_.FeatureToCurrentPixel(*it).cast<float>());
+  frame.pose_history.assign(pose_history_.begin(), pose_history_.end());
+  memcpy(frame.mahal_bins, mahal_bins_, sizeof(int) * MAHAL_NUM_BINS);
+  pipeline_.Push(std::move(frame));
+}
+
+void EkfBagVideo::ComposeFrame(const VideoFrame & frame, QImage* image) {
+  // the image of a pipeline slot is reused by the frames composed in it
+  if (image->isNull())
+    *image = QImage(1920, 1080, QImage::Format_ARGB32);
+  image->fill(QColor::fromRgb(0, 0, 0));
+  QPainter p(image);
 
-  DrawImage(p, ros_image, QRect(0, 0, 1280, 960));
+  DrawImage(p, frame, QRect(0, 0, 1280, 960));
 
   // draw side widgets
   // starts at pixel 1280, width is 640
-  DrawTable(p, QRect(1280, 0, 640, 640));
-  DrawMahalanobis(p, QRect(1280, 640, 640, 60));
+  DrawTable(p, frame, QRect(1280, 0, 640, 640));
+  DrawMahalanobis(p, frame, QRect(1280, 640, 640, 60));
 
   p.end();
-  video_.AddFrame(image);
 }
 
 void EkfBagVideo::UpdateEKF(const ff_msgs::EkfState & s) {
@@ -41,17 +41,17 @@ void InitializeLibAv(void) {
   avcodec_register_all();
 }
 
-VideoWriter::VideoWriter(const char* videofile, int width, int height) :
-     width_(width), height_(height) {
+VideoWriter::VideoWriter(const char* videofile, int width, int height, const char* preset) :
+     width_(width), height_(height), sws_context_(NULL) {
   InitializeLibAv();
-  OpenVideo(videofile);
+  OpenVideo(videofile, preset);
 }
 
 VideoWriter::~VideoWriter(void) {
   CloseVideo();
 }
 
-void VideoWriter::OpenVideo(const char* videofile) {
+void VideoWriter::OpenVideo(const char* videofile, const char* preset) {
   // open container
   avformat_alloc_output_context2(&format_context_, NULL, NULL, videofile);
   if (format_context_ == NULL) {
@@ -88,9 +88,13 @@ void VideoWriter::OpenVideo(const char* videofile) {
   codec_context_->pix_fmt = AV_PIX_FMT_YUV420P;
   if (format_context_->oformat->flags & AVFMT_GLOBALHEADER)
     codec_context_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  // let the encoder pick its number of threads, encoding several frames at
+  // once and splitting each one in slices
+  codec_context_->thread_count = 0;
+  codec_context_->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
   AVDictionary* dict = NULL;
-  av_dict_set(&dict, "preset", "veryslow", 0);
+  av_dict_set(&dict, "preset", preset, 0);
   av_dict_set_int(&dict, "crf", 10, 0);
   int result = avcodec_open2(codec_context_, codec, &dict);
   if (result < 0) {
@@ -149,6 +153,8 @@ void VideoWriter::CloseVideo(void) {
     if (format_context_->streams[i]->codec)
       avcodec_close(format_context_->streams[i]->codec);
   av_frame_free(&frame_);
+  sws_freeContext(sws_context_);
+  sws_context_ = NULL;
   if (!(format_context_->oformat->flags & AVFMT_NOFILE))
     avio_close(format_context_->pb);
   avformat_free_context(format_context_);
@@ -170,8 +176,8 @@ int VideoWriter::EncodeFrame(AVFrame* frame, int* output_received) {
     return result;
   }
   if (update) {
-    if (frame && frame->key_frame)
-      packet.flags |= AV_PKT_FLAG_KEY;
+    // the packet may be for an earlier frame, since frames are encoded in
+    // parallel, and the encoder has already flagged it if it is a key frame
     packet.pts = av_rescale_q_rnd(packet.pts, codec_context_->time_base,
                                   format_context_->streams[0]->time_base, AV_ROUND_NEAR_INF);
     packet.dts = av_rescale_q_rnd(packet.dts, codec_context_->time_base,
@@ -190,7 +196,8 @@ int VideoWriter::EncodeFrame(AVFrame* frame, int* output_received) {
 }
 
 void VideoWriter::AddFrame(const QImage & image) {
-  struct SwsContext* context = sws_getContext(image.width(), image.height(), AV_PIX_FMT_BGRA,
+  // reuses the context as long as the images keep the same size
+  sws_context_ = sws_getCachedContext(sws_context_, image.width(), image.height(), AV_PIX_FMT_BGRA,
                                width_, height_, AV_PIX_FMT_YUV420P, SWS_BICUBIC, NULL, NULL, NULL);
   int result = av_frame_make_writable(frame_);
   if (result < 0) {
@@ -201,8 +208,7 @@ void VideoWriter::AddFrame(const QImage & image) {
   const unsigned char* source_image = image.constBits();
   int image_size = image.bytesPerLine();
 
-  sws_scale(context, &source_image, &image_size, 0, image.height(), frame_->data, frame_->linesize);
-  sws_freeContext(context);
+  sws_scale(sws_context_, &source_image, &image_size, 0, image.height(), frame_->data, frame_->linesize);
 
   if (frame_->pts % 15 == 0)
     frame_->key_frame = 1;
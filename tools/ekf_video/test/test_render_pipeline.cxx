@@ -0,0 +1,168 @@
+/* Copyright (c) 2017, United States Government, as represented by the
+ * Administrator of the National Aeronautics and Space Administration.
+ * 
+ * All rights reserved.
+ * 
+ * The Astrobee platform is licensed under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with the
+ * License. You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <ekf_bag/bounded_queue.h>
+#include <ekf_video/render_pipeline.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+// Sleeps for a random time of up to a fifth of a millisecond, so that frames are composed out of
+// order by the workers
+void Jitter(void) {
+  thread_local std::mt19937 generator(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  std::this_thread::sleep_for(std::chrono::microseconds(generator() % 200));
+}
+
+// Every frame is encoded once, in the order pushed, whatever the number of workers and the depth
+TEST(RenderPipeline, EncodesInOrder) {
+  const int kFrames = 2000;
+  for (unsigned int workers = 1; workers <= 5; workers++) {
+    for (size_t depth : {1, 2, 3, 8}) {
+      int encoded = 0;
+      bool in_order = true;
+      {
+        ekf_video::RenderPipeline<std::vector<int>, int> pipeline(
+          [](const std::vector<int> & frame, int* image) {
+            Jitter();
+            *image = 2 * frame[0];
+          },
+          [&encoded, &in_order](const int & image) {
+            in_order = in_order && (image == 2 * encoded);
+            encoded++;
+          },
+          workers, depth);
+        for (int i = 0; i < kFrames; i++)
+          pipeline.Push(std::vector<int>{i});
+      }
+      EXPECT_TRUE(in_order) << workers << " workers, depth " << depth;
+      EXPECT_EQ(kFrames, encoded) << workers << " workers, depth " << depth;
+    }
+  }
+}
+
+// Push blocks while depth frames are waiting to be encoded, so the replay cannot run ahead
+TEST(RenderPipeline, BoundsFramesInFlight) {
+  const size_t kDepth = 4;
+  std::atomic<int> in_flight(0), most(0);
+  {
+    ekf_video::RenderPipeline<int, int> pipeline(
+      [](const int & frame, int* image) { *image = frame; },
+      [&in_flight](const int & image) {
+        Jitter();
+        in_flight--;
+      },
+      3, kDepth);
+    for (int i = 0; i < 500; i++) {
+      // counted before the push, so one more than the frames the pipeline holds
+      int now = ++in_flight;
+      most = std::max(most.load(), now);
+      pipeline.Push(std::move(i));
+    }
+    pipeline.Finish();
+    EXPECT_EQ(0, in_flight.load());
+  }
+  EXPECT_LE(most.load(), static_cast<int>(kDepth) + 1);
+}
+
+// Finishing a pipeline that was given nothing, or finishing it twice, returns
+TEST(RenderPipeline, FinishesEmpty) {
+  int encoded = 0;
+  ekf_video::RenderPipeline<int, int> pipeline(
+    [](const int & frame, int* image) { *image = frame; },
+    [&encoded](const int & image) { encoded++; },
+    2, 2);
+  pipeline.Finish();
+  pipeline.Finish();
+  EXPECT_EQ(0, encoded);
+}
+
+// Items come out in the order they went in, across threads, and none is lost
+TEST(BoundedQueue, KeepsOrder) {
+  const int kItems = 100000;
+  ekf_bag::BoundedQueue<std::unique_ptr<int>> queue(8);
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kItems; i++)
+      queue.Push(std::unique_ptr<int>(new int(i)));
+    queue.Close();
+  });
+  std::unique_ptr<int> item;
+  int popped = 0;
+  bool in_order = true;
+  while (queue.Pop(&item)) {
+    in_order = in_order && (*item == popped);
+    popped++;
+  }
+  producer.join();
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(kItems, popped);
+}
+
+// Push blocks while the queue is full, so the producer is at most capacity items ahead
+TEST(BoundedQueue, BoundsProducer) {
+  const size_t kCapacity = 4;
+  ekf_bag::BoundedQueue<int> queue(kCapacity);
+  std::atomic<int> pushed(0), popped(0), most(0);
+  std::thread producer([&queue, &pushed, &popped, &most]() {
+    for (int i = 0; i < 1000; i++) {
+      int item = i;
+      queue.Push(std::move(item));
+      pushed++;
+      most = std::max(most.load(), pushed.load() - popped.load());
+    }
+    queue.Close();
+  });
+  int item;
+  while (queue.Pop(&item)) {
+    Jitter();
+    popped++;
+  }
+  producer.join();
+  EXPECT_EQ(1000, popped.load());
+  // the producer may push one more item between a pop and the count of it
+  EXPECT_LE(most.load(), static_cast<int>(kCapacity) + 1);
+}
+
+// Once closed, Push drops items and unblocks, while Pop still returns the items left
+TEST(BoundedQueue, CloseDrains) {
+  ekf_bag::BoundedQueue<int> queue(1);
+  int item = 1;
+  EXPECT_TRUE(queue.Push(std::move(item)));
+  std::atomic<bool> dropped(false);
+  std::thread producer([&queue, &dropped]() {
+    int blocked = 2;
+    dropped = !queue.Push(std::move(blocked));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  queue.Close();
+  producer.join();
+  EXPECT_TRUE(dropped.load());
+  item = 3;
+  EXPECT_FALSE(queue.Push(std::move(item)));
+  ASSERT_TRUE(queue.Pop(&item));
+  EXPECT_EQ(1, item);
+  EXPECT_FALSE(queue.Pop(&item));
+}
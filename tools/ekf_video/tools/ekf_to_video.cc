@@ -19,6 +19,14 @@
 #include <common/init.h>
 #include <ekf_video/ekf_bag_video.h>
 
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+
+DEFINE_int32(render_threads, 0, "Number of threads composing frames. If zero, use one per core.");
+DEFINE_string(preset, "faster", "x264 preset. Slower presets encode smaller files, and fall behind the bag.");
+
 int main(int argc, char ** argv) {
   common::InitFreeFlyerApplication(&argc, &argv);
 
@@ -27,8 +35,19 @@ int main(int argc, char ** argv) {
     exit(0);
   }
 
-  ekf_video::EkfBagVideo bag(argv[2], argv[1], argv[3]);
-
-  bag.Run();
+  // time the replay from after the map is loaded until the bag, and with it
+  // the render pipeline, is destroyed and the last frame encoded
+  std::chrono::steady_clock::time_point start;
+  double duration;
+  {
+    ekf_video::EkfBagVideo bag(argv[2], argv[1], argv[3], std::max(FLAGS_render_threads, 0),
+                               FLAGS_preset.c_str());
+    duration = bag.Duration();
+    start = std::chrono::steady_clock::now();
+    bag.Run();
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG(INFO) << "Rendered " << duration << " s of bag in " << elapsed << " s, "
+            << duration / elapsed << " times real time.";
 }
 